@@ -10,3 +10,14 @@ option(ENABLE_SINGLE_PRECISION "Enable support for single-precision calculations
 option(ENABLE_DOUBLE_PRECISION "Enable support for double-precision calculations" ON)
 option(ENABLE_COMPLEX_KERNELS  "Enable support for complex-valued kernel functions" ON)
 option(ENABLE_COMPLEX_BASIS_FUNCTIONS  "Enable support for complex-valued basis functions" ON)
+option(WITH_NATIVE_ARCH "Optimise for the instruction set of the build machine (e.g. AVX2, AVX-512)" OFF)
+
+if(WITH_NATIVE_ARCH)
+    include(CheckCXXCompilerFlag)
+    check_cxx_compiler_flag("-march=native" BEMPP_HAS_MARCH_NATIVE)
+    if(BEMPP_HAS_MARCH_NATIVE)
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -march=native")
+    else()
+        message(WARNING "WITH_NATIVE_ARCH requested, but the compiler does not accept -march=native")
+    endif()
+endif()
@@ -0,0 +1,112 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Measures the scaling of dense weak-form assembly with the number of threads.
+//
+// Usage: benchmark_dense_assembly [mesh_file [max_thread_count]]
+//
+// The weak form of the Laplace single-layer boundary operator discretised
+// with piecewise linear functions is assembled repeatedly with 1, 2, 4, ...
+// threads, both with the lock-free (colored) and the mutex-protected
+// scatter, and the wall times, speedups and parallel efficiencies are printed.
+
+#include "bempp/assembly/assembly_options.hpp"
+#include "bempp/assembly/boundary_operator.hpp"
+#include "bempp/assembly/context.hpp"
+#include "bempp/assembly/discrete_boundary_operator.hpp"
+#include "bempp/assembly/laplace_3d_single_layer_boundary_operator.hpp"
+#include "bempp/assembly/numerical_quadrature_strategy.hpp"
+
+#include "bempp/common/boost_make_shared_fwd.hpp"
+
+#include "bempp/grid/grid.hpp"
+#include "bempp/grid/grid_factory.hpp"
+
+#include "bempp/space/piecewise_linear_continuous_scalar_space.hpp"
+
+#include <tbb/task_scheduler_init.h>
+#include <tbb/tick_count.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+typedef double BFT;
+typedef double RT;
+
+using namespace Bempp;
+
+double assemblyTime(const shared_ptr<const Space<BFT>> &space,
+                    int threadCount, bool lockFree) {
+  AssemblyOptions assemblyOptions;
+  assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+  assemblyOptions.setMaxThreadCount(threadCount);
+  assemblyOptions.enableLockFreeDenseAssembly(lockFree);
+  AccuracyOptions accuracyOptions;
+  shared_ptr<NumericalQuadratureStrategy<BFT, RT>> quadStrategy(
+      new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+  shared_ptr<Context<BFT, RT>> context(
+      new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+  BoundaryOperator<BFT, RT> op = laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+      context, space, space, space);
+
+  tbb::tick_count start = tbb::tick_count::now();
+  op.weakForm();
+  tbb::tick_count end = tbb::tick_count::now();
+  return (end - start).seconds();
+}
+
+int main(int argc, char *argv[]) {
+  const char *meshFile =
+      argc > 1 ? argv[1] : "../../../meshes/sphere-h-0.05.msh";
+  int maxThreadCount = argc > 2
+                           ? std::atoi(argv[2])
+                           : tbb::task_scheduler_init::default_num_threads();
+
+  GridParameters params;
+  params.topology = GridParameters::TRIANGULAR;
+  shared_ptr<Grid> grid = GridFactory::importGmshGrid(params, meshFile);
+  shared_ptr<Space<BFT>> space(
+      new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+  std::cout << "Mesh: " << meshFile << ", "
+            << space->globalDofCount() << " DOFs" << std::endl;
+  std::cout << std::setw(8) << "threads" << std::setw(14) << "locked [s]"
+            << std::setw(14) << "lock-free [s]" << std::setw(10) << "speedup"
+            << std::setw(12) << "efficiency" << std::endl;
+
+  double serialTime = 0.;
+  for (int threadCount = 1; threadCount <= maxThreadCount;) {
+    const double lockedTime = assemblyTime(space, threadCount, false);
+    const double lockFreeTime = assemblyTime(space, threadCount, true);
+    if (threadCount == 1)
+      serialTime = lockFreeTime;
+    const double speedup = serialTime / lockFreeTime;
+    std::cout << std::setw(8) << threadCount << std::setw(14) << lockedTime
+              << std::setw(14) << lockFreeTime << std::setw(10) << speedup
+              << std::setw(12) << speedup / threadCount << std::endl;
+    if (threadCount == maxThreadCount)
+      break;
+    threadCount = std::min(2 * threadCount, maxThreadCount);
+  }
+  return 0;
+}
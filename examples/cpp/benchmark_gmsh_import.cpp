@@ -0,0 +1,127 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Measures the time needed to load large Gmsh files.
+//
+// Usage: benchmark_gmsh_import [directory [max_divisions]]
+//
+// Triangulations of a torus with 2 * n^2 elements, n = 125, 250, ...,
+// max_divisions (default: 1000), are written in the ASCII and binary MSH 2.2
+// formats to the given directory (default: the current directory). For each
+// file, the times taken by GmshData::read() and GridFactory::importGmshGrid()
+// are printed; for ASCII files, the time taken by Dune::GmshReader, which
+// importGmshGrid() used previously, is given for comparison.
+
+#include "bempp/grid/dune.hpp"
+#include "bempp/grid/grid.hpp"
+#include "bempp/grid/grid_factory.hpp"
+#include "bempp/grid/grid_view.hpp"
+#include "bempp/io/gmsh.hpp"
+
+#include <dune/grid/io/file/gmshreader.hh>
+
+#include <tbb/tick_count.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Bempp;
+
+// Triangulation of a torus with n x n quadrilaterals split into triangles
+GmshData createTorus(int n) {
+  const double pi = 3.14159265358979323846;
+  const double R = 1., r = 0.4;
+  GmshData gmshData;
+  gmshData.reserveNumberOfNodes(n * n);
+  gmshData.reserveNumberOfElements(2 * n * n);
+  for (int j = 0; j < n; ++j)
+    for (int i = 0; i < n; ++i) {
+      const double u = 2. * pi * i / n, v = 2. * pi * j / n;
+      gmshData.addNode(1 + i + j * n, (R + r * std::cos(v)) * std::cos(u),
+                       (R + r * std::cos(v)) * std::sin(u), r * std::sin(v));
+    }
+  std::vector<int> nodes(3);
+  int element = 1;
+  for (int j = 0; j < n; ++j)
+    for (int i = 0; i < n; ++i) {
+      const int a = 1 + i + j * n;
+      const int b = 1 + (i + 1) % n + j * n;
+      const int c = 1 + (i + 1) % n + (j + 1) % n * n;
+      const int d = 1 + i + (j + 1) % n * n;
+      nodes[0] = a, nodes[1] = b, nodes[2] = c;
+      gmshData.addElement(element++, 2, nodes, 1, 1);
+      nodes[0] = a, nodes[1] = c, nodes[2] = d;
+      gmshData.addElement(element++, 2, nodes, 1, 1);
+    }
+  return gmshData;
+}
+
+void benchmark(const std::string &fileName, bool binary) {
+  tbb::tick_count start = tbb::tick_count::now();
+  GmshData gmshData = GmshData::read(fileName, 2, -1, false);
+  const double readTime = (tbb::tick_count::now() - start).seconds();
+
+  GridParameters params;
+  params.topology = GridParameters::TRIANGULAR;
+  start = tbb::tick_count::now();
+  shared_ptr<Grid> grid = GridFactory::importGmshGrid(params, fileName);
+  const double importTime = (tbb::tick_count::now() - start).seconds();
+
+  std::cout << std::setw(10) << grid->leafView()->entityCount(0)
+            << std::setw(8) << (binary ? "binary" : "ASCII") << std::setw(14)
+            << readTime << std::setw(14) << importTime;
+  if (!binary) {
+    std::vector<int> boundaryId2PhysicalEntity;
+    std::vector<int> elementIndex2PhysicalEntity;
+    start = tbb::tick_count::now();
+    std::unique_ptr<Default2dIn3dDuneGrid> duneGrid(
+        Dune::GmshReader<Default2dIn3dDuneGrid>::read(
+            fileName, boundaryId2PhysicalEntity, elementIndex2PhysicalEntity,
+            false, false));
+    std::cout << std::setw(14) << (tbb::tick_count::now() - start).seconds();
+  }
+  std::cout << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  const std::string directory = argc > 1 ? argv[1] : ".";
+  const int maxDivisions = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+  std::cout << std::setw(10) << "elements" << std::setw(8) << "format"
+            << std::setw(14) << "read [s]" << std::setw(14) << "import [s]"
+            << std::setw(14) << "Dune [s]" << std::endl;
+  for (int n = 125; n <= maxDivisions; n *= 2) {
+    const GmshData torus = createTorus(n);
+    for (int binary = 0; binary < 2; ++binary) {
+      const std::string fileName = directory + "/torus-" + std::to_string(n) +
+                                   (binary ? "-binary" : "-ascii") + ".msh";
+      torus.write(fileName, binary);
+      benchmark(fileName, binary);
+      std::remove(fileName.c_str());
+    }
+  }
+  return 0;
+}
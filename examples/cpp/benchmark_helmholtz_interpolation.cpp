@@ -0,0 +1,118 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Compares the direct and the Hermite-interpolated evaluation of the
+// Helmholtz single-layer kernel exp(-k r) / (4 pi r).
+//
+// Usage: benchmark_helmholtz_interpolation [wave_number [accuracy]]
+//
+// The kernels are evaluated on a grid of random test and trial points in the
+// unit cube, with the wave number k = -i * wave_number. The interpolation
+// table is built once with the density that
+// Fiber::modifiedHelmholtz3dInterpolationDensity() selects for the requested
+// relative accuracy, and once with the default density of 5000 points per
+// wavelength.
+
+#include "bempp/assembly/helmholtz_3d_operators_common.hpp"
+
+#include "bempp/fiber/collection_of_4d_arrays.hpp"
+#include "bempp/fiber/default_collection_of_kernels.hpp"
+#include "bempp/fiber/geometrical_data.hpp"
+#include "bempp/fiber/initialize_interpolator_for_modified_helmholtz_3d_kernels.hpp"
+#include "bempp/fiber/modified_helmholtz_3d_single_layer_potential_kernel_functor.hpp"
+#include "bempp/fiber/modified_helmholtz_3d_single_layer_potential_kernel_interpolated_functor.hpp"
+
+#include <tbb/tick_count.h>
+
+#include <algorithm>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+
+typedef std::complex<double> ValueType;
+typedef double CoordinateType;
+
+template <typename Functor>
+double timeKernel(const Functor &functor,
+                  const Fiber::GeometricalData<CoordinateType> &testGeomData,
+                  const Fiber::GeometricalData<CoordinateType> &trialGeomData,
+                  int repetitions,
+                  Fiber::CollectionOf4dArrays<ValueType> &result) {
+  Fiber::DefaultCollectionOfKernels<Functor> kernels(functor);
+  kernels.evaluateOnGrid(testGeomData, trialGeomData, result);
+  tbb::tick_count start = tbb::tick_count::now();
+  for (int r = 0; r < repetitions; ++r)
+    kernels.evaluateOnGrid(testGeomData, trialGeomData, result);
+  tbb::tick_count end = tbb::tick_count::now();
+  const double pairCount = double(repetitions) *
+                           testGeomData.globals.n_cols *
+                           trialGeomData.globals.n_cols;
+  return 1e9 * (end - start).seconds() / pairCount;
+}
+
+double maxRelativeError(const Fiber::_4dArray<ValueType> &approx,
+                        const Fiber::_4dArray<ValueType> &exact) {
+  double result = 0.;
+  for (const ValueType *a = approx.begin(), *e = exact.begin();
+       e != exact.end(); ++a, ++e)
+    result = std::max(result, std::abs(*a - *e) / std::abs(*e));
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  const double waveNumberImag = argc > 1 ? std::atof(argv[1]) : 10.;
+  const double accuracy = argc > 2 ? std::atof(argv[2]) : 1e-10;
+  const ValueType waveNumber(0., -waveNumberImag);
+  const int testPointCount = 1000, trialPointCount = 1000;
+  const int repetitions = 10;
+
+  Fiber::GeometricalData<CoordinateType> testGeomData, trialGeomData;
+  testGeomData.globals.randu(3, testPointCount);
+  trialGeomData.globals.randu(3, trialPointCount);
+  const CoordinateType maxDist = 1.1 * std::sqrt(3.);
+
+  typedef Fiber::ModifiedHelmholtz3dSingleLayerPotentialKernelFunctor<
+      ValueType> DirectFunctor;
+  typedef Fiber::ModifiedHelmholtz3dSingleLayerPotentialKernelInterpolatedFunctor<
+      ValueType> InterpolatedFunctor;
+
+  const int automaticDensity =
+      Fiber::modifiedHelmholtz3dInterpolationDensity(accuracy);
+
+  Fiber::CollectionOf4dArrays<ValueType> exact, approx;
+  std::cout << "Wave number: " << waveNumber << std::endl;
+  std::cout << "Direct evaluation: "
+            << timeKernel(DirectFunctor(waveNumber), testGeomData,
+                          trialGeomData, repetitions, exact)
+            << " ns per pair" << std::endl;
+
+  const int densities[] = {automaticDensity,
+                           Bempp::DEFAULT_HELMHOLTZ_INTERPOLATION_DENSITY};
+  for (int density : densities) {
+    const double time =
+        timeKernel(InterpolatedFunctor(waveNumber, maxDist, density),
+                   testGeomData, trialGeomData, repetitions, approx);
+    std::cout << "Interpolation with " << density
+              << " points per wavelength: " << time
+              << " ns per pair, max. relative error "
+              << maxRelativeError(approx[0], exact[0]) << std::endl;
+  }
+  return 0;
+}
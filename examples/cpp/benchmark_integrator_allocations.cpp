@@ -0,0 +1,133 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Counts the heap allocations made while integrating pairs of elements.
+//
+// Usage: benchmark_integrator_allocations [mesh_file [repetitions]]
+//
+// The local weak forms of the Laplace single-layer operator between all
+// elements of the mesh and a fixed trial element are evaluated repeatedly
+// through the local assembler, which for regular pairs ends up in
+// SeparableNumericalTestKernelTrialIntegrator::integrateCpu(). The first
+// call fills the per-thread work arrays; the number of allocations per
+// element pair is reported for the subsequent calls.
+
+#include "bempp/assembly/assembly_options.hpp"
+#include "bempp/assembly/boundary_operator.hpp"
+#include "bempp/assembly/context.hpp"
+#include "bempp/assembly/elementary_integral_operator_base.hpp"
+#include "bempp/assembly/laplace_3d_single_layer_boundary_operator.hpp"
+#include "bempp/assembly/numerical_quadrature_strategy.hpp"
+
+#include "bempp/fiber/local_assembler_for_integral_operators.hpp"
+
+#include "bempp/grid/grid.hpp"
+#include "bempp/grid/grid_factory.hpp"
+
+#include "bempp/space/piecewise_linear_continuous_scalar_space.hpp"
+
+#include <tbb/atomic.h>
+#include <tbb/tick_count.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+namespace {
+tbb::atomic<std::size_t> allocationCount;
+}
+
+void *operator new(std::size_t size) {
+  ++allocationCount;
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete[](void *p) noexcept { std::free(p); }
+
+typedef double BFT;
+typedef double RT;
+
+using namespace Bempp;
+
+int main(int argc, char *argv[]) {
+  const char *meshFile =
+      argc > 1 ? argv[1] : "../../../meshes/sphere-h-0.1.msh";
+  const int repetitions = argc > 2 ? std::atoi(argv[2]) : 10;
+
+  GridParameters params;
+  params.topology = GridParameters::TRIANGULAR;
+  shared_ptr<Grid> grid = GridFactory::importGmshGrid(params, meshFile);
+  shared_ptr<Space<BFT>> space(
+      new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+  AssemblyOptions assemblyOptions;
+  assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+  assemblyOptions.setMaxThreadCount(1);
+  AccuracyOptions accuracyOptions;
+  shared_ptr<NumericalQuadratureStrategy<BFT, RT>> quadStrategy(
+      new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+  shared_ptr<Context<BFT, RT>> context(
+      new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+  BoundaryOperator<BFT, RT> op = laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+      context, space, space, space);
+  const ElementaryIntegralOperatorBase<BFT, RT> &elementaryOp =
+      dynamic_cast<const ElementaryIntegralOperatorBase<BFT, RT> &>(
+          *op.abstractOperator());
+  std::unique_ptr<Fiber::LocalAssemblerForIntegralOperators<RT>> assembler =
+      elementaryOp.makeAssembler(*quadStrategy, assemblyOptions);
+
+  const int elementCount = grid->leafView()->entityCount(0);
+  std::vector<int> testElements(elementCount);
+  for (int i = 0; i < elementCount; ++i)
+    testElements[i] = i;
+  const int trialElement = elementCount / 2;
+
+  std::vector<arma::Mat<RT>> localWeakForms;
+  assembler->evaluateLocalWeakForms(Fiber::TEST_TRIAL, testElements,
+                                    trialElement, Fiber::ALL_DOFS,
+                                    localWeakForms);
+
+  const std::size_t countBefore = allocationCount;
+  tbb::tick_count start = tbb::tick_count::now();
+  for (int r = 0; r < repetitions; ++r)
+    assembler->evaluateLocalWeakForms(Fiber::TEST_TRIAL, testElements,
+                                      trialElement, Fiber::ALL_DOFS,
+                                      localWeakForms);
+  tbb::tick_count end = tbb::tick_count::now();
+  const std::size_t allocations = allocationCount - countBefore;
+
+  const double pairCount = double(repetitions) * elementCount;
+  std::cout << "Mesh: " << meshFile << ", " << elementCount << " elements"
+            << std::endl;
+  std::cout << "Element pairs integrated: " << pairCount << std::endl;
+  std::cout << "Allocations per element pair: " << allocations / pairCount
+            << std::endl;
+  std::cout << "Time per element pair: "
+            << 1e6 * (end - start).seconds() / pairCount << " us" << std::endl;
+  return 0;
+}
@@ -0,0 +1,127 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Compares the treecode with direct evaluation of potentials.
+//
+// Usage: benchmark_potential_treecode [mesh_file [points_per_side [order]]]
+//
+// The Laplace and Helmholtz (wave number 1) single-layer potentials of a
+// random density discretised with piecewise constant functions are evaluated
+// on a square grid of points in the plane z = 0, first directly (dense
+// evaluation mode) and then with the treecode, and the wall times and the
+// relative difference of the results are printed.
+
+#include "bempp/assembly/assembly_options.hpp"
+#include "bempp/assembly/context.hpp"
+#include "bempp/assembly/evaluation_options.hpp"
+#include "bempp/assembly/grid_function.hpp"
+#include "bempp/assembly/helmholtz_3d_single_layer_potential_operator.hpp"
+#include "bempp/assembly/laplace_3d_single_layer_potential_operator.hpp"
+#include "bempp/assembly/numerical_quadrature_strategy.hpp"
+#include "bempp/assembly/treecode_options.hpp"
+
+#include "bempp/common/boost_make_shared_fwd.hpp"
+
+#include "bempp/grid/grid.hpp"
+#include "bempp/grid/grid_factory.hpp"
+
+#include "bempp/space/piecewise_constant_scalar_space.hpp"
+
+#include <tbb/tick_count.h>
+
+#include <complex>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+typedef double BFT;
+
+using namespace Bempp;
+
+template <typename RT>
+void compare(const char *name, const PotentialOperator<BFT, RT> &op,
+             const shared_ptr<const Space<BFT>> &space,
+             const arma::Mat<double> &points, int order) {
+  AccuracyOptions accuracyOptions;
+  NumericalQuadratureStrategy<BFT, RT> quadStrategy(accuracyOptions);
+  shared_ptr<Context<BFT, RT>> context(new Context<BFT, RT>(
+      make_shared_from_ref(quadStrategy), AssemblyOptions()));
+  arma::Col<RT> coefficients(space->globalDofCount());
+  coefficients.randu();
+  GridFunction<BFT, RT> density(context, space, coefficients);
+
+  EvaluationOptions evaluationOptions;
+  evaluationOptions.switchToDenseMode();
+  tbb::tick_count start = tbb::tick_count::now();
+  arma::Mat<RT> direct = op.evaluateAtPoints(density, points, quadStrategy,
+                                             evaluationOptions);
+  const double directTime = (tbb::tick_count::now() - start).seconds();
+
+  TreecodeOptions treecodeOptions;
+  treecodeOptions.interpolationOrder = order;
+  evaluationOptions.switchToTreecodeMode(treecodeOptions);
+  start = tbb::tick_count::now();
+  arma::Mat<RT> treecode = op.evaluateAtPoints(density, points, quadStrategy,
+                                               evaluationOptions);
+  const double treecodeTime = (tbb::tick_count::now() - start).seconds();
+
+  std::cout << std::setw(10) << name << std::setw(14) << directTime
+            << std::setw(14) << treecodeTime << std::setw(10)
+            << directTime / treecodeTime << std::setw(14)
+            << arma::norm(treecode - direct, "fro") /
+                   arma::norm(direct, "fro") << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  const char *meshFile =
+      argc > 1 ? argv[1] : "../../../meshes/sphere-h-0.05.msh";
+  const int pointsPerSide = argc > 2 ? std::atoi(argv[2]) : 300;
+  const int order = argc > 3 ? std::atoi(argv[3]) : 6;
+
+  GridParameters params;
+  params.topology = GridParameters::TRIANGULAR;
+  shared_ptr<Grid> grid = GridFactory::importGmshGrid(params, meshFile);
+  shared_ptr<Space<BFT>> space(new PiecewiseConstantScalarSpace<BFT>(grid));
+
+  arma::Mat<double> points(3, pointsPerSide * pointsPerSide);
+  for (int j = 0; j < pointsPerSide; ++j)
+    for (int i = 0; i < pointsPerSide; ++i) {
+      const int col = i + j * pointsPerSide;
+      points(0, col) = -3. + 6. * i / (pointsPerSide - 1);
+      points(1, col) = -3. + 6. * j / (pointsPerSide - 1);
+      points(2, col) = 0.;
+    }
+
+  std::cout << "Mesh: " << meshFile << ", " << space->globalDofCount()
+            << " DOFs, " << points.n_cols << " evaluation points"
+            << std::endl;
+  std::cout << std::setw(10) << "kernel" << std::setw(14) << "direct [s]"
+            << std::setw(14) << "treecode [s]" << std::setw(10) << "speedup"
+            << std::setw(14) << "rel. diff." << std::endl;
+
+  compare<double>("Laplace",
+                  Laplace3dSingleLayerPotentialOperator<BFT, double>(), space,
+                  points, order);
+  compare<std::complex<double>>(
+      "Helmholtz",
+      Helmholtz3dSingleLayerPotentialOperator<BFT>(std::complex<double>(1.)),
+      space, points, order);
+  return 0;
+}
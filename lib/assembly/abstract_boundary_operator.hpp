@@ -231,8 +231,9 @@ protected:
    *  subsequent local assembler construction. */
   void collectDataForAssemblerConstruction(
       const AssemblyOptions &options,
-      shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &testRawGeometry,
-      shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &trialRawGeometry,
+      shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &testRawGeometry,
+      shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &
+          trialRawGeometry,
       shared_ptr<GeometryFactory> &testGeometryFactory,
       shared_ptr<GeometryFactory> &trialGeometryFactory,
       shared_ptr<std::vector<const Fiber::Shapeset<BasisFunctionType_> *>> &
@@ -245,8 +246,9 @@ protected:
   /** \brief Construct those objects necessary for subsequent local
    *  assembler construction that are independent from assembly options. */
   void collectOptionsIndependentDataForAssemblerConstruction(
-      shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &testRawGeometry,
-      shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &trialRawGeometry,
+      shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &testRawGeometry,
+      shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &
+          trialRawGeometry,
       shared_ptr<GeometryFactory> &testGeometryFactory,
       shared_ptr<GeometryFactory> &trialGeometryFactory,
       shared_ptr<std::vector<const Fiber::Shapeset<BasisFunctionType_> *>> &
@@ -259,8 +261,9 @@ protected:
    */
   void collectOptionsDependentDataForAssemblerConstruction(
       const AssemblyOptions &options,
-      const shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &testRawGeometry,
-      const shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &
+      const shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &
+          testRawGeometry,
+      const shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &
           trialRawGeometry,
       shared_ptr<Fiber::OpenClHandler> &openClHandler,
       bool &cacheSingularIntegrals) const;
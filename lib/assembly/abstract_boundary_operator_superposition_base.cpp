@@ -356,7 +356,7 @@ AbstractBoundaryOperatorSuperpositionBase<BasisFunctionType_, ResultType_>::
     typedef std::vector<const Fiber::Shapeset<BasisFunctionType> *>
     ShapesetPtrVector;
 
-    shared_ptr<RawGridGeometry> testRawGeometry, trialRawGeometry;
+    shared_ptr<const RawGridGeometry> testRawGeometry, trialRawGeometry;
     shared_ptr<GeometryFactory> testGeometryFactory, trialGeometryFactory;
     shared_ptr<ShapesetPtrVector> testShapesets, trialShapesets;
 
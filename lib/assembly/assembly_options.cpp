@@ -28,7 +28,7 @@ AssemblyOptions::AssemblyOptions()
     : m_assemblyMode(DENSE), m_verbosityLevel(VerbosityLevel::DEFAULT),
       m_singularIntegralCaching(true), m_sparseStorageOfLocalOperators(true),
       m_jointAssembly(false), m_uniformQuadrature(true),
-      m_blasInQuadrature(AUTO) {}
+      m_lockFreeDenseAssembly(true), m_blasInQuadrature(AUTO) {}
 
 void AssemblyOptions::switchToDenseMode() { m_assemblyMode = DENSE; }
 
@@ -83,6 +83,14 @@ const ParallelizationOptions &AssemblyOptions::parallelizationOptions() const {
   return m_parallelizationOptions;
 }
 
+void AssemblyOptions::enableLockFreeDenseAssembly(bool value) {
+  m_lockFreeDenseAssembly = value;
+}
+
+bool AssemblyOptions::isLockFreeDenseAssemblyEnabled() const {
+  return m_lockFreeDenseAssembly;
+}
+
 void AssemblyOptions::setVerbosityLevel(VerbosityLevel::Level level) {
   m_verbosityLevel = level;
 }
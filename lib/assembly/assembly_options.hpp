@@ -127,6 +127,22 @@ public:
   /** \brief Return current parallelization options. */
   const ParallelizationOptions &parallelizationOptions() const;
 
+  /** \brief Specify whether dense weak forms are assembled without locking.
+   *
+   *  If <tt>value == true</tt> (default), the trial elements are partitioned
+   *  into groups ("colors") whose elements do not share any global DOFs.
+   *  The elements of each group are then processed in parallel, each thread
+   *  adding local contributions directly to the matrix columns it owns.
+   *  Otherwise all trial elements are processed in a single parallel loop
+   *  and the global matrix is updated under a mutex, which scales poorly on
+   *  machines with many cores. */
+  void enableLockFreeDenseAssembly(bool value = true);
+
+  /** \brief Return whether dense weak forms are assembled without locking.
+   *
+   *  See enableLockFreeDenseAssembly() for more information. */
+  bool isLockFreeDenseAssemblyEnabled() const;
+
   /** @}
     @name Verbosity
     */
@@ -264,6 +280,7 @@ private:
   bool m_sparseStorageOfLocalOperators;
   bool m_jointAssembly;
   bool m_uniformQuadrature;
+  bool m_lockFreeDenseAssembly;
   Value m_blasInQuadrature;
   /** \endcond */
 };
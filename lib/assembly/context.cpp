@@ -42,6 +42,11 @@ Context<BasisFunctionType, ResultType>::Context(
   if (quadStrategy.get() == 0)
     throw std::invalid_argument("Context::Context(): "
                                 "quadStrategy must not be null");
+
+  ParameterList parameters(globalParameterList);
+  parameters.setParametersNotAlreadySet(GlobalParameters::parameterList());
+  m_accuracyOptions.setKernelInterpolationAccuracy(
+      parameters.get<double>("kernelInterpolationAccuracy"));
 }
 
 template <typename BasisFunctionType, typename ResultType>
@@ -84,6 +89,9 @@ Context<BasisFunctionType, ResultType>::Context(
   m_assemblyOptions.enableSingularIntegralCaching(
       parameters.get<bool>("enableSingularIntegralCaching"));
 
+  m_assemblyOptions.enableLockFreeDenseAssembly(
+      parameters.get<bool>("enableLockFreeDenseAssembly"));
+
   std::string enableBlasInQuadrature =
       parameters.get<std::string>("enableBlasInQuadrature");
   if (enableBlasInQuadrature == "auto")
@@ -120,6 +128,13 @@ Context<BasisFunctionType, ResultType>::Context(
       quadOps.get<int>("doubleSingular"),
       quadOps.get<bool>("quadratureOrdersAreRelative"));
 
+  accuracyOptions.enableCongruentSingularIntegralReuse(
+      parameters.get<bool>("enableCongruentSingularIntegralReuse"));
+
+  accuracyOptions.setKernelInterpolationAccuracy(
+      parameters.get<double>("kernelInterpolationAccuracy"));
+  m_accuracyOptions = accuracyOptions;
+
   m_quadStrategy.reset(
       new NumericalQuadratureStrategy<BasisFunctionType, ResultType>(
           accuracyOptions));
@@ -3,6 +3,7 @@
 
 #include "../common/common.hpp"
 #include "../common/shared_ptr.hpp"
+#include "../fiber/accuracy_options.hpp"
 #include "../fiber/quadrature_strategy.hpp"
 #include "../common/global_parameters.hpp"
 #include "../common/types.hpp"
@@ -87,6 +88,15 @@ public:
     return m_quadStrategy;
   }
 
+  /** \brief Return the accuracy options of the Context.
+   *
+   *  Only the options not covered by the QuadratureStrategy, such as the
+   *  accuracy of interpolated kernels, are guaranteed to be meaningful if
+   *  the Context was constructed from a QuadratureStrategy. */
+  const Fiber::AccuracyOptionsEx &accuracyOptions() const {
+    return m_accuracyOptions;
+  }
+
   /** \brief Const version of \p globalParameterList. */
 
   const ParameterList &globalParameterList() const {
@@ -96,6 +106,7 @@ public:
 private:
   shared_ptr<const QuadratureStrategy> m_quadStrategy;
   AssemblyOptions m_assemblyOptions;
+  Fiber::AccuracyOptionsEx m_accuracyOptions;
   ParameterList m_globalParameterList;
 };
 
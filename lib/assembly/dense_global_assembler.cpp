@@ -25,6 +25,7 @@
 #include "assembly_options.hpp"
 #include "evaluation_options.hpp"
 #include "discrete_dense_boundary_operator.hpp"
+#include "element_coloring.hpp"
 #include "context.hpp"
 
 #include "../common/auto_timer.hpp"
@@ -67,6 +68,13 @@ class DenseWeakFormAssemblerLoopBody
 public:
     typedef tbb::spin_mutex MutexType;
 
+    /** \brief Constructor.
+     *
+     *  If \p trialIndices is null, the loop runs over all trial elements
+     *  and the global assembly is protected by \p mutex. Otherwise the
+     *  loop runs over the trial elements listed in \p *trialIndices, which
+     *  must not share any global DOFs, and \p mutex may be null: each
+     *  matrix column is then written by only one thread. */
     DenseWeakFormAssemblerLoopBody(
             const std::vector<int>& testIndices,
             const std::vector<std::vector<GlobalDofIndex> >& testGlobalDofs,
@@ -74,18 +82,20 @@ public:
             const std::vector<std::vector<BasisFunctionType> >& testLocalDofWeights,
             const std::vector<std::vector<BasisFunctionType> >& trialLocalDofWeights,
             Fiber::LocalAssemblerForIntegralOperators<ResultType>& assembler,
-            arma::Mat<ResultType>& result, MutexType& mutex) :
+            arma::Mat<ResultType>& result, MutexType* mutex,
+            const std::vector<int>* trialIndices = 0) :
         m_testIndices(testIndices),
         m_testGlobalDofs(testGlobalDofs), m_trialGlobalDofs(trialGlobalDofs),
         m_testLocalDofWeights(testLocalDofWeights),
         m_trialLocalDofWeights(trialLocalDofWeights),
-        m_assembler(assembler), m_result(result), m_mutex(mutex) {
+        m_assembler(assembler), m_result(result), m_mutex(mutex),
+        m_trialIndices(trialIndices) {
     }
 
     void operator() (const tbb::blocked_range<int>& r) const {
-        const int testElementCount = m_testIndices.size();
         std::vector<arma::Mat<ResultType> > localResult;
-        for (int trialIndex = r.begin(); trialIndex != r.end(); ++trialIndex) {
+        for (int i = r.begin(); i != r.end(); ++i) {
+            const int trialIndex = m_trialIndices ? (*m_trialIndices)[i] : i;
             // Handle this trial element only if it contributes to any global DOFs.
             bool skipTrialElement = true;
             const int trialDofCount = m_trialGlobalDofs[trialIndex].size();
@@ -105,35 +115,43 @@ public:
                                                ALL_DOFS, localResult);
 
             // Global assembly
-            {
-                MutexType::scoped_lock lock(m_mutex);
-                // Loop over test indices
-                for (int row = 0; row < testElementCount; ++row) {
-                    const int testIndex = m_testIndices[row];
-                    const int testDofCount = m_testGlobalDofs[testIndex].size();
-                    // Add the integrals to appropriate entries in the operator's matrix
-                    for (int trialDof = 0; trialDof < trialDofCount; ++trialDof) {
-                        int trialGlobalDof = m_trialGlobalDofs[trialIndex][trialDof];
-                        if (trialGlobalDof < 0)
-                            continue;
-                        for (int testDof = 0; testDof < testDofCount; ++testDof) {
-                            int testGlobalDof = m_testGlobalDofs[testIndex][testDof];
-                            if (testGlobalDof < 0)
-                                continue;
-                            assert(std::abs(m_testLocalDofWeights[testIndex][testDof]) > 0.);
-                            assert(std::abs(m_trialLocalDofWeights[trialIndex][trialDof]) > 0.);
-                            m_result(testGlobalDof, trialGlobalDof) +=
-                                    conj(m_testLocalDofWeights[testIndex][testDof]) *
-                                    m_trialLocalDofWeights[trialIndex][trialDof] *
-                                    localResult[row](testDof, trialDof);
-                        }
-                    }
+            if (m_mutex) {
+                MutexType::scoped_lock lock(*m_mutex);
+                addToResult(trialIndex, localResult);
+            } else
+                addToResult(trialIndex, localResult);
+        }
+    }
+
+private:
+    void addToResult(int trialIndex,
+                     const std::vector<arma::Mat<ResultType> >& localResult) const {
+        const int testElementCount = m_testIndices.size();
+        const int trialDofCount = m_trialGlobalDofs[trialIndex].size();
+        // Loop over test indices
+        for (int row = 0; row < testElementCount; ++row) {
+            const int testIndex = m_testIndices[row];
+            const int testDofCount = m_testGlobalDofs[testIndex].size();
+            // Add the integrals to appropriate entries in the operator's matrix
+            for (int trialDof = 0; trialDof < trialDofCount; ++trialDof) {
+                int trialGlobalDof = m_trialGlobalDofs[trialIndex][trialDof];
+                if (trialGlobalDof < 0)
+                    continue;
+                for (int testDof = 0; testDof < testDofCount; ++testDof) {
+                    int testGlobalDof = m_testGlobalDofs[testIndex][testDof];
+                    if (testGlobalDof < 0)
+                        continue;
+                    assert(std::abs(m_testLocalDofWeights[testIndex][testDof]) > 0.);
+                    assert(std::abs(m_trialLocalDofWeights[trialIndex][trialDof]) > 0.);
+                    m_result(testGlobalDof, trialGlobalDof) +=
+                            conj(m_testLocalDofWeights[testIndex][testDof]) *
+                            m_trialLocalDofWeights[trialIndex][trialDof] *
+                            localResult[row](testDof, trialDof);
                 }
             }
         }
     }
 
-private:
     const std::vector<int>& m_testIndices;
     const std::vector<std::vector<GlobalDofIndex> >& m_testGlobalDofs;
     const std::vector<std::vector<GlobalDofIndex> >& m_trialGlobalDofs;
@@ -142,11 +160,13 @@ private:
     // mutable OK because Assembler is thread-safe. (Alternative to "mutable" here:
     // make assembler's internal integrator map mutable)
     typename Fiber::LocalAssemblerForIntegralOperators<ResultType>& m_assembler;
-    // mutable OK because write access to this matrix is protected by a mutex
+    // mutable OK because write access to this matrix is either protected by
+    // a mutex or restricted to columns owned by the current thread
     arma::Mat<ResultType>& m_result;
 
     // mutex must be mutable because we need to lock and unlock it
-    MutexType& m_mutex;
+    MutexType* m_mutex;
+    const std::vector<int>* m_trialIndices;
 };
 
 template <typename BasisFunctionType, typename ResultType>
@@ -321,12 +341,26 @@ assembleDetachedWeakForm(
             maxThreadCount = parallelOptions.maxThreadCount();
     }
     tbb::task_scheduler_init scheduler(maxThreadCount);
-    {
+    if (options.isLockFreeDenseAssemblyEnabled()) {
+        // Trial elements of a single color write to disjoint sets of
+        // columns, so each color can be processed without locking
+        std::vector<std::vector<int> > trialIndicesByColor;
+        colorElementsByGlobalDofs(trialGlobalDofs, trialIndicesByColor);
+        Fiber::SerialBlasRegion region;
+        for (size_t color = 0; color < trialIndicesByColor.size(); ++color) {
+            const std::vector<int>& trialIndices = trialIndicesByColor[color];
+            tbb::parallel_for(tbb::blocked_range<int>(0, trialIndices.size()),
+                              Body(testIndices, testGlobalDofs, trialGlobalDofs,
+                                   testLocalDofWeights, trialLocalDofWeights,
+                                   assembler, result, 0 /* no mutex */,
+                                   &trialIndices));
+        }
+    } else {
         Fiber::SerialBlasRegion region;
         tbb::parallel_for(tbb::blocked_range<int>(0, trialElementCount),
                           Body(testIndices, testGlobalDofs, trialGlobalDofs,
                                testLocalDofWeights, trialLocalDofWeights,
-                               assembler, result, mutex));
+                               assembler, result, &mutex));
     }
 
     //// Old serial code (TODO: decide whether to keep it behind e.g. #ifndef PARALLEL)
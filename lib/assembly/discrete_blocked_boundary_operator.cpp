@@ -24,6 +24,12 @@
 #include "discrete_blocked_boundary_operator.hpp"
 
 #include "discrete_aca_boundary_operator.hpp"
+#include "discrete_null_boundary_operator.hpp"
+#ifdef WITH_TRILINOS
+#include "discrete_hmat_boundary_operator.hpp"
+#include "discrete_sparse_boundary_operator.hpp"
+#include "sparse_csr_matrix.hpp"
+#endif
 #ifdef WITH_AHMED
 #include "ahmed_aux.hpp"
 #endif
@@ -31,7 +37,11 @@
 #include "../fiber/_4d_array.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <numeric>
+#include <tbb/concurrent_queue.h>
+#include <tbb/parallel_for.h>
 #ifdef WITH_TRILINOS
 #include <Thyra_DefaultSpmdVectorSpace_decl.hpp>
 #endif // WITH_TRILINOS
@@ -42,6 +52,28 @@ namespace Bempp {
 // DiscreteBlockBoundaryOperator::asDiscreteAcaBoundaryOperator().
 namespace {
 
+// Estimate the relative cost of a product of op with a vector, i.e. the
+// number of matrix entries it touches
+template <typename ValueType>
+double estimateApplyCost(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &op) {
+  if (!op || dynamic_cast<const DiscreteNullBoundaryOperator<ValueType> *>(
+                 op.get()))
+    return 0.;
+#ifdef WITH_TRILINOS
+  if (const DiscreteSparseBoundaryOperator<ValueType> *sparseOp =
+          dynamic_cast<const DiscreteSparseBoundaryOperator<ValueType> *>(
+              op.get()))
+    return sparseOp->sparseMatrix()->nonzeroCount();
+  if (const DiscreteHMatBoundaryOperator<ValueType> *hMatOp =
+          dynamic_cast<const DiscreteHMatBoundaryOperator<ValueType> *>(
+              op.get()))
+    return hMatOp->hMatrix()->memSizeKb() * 1024. / sizeof(ValueType);
+#endif
+  // Dense matrix or unknown operator
+  return static_cast<double>(op->rowCount()) * op->columnCount();
+}
+
 template <typename T> void dump(const Fiber::_2dArray<T> &a) {
   for (int i = 0; i < a.extent(0); ++i) {
     for (int j = 0; j < a.extent(1); ++j)
@@ -487,6 +519,12 @@ DiscreteBlockedBoundaryOperator<ValueType>::DiscreteBlockedBoundaryOperator(
               toString(rowCounts[row]) + ", " + toString(columnCounts[col]) +
               ")");
       }
+
+  m_blockCosts.set_size(blocks.extent(0), blocks.extent(1));
+  for (size_t col = 0; col < blocks.extent(1); ++col)
+    for (size_t row = 0; row < blocks.extent(0); ++row)
+      m_blockCosts(row, col) = estimateApplyCost(blocks(row, col));
+
 #ifdef WITH_TRILINOS
   m_domainSpace = Thyra::defaultSpmdVectorSpace<ValueType>(
       std::accumulate(m_columnCounts.begin(), m_columnCounts.end(), 0));
@@ -813,41 +851,103 @@ void DiscreteBlockedBoundaryOperator<ValueType>::applyBuiltInImpl(
     const TranspositionMode trans, const arma::Col<ValueType> &x_in,
     arma::Col<ValueType> &y_inout, const ValueType alpha,
     const ValueType beta) const {
+  applyBuiltInMultiVectorImpl(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteBlockedBoundaryOperator<ValueType>::applyBuiltInMultiVectorImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
   bool transpose = (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE);
   size_t y_count = transpose ? m_columnCounts.size() : m_rowCounts.size();
   size_t x_count = transpose ? m_rowCounts.size() : m_columnCounts.size();
-
-  for (int yi = 0, y_start = 0; yi < y_count; ++yi) {
-    size_t y_chunk_size = transpose ? m_columnCounts[yi] : m_rowCounts[yi];
-    arma::Col<ValueType> y_chunk(&y_inout[y_start], y_chunk_size,
-                                 false /* copy_aux_mem */);
-    for (int xi = 0, x_start = 0; xi < x_count; ++xi) {
-      size_t x_chunk_size = transpose ? m_rowCounts[xi] : m_columnCounts[xi];
-      shared_ptr<const Base> op =
-          transpose ? m_blocks(xi, yi) : m_blocks(yi, xi);
-      //            arma::Col<ValueType> x_chunk(&x_in[colStart],
-      // m_columnCounts[col],
-      //                                         false /* copy_aux_mem */);
-      if (xi == 0) {
-        // This branch ensures that the "y += beta * y" part is done
-        if (op)
-          //                    op->apply(trans, x_chunk, y_chunk, alpha, beta);
-          op->apply(trans, x_in.rows(x_start, x_start + x_chunk_size - 1),
-                    y_chunk, alpha, beta);
-        else {
-          if (beta == static_cast<ValueType>(0.))
-            y_chunk.fill(0.);
-          else
-            y_chunk *= beta;
-        }
-      } else if (op)
-        //                    op->apply(trans, x_chunk, y_chunk, alpha, 1.);
-        op->apply(trans, x_in.rows(x_start, x_start + x_chunk_size - 1),
-                  y_chunk, alpha, 1.);
-      x_start += x_chunk_size;
-    }
-    y_start += y_chunk_size;
+  const size_t colCount = x_in.n_cols;
+
+  // Offsets of the chunks of x and y corresponding to consecutive blocks
+  std::vector<size_t> y_starts(y_count + 1, 0), x_starts(x_count + 1, 0);
+  for (size_t yi = 0; yi < y_count; ++yi)
+    y_starts[yi + 1] =
+        y_starts[yi] + (transpose ? m_columnCounts[yi] : m_rowCounts[yi]);
+  for (size_t xi = 0; xi < x_count; ++xi)
+    x_starts[xi + 1] =
+        x_starts[xi] + (transpose ? m_rowCounts[xi] : m_columnCounts[xi]);
+
+  // With several columns the rows of a chunk of x are not contiguous, so
+  // the chunks are copied once here; a single-column x is used in place
+  std::vector<arma::Mat<ValueType>> x_copies(colCount == 1 ? 0 : x_count);
+  for (size_t xi = 0; xi < x_copies.size(); ++xi)
+    if (x_starts[xi + 1] > x_starts[xi])
+      x_copies[xi] = x_in.rows(x_starts[xi], x_starts[xi + 1] - 1);
+
+  // Each chunk of y is updated by a single task. The chunks are processed in
+  // the order of decreasing cost, so that the most expensive block rows
+  // (e.g. those containing dense blocks) do not end up being started last.
+  std::vector<std::pair<double, size_t>> y_costs(y_count);
+  for (size_t yi = 0; yi < y_count; ++yi) {
+    y_costs[yi] = std::make_pair(0., yi);
+    for (size_t xi = 0; xi < x_count; ++xi)
+      y_costs[yi].first +=
+          transpose ? m_blockCosts(xi, yi) : m_blockCosts(yi, xi);
   }
+  std::sort(y_costs.begin(), y_costs.end(),
+            std::greater<std::pair<double, size_t>>());
+  tbb::concurrent_queue<size_t> y_queue;
+  for (size_t i = 0; i < y_count; ++i)
+    y_queue.push(y_costs[i].second);
+
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, y_count, 1),
+      [&](const tbb::blocked_range<size_t> &r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          size_t yi = 0;
+          if (!y_queue.try_pop(yi))
+            continue; // shouldn't happen
+          const size_t chunkSize = y_starts[yi + 1] - y_starts[yi];
+          if (chunkSize == 0)
+            continue;
+          arma::Mat<ValueType> y_copy;
+          if (colCount > 1) {
+            if (beta == static_cast<ValueType>(0.))
+              y_copy.set_size(chunkSize, colCount);
+            else
+              y_copy = y_inout.rows(y_starts[yi], y_starts[yi + 1] - 1);
+          }
+          arma::Mat<ValueType> y_chunk(colCount == 1
+                                           ? y_inout.memptr() + y_starts[yi]
+                                           : y_copy.memptr(),
+                                       chunkSize, colCount,
+                                       false /* copy_aux_mem */);
+          bool y_initialized = false;
+          for (size_t xi = 0; xi < x_count; ++xi) {
+            shared_ptr<const Base> op =
+                transpose ? m_blocks(xi, yi) : m_blocks(yi, xi);
+            if (!op)
+              continue;
+            // View of the chunk of x; const_cast is needed to wrap the
+            // memory of x_in without copying it
+            const ValueType *x_data = colCount == 1
+                                          ? x_in.memptr() + x_starts[xi]
+                                          : x_copies[xi].memptr();
+            const arma::Mat<ValueType> x_chunk(
+                const_cast<ValueType *>(x_data),
+                x_starts[xi + 1] - x_starts[xi], colCount,
+                false /* copy_aux_mem */);
+            // The first product also does the "y *= beta" part
+            op->apply(trans, x_chunk, y_chunk, alpha,
+                      y_initialized ? static_cast<ValueType>(1.) : beta);
+            y_initialized = true;
+          }
+          if (!y_initialized) {
+            if (beta == static_cast<ValueType>(0.))
+              y_chunk.fill(0.);
+            else
+              y_chunk *= beta;
+          }
+          if (colCount > 1)
+            y_inout.rows(y_starts[yi], y_starts[yi + 1] - 1) = y_copy;
+        }
+      });
 }
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteBlockedBoundaryOperator);
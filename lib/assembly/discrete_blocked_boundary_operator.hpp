@@ -131,6 +131,11 @@ private:
                                 arma::Col<ValueType> &y_inout,
                                 const ValueType alpha,
                                 const ValueType beta) const;
+  virtual void applyBuiltInMultiVectorImpl(const TranspositionMode trans,
+                                           const arma::Mat<ValueType> &x_in,
+                                           arma::Mat<ValueType> &y_inout,
+                                           const ValueType alpha,
+                                           const ValueType beta) const;
 
 #ifdef WITH_AHMED
   void mergeHMatrices(unsigned currentLevel,
@@ -146,6 +151,8 @@ private:
   Fiber::_2dArray<shared_ptr<const Base>> m_blocks;
   std::vector<size_t> m_rowCounts;
   std::vector<size_t> m_columnCounts;
+  // Estimated relative costs of products with individual blocks
+  Fiber::_2dArray<double> m_blockCosts;
 #ifdef WITH_TRILINOS
   Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> m_domainSpace;
   Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>> m_rangeSpace;
@@ -31,6 +31,7 @@
 
 #include "../fiber/explicit_instantiation.hpp"
 
+#include <Thyra_DetachedMultiVectorView.hpp>
 #include <Thyra_DetachedSpmdVectorView.hpp>
 
 namespace Bempp {
@@ -74,6 +75,19 @@ void DiscreteBoundaryOperator<ValueType>::apply(
                                 "vectors x_in and y_inout must have "
                                 "the same number of columns");
 
+  if (x_in.n_cols == 1) {
+    const arma::Col<ValueType> x_in_col = x_in.unsafe_col(0);
+    arma::Col<ValueType> y_inout_col = y_inout.unsafe_col(0);
+    applyBuiltInImpl(trans, x_in_col, y_inout_col, alpha, beta);
+  } else
+    applyBuiltInMultiVectorImpl(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteBoundaryOperator<ValueType>::applyBuiltInMultiVectorImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
   for (size_t i = 0; i < x_in.n_cols; ++i) {
     const arma::Col<ValueType> x_in_col = x_in.unsafe_col(i);
     arma::Col<ValueType> y_inout_col = y_inout.unsafe_col(i);
@@ -122,6 +136,27 @@ void DiscreteBoundaryOperator<ValueType>::applyImpl(
 
   const Ordinal colCount = X_in.domain()->dim();
 
+  if (colCount > 1) {
+    // Get access to all columns of X_in and Y_inout at once; if their
+    // elements are stored contiguously, hand them over to the operator in
+    // one go
+    Thyra::ConstDetachedMultiVectorView<ValueType> xView(
+        Teuchos::rcpFromRef(X_in));
+    Thyra::DetachedMultiVectorView<ValueType> yView(
+        Teuchos::rcpFromRef(*Y_inout));
+    if (xView.leadingDim() == xView.subDim() &&
+        yView.leadingDim() == yView.subDim()) {
+      const arma::Mat<ValueType> x(const_cast<ValueType *>(xView.values()),
+                                   xView.subDim(), xView.numSubCols(),
+                                   false /* copy_aux_mem */);
+      arma::Mat<ValueType> y(yView.values(), yView.subDim(),
+                             yView.numSubCols(), false /* copy_aux_mem */);
+      applyBuiltInMultiVectorImpl(static_cast<TranspositionMode>(M_trans), x,
+                                  y, alpha, beta);
+      return;
+    }
+  }
+
   // Loop over the input columns
 
   for (Ordinal col = 0; col < colCount; ++col) {
@@ -142,6 +142,10 @@ public:
    *
    *  This overload is always available, even if the library was compiled
    *  without Trilinos.
+   *
+   *  All columns of \p x_in are passed to the operator at once, so operators
+   *  that support it (e.g. dense, sparse and H-matrix ones) perform a single
+   *  matrix-matrix product instead of one matrix-vector product per column.
    */
   void apply(const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
              arma::Mat<ValueType> &y_inout, const ValueType alpha,
@@ -234,6 +238,18 @@ private:
                                 arma::Col<ValueType> &y_inout,
                                 const ValueType alpha,
                                 const ValueType beta) const = 0;
+
+  /** \brief Apply the operator to all columns of a multivector.
+   *
+   *  The arguments have the same meaning as in applyBuiltInImpl() and have
+   *  already been checked for consistency. The default implementation calls
+   *  applyBuiltInImpl() for each column; subclasses able to process several
+   *  columns more efficiently should override it. */
+  virtual void applyBuiltInMultiVectorImpl(const TranspositionMode trans,
+                                           const arma::Mat<ValueType> &x_in,
+                                           arma::Mat<ValueType> &y_inout,
+                                           const ValueType alpha,
+                                           const ValueType beta) const;
 };
 
 /** \relates DiscreteBoundaryOperator
@@ -114,6 +114,14 @@ void DiscreteBoundaryOperatorSum<ValueType>::applyBuiltInImpl(
     const TranspositionMode trans, const arma::Col<ValueType> &x_in,
     arma::Col<ValueType> &y_inout, const ValueType alpha,
     const ValueType beta) const {
+  applyBuiltInMultiVectorImpl(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteBoundaryOperatorSum<ValueType>::applyBuiltInMultiVectorImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
   m_term1->apply(trans, x_in, y_inout, alpha, beta);
   m_term2->apply(trans, x_in, y_inout, alpha,
                  1. /* "+ beta * y_inout" has already been done */);
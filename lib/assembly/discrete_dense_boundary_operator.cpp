@@ -123,6 +123,15 @@ void DiscreteDenseBoundaryOperator<ValueType>::applyBuiltInImpl(
     const TranspositionMode trans, const arma::Col<ValueType> &x_in,
     arma::Col<ValueType> &y_inout, const ValueType alpha,
     const ValueType beta) const {
+  applyBuiltInMultiVectorImpl(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteDenseBoundaryOperator<ValueType>::applyBuiltInMultiVectorImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  // With several columns in x_in the products below are matrix-matrix ones
   if (beta == static_cast<ValueType>(0.))
     y_inout.fill(static_cast<ValueType>(0.));
   else
@@ -143,7 +152,7 @@ void DiscreteDenseBoundaryOperator<ValueType>::applyBuiltInImpl(
     break;
   default:
     throw std::invalid_argument(
-        "DiscreteDenseBoundaryOperator::applyBuiltInImpl(): "
+        "DiscreteDenseBoundaryOperator::applyBuiltInMultiVectorImpl(): "
         "invalid transposition mode");
   }
 }
@@ -19,10 +19,12 @@
 // THE SOFTWARE.
 
 #include "discrete_hmat_boundary_operator.hpp"
+#include "hmat_approximate_lu_inverse.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 #include <boost/numeric/conversion/converter.hpp>
 #include "../hmat/compressed_matrix.hpp"
 #include "../hmat/hmatrix.hpp"
+#include "../hmat/hmatrix_io.hpp"
 
 namespace Bempp {
 
@@ -66,6 +68,14 @@ void DiscreteHMatBoundaryOperator<ValueType>::applyBuiltInImpl(
     const TranspositionMode trans, const arma::Col<ValueType> &x_in,
     arma::Col<ValueType> &y_inout, const ValueType alpha,
     const ValueType beta) const {
+  applyBuiltInMultiVectorImpl(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void DiscreteHMatBoundaryOperator<ValueType>::applyBuiltInMultiVectorImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
 
   hmat::TransposeMode hmatTrans;
   if (trans == TranspositionMode::NO_TRANSPOSE)
@@ -98,7 +108,60 @@ bool DiscreteHMatBoundaryOperator<ValueType>::opSupportedImpl(
           M_trans == Thyra::CONJTRANS);
 }
 
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType>>
+hMatOperatorApproximateLuInverse(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &op,
+    double eps) {
+  typedef DiscreteHMatBoundaryOperator<ValueType> HMatOp;
+  shared_ptr<const HMatOp> hMatOp =
+      boost::dynamic_pointer_cast<const HMatOp>(op);
+  if (!hMatOp)
+    throw std::invalid_argument(
+        "hMatOperatorApproximateLuInverse(): "
+        "operator is not of type DiscreteHMatBoundaryOperator");
+  shared_ptr<const DiscreteBoundaryOperator<ValueType>> result(
+      new HMatApproximateLuInverse<ValueType>(*hMatOp, eps));
+  return result;
+}
+
+template <typename ValueType>
+void saveHMatOperator(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &op,
+    const std::string &fileName) {
+  typedef DiscreteHMatBoundaryOperator<ValueType> HMatOp;
+  shared_ptr<const HMatOp> hMatOp =
+      boost::dynamic_pointer_cast<const HMatOp>(op);
+  if (!hMatOp)
+    throw std::invalid_argument(
+        "saveHMatOperator(): "
+        "operator is not of type DiscreteHMatBoundaryOperator");
+  hmat::saveHMatrix(*hMatOp->hMatrix(), fileName);
+}
+
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType>>
+loadHMatOperator(const std::string &fileName, bool verifyData) {
+  shared_ptr<const DiscreteBoundaryOperator<ValueType>> result(
+      new DiscreteHMatBoundaryOperator<ValueType>(
+          hmat::loadHMatrix<ValueType, 2>(fileName, verifyData)));
+  return result;
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteHMatBoundaryOperator);
+
+#define INSTANTIATE_FREE_FUNCTIONS(VALUE)                                      \
+  template shared_ptr<const DiscreteBoundaryOperator<VALUE>>                   \
+  hMatOperatorApproximateLuInverse(                                            \
+      const shared_ptr<const DiscreteBoundaryOperator<VALUE>> &op,             \
+      double eps);                                                             \
+  template void saveHMatOperator(                                              \
+      const shared_ptr<const DiscreteBoundaryOperator<VALUE>> &op,             \
+      const std::string &fileName);                                            \
+  template shared_ptr<const DiscreteBoundaryOperator<VALUE>>                   \
+  loadHMatOperator<VALUE>(const std::string &fileName, bool verifyData);
+
+FIBER_ITERATE_OVER_VALUE_TYPES(INSTANTIATE_FREE_FUNCTIONS);
 }
 
 
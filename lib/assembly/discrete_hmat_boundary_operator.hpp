@@ -29,6 +29,8 @@
 #include <Thyra_DefaultSpmdVectorSpace_decl.hpp>
 #include "../hmat/hmatrix.hpp"
 
+#include <string>
+
 namespace Bempp {
 
 template <typename ValueType>
@@ -60,12 +62,61 @@ private:
                         const arma::Col<ValueType> &x_in,
                         arma::Col<ValueType> &y_inout, const ValueType alpha,
                         const ValueType beta) const override;
+  void applyBuiltInMultiVectorImpl(const TranspositionMode trans,
+                                   const arma::Mat<ValueType> &x_in,
+                                   arma::Mat<ValueType> &y_inout,
+                                   const ValueType alpha,
+                                   const ValueType beta) const override;
 
   shared_ptr<hmat::DefaultHMatrixType<ValueType>> m_hMatrix;
 
   Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType>> m_domainSpace;
   Teuchos::RCP<const Thyra::SpmdVectorSpaceBase<ValueType>> m_rangeSpace;
 };
+
+/** \relates DiscreteHMatBoundaryOperator
+ *  \brief H-LU inverse of a discrete boundary operator stored as an H-matrix.
+ *
+ *  \param[in] op  Discrete boundary operator of type
+ *                 DiscreteHMatBoundaryOperator.
+ *  \param[in] eps Truncation accuracy of the H-matrix arithmetic used to
+ *                 compute the LU decomposition of \p op.
+ *
+ *  \return A shared pointer to a newly allocated HMatApproximateLuInverse
+ *  object representing the (approximate) inverse of \p op. */
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType>>
+hMatOperatorApproximateLuInverse(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &op,
+    double eps);
+
+/** \relates DiscreteHMatBoundaryOperator
+ *  \brief Save a discrete boundary operator stored as an H-matrix to a file.
+ *
+ *  The file contains the cluster trees, DOF permutations and leaf blocks of
+ *  the H-matrix in the binary format described in hmat/hmatrix_io.hpp.
+ *
+ *  \param[in] op       Discrete boundary operator of type
+ *                      DiscreteHMatBoundaryOperator.
+ *  \param[in] fileName Name of the file to write. */
+template <typename ValueType>
+void saveHMatOperator(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &op,
+    const std::string &fileName);
+
+/** \relates DiscreteHMatBoundaryOperator
+ *  \brief Load a discrete boundary operator saved with saveHMatOperator().
+ *
+ *  The file is memory-mapped and the H-matrix blocks are used directly from
+ *  the mapped pages, so that loading is nearly instantaneous.
+ *
+ *  \param[in] fileName   Name of the file to read.
+ *  \param[in] verifyData If true, the checksum of the H-matrix blocks is
+ *                        verified, which requires reading the whole file.
+ *                        The checksum of the metadata is always verified. */
+template <typename ValueType>
+shared_ptr<const DiscreteBoundaryOperator<ValueType>>
+loadHMatOperator(const std::string &fileName, bool verifyData = false);
 }
 
 #endif
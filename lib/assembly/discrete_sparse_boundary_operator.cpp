@@ -27,153 +27,93 @@
 #include "ahmed_mblock_array_deleter.hpp"
 #include "discrete_aca_boundary_operator.hpp"
 #include "index_permutation.hpp"
+#include "sparse_csr_matrix.hpp"
 #include "sparse_to_h_matrix_converter.hpp"
 
+#include "../common/boost_make_shared_fwd.hpp"
 #include "../common/boost_shared_array_fwd.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 #include "../fiber/parallelization_options.hpp"
 
 #include <iostream>
 #include <stdexcept>
+#include <utility>
 
-#include <Epetra_Map.h>
-#include <Epetra_Vector.h>
 #include <Epetra_CrsMatrix.h>
+#include <Epetra_LocalMap.h>
 #include <Epetra_SerialComm.h>
 #include <Thyra_DefaultSpmdVectorSpace_decl.hpp>
 
 namespace Bempp {
 
-// Helper functions for the applyBuiltIn member function
 namespace {
 
-template <typename ValueType>
-void reallyApplyBuiltInImpl(const Epetra_CrsMatrix &mat,
-                            const TranspositionMode trans,
-                            const arma::Col<ValueType> &x_in,
-                            arma::Col<ValueType> &y_inout,
-                            const ValueType alpha, const ValueType beta);
-
-template <>
-void reallyApplyBuiltInImpl<double>(const Epetra_CrsMatrix &mat,
-                                    const TranspositionMode trans,
-                                    const arma::Col<double> &x_in,
-                                    arma::Col<double> &y_inout,
-                                    const double alpha, const double beta) {
-  if (trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE) {
-    assert(mat.NumGlobalRows() == static_cast<int>(x_in.n_rows));
-    assert(mat.NumGlobalCols() == static_cast<int>(y_inout.n_rows));
-  } else {
-    assert(mat.NumGlobalCols() == static_cast<int>(x_in.n_rows));
-    assert(mat.NumGlobalRows() == static_cast<int>(y_inout.n_rows));
+// Copy an Epetra matrix into the native sparse matrix format
+template <typename CoordinateType>
+shared_ptr<const SparseCsrMatrix<CoordinateType>>
+convertEpetraMatrix(const Epetra_CrsMatrix &mat) {
+  if (mat.Comm().NumProc() != 1)
+    throw std::runtime_error(
+        "DiscreteSparseBoundaryOperator::DiscreteSparseBoundaryOperator(): "
+        "distributed matrices are unsupported");
+
+  const int rowCount = mat.NumGlobalRows();
+  std::vector<int> rowOffsets(rowCount + 1, 0);
+  std::vector<int> columnIndices;
+  std::vector<CoordinateType> values;
+  columnIndices.reserve(mat.NumMyNonzeros());
+  values.reserve(mat.NumMyNonzeros());
+  for (int row = 0; row < rowCount; ++row) {
+    int entryCount = 0;
+    double *rowValues = 0;
+    int *indices = 0;
+    int errorCode = mat.ExtractMyRowView(row, entryCount, rowValues, indices);
+    if (errorCode != 0)
+      throw std::runtime_error(
+          "DiscreteSparseBoundaryOperator::DiscreteSparseBoundaryOperator(): "
+          "Epetra_CrsMatrix::ExtractMyRowView()) failed");
+    for (int entry = 0; entry < entryCount; ++entry) {
+      columnIndices.push_back(mat.GCID(indices[entry]));
+      values.push_back(rowValues[entry]);
+    }
+    rowOffsets[row + 1] = columnIndices.size();
   }
-
-  Epetra_Map map_x((int)x_in.n_rows, 0, Epetra_SerialComm());
-  Epetra_Map map_y((int)y_inout.n_rows, 0, Epetra_SerialComm());
-
-  Epetra_Vector vec_x(View, map_x, const_cast<double *>(x_in.memptr()));
-  // vec_temp will store the result of matrix * x_in
-  Epetra_Vector vec_temp(map_y, false /* no need to initialise to zero */);
-
-  mat.Multiply(trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE, vec_x,
-               vec_temp);
-
-  if (beta == 0.)
-    for (size_t i = 0; i < y_inout.n_rows; ++i)
-      y_inout(i) = alpha * vec_temp[i];
-  else
-    for (size_t i = 0; i < y_inout.n_rows; ++i)
-      y_inout(i) = alpha * vec_temp[i] + beta * y_inout(i);
+  return shared_ptr<const SparseCsrMatrix<CoordinateType>>(
+      new SparseCsrMatrix<CoordinateType>(
+          rowCount, mat.NumGlobalCols(), std::move(rowOffsets),
+          std::move(columnIndices), std::move(values)));
 }
 
-template <>
-void reallyApplyBuiltInImpl<float>(const Epetra_CrsMatrix &mat,
-                                   const TranspositionMode trans,
-                                   const arma::Col<float> &x_in,
-                                   arma::Col<float> &y_inout, const float alpha,
-                                   const float beta) {
-  // Copy the float vectors to double vectors
-  arma::Col<double> x_in_double(x_in.n_rows);
-  std::copy(x_in.begin(), x_in.end(), x_in_double.begin());
-  arma::Col<double> y_inout_double(y_inout.n_rows);
-  if (beta != 0.f)
-    std::copy(y_inout.begin(), y_inout.end(), y_inout_double.begin());
-
-  // Do the operation on the double vectors
-  reallyApplyBuiltInImpl<double>(mat, trans, x_in_double, y_inout_double, alpha,
-                                 beta);
-
-  // Copy the result back to the float vector
-  std::copy(y_inout_double.begin(), y_inout_double.end(), y_inout.begin());
-}
-
-template <>
-void reallyApplyBuiltInImpl<std::complex<float>>(
-    const Epetra_CrsMatrix &mat, const TranspositionMode trans,
-    const arma::Col<std::complex<float>> &x_in,
-    arma::Col<std::complex<float>> &y_inout, const std::complex<float> alpha,
-    const std::complex<float> beta) {
-  // Do the y_inout *= beta part
-  const std::complex<float> zero(0.f, 0.f);
-  if (beta == zero)
-    y_inout.fill(zero);
-  else
-    y_inout *= beta;
-
-  // Separate the real and imaginary components and store them in
-  // double-precision vectors
-  arma::Col<double> x_real(x_in.n_rows);
-  for (size_t i = 0; i < x_in.n_rows; ++i)
-    x_real(i) = x_in(i).real();
-  arma::Col<double> x_imag(x_in.n_rows);
-  for (size_t i = 0; i < x_in.n_rows; ++i)
-    x_imag(i) = x_in(i).imag();
-  arma::Col<double> y_real(y_inout.n_rows);
-  for (size_t i = 0; i < y_inout.n_rows; ++i)
-    y_real(i) = y_inout(i).real();
-  arma::Col<double> y_imag(y_inout.n_rows);
-  for (size_t i = 0; i < y_inout.n_rows; ++i)
-    y_imag(i) = y_inout(i).imag();
-
-  // Do the "+= alpha A x" part (in steps)
-  reallyApplyBuiltInImpl<double>(mat, trans, x_real, y_real, alpha.real(), 1.);
-  reallyApplyBuiltInImpl<double>(mat, trans, x_imag, y_real, -alpha.imag(), 1.);
-  reallyApplyBuiltInImpl<double>(mat, trans, x_real, y_imag, alpha.imag(), 1.);
-  reallyApplyBuiltInImpl<double>(mat, trans, x_imag, y_imag, alpha.real(), 1.);
-
-  // Copy the result back to the complex vector
-  for (size_t i = 0; i < y_inout.n_rows; ++i)
-    y_inout(i) = std::complex<float>(y_real(i), y_imag(i));
-}
-
-template <>
-void reallyApplyBuiltInImpl<std::complex<double>>(
-    const Epetra_CrsMatrix &mat, const TranspositionMode trans,
-    const arma::Col<std::complex<double>> &x_in,
-    arma::Col<std::complex<double>> &y_inout, const std::complex<double> alpha,
-    const std::complex<double> beta) {
-  // Do the y_inout *= beta part
-  const std::complex<double> zero(0., 0.);
-  if (beta == zero)
-    y_inout.fill(zero);
-  else
-    y_inout *= beta;
-
-  // Separate the real and imaginary components
-  arma::Col<double> x_real(arma::real(x_in));
-  arma::Col<double> x_imag(arma::imag(x_in));
-  arma::Col<double> y_real(arma::real(y_inout));
-  arma::Col<double> y_imag(arma::imag(y_inout));
-
-  // Do the "+= alpha A x" part (in steps)
-  reallyApplyBuiltInImpl<double>(mat, trans, x_real, y_real, alpha.real(), 1.);
-  reallyApplyBuiltInImpl<double>(mat, trans, x_imag, y_real, -alpha.imag(), 1.);
-  reallyApplyBuiltInImpl<double>(mat, trans, x_real, y_imag, alpha.imag(), 1.);
-  reallyApplyBuiltInImpl<double>(mat, trans, x_imag, y_imag, alpha.real(), 1.);
-
-  // Copy the result back to the complex vector
-  for (size_t i = 0; i < y_inout.n_rows; ++i)
-    y_inout(i) = std::complex<double>(y_real(i), y_imag(i));
+// Copy a native sparse matrix into an Epetra matrix
+template <typename CoordinateType>
+shared_ptr<const Epetra_CrsMatrix>
+convertToEpetraMatrix(const SparseCsrMatrix<CoordinateType> &mat) {
+  const int rowCount = mat.rowCount();
+  const std::vector<int> &rowOffsets = mat.rowOffsets();
+  const std::vector<int> &columnIndices = mat.columnIndices();
+  const std::vector<CoordinateType> &values = mat.values();
+
+  std::vector<int> entryCounts(rowCount);
+  for (int row = 0; row < rowCount; ++row)
+    entryCounts[row] = rowOffsets[row + 1] - rowOffsets[row];
+
+  Epetra_SerialComm comm;
+  Epetra_LocalMap rowMap(rowCount, 0 /* index_base */, comm);
+  Epetra_LocalMap colMap(mat.columnCount(), 0 /* index_base */, comm);
+  shared_ptr<Epetra_CrsMatrix> result = boost::make_shared<Epetra_CrsMatrix>(
+      Copy, rowMap, colMap, rowCount == 0 ? 0 : &entryCounts[0]);
+  std::vector<double> rowValues;
+  for (int row = 0; row < rowCount; ++row) {
+    if (entryCounts[row] == 0)
+      continue;
+    rowValues.assign(values.begin() + rowOffsets[row],
+                     values.begin() + rowOffsets[row + 1]);
+    result->InsertGlobalValues(
+        row, entryCounts[row], &rowValues[0],
+        const_cast<int *>(&columnIndices[rowOffsets[row]]));
+  }
+  result->FillComplete(colMap, rowMap);
+  return result;
 }
 
 } // namespace
@@ -184,61 +124,70 @@ DiscreteSparseBoundaryOperator<ValueType>::DiscreteSparseBoundaryOperator(
     TranspositionMode trans, const shared_ptr<AhmedBemBlcluster> &blockCluster,
     const shared_ptr<IndexPermutation> &domainPermutation,
     const shared_ptr<IndexPermutation> &rangePermutation)
+    : m_mat(convertEpetraMatrix<CoordinateType>(*mat)), m_epetraMat(mat),
+      m_symmetry(symmetry), m_trans(trans), m_blockCluster(blockCluster),
+      m_domainPermutation(domainPermutation),
+      m_rangePermutation(rangePermutation) {
+  initializeVectorSpaces();
+}
+
+template <typename ValueType>
+DiscreteSparseBoundaryOperator<ValueType>::DiscreteSparseBoundaryOperator(
+    const shared_ptr<const SparseCsrMatrix<CoordinateType>> &mat, int symmetry,
+    TranspositionMode trans, const shared_ptr<AhmedBemBlcluster> &blockCluster,
+    const shared_ptr<IndexPermutation> &domainPermutation,
+    const shared_ptr<IndexPermutation> &rangePermutation)
     : m_mat(mat), m_symmetry(symmetry), m_trans(trans),
       m_blockCluster(blockCluster), m_domainPermutation(domainPermutation),
       m_rangePermutation(rangePermutation) {
-  m_domainSpace = Thyra::defaultSpmdVectorSpace<ValueType>(
-      isTransposed() ? m_mat->NumGlobalRows() : m_mat->NumGlobalCols());
-  m_rangeSpace = Thyra::defaultSpmdVectorSpace<ValueType>(
-      isTransposed() ? m_mat->NumGlobalCols() : m_mat->NumGlobalRows());
+  if (!mat)
+    throw std::invalid_argument(
+        "DiscreteSparseBoundaryOperator::DiscreteSparseBoundaryOperator(): "
+        "mat must not be null");
+  initializeVectorSpaces();
+}
+
+template <typename ValueType>
+void DiscreteSparseBoundaryOperator<ValueType>::initializeVectorSpaces() {
+  m_domainSpace = Thyra::defaultSpmdVectorSpace<ValueType>(columnCount());
+  m_rangeSpace = Thyra::defaultSpmdVectorSpace<ValueType>(rowCount());
 }
 
 template <typename ValueType>
 void DiscreteSparseBoundaryOperator<ValueType>::dump() const {
   if (isTransposed())
-    std::cout << "Transpose of " << *m_mat << std::endl;
+    std::cout << "Transpose of " << *epetraMatrix() << std::endl;
   else
-    std::cout << *m_mat << std::endl;
+    std::cout << *epetraMatrix() << std::endl;
 }
 
 template <typename ValueType>
 arma::Mat<ValueType>
 DiscreteSparseBoundaryOperator<ValueType>::asMatrix() const {
-  if (m_mat->Comm().NumProc() != 1)
-    throw std::runtime_error(
-        "DiscreteSparseBoundaryOperator::asMatrix(): "
-        "conversion of distributed matrices to local matrices is unsupported");
-
   bool transposed = isTransposed();
-  const int untransposedRowCount = m_mat->NumGlobalRows();
+  const int untransposedRowCount = m_mat->rowCount();
+  const std::vector<int> &rowOffsets = m_mat->rowOffsets();
+  const std::vector<int> &columnIndices = m_mat->columnIndices();
+  const std::vector<CoordinateType> &values = m_mat->values();
   arma::Mat<ValueType> mat(rowCount(), columnCount());
   mat.fill(0.);
-  for (int row = 0; row < untransposedRowCount; ++row) {
-    int entryCount = 0;
-    double *values = 0;
-    int *indices = 0;
-    int errorCode = m_mat->ExtractMyRowView(row, entryCount, values, indices);
-    if (errorCode != 0)
-      throw std::runtime_error("DiscreteSparseBoundaryOperator::asMatrix(): "
-                               "Epetra_CrsMatrix::ExtractMyRowView()) failed");
-    if (transposed)
-      for (int entry = 0; entry < entryCount; ++entry)
-        mat(indices[entry], row) = values[entry];
-    else
-      for (int entry = 0; entry < entryCount; ++entry)
-        mat(row, indices[entry]) = values[entry];
-  }
+  for (int row = 0; row < untransposedRowCount; ++row)
+    for (int entry = rowOffsets[row]; entry < rowOffsets[row + 1]; ++entry)
+      if (transposed)
+        mat(columnIndices[entry], row) += values[entry];
+      else
+        mat(row, columnIndices[entry]) += values[entry];
   return mat;
 }
 
 template <typename ValueType>
 unsigned int DiscreteSparseBoundaryOperator<ValueType>::rowCount() const {
-  return isTransposed() ? m_mat->NumGlobalCols() : m_mat->NumGlobalRows();
+  return isTransposed() ? m_mat->columnCount() : m_mat->rowCount();
 }
 
 template <typename ValueType>
 unsigned int DiscreteSparseBoundaryOperator<ValueType>::columnCount() const {
-  return isTransposed() ? m_mat->NumGlobalRows() : m_mat->NumGlobalCols();
+  return isTransposed() ? m_mat->rowCount() : m_mat->columnCount();
 }
 
 template <typename ValueType>
@@ -254,31 +203,16 @@ void DiscreteSparseBoundaryOperator<ValueType>::addBlock(
     throw std::invalid_argument("DiscreteSparseBoundaryOperator::addBlock(): "
                                 "incorrect block size");
 
-  int entryCount = 0;
-  double *values = 0;
-  int *indices = 0;
+  const std::vector<int> &rowOffsets = m_mat->rowOffsets();
+  const std::vector<int> &columnIndices = m_mat->columnIndices();
+  const std::vector<CoordinateType> &values = m_mat->values();
 
   for (size_t row = 0; row < untransposedRows.size(); ++row) {
-    // Provision for future MPI support.
-    if (m_mat->IndicesAreLocal()) {
-      int errorCode = m_mat->ExtractMyRowView(untransposedRows[row], entryCount,
-                                              values, indices);
-      if (errorCode != 0)
-        throw std::runtime_error(
-            "DiscreteSparseBoundaryOperator::addBlock(): "
-            "Epetra_CrsMatrix::ExtractMyRowView()) failed");
-    } else {
-      int errorCode = m_mat->ExtractGlobalRowView(untransposedRows[row],
-                                                  entryCount, values, indices);
-      if (errorCode != 0)
-        throw std::runtime_error(
-            "DiscreteSparseBoundaryOperator::addBlock(): "
-            "Epetra_CrsMatrix::ExtractGlobalRowView()) failed");
-    }
-
+    const int untransposedRow = untransposedRows[row];
     for (size_t col = 0; col < untransposedCols.size(); ++col)
-      for (int entry = 0; entry < entryCount; ++entry)
-        if (indices[entry] == cols[col])
+      for (int entry = rowOffsets[untransposedRow];
+           entry < rowOffsets[untransposedRow + 1]; ++entry)
+        if (columnIndices[entry] == untransposedCols[col])
           block(transposed ? col : row, transposed ? row : col) +=
               alpha * static_cast<ValueType>(values[entry]);
   }
@@ -307,7 +241,7 @@ DiscreteSparseBoundaryOperator<ValueType>::asDiscreteAcaBoundaryOperator(
   int *rowOffsets = 0;
   int *colIndices = 0;
   double *values = 0;
-  m_mat->ExtractCrsDataPointers(rowOffsets, colIndices, values);
+  epetraMatrix()->ExtractCrsDataPointers(rowOffsets, colIndices, values);
 
   std::vector<unsigned int> domain_o2p = m_domainPermutation->permutedIndices();
   std::vector<unsigned int> range_o2p = m_rangePermutation->permutedIndices();
@@ -348,10 +282,21 @@ DiscreteSparseBoundaryOperator<ValueType>::castToSparse(const shared_ptr<
   return result;
 }
 
+template <typename ValueType>
+shared_ptr<const SparseCsrMatrix<
+    typename DiscreteSparseBoundaryOperator<ValueType>::CoordinateType>>
+DiscreteSparseBoundaryOperator<ValueType>::sparseMatrix() const {
+  return m_mat;
+}
+
 template <typename ValueType>
 shared_ptr<const Epetra_CrsMatrix>
 DiscreteSparseBoundaryOperator<ValueType>::epetraMatrix() const {
-  return m_mat;
+  std::call_once(m_epetraMatFlag, [this]() {
+    if (!m_epetraMat)
+      m_epetraMat = convertToEpetraMatrix(*m_mat);
+  });
+  return m_epetraMat;
 }
 
 template <typename ValueType>
@@ -384,31 +329,42 @@ bool DiscreteSparseBoundaryOperator<ValueType>::isTransposed() const {
   return m_trans & (TRANSPOSE | CONJUGATE_TRANSPOSE);
 }
 
+template <typename ValueType>
+TranspositionMode DiscreteSparseBoundaryOperator<ValueType>::storedMatrixMode(
+    TranspositionMode trans) const {
+  // Transformation of the stored matrix equivalent to the transformation
+  // trans of the matrix represented by this operator
+  if (!isTransposed())
+    return trans;
+  switch (trans) {
+  case NO_TRANSPOSE:
+    return TRANSPOSE;
+  case TRANSPOSE:
+    return NO_TRANSPOSE;
+  case CONJUGATE:
+    return CONJUGATE_TRANSPOSE;
+  case CONJUGATE_TRANSPOSE:
+    return CONJUGATE;
+  default: // should not happen; anyway, don't change trans
+    return trans;
+  }
+}
+
 template <typename ValueType>
 void DiscreteSparseBoundaryOperator<ValueType>::applyBuiltInImpl(
     const TranspositionMode trans, const arma::Col<ValueType> &x_in,
     arma::Col<ValueType> &y_inout, const ValueType alpha,
     const ValueType beta) const {
-  TranspositionMode realTrans = trans;
-  bool transposed = isTransposed();
-  if (transposed)
-    switch (trans) {
-    case NO_TRANSPOSE:
-      realTrans = TRANSPOSE;
-      break;
-    case TRANSPOSE:
-      realTrans = NO_TRANSPOSE;
-      break;
-    case CONJUGATE:
-      realTrans = CONJUGATE_TRANSPOSE;
-      break;
-    case CONJUGATE_TRANSPOSE:
-      realTrans = CONJUGATE;
-      break;
-      // default: should not happen; anyway, don't change trans
-    }
+  m_mat->apply(storedMatrixMode(trans), x_in, y_inout, alpha, beta);
+}
 
-  reallyApplyBuiltInImpl(*m_mat, realTrans, x_in, y_inout, alpha, beta);
+template <typename ValueType>
+void DiscreteSparseBoundaryOperator<ValueType>::applyBuiltInMultiVectorImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  // All columns are multiplied in a single pass over the stored matrix
+  m_mat->apply(storedMatrixMode(trans), x_in, y_inout, alpha, beta);
 }
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(DiscreteSparseBoundaryOperator);
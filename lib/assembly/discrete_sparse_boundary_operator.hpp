@@ -35,6 +35,8 @@
 #include "../common/boost_shared_array_fwd.hpp"
 #include "../fiber/scalar_traits.hpp"
 
+#include <mutex>
+
 #ifdef WITH_TRILINOS
 #include <Teuchos_RCP.hpp>
 #include <Thyra_SpmdVectorSpaceBase_decl.hpp>
@@ -46,10 +48,16 @@ class Epetra_CrsMatrix;
 namespace Bempp {
 /** \cond FORWARD_DECL */
 class IndexPermutation;
+template <typename ValueType> class SparseCsrMatrix;
 /** \endcond */
 
 /** \ingroup discrete_boundary_operators
  *  \brief Discrete boundary operator stored as a sparse matrix.
+ *
+ *  The matrix is stored in the native SparseCsrMatrix format and has real
+ *  entries, also for complex \p ValueType; it is multiplied by complex
+ *  vectors directly. An equivalent Epetra matrix is available through
+ *  epetraMatrix().
  */
 template <typename ValueType>
 class DiscreteSparseBoundaryOperator
@@ -81,6 +89,24 @@ public:
           shared_ptr<IndexPermutation>(),
       const shared_ptr<IndexPermutation> &rangePermutation =
           shared_ptr<IndexPermutation>());
+
+  /** \brief Constructor.
+   *
+   *  \param[in] mat
+   *    Sparse matrix that will be represented by the newly
+   *    constructed operator. Must not be null.
+   *
+   *  The remaining parameters have the same meaning as in the constructor
+   *  taking an Epetra matrix. */
+  DiscreteSparseBoundaryOperator(
+      const shared_ptr<const SparseCsrMatrix<CoordinateType>> &mat,
+      int symmetry = NO_SYMMETRY, TranspositionMode trans = NO_TRANSPOSE,
+      const shared_ptr<AhmedBemBlcluster> &blockCluster =
+          shared_ptr<AhmedBemBlcluster>(),
+      const shared_ptr<IndexPermutation> &domainPermutation =
+          shared_ptr<IndexPermutation>(),
+      const shared_ptr<IndexPermutation> &rangePermutation =
+          shared_ptr<IndexPermutation>());
 #else
   // This class cannot be used without Trilinos
 private:
@@ -122,6 +148,17 @@ public:
    *  \note The discrete operator represents the matrix returned by this
    *  function *and possibly transposed and/or complex-conjugated*, depending on
    *  the value returned by transpositionMode(). */
+  shared_ptr<const SparseCsrMatrix<CoordinateType>> sparseMatrix() const;
+
+  /** \brief Return a shared pointer to an Epetra matrix equivalent to the
+   *  sparse matrix stored within this operator.
+   *
+   *  If the operator was constructed from a SparseCsrMatrix, the Epetra
+   *  matrix is created on the first call to this function.
+   *
+   *  \note The discrete operator represents the matrix returned by this
+   *  function *and possibly transposed and/or complex-conjugated*, depending on
+   *  the value returned by transpositionMode(). */
   shared_ptr<const Epetra_CrsMatrix> epetraMatrix() const;
 #endif
 
@@ -151,7 +188,14 @@ private:
                                 arma::Col<ValueType> &y_inout,
                                 const ValueType alpha,
                                 const ValueType beta) const;
+  virtual void applyBuiltInMultiVectorImpl(const TranspositionMode trans,
+                                           const arma::Mat<ValueType> &x_in,
+                                           arma::Mat<ValueType> &y_inout,
+                                           const ValueType alpha,
+                                           const ValueType beta) const;
   bool isTransposed() const;
+  TranspositionMode storedMatrixMode(TranspositionMode trans) const;
+  void initializeVectorSpaces();
 
   // void constructAhmedMatrix(
   //         int* rowOffsets, int* colIndices, double* values,
@@ -166,7 +210,10 @@ private:
 private:
 /** \cond PRIVATE */
 #ifdef WITH_TRILINOS
-  shared_ptr<const Epetra_CrsMatrix> m_mat;
+  shared_ptr<const SparseCsrMatrix<CoordinateType>> m_mat;
+  // Epetra counterpart of m_mat, created on demand
+  mutable shared_ptr<const Epetra_CrsMatrix> m_epetraMat;
+  mutable std::once_flag m_epetraMatFlag;
   int m_symmetry;
   TranspositionMode m_trans;
   shared_ptr<AhmedBemBlcluster> m_blockCluster;
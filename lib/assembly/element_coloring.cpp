@@ -0,0 +1,68 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "element_coloring.hpp"
+
+#include <algorithm>
+
+namespace Bempp {
+
+void colorElementsByGlobalDofs(
+    const std::vector<std::vector<GlobalDofIndex>> &globalDofs,
+    std::vector<std::vector<int>> &elementsByColor) {
+  elementsByColor.clear();
+
+  GlobalDofIndex dofCount = 0;
+  for (size_t e = 0; e < globalDofs.size(); ++e)
+    for (size_t d = 0; d < globalDofs[e].size(); ++d)
+      dofCount = std::max(dofCount, globalDofs[e][d] + 1);
+
+  // Colors already used by elements touching each DOF
+  std::vector<std::vector<int>> dofColors(dofCount);
+  std::vector<char> forbidden;
+
+  const int elementCount = globalDofs.size();
+  for (int e = 0; e < elementCount; ++e) {
+    const std::vector<GlobalDofIndex> &dofs = globalDofs[e];
+    forbidden.assign(elementsByColor.size() + 1, false);
+    bool active = false;
+    for (size_t d = 0; d < dofs.size(); ++d) {
+      if (dofs[d] < 0)
+        continue;
+      active = true;
+      const std::vector<int> &colors = dofColors[dofs[d]];
+      for (size_t c = 0; c < colors.size(); ++c)
+        forbidden[colors[c]] = true;
+    }
+    if (!active)
+      continue;
+
+    const int color = std::find(forbidden.begin(), forbidden.end(), false) -
+                      forbidden.begin();
+    if (color == static_cast<int>(elementsByColor.size()))
+      elementsByColor.push_back(std::vector<int>());
+    elementsByColor[color].push_back(e);
+    for (size_t d = 0; d < dofs.size(); ++d)
+      if (dofs[d] >= 0)
+        dofColors[dofs[d]].push_back(color);
+  }
+}
+
+} // namespace Bempp
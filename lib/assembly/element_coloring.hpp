@@ -0,0 +1,51 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_element_coloring_hpp
+#define bempp_element_coloring_hpp
+
+#include "../common/common.hpp"
+#include "../common/types.hpp"
+
+#include <vector>
+
+namespace Bempp {
+
+/** \ingroup weak_form_assembly_internal
+ *  \brief Partition elements into groups not sharing any global DOFs.
+ *
+ *  Element \p i is assumed to contribute to the global DOFs listed in
+ *  <tt>globalDofs[i]</tt>; negative entries are ignored. On output,
+ *  <tt>elementsByColor[c]</tt> contains the indices of all elements of
+ *  color \p c. No two elements of the same color share a global DOF, so
+ *  that contributions of the elements of a single color can be added to a
+ *  global vector or matrix concurrently without any locking. Elements that
+ *  do not contribute to any global DOF are not assigned a color.
+ *
+ *  A greedy algorithm is used; for the usual low-order spaces the number of
+ *  colors is bounded by the maximum number of elements sharing a DOF plus a
+ *  small constant. */
+void colorElementsByGlobalDofs(
+    const std::vector<std::vector<GlobalDofIndex>> &globalDofs,
+    std::vector<std::vector<int>> &elementsByColor);
+
+} // namespace Bempp
+
+#endif
@@ -453,7 +453,7 @@ ElementaryLocalOperator<BasisFunctionType, ResultType>::makeAssembler(
 
   const bool verbose = (options.verbosityLevel() >= VerbosityLevel::DEFAULT);
 
-  shared_ptr<RawGridGeometry> testRawGeometry, trialRawGeometry;
+  shared_ptr<const RawGridGeometry> testRawGeometry, trialRawGeometry;
   shared_ptr<GeometryFactory> testGeometryFactory, trialGeometryFactory;
   shared_ptr<Fiber::OpenClHandler> openClHandler;
   shared_ptr<ShapesetPtrVector> testShapesets, trialShapesets;
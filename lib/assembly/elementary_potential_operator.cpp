@@ -28,6 +28,7 @@
 #include "local_assembler_construction_helper.hpp"
 #include "discrete_null_boundary_operator.hpp"
 #include "dense_global_assembler.hpp"
+#include "treecode_potential_evaluator.hpp"
 
 #include "../common/shared_ptr.hpp"
 
@@ -127,10 +128,19 @@ ElementaryPotentialOperator<BasisFunctionType, KernelType, ResultType>::
     std::unique_ptr<Evaluator> evaluator =
         makeEvaluator(argument, quadStrategy, options);
 
-    // right now we don't bother about far and near field
-    // (this might depend on evaluation options)
+    // The contributions of elements lying close to individual evaluation
+    // points are integrated more accurately
     arma::Mat<ResultType> result;
-    evaluator->evaluate(Evaluator::FAR_FIELD, evaluationPoints, result);
+    evaluator->evaluate(Evaluator::NEAR_FIELD, evaluationPoints, result);
+    return result;
+  } else if (options.evaluationMode() == EvaluationOptions::TREECODE) {
+    std::unique_ptr<Evaluator> evaluator =
+        makeEvaluator(argument, quadStrategy, options);
+    TreecodePotentialEvaluator<ResultType> treecode(
+        *evaluator, options.treecodeOptions(),
+        options.parallelizationOptions());
+    arma::Mat<ResultType> result;
+    treecode.evaluate(evaluationPoints, result);
     return result;
   } else if (options.evaluationMode() == EvaluationOptions::ACA) {
     AssembledPotentialOperator<BasisFunctionType, ResultType> assembledOp =
@@ -192,7 +202,7 @@ ElementaryPotentialOperator<BasisFunctionType, KernelType, ResultType>::
   typedef std::vector<std::vector<ResultType>> CoefficientsVector;
   typedef LocalAssemblerConstructionHelper Helper;
 
-  shared_ptr<RawGridGeometry> rawGeometry;
+  shared_ptr<const RawGridGeometry> rawGeometry;
   shared_ptr<GeometryFactory> geometryFactory;
   shared_ptr<Fiber::OpenClHandler> openClHandler;
   shared_ptr<ShapesetPtrVector> shapesets;
@@ -244,7 +254,7 @@ ElementaryPotentialOperator<BasisFunctionType, KernelType, ResultType>::
   typedef std::vector<std::vector<ResultType>> CoefficientsVector;
   typedef LocalAssemblerConstructionHelper Helper;
 
-  shared_ptr<RawGridGeometry> rawGeometry;
+  shared_ptr<const RawGridGeometry> rawGeometry;
   shared_ptr<GeometryFactory> geometryFactory;
   shared_ptr<Fiber::OpenClHandler> openClHandler;
   shared_ptr<ShapesetPtrVector> shapesets;
@@ -36,10 +36,18 @@ EvaluationOptions::EvaluationOptions(const ParameterList &parameters)
 
   m_parallelizationOptions.setMaxThreadCount(maxThreadCount);
 
+  const ParameterList &treecodeParameters = parameters.sublist("Treecode");
+  m_treecodeOptions.interpolationOrder =
+      treecodeParameters.get<int>("interpolationOrder");
+  m_treecodeOptions.eta = treecodeParameters.get<double>("eta");
+  m_treecodeOptions.maxLeafSize = treecodeParameters.get<int>("maxLeafSize");
+
   if (assemblyType == "dense") {
     m_evaluationMode = DENSE;
   } else if (assemblyType == "hmat") {
     m_evaluationMode = HMAT;
+  } else if (assemblyType == "treecode") {
+    m_evaluationMode = TREECODE;
   } else
     throw std::runtime_error(
         "EvaluationOptions::EvaluationOptions(): "
@@ -56,12 +64,29 @@ EvaluationOptions::EvaluationOptions(const ParameterList &parameters)
         "Context::Context(): verbosityLevel has unsupported value");
 }
 
+void EvaluationOptions::switchToDenseMode() { m_evaluationMode = DENSE; }
+
+void EvaluationOptions::switchToAcaMode(const AcaOptions &acaOptions) {
+  m_evaluationMode = ACA;
+  m_acaOptions = acaOptions;
+}
+
 EvaluationOptions::Mode EvaluationOptions::evaluationMode() const {
   return m_evaluationMode;
 }
 
 const AcaOptions &EvaluationOptions::acaOptions() const { return m_acaOptions; }
 
+void EvaluationOptions::switchToTreecodeMode(
+    const TreecodeOptions &treecodeOptions) {
+  m_evaluationMode = TREECODE;
+  m_treecodeOptions = treecodeOptions;
+}
+
+const TreecodeOptions &EvaluationOptions::treecodeOptions() const {
+  return m_treecodeOptions;
+}
+
 // void EvaluationOptions::switchToOpenCl(const OpenClOptions& openClOptions)
 //{
 //    m_parallelizationOptions.switchToOpenCl(openClOptions);
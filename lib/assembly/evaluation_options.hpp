@@ -25,6 +25,7 @@
 #include "../common/types.hpp"
 
 #include "aca_options.hpp"
+#include "treecode_options.hpp"
 
 #include "../common/deprecated.hpp"
 #include "../fiber/opencl_options.hpp"
@@ -63,7 +64,9 @@ public:
        (ACA). */
     ACA,
     /** \brief Assemble hierarchical matrices using HMat. */
-    HMAT    
+    HMAT,
+    /** \brief Evaluate potentials with a treecode. */
+    TREECODE
   };
 
   /** \brief Use dense-matrix representations of elementary potential operators.
@@ -123,10 +126,31 @@ public:
    */
   void switchToAcaMode(const AcaOptions &acaOptions);
 
+  /** \brief Evaluate potentials with a treecode.
+   *
+   *  \param[in] treecodeOptions Parameters of the treecode.
+   *
+   *  In this mode, PotentialOperator::evaluateAtPoints() and evaluateOnGrid()
+   *  organise the evaluation points and the quadrature points of the charge
+   *  distribution (the sources) in cluster trees. Interactions between
+   *  well-separated clusters are computed by evaluating the potential of the
+   *  source cluster at a small number of Chebyshev points in the bounding box
+   *  of the evaluation-point cluster and interpolating it to the individual
+   *  evaluation points; the remaining interactions are computed directly as
+   *  in the dense mode. Only kernel values are needed, so any kernel can be
+   *  used, but the method is efficient only for kernels that are smooth
+   *  away from the origin on the scale of the clusters, e.g. the Laplace,
+   *  modified Helmholtz and low-frequency Helmholtz kernels. Evaluation cost
+   *  grows roughly as O((M + N) log(M + N)) rather than O(MN), where M and N
+   *  are the numbers of evaluation points and sources.
+   *
+   *  PotentialOperator::assemble() does not support this mode. */
+  void switchToTreecodeMode(const TreecodeOptions &treecodeOptions);
+
   /** \brief Return current evaluation mode.
    *
-   *  The evaluation mode can be changed by calling switchToDenseMode() or
-   *  switchToAcaMode(). */
+   *  The evaluation mode can be changed by calling switchToDenseMode(),
+   *  switchToAcaMode() or switchToTreecodeMode(). */
   Mode evaluationMode() const;
 
   /** \brief Return the current adaptive cross approximation (ACA) settings.
@@ -135,6 +159,12 @@ public:
    *  evaluationMode() returns ACA. */
   const AcaOptions &acaOptions() const;
 
+  /** \brief Return the current treecode settings.
+   *
+   *  \note These settings are only used in the treecode evaluation mode, i.e.
+   *  when evaluationMode() returns TREECODE. */
+  const TreecodeOptions &treecodeOptions() const;
+
   /** @}
     @name Parallelization
     @{ */
@@ -179,6 +209,7 @@ private:
   /** \cond */
   Mode m_evaluationMode;
   AcaOptions m_acaOptions;
+  TreecodeOptions m_treecodeOptions;
   ParallelizationOptions m_parallelizationOptions;
   VerbosityLevel::Level m_verbosityLevel;
   ParameterList m_parameterList;
@@ -25,6 +25,7 @@
 #include "boundary_operator.hpp"
 #include "context.hpp"
 #include "discrete_boundary_operator.hpp"
+#include "element_coloring.hpp"
 #include "identity_operator.hpp"
 #include "local_assembler_construction_helper.hpp"
 
@@ -40,6 +41,7 @@
 #include "../fiber/opencl_handler.hpp"
 #include "../fiber/quadrature_strategy.hpp"
 #include "../fiber/raw_grid_geometry.hpp"
+#include "../fiber/serial_blas_region.hpp"
 #include "../grid/geometry_factory.hpp"
 #include "../grid/grid.hpp"
 #include "../grid/grid_view.hpp"
@@ -55,6 +57,8 @@
 #include <fstream>
 #include <set>
 #include <sstream>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
 
 namespace Bempp {
 
@@ -62,12 +66,26 @@ namespace Bempp {
 
 namespace {
 
+// Number of threads allowed by the given parallelisation options
+int effectiveMaxThreadCount(const ParallelizationOptions &parallelOptions) {
+  int maxThreadCount = 1;
+  if (!parallelOptions.isOpenClEnabled()) {
+    if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+      maxThreadCount = tbb::task_scheduler_init::automatic;
+    else
+      maxThreadCount = parallelOptions.maxThreadCount();
+  }
+  return maxThreadCount;
+}
+
 template <typename BasisFunctionType, typename ResultType>
 shared_ptr<arma::Col<ResultType>> reallyCalculateProjections(
     const Space<BasisFunctionType> &dualSpace,
     Fiber::LocalAssemblerForGridFunctions<ResultType> &assembler,
     const AssemblyOptions &options) {
-  // TODO: parallelise using TBB (the parameter options will then start be used)
+  // Number of elements whose local weak forms are evaluated in one call to
+  // the assembler
+  const size_t ELEMENT_GRAIN_SIZE = 64;
 
   // Get the grid's leaf view so that we can iterate over elements
   const GridView &view = dualSpace.gridView();
@@ -88,32 +106,45 @@ shared_ptr<arma::Col<ResultType>> reallyCalculateProjections(
     it->next();
   }
 
-  // Make a vector of all element indices
-  std::vector<int> testIndices(elementCount);
-  for (size_t i = 0; i < elementCount; ++i)
-    testIndices[i] = i;
+  // Elements of a single color do not share any global DOFs, so their
+  // contributions can be added to the result without locking
+  std::vector<std::vector<int>> testIndicesByColor;
+  colorElementsByGlobalDofs(testGlobalDofs, testIndicesByColor);
 
   // Create the weak form's column vector
   shared_ptr<arma::Col<ResultType>> result(
       new arma::Col<ResultType>(dualSpace.globalDofCount()));
   result->fill(0.);
 
-  std::vector<arma::Col<ResultType>> localResult;
-  // Evaluate local weak forms
-  assembler.evaluateLocalWeakForms(testIndices, localResult);
-
-  // Loop over test indices
-  for (size_t testIndex = 0; testIndex < elementCount; ++testIndex)
-    // Add the integrals to appropriate entries in the global weak form
-    for (size_t testDof = 0; testDof < testGlobalDofs[testIndex].size();
-         ++testDof) {
-      int testGlobalDof = testGlobalDofs[testIndex][testDof];
-      if (testGlobalDof >= 0) // if it's negative, it means that this
-                              // local dof is constrained (not used)
-        (*result)(testGlobalDof) +=
-            conj(testLocalDofWeights[testIndex][testDof]) *
-            localResult[testIndex](testDof);
-    }
+  tbb::task_scheduler_init scheduler(
+      effectiveMaxThreadCount(options.parallelizationOptions()));
+  Fiber::SerialBlasRegion region;
+  for (size_t color = 0; color < testIndicesByColor.size(); ++color) {
+    const std::vector<int> &colorIndices = testIndicesByColor[color];
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, colorIndices.size(), ELEMENT_GRAIN_SIZE),
+        [&](const tbb::blocked_range<size_t> &r) {
+          // Evaluate local weak forms
+          std::vector<int> testIndices(colorIndices.begin() + r.begin(),
+                                       colorIndices.begin() + r.end());
+          std::vector<arma::Col<ResultType>> localResult;
+          assembler.evaluateLocalWeakForms(testIndices, localResult);
+
+          // Add the integrals to appropriate entries in the global weak form
+          for (size_t i = 0; i < testIndices.size(); ++i) {
+            const int testIndex = testIndices[i];
+            for (size_t testDof = 0;
+                 testDof < testGlobalDofs[testIndex].size(); ++testDof) {
+              int testGlobalDof = testGlobalDofs[testIndex][testDof];
+              if (testGlobalDof >= 0) // if it's negative, it means that this
+                                      // local dof is constrained (not used)
+                (*result)(testGlobalDof) +=
+                    conj(testLocalDofWeights[testIndex][testDof]) *
+                    localResult[i](testDof);
+            }
+          }
+        });
+  }
 
   // Return the vector of projections <phi_i, f>
   return result;
@@ -126,7 +157,9 @@ shared_ptr<arma::Col<ResultType>>
 calculateProjections(const Context<BasisFunctionType, ResultType> &context,
                      const Function<ResultType> &globalFunction,
                      const Space<BasisFunctionType> &dualSpace) {
-  const AssemblyOptions &options = context.assemblyOptions();
+  AssemblyOptions options = context.assemblyOptions();
+  if (!globalFunction.isThreadSafe())
+    options.setMaxThreadCount(1);
 
   // Prepare local assembler
   typedef typename Fiber::ScalarTraits<ResultType>::RealType CoordinateType;
@@ -135,7 +168,7 @@ calculateProjections(const Context<BasisFunctionType, ResultType> &context,
   ShapesetPtrVector;
   typedef LocalAssemblerConstructionHelper Helper;
 
-  shared_ptr<RawGridGeometry> rawGeometry;
+  shared_ptr<const RawGridGeometry> rawGeometry;
   shared_ptr<GeometryFactory> geometryFactory;
   shared_ptr<Fiber::OpenClHandler> openClHandler;
   shared_ptr<ShapesetPtrVector> testShapesets;
@@ -826,19 +859,13 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
   std::fill(multiplicities.begin(), multiplicities.end(), 0);
 
   // Gather geometric data
-  Fiber::RawGridGeometry<CoordinateType> rawGeometry(gridDim,
-                                                     m_space->worldDimension());
-  view.getRawElementData(rawGeometry.vertices(),
-                         rawGeometry.elementCornerIndices(),
-                         rawGeometry.auxData(), rawGeometry.domainIndices());
+  shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> rawGeometry =
+      view.rawGeometry<CoordinateType>();
 
   // Make geometry factory
   shared_ptr<const Grid> grid = m_space->grid();
   std::unique_ptr<GeometryFactory> geometryFactory =
       grid->elementGeometryFactory();
-  std::unique_ptr<typename GeometryFactory::Geometry> geometry(
-      geometryFactory->make());
-  Fiber::GeometricalData<CoordinateType> geomData;
 
   // For each element, get its shapeset and corner count (this is sufficient
   // to identify its geometry) as well as its local coefficients
@@ -855,12 +882,35 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
       const int elementIndex = mapper.entityIndex(element);
       basesAndCornerCounts[elementIndex] =
           ShapesetAndCornerCount(&m_space->shapeset(element),
-                                 rawGeometry.elementCornerCount(elementIndex));
+                                 rawGeometry->elementCornerCount(elementIndex));
       getLocalCoefficients(element, localCoefficients[elementIndex]);
       it->next();
     }
   }
 
+  // Elements are processed concurrently in groups. With CELL_DATA each
+  // element writes only its own column of the result arrays. With
+  // VERTEX_DATA elements sharing a vertex update the same columns, so the
+  // elements are grouped by colors such that no two elements of a single
+  // color share a vertex.
+  std::vector<std::vector<int>> elementsByColor;
+  if (dataType == VtkWriter::CELL_DATA) {
+    elementsByColor.resize(1);
+    for (size_t e = 0; e < elementCount; ++e)
+      elementsByColor[0].push_back(e);
+  } else {
+    std::vector<std::vector<GlobalDofIndex>> elementVertices(elementCount);
+    for (size_t e = 0; e < elementCount; ++e)
+      for (int c = 0; c < basesAndCornerCounts[e].second; ++c)
+        elementVertices[e].push_back(
+            rawGeometry->elementCornerIndices()(c, e));
+    colorElementsByGlobalDofs(elementVertices, elementsByColor);
+  }
+  const size_t ELEMENT_GRAIN_SIZE = 256;
+  tbb::task_scheduler_init scheduler(
+      effectiveMaxThreadCount(
+          m_context->assemblyOptions().parallelizationOptions()));
+
   typedef std::set<ShapesetAndCornerCount> ShapesetAndCornerCountSet;
   ShapesetAndCornerCountSet uniqueShapesetsAndCornerCounts(
       basesAndCornerCounts.begin(), basesAndCornerCounts.end());
@@ -935,84 +985,105 @@ void GridFunction<BasisFunctionType, ResultType>::evaluateAtSpecialPoints(
     Fiber::BasisData<BasisFunctionType> basisData;
     activeShapeset.evaluate(basisDeps, local, ALL_DOFS, basisData);
 
-    Fiber::BasisData<ResultType> functionData;
-    if (basisDeps & Fiber::VALUES)
-      functionData.values.set_size(basisData.values.extent(0),
-                                   1, // just one function
-                                   basisData.values.extent(2));
-    if (basisDeps & Fiber::DERIVATIVES)
-      functionData.derivatives.set_size(basisData.derivatives.extent(0),
-                                        basisData.derivatives.extent(1),
-                                        1, // just one function
-                                        basisData.derivatives.extent(3));
-    Fiber::CollectionOf3dArrays<ResultType> functionValues;
-
     // Loop over elements and process those that use the active shapeset
-    for (size_t e = 0; e < elementCount; ++e) {
-      if (basesAndCornerCounts[e].first != &activeShapeset)
-        continue;
-
-      // Local coefficients of the argument in the current element
-      const std::vector<ResultType> &activeLocalCoefficients =
-          localCoefficients[e];
-
-      // Calculate the function's values and/or derivatives
-      // at the requested points in the current element
-      if (basisDeps & Fiber::VALUES) {
-        std::fill(functionData.values.begin(), functionData.values.end(), 0.);
-        for (size_t point = 0; point < basisData.values.extent(2); ++point)
-          for (size_t dim = 0; dim < basisData.values.extent(0); ++dim)
-            for (size_t fun = 0; fun < basisData.values.extent(1); ++fun)
-              functionData.values(dim, 0, point) +=
-                  basisData.values(dim, fun, point) *
-                  activeLocalCoefficients[fun];
-      }
-      if (basisDeps & Fiber::DERIVATIVES) {
-        std::fill(functionData.derivatives.begin(),
-                  functionData.derivatives.end(), 0.);
-        for (size_t point = 0; point < basisData.derivatives.extent(3); ++point)
-          for (size_t dim = 0; dim < basisData.derivatives.extent(1); ++dim)
-            for (size_t comp = 0; comp < basisData.derivatives.extent(0);
-                 ++comp)
-              for (size_t fun = 0; fun < basisData.derivatives.extent(2); ++fun)
-                functionData.derivatives(comp, dim, 0, point) +=
-                    basisData.derivatives(comp, dim, fun, point) *
-                    activeLocalCoefficients[fun];
-      }
-
-      // Get geometrical data
-      rawGeometry.setupGeometry(e, *geometry);
-      geometry->getData(geomDeps, local, geomData);
-      if (geomDeps & Fiber::DOMAIN_INDEX)
-        geomData.domainIndex = rawGeometry.domainIndex(e);
-
-      transformations.evaluate(functionData, geomData, functionValues);
-      assert(functionValues[0].extent(1) == 1); // one function
-
-      if (dataType == VtkWriter::CELL_DATA) {
-        for (int dim = 0; dim < nComponents; ++dim)
-          values(dim, e) = functionValues[0]( // array index
-              dim,                            // component
-              0,                              // function index
-              0);                             // point index
-        for (int dim = 0; dim < worldDim; ++dim)
-          points(dim, e) = geomData.globals(dim, 0);
-      } else { // VERTEX_DATA
-        // Add the calculated values to the columns of the result array
-        // corresponding to the active element's vertices
-        for (int c = 0; c < activeCornerCount; ++c) {
-          int vertexIndex = rawGeometry.elementCornerIndices()(c, e);
-          for (int dim = 0; dim < nComponents; ++dim)
-            values(dim, vertexIndex) += functionValues[0](dim, 0, c);
-          ++multiplicities[vertexIndex];
-        }
-        for (int c = 0; c < activeCornerCount; ++c) {
-          int vertexIndex = rawGeometry.elementCornerIndices()(c, e);
-          for (int dim = 0; dim < worldDim; ++dim)
-            points(dim, vertexIndex) = geomData.globals(dim, c);
-        }
-      }
-    } // end of loop over elements
+    for (size_t color = 0; color < elementsByColor.size(); ++color) {
+      const std::vector<int> &colorElements = elementsByColor[color];
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, colorElements.size(),
+                                     ELEMENT_GRAIN_SIZE),
+          [&](const tbb::blocked_range<size_t> &r) {
+            std::unique_ptr<typename GeometryFactory::Geometry> geometry(
+                geometryFactory->make());
+            Fiber::GeometricalData<CoordinateType> geomData;
+            Fiber::BasisData<ResultType> functionData;
+            if (basisDeps & Fiber::VALUES)
+              functionData.values.set_size(basisData.values.extent(0),
+                                           1, // just one function
+                                           basisData.values.extent(2));
+            if (basisDeps & Fiber::DERIVATIVES)
+              functionData.derivatives.set_size(
+                  basisData.derivatives.extent(0),
+                  basisData.derivatives.extent(1),
+                  1, // just one function
+                  basisData.derivatives.extent(3));
+            Fiber::CollectionOf3dArrays<ResultType> functionValues;
+
+            for (size_t i = r.begin(); i != r.end(); ++i) {
+              const int e = colorElements[i];
+              if (basesAndCornerCounts[e].first != &activeShapeset)
+                continue;
+
+              // Local coefficients of the argument in the current element
+              const std::vector<ResultType> &activeLocalCoefficients =
+                  localCoefficients[e];
+
+              // Calculate the function's values and/or derivatives
+              // at the requested points in the current element
+              if (basisDeps & Fiber::VALUES) {
+                std::fill(functionData.values.begin(),
+                          functionData.values.end(), 0.);
+                for (size_t point = 0; point < basisData.values.extent(2);
+                     ++point)
+                  for (size_t dim = 0; dim < basisData.values.extent(0);
+                       ++dim)
+                    for (size_t fun = 0; fun < basisData.values.extent(1);
+                         ++fun)
+                      functionData.values(dim, 0, point) +=
+                          basisData.values(dim, fun, point) *
+                          activeLocalCoefficients[fun];
+              }
+              if (basisDeps & Fiber::DERIVATIVES) {
+                std::fill(functionData.derivatives.begin(),
+                          functionData.derivatives.end(), 0.);
+                for (size_t point = 0;
+                     point < basisData.derivatives.extent(3); ++point)
+                  for (size_t dim = 0; dim < basisData.derivatives.extent(1);
+                       ++dim)
+                    for (size_t comp = 0;
+                         comp < basisData.derivatives.extent(0); ++comp)
+                      for (size_t fun = 0;
+                           fun < basisData.derivatives.extent(2); ++fun)
+                        functionData.derivatives(comp, dim, 0, point) +=
+                            basisData.derivatives(comp, dim, fun, point) *
+                            activeLocalCoefficients[fun];
+              }
+
+              // Get geometrical data
+              rawGeometry->setupGeometry(e, *geometry);
+              geometry->getData(geomDeps, local, geomData);
+              if (geomDeps & Fiber::DOMAIN_INDEX)
+                geomData.domainIndex = rawGeometry->domainIndex(e);
+
+              transformations.evaluate(functionData, geomData,
+                                       functionValues);
+              assert(functionValues[0].extent(1) == 1); // one function
+
+              if (dataType == VtkWriter::CELL_DATA) {
+                for (int dim = 0; dim < nComponents; ++dim)
+                  values(dim, e) = functionValues[0]( // array index
+                      dim,                            // component
+                      0,                              // function index
+                      0);                             // point index
+                for (int dim = 0; dim < worldDim; ++dim)
+                  points(dim, e) = geomData.globals(dim, 0);
+              } else { // VERTEX_DATA
+                // Add the calculated values to the columns of the result
+                // array corresponding to the active element's vertices
+                for (int c = 0; c < activeCornerCount; ++c) {
+                  int vertexIndex = rawGeometry->elementCornerIndices()(c, e);
+                  for (int dim = 0; dim < nComponents; ++dim)
+                    values(dim, vertexIndex) += functionValues[0](dim, 0, c);
+                  ++multiplicities[vertexIndex];
+                }
+                for (int c = 0; c < activeCornerCount; ++c) {
+                  int vertexIndex = rawGeometry->elementCornerIndices()(c, e);
+                  for (int dim = 0; dim < worldDim; ++dim)
+                    points(dim, vertexIndex) = geomData.globals(dim, c);
+                }
+              }
+            } // end of loop over elements
+          });
+    } // end of loop over colors
   }   // end of loop over unique combinations of shapeset and corner count
 
   // Take average of the vertex values obtained in each of the adjacent elements
@@ -21,9 +21,34 @@
 #ifndef bempp_helmholtz_3d_operators_common_hpp
 #define bempp_helmholtz_3d_operators_common_hpp
 
+#include "context.hpp"
+#include "../fiber/initialize_interpolator_for_modified_helmholtz_3d_kernels.hpp"
+
 namespace Bempp {
 
-const int DEFAULT_HELMHOLTZ_INTERPOLATION_DENSITY = 5000;
+/** \brief Pass as \p interpPtsPerWavelength to let the interpolation density
+ *  be chosen from the kernel interpolation accuracy of the context (see
+ *  helmholtz3dInterpolationDensity()). */
+const int AUTOMATIC_HELMHOLTZ_INTERPOLATION_DENSITY = 0;
+const int DEFAULT_HELMHOLTZ_INTERPOLATION_DENSITY =
+    AUTOMATIC_HELMHOLTZ_INTERPOLATION_DENSITY;
+
+/** \brief Return the number of interpolation points per wavelength of an
+ *  interpolated (modified) Helmholtz or Maxwell kernel.
+ *
+ *  \p interpPtsPerWavelength is returned if it is positive. Otherwise the
+ *  density is derived by Fiber::modifiedHelmholtz3dInterpolationDensity()
+ *  from the kernel interpolation accuracy of \p context. */
+template <typename BasisFunctionType, typename ResultType>
+int helmholtz3dInterpolationDensity(
+    const Context<BasisFunctionType, ResultType> &context,
+    int interpPtsPerWavelength) {
+  if (interpPtsPerWavelength > 0)
+    return interpPtsPerWavelength;
+  typedef typename ScalarTraits<BasisFunctionType>::RealType CoordinateType;
+  return Fiber::modifiedHelmholtz3dInterpolationDensity(CoordinateType(
+      context.accuracyOptions().kernelInterpolationAccuracy()));
+}
 
 } // namespace Bempp
 
@@ -0,0 +1,118 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_approximate_lu_inverse.hpp"
+#include "discrete_hmat_boundary_operator.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+#include "../hmat/hmatrix_lu.hpp"
+
+#include <boost/numeric/conversion/converter.hpp>
+
+namespace Bempp {
+
+template <typename ValueType>
+HMatApproximateLuInverse<ValueType>::HMatApproximateLuInverse(
+    const DiscreteHMatBoundaryOperator<ValueType> &fwdOp, double eps)
+    : m_lu(new hmat::DefaultHMatrixLuType<ValueType>(*fwdOp.hMatrix(), eps)),
+      // All range-domain swaps intended!
+      m_domainSpace(Thyra::defaultSpmdVectorSpace<ValueType>(
+          fwdOp.hMatrix()->rows())),
+      m_rangeSpace(Thyra::defaultSpmdVectorSpace<ValueType>(
+          fwdOp.hMatrix()->columns())) {}
+
+template <typename ValueType>
+unsigned int HMatApproximateLuInverse<ValueType>::rowCount() const {
+  return boost::numeric::converter<unsigned int, std::size_t>::convert(
+      m_lu->columns());
+}
+
+template <typename ValueType>
+unsigned int HMatApproximateLuInverse<ValueType>::columnCount() const {
+  return boost::numeric::converter<unsigned int, std::size_t>::convert(
+      m_lu->rows());
+}
+
+template <typename ValueType>
+void HMatApproximateLuInverse<ValueType>::addBlock(
+    const std::vector<int> &rows, const std::vector<int> &cols,
+    const ValueType alpha, arma::Mat<ValueType> &block) const {
+  throw std::runtime_error("HMatApproximateLuInverse::addBlock(): "
+                           "not implemented");
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>>
+HMatApproximateLuInverse<ValueType>::domain() const {
+  return m_domainSpace;
+}
+
+template <typename ValueType>
+Teuchos::RCP<const Thyra::VectorSpaceBase<ValueType>>
+HMatApproximateLuInverse<ValueType>::range() const {
+  return m_rangeSpace;
+}
+
+template <typename ValueType>
+double HMatApproximateLuInverse<ValueType>::memSizeKb() const {
+  return m_lu->memSizeKb();
+}
+
+template <typename ValueType>
+bool HMatApproximateLuInverse<ValueType>::opSupportedImpl(
+    Thyra::EOpTransp M_trans) const {
+  return (M_trans == Thyra::NOTRANS);
+}
+
+template <typename ValueType>
+void HMatApproximateLuInverse<ValueType>::applyBuiltInImpl(
+    const TranspositionMode trans, const arma::Col<ValueType> &x_in,
+    arma::Col<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  applyBuiltInMultiVectorImpl(trans, x_in, y_inout, alpha, beta);
+}
+
+template <typename ValueType>
+void HMatApproximateLuInverse<ValueType>::applyBuiltInMultiVectorImpl(
+    const TranspositionMode trans, const arma::Mat<ValueType> &x_in,
+    arma::Mat<ValueType> &y_inout, const ValueType alpha,
+    const ValueType beta) const {
+  if (trans != NO_TRANSPOSE)
+    throw std::runtime_error(
+        "HMatApproximateLuInverse::applyBuiltInMultiVectorImpl(): "
+        "transposition modes other than NO_TRANSPOSE are not supported");
+  if (columnCount() != x_in.n_rows || rowCount() != y_inout.n_rows ||
+      x_in.n_cols != y_inout.n_cols)
+    throw std::invalid_argument(
+        "HMatApproximateLuInverse::applyBuiltInMultiVectorImpl(): "
+        "incorrect vector length");
+
+  if (beta == static_cast<ValueType>(0.))
+    y_inout.fill(static_cast<ValueType>(0.));
+  else
+    y_inout *= beta;
+
+  // All right-hand sides are solved for in a single sweep over the factors
+  arma::Mat<ValueType> solution = x_in;
+  m_lu->solve(solution);
+  y_inout += alpha * solution;
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(HMatApproximateLuInverse);
+}
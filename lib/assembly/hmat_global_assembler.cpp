@@ -38,6 +38,7 @@
 #include "../fiber/explicit_instantiation.hpp"
 #include "../fiber/local_assembler_for_integral_operators.hpp"
 #include "../fiber/scalar_traits.hpp"
+#include "../fiber/serial_blas_region.hpp"
 #include "../fiber/shared_ptr.hpp"
 #include "../space/space.hpp"
 #include "../common/bounding_box.hpp"
@@ -107,7 +108,8 @@ template <typename BasisFunctionType>
 shared_ptr<hmat::DefaultBlockClusterTreeType>
 generateBlockClusterTree(const Space<BasisFunctionType> &testSpace,
                          const Space<BasisFunctionType> &trialSpace,
-                         int minBlockSize, int maxBlockSize, double eta) {
+                         int minBlockSize, int maxBlockSize, double eta,
+                         hmat::ClusterSplittingStrategy splittingStrategy) {
 
   hmat::Geometry testGeometry;
   hmat::Geometry trialGeometry;
@@ -122,10 +124,12 @@ generateBlockClusterTree(const Space<BasisFunctionType> &testSpace,
   hmat::fillGeometry(trialGeometry, *trialSpaceGeometryInterface);
 
   auto testClusterTree = shared_ptr<hmat::DefaultClusterTreeType>(
-      new hmat::DefaultClusterTreeType(testGeometry, minBlockSize));
+      new hmat::DefaultClusterTreeType(testGeometry, minBlockSize,
+                                       splittingStrategy));
 
   auto trialClusterTree = shared_ptr<hmat::DefaultClusterTreeType>(
-      new hmat::DefaultClusterTreeType(trialGeometry, minBlockSize));
+      new hmat::DefaultClusterTreeType(trialGeometry, minBlockSize,
+                                       splittingStrategy));
 
   shared_ptr<hmat::DefaultBlockClusterTreeType> blockClusterTree(
       new hmat::DefaultBlockClusterTreeType(testClusterTree, trialClusterTree,
@@ -150,7 +154,7 @@ HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
 
   const AssemblyOptions &options = context.assemblyOptions();
   const auto hMatParameterList =
-      context.globalParameterList().sublist("HMatParameters");
+      context.globalParameterList().sublist("HMat");
   const bool indexWithGlobalDofs =
       (hMatParameterList.template get<std::string>("HMatAssemblyMode") ==
        "GlobalAssembly");
@@ -172,14 +176,40 @@ HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
     actualTrialSpace = trialSpacePointer;
   }
 
-  auto minBlockSize =
-      hMatParameterList.template get<unsigned int>("minBlockSize");
-  auto maxBlockSize =
-      hMatParameterList.template get<unsigned int>("maxBlockSize");
+  auto minBlockSize = static_cast<unsigned int>(
+      hMatParameterList.template get<int>("minBlockSize"));
+  auto maxBlockSize = static_cast<unsigned int>(
+      hMatParameterList.template get<int>("maxBlockSize"));
   auto eta = hMatParameterList.template get<double>("eta");
+  auto clusterSplitting =
+      hMatParameterList.template get<std::string>("clusterSplitting");
+
+  hmat::ClusterSplittingStrategy splittingStrategy;
+  if (clusterSplitting == "geometric")
+    splittingStrategy = hmat::GEOMETRIC_SPLITTING;
+  else if (clusterSplitting == "cardinality")
+    splittingStrategy = hmat::CARDINALITY_SPLITTING;
+  else
+    throw std::runtime_error(
+        "HMatGlobalAssember::assembleDetachedWeakForm: "
+        "Unknown cluster splitting strategy");
+
+  const ParallelizationOptions &parallelOptions =
+      options.parallelizationOptions();
+  int maxThreadCount = 1;
+  if (!parallelOptions.isOpenClEnabled()) {
+    if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+      maxThreadCount = tbb::task_scheduler_init::automatic;
+    else
+      maxThreadCount = parallelOptions.maxThreadCount();
+  }
+  tbb::task_scheduler_init scheduler(maxThreadCount);
+  Fiber::SerialBlasRegion region;
 
-  auto blockClusterTree = generateBlockClusterTree(
-      *actualTestSpace, *actualTrialSpace, minBlockSize, maxBlockSize, eta);
+  auto blockClusterTree =
+      generateBlockClusterTree(*actualTestSpace, *actualTrialSpace,
+                               minBlockSize, maxBlockSize, eta,
+                               splittingStrategy);
 
   WeakFormHMatAssemblyHelper<BasisFunctionType, ResultType> helper(
       *actualTestSpace, *actualTrialSpace, blockClusterTree, localAssemblers,
@@ -190,13 +220,17 @@ HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
 
   shared_ptr<hmat::DefaultHMatrixType<ResultType>> hMatrix;
 
-  if (defaultCompressionAlg=="aca")
+  if (defaultCompressionAlg=="aca" || defaultCompressionAlg=="aca+")
   {
 
     auto eps = hMatParameterList.template get<double>("eps");
     auto maxRank = hMatParameterList.template get<int>("maxRank");
-    hmat::HMatrixAcaCompressor<ResultType, 2> 
-        compressor(helper, 1E-3, 30);
+    auto seed = hMatParameterList.template get<int>("acaSeed");
+    auto variant = (defaultCompressionAlg=="aca+") ? hmat::ACA_PLUS
+                                                   : hmat::ACA_PARTIAL_PIVOTING;
+    hmat::HMatrixAcaCompressor<ResultType, 2>
+        compressor(helper, eps, static_cast<unsigned int>(maxRank), variant,
+                   static_cast<unsigned int>(seed));
     hMatrix.reset(new hmat::DefaultHMatrixType<ResultType>
             (blockClusterTree, compressor));
   }
@@ -209,6 +243,19 @@ HMatGlobalAssembler<BasisFunctionType, ResultType>::assembleDetachedWeakForm(
   else throw std::runtime_error(
           "HMatGlobalAssember::assembleDetachedWeakForm: "
           "Unknown compression algorithm");
+
+  if (hMatParameterList.template get<bool>("recompress")) {
+    const double memSizeKbBefore = hMatrix->memSizeKb();
+    const std::size_t numberOfLeafsBefore = hMatrix->numberOfLeafs();
+    hMatrix->recompress(hMatParameterList.template get<double>("eps"),
+                        hMatParameterList.template get<bool>("coarsening"));
+    if (verbosityAtLeastDefault)
+      std::cout << "HMatGlobalAssembler: recompression reduced the storage "
+                   "from " << memSizeKbBefore / 1024 << " MB ("
+                << numberOfLeafsBefore << " blocks) to "
+                << hMatrix->memSizeKb() / 1024 << " MB ("
+                << hMatrix->numberOfLeafs() << " blocks)" << std::endl;
+  }
   return std::unique_ptr<DiscreteBoundaryOperator<ResultType>>(
       new DiscreteHMatBoundaryOperator<ResultType>(hMatrix));
 
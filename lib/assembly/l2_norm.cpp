@@ -148,7 +148,7 @@ makeEvaluator(const GridFunction<BasisFunctionType, ResultType> &gridFunction,
   typedef std::vector<std::vector<ResultType>> CoefficientsVector;
   typedef LocalAssemblerConstructionHelper Helper;
 
-  shared_ptr<RawGridGeometry> rawGeometry;
+  shared_ptr<const RawGridGeometry> rawGeometry;
   shared_ptr<GeometryFactory> geometryFactory;
   shared_ptr<Fiber::OpenClHandler> openClHandler;
   shared_ptr<ShapesetPtrVector> shapesets;
@@ -44,16 +44,11 @@ struct LocalAssemblerConstructionHelper {
   template <typename CoordinateType, typename BasisFunctionType>
   static void collectGridData(
       const Space<BasisFunctionType> &space,
-      shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &rawGeometry,
+      shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &rawGeometry,
       shared_ptr<GeometryFactory> &geometryFactory) {
-    typedef Fiber::RawGridGeometry<CoordinateType> RawGridGeometry;
-
-    rawGeometry = boost::make_shared<RawGridGeometry>(space.gridDimension(),
-                                                      space.worldDimension());
-    const GridView &view = space.gridView();
-    view.getRawElementData(
-        rawGeometry->vertices(), rawGeometry->elementCornerIndices(),
-        rawGeometry->auxData(), rawGeometry->domainIndices());
+    // The raw geometry is cached by the grid and shared by all operators
+    // and grid functions defined on it
+    rawGeometry = space.gridView().template rawGeometry<CoordinateType>();
     geometryFactory = space.elementGeometryFactory();
   }
 
@@ -73,7 +68,8 @@ struct LocalAssemblerConstructionHelper {
   template <typename CoordinateType>
   static void makeOpenClHandler(
       const OpenClOptions &openClOptions,
-      const shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &rawGeometry,
+      const shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &
+          rawGeometry,
       shared_ptr<Fiber::OpenClHandler> &openClHandler) {
     openClHandler = boost::make_shared<Fiber::OpenClHandler>(openClOptions);
     if (openClHandler->UseOpenCl())
@@ -84,8 +80,9 @@ struct LocalAssemblerConstructionHelper {
   template <typename CoordinateType>
   static void makeOpenClHandler(
       const OpenClOptions &openClOptions,
-      const shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &testRawGeometry,
-      const shared_ptr<Fiber::RawGridGeometry<CoordinateType>> &
+      const shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &
+          testRawGeometry,
+      const shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &
           trialRawGeometry,
       shared_ptr<Fiber::OpenClHandler> &openClHandler) {
     openClHandler = boost::make_shared<Fiber::OpenClHandler>(openClOptions);
@@ -72,6 +72,8 @@ maxwell3dDoubleLayerBoundaryOperator(
 
   typedef GeneralElementarySingularIntegralOperator<BasisFunctionType,
                                                     KernelType, ResultType> Op;
+  interpPtsPerWavelength =
+      helmholtz3dInterpolationDensity(*usedContext, interpPtsPerWavelength);
   if (useInterpolation)
     return BoundaryOperator<BasisFunctionType, ResultType>(
         usedContext,
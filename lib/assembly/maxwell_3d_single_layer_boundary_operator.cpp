@@ -214,6 +214,8 @@ maxwell3dSingleLayerBoundaryOperator(
 
   typedef GeneralElementarySingularIntegralOperator<BasisFunctionType,
                                                     KernelType, ResultType> Op;
+  interpPtsPerWavelength =
+      helmholtz3dInterpolationDensity(*usedContext, interpPtsPerWavelength);
   if (useInterpolation)
     return BoundaryOperator<BasisFunctionType, ResultType>(
         usedContext,
@@ -85,6 +85,8 @@ modifiedHelmholtz3dAdjointDoubleLayerBoundaryOperator(
 
   typedef GeneralElementarySingularIntegralOperator<BasisFunctionType,
                                                     KernelType, ResultType> Op;
+  interpPtsPerWavelength =
+      helmholtz3dInterpolationDensity(*context, interpPtsPerWavelength);
   shared_ptr<Op> newOp;
   if (useInterpolation)
     newOp.reset(
@@ -86,6 +86,8 @@ modifiedHelmholtz3dDoubleLayerBoundaryOperator(
     integral.reset(new Fiber::DefaultTestKernelTrialIntegral<IntegrandFunctor>(
         IntegrandFunctor()));
 
+  interpPtsPerWavelength =
+      helmholtz3dInterpolationDensity(*context, interpPtsPerWavelength);
   shared_ptr<Op> newOp;
   if (useInterpolation)
     newOp.reset(
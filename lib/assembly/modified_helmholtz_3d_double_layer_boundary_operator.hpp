@@ -61,8 +61,9 @@ namespace Bempp {
  *    If \p useInterpolation is set to \p true, this parameter determines the
  *    number of points per "effective wavelength" (defined as \f$2\pi/|k|\f$,
  *    where \f$k\f$ = \p waveNumber) used to construct the interpolation grid.
- *    The default value (5000) is normally enough to reduce the relative or
- *    absolute error, *whichever is smaller*, below 100 * machine precision. If
+ *    If this parameter is not positive (the default), the density is chosen
+ *    from the kernel interpolation accuracy of the context (see
+ *    Fiber::AccuracyOptionsEx::setKernelInterpolationAccuracy()). If
  *    \p useInterpolation is set to \p false, this parameter is ignored.
  *
  *  None of the shared pointers may be null and the spaces \p range and \p
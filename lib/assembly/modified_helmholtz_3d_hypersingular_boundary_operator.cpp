@@ -247,6 +247,8 @@ modifiedHelmholtz3dHypersingularBoundaryOperator(
 
   typedef GeneralHypersingularIntegralOperator<BasisFunctionType, KernelType,
                                                ResultType> Op;
+  interpPtsPerWavelength =
+      helmholtz3dInterpolationDensity(*context, interpPtsPerWavelength);
   shared_ptr<Op> newOp;
   if (shouldUseBlasInQuadrature(assemblyOptions, *domain, *dualToRange)) {
     shared_ptr<Fiber::TestKernelTrialIntegral<BasisFunctionType, KernelType,
@@ -89,6 +89,8 @@ modifiedHelmholtz3dSingleLayerBoundaryOperator(
     integral.reset(new Fiber::DefaultTestKernelTrialIntegral<IntegrandFunctor>(
         IntegrandFunctor()));
 
+  interpPtsPerWavelength =
+      helmholtz3dInterpolationDensity(*context, interpPtsPerWavelength);
   shared_ptr<Op> newOp;
   if (useInterpolation)
     newOp.reset(
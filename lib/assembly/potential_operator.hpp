@@ -117,9 +117,14 @@ public:
    * Hence values of the potential at any vertices of \p evaluationGrid that
    * coincide with \f$\Gamma\f$ can be badly wrong.
    *
-   * The current implementation does not yet take special measures to prevent
-   * loss of accuracy *near* \f$\Gamma\f$, either. If in doubt, increase the
-   * quadrature accuracy. */
+   * In the DENSE and TREECODE evaluation modes, points lying *near*
+   * \f$\Gamma\f$ are handled by integrating the contributions of the
+   * elements close to each of them with the distance-dependent quadrature
+   * orders of the quadrature strategy, on elements subdivided adaptively
+   * around the point; the contributions of all other elements are integrated
+   * with the far-field rule. The other evaluation modes, e.g. ACA, take no
+   * special measures to prevent loss of accuracy near \f$\Gamma\f$; if in
+   * doubt, increase the quadrature accuracy. */
   virtual std::unique_ptr<InterpolatedFunction<ResultType>>
   evaluateOnGrid(const GridFunction<BasisFunctionType, ResultType> &argument,
                  const Grid &evaluationGrid,
@@ -158,10 +163,14 @@ public:
    * Hence values of the potential at any points belonging to \f$\Gamma\f$
    * can be badly wrong.
    *
-   * The current implementation does not yet take special measures to prevent
-   * loss of accuracy *near* \f$\Gamma\f$, either. Users are advised to
-   * increase the quadrature accuracy for points lying in the vicinity of
-   * \f$\Gamma\f$. */
+   * In the DENSE and TREECODE evaluation modes, points lying *near*
+   * \f$\Gamma\f$ are handled by integrating the contributions of the
+   * elements close to each of them with the distance-dependent quadrature
+   * orders of the quadrature strategy, on elements subdivided adaptively
+   * around the point; the contributions of all other elements are integrated
+   * with the far-field rule. The other evaluation modes, e.g. ACA, take no
+   * special measures to prevent loss of accuracy near \f$\Gamma\f$; if in
+   * doubt, increase the quadrature accuracy. */
   virtual arma::Mat<ResultType>
   evaluateAtPoints(const GridFunction<BasisFunctionType, ResultType> &argument,
                    const arma::Mat<CoordinateType> &evaluationPoints,
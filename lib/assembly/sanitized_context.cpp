@@ -82,7 +82,8 @@ shared_ptr<const Context<BasisFunctionType, ResultType>> sanitizedContext(
     AssemblyOptions newAssemblyOptions = assemblyOptions;
     newAssemblyOptions.switchToAcaMode(newAcaOptions);
     context.reset(new Context<BasisFunctionType, ResultType>(
-        context->quadStrategy(), newAssemblyOptions));
+        context->quadStrategy(), newAssemblyOptions,
+        context->globalParameterList()));
   }
   return context;
 }
@@ -0,0 +1,178 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "sparse_csr_matrix.hpp"
+
+#include "../common/complex_aux.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <stdexcept>
+#include <utility>
+
+namespace Bempp {
+
+namespace {
+
+// Number of rows processed by a single task
+const int ROW_GRAIN_SIZE = 256;
+
+} // namespace
+
+template <typename ValueType>
+SparseCsrMatrix<ValueType>::SparseCsrMatrix(int rowCount, int columnCount,
+                                            std::vector<int> rowOffsets,
+                                            std::vector<int> columnIndices,
+                                            std::vector<ValueType> values)
+    : m_rowCount(rowCount), m_columnCount(columnCount),
+      m_rowOffsets(std::move(rowOffsets)),
+      m_columnIndices(std::move(columnIndices)), m_values(std::move(values)) {
+  if (m_rowCount < 0 || m_columnCount < 0)
+    throw std::invalid_argument("SparseCsrMatrix::SparseCsrMatrix(): "
+                                "matrix dimensions must be non-negative");
+  if (m_rowOffsets.size() != static_cast<size_t>(m_rowCount) + 1 ||
+      m_rowOffsets.front() != 0 ||
+      static_cast<size_t>(m_rowOffsets.back()) != m_columnIndices.size() ||
+      m_columnIndices.size() != m_values.size())
+    throw std::invalid_argument("SparseCsrMatrix::SparseCsrMatrix(): "
+                                "inconsistent sizes of the CSR arrays");
+  for (int row = 0; row < m_rowCount; ++row)
+    if (m_rowOffsets[row] > m_rowOffsets[row + 1])
+      throw std::invalid_argument("SparseCsrMatrix::SparseCsrMatrix(): "
+                                  "row offsets must be non-decreasing");
+  for (size_t k = 0; k < m_columnIndices.size(); ++k)
+    if (m_columnIndices[k] < 0 || m_columnIndices[k] >= m_columnCount)
+      throw std::invalid_argument("SparseCsrMatrix::SparseCsrMatrix(): "
+                                  "column index out of range");
+}
+
+template <typename ValueType>
+arma::Mat<ValueType> SparseCsrMatrix<ValueType>::asMatrix() const {
+  arma::Mat<ValueType> result(m_rowCount, m_columnCount);
+  result.fill(0.);
+  for (int row = 0; row < m_rowCount; ++row)
+    for (int k = m_rowOffsets[row]; k < m_rowOffsets[row + 1]; ++k)
+      result(row, m_columnIndices[k]) += m_values[k];
+  return result;
+}
+
+template <typename ValueType>
+template <typename VectorValueType>
+void SparseCsrMatrix<ValueType>::apply(TranspositionMode trans,
+                                       const arma::Mat<VectorValueType> &x,
+                                       arma::Mat<VectorValueType> &y,
+                                       VectorValueType alpha,
+                                       VectorValueType beta) const {
+  const bool transposed = trans == TRANSPOSE || trans == CONJUGATE_TRANSPOSE;
+  const bool conjugated = trans == CONJUGATE || trans == CONJUGATE_TRANSPOSE;
+  const SparseCsrMatrix &matrix = transposed ? transpose() : *this;
+  if (x.n_rows != matrix.m_columnCount || y.n_rows != matrix.m_rowCount ||
+      x.n_cols != y.n_cols)
+    throw std::invalid_argument("SparseCsrMatrix::apply(): "
+                                "incorrect dimensions of x or y");
+
+  const size_t vectorCount = x.n_cols;
+  const size_t xStride = x.n_rows;
+  const VectorValueType zero(0.);
+  tbb::parallel_for(
+      tbb::blocked_range<int>(0, matrix.m_rowCount, ROW_GRAIN_SIZE),
+      [&](const tbb::blocked_range<int> &r) {
+        std::vector<VectorValueType> sums(vectorCount);
+        for (int row = r.begin(); row < r.end(); ++row) {
+          std::fill(sums.begin(), sums.end(), zero);
+          for (int k = matrix.m_rowOffsets[row];
+               k < matrix.m_rowOffsets[row + 1]; ++k) {
+            const ValueType value = conjugated
+                                        ? Fiber::conj(matrix.m_values[k])
+                                        : matrix.m_values[k];
+            const VectorValueType *xEntries =
+                x.memptr() + matrix.m_columnIndices[k];
+            for (size_t v = 0; v < vectorCount; ++v)
+              sums[v] += value * xEntries[v * xStride];
+          }
+          if (beta == zero)
+            for (size_t v = 0; v < vectorCount; ++v)
+              y(row, v) = alpha * sums[v];
+          else
+            for (size_t v = 0; v < vectorCount; ++v)
+              y(row, v) = alpha * sums[v] + beta * y(row, v);
+        }
+      });
+}
+
+template <typename ValueType>
+const SparseCsrMatrix<ValueType> &SparseCsrMatrix<ValueType>::transpose()
+    const {
+  std::call_once(m_transposeFlag, [this]() {
+    const size_t entryCount = m_values.size();
+    std::vector<int> offsets(m_columnCount + 1, 0);
+    for (size_t k = 0; k < entryCount; ++k)
+      ++offsets[m_columnIndices[k] + 1];
+    for (int col = 0; col < m_columnCount; ++col)
+      offsets[col + 1] += offsets[col];
+    std::vector<int> indices(entryCount);
+    std::vector<ValueType> values(entryCount);
+    std::vector<int> next(offsets.begin(), offsets.end() - 1);
+    for (int row = 0; row < m_rowCount; ++row)
+      for (int k = m_rowOffsets[row]; k < m_rowOffsets[row + 1]; ++k) {
+        const int position = next[m_columnIndices[k]]++;
+        indices[position] = row;
+        values[position] = m_values[k];
+      }
+    m_transpose.reset(new SparseCsrMatrix(m_columnCount, m_rowCount,
+                                          std::move(offsets),
+                                          std::move(indices),
+                                          std::move(values)));
+  });
+  return *m_transpose;
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(SparseCsrMatrix);
+
+#define INSTANTIATE_APPLY(MATRIX, VECTOR)                                      \
+  template void SparseCsrMatrix<MATRIX>::apply(                                \
+      TranspositionMode trans, const arma::Mat<VECTOR> &x,                     \
+      arma::Mat<VECTOR> &y, VECTOR alpha, VECTOR beta) const
+
+#if defined(ENABLE_SINGLE_PRECISION)
+INSTANTIATE_APPLY(float, float);
+#endif
+
+#if defined(ENABLE_SINGLE_PRECISION) &&                                        \
+    (defined(ENABLE_COMPLEX_BASIS_FUNCTIONS) ||                                \
+     defined(ENABLE_COMPLEX_KERNELS))
+INSTANTIATE_APPLY(float, std::complex<float>);
+INSTANTIATE_APPLY(std::complex<float>, std::complex<float>);
+#endif
+
+#if defined(ENABLE_DOUBLE_PRECISION)
+INSTANTIATE_APPLY(double, double);
+#endif
+
+#if defined(ENABLE_DOUBLE_PRECISION) &&                                        \
+    (defined(ENABLE_COMPLEX_BASIS_FUNCTIONS) ||                                \
+     defined(ENABLE_COMPLEX_KERNELS))
+INSTANTIATE_APPLY(double, std::complex<double>);
+INSTANTIATE_APPLY(std::complex<double>, std::complex<double>);
+#endif
+
+} // namespace Bempp
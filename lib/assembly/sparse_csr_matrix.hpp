@@ -0,0 +1,113 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_sparse_csr_matrix_hpp
+#define bempp_sparse_csr_matrix_hpp
+
+#include "../common/common.hpp"
+
+#include "transposition_mode.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Bempp {
+
+/** \ingroup discrete_boundary_operators
+ *  \brief Sparse matrix stored in the compressed sparse row (CSR) format.
+ *
+ *  Products of this matrix (or its transpose, conjugate or conjugate
+ *  transpose) with vectors and multivectors are computed natively, with
+ *  rows processed in parallel. A real matrix can be multiplied directly by
+ *  complex vectors.
+ *
+ *  \tparam ValueType
+ *    Type of the matrix entries. Supported types: float, double,
+ *    std::complex<float> and std::complex<double>. */
+template <typename ValueType> class SparseCsrMatrix {
+public:
+  /** \brief Constructor.
+   *
+   *  \param[in] rowCount Number of rows.
+   *  \param[in] columnCount Number of columns.
+   *  \param[in] rowOffsets
+   *    Vector of length <tt>rowCount + 1</tt>; the entries of row \e i are
+   *    stored at positions <tt>rowOffsets[i]</tt> to
+   *    <tt>rowOffsets[i + 1] - 1</tt> of \p columnIndices and \p values.
+   *  \param[in] columnIndices Column indices of the stored entries.
+   *  \param[in] values Values of the stored entries. */
+  SparseCsrMatrix(int rowCount, int columnCount, std::vector<int> rowOffsets,
+                  std::vector<int> columnIndices,
+                  std::vector<ValueType> values);
+
+  /** \brief Number of rows. */
+  int rowCount() const { return m_rowCount; }
+  /** \brief Number of columns. */
+  int columnCount() const { return m_columnCount; }
+  /** \brief Number of stored entries. */
+  size_t nonzeroCount() const { return m_values.size(); }
+
+  /** \brief Offsets of the first stored entries of consecutive rows. */
+  const std::vector<int> &rowOffsets() const { return m_rowOffsets; }
+  /** \brief Column indices of the stored entries. */
+  const std::vector<int> &columnIndices() const { return m_columnIndices; }
+  /** \brief Values of the stored entries. */
+  const std::vector<ValueType> &values() const { return m_values; }
+
+  /** \brief Return the matrix as a dense matrix. */
+  arma::Mat<ValueType> asMatrix() const;
+
+  /** \brief Compute y := alpha * op(A) * x + beta * y.
+   *
+   *  Here A denotes this matrix and op(A) its transformation specified by
+   *  \p trans. Each column of \p x and \p y is treated as a separate vector.
+   *  If \p beta is zero, the initial contents of \p y are ignored (in
+   *  particular, they may be NaNs).
+   *
+   *  \tparam VectorValueType
+   *    Type of the vector entries; either \p ValueType or, if \p ValueType
+   *    is real, the complex type of the same precision. */
+  template <typename VectorValueType>
+  void apply(TranspositionMode trans, const arma::Mat<VectorValueType> &x,
+             arma::Mat<VectorValueType> &y, VectorValueType alpha,
+             VectorValueType beta) const;
+
+private:
+  /** \cond PRIVATE */
+  const SparseCsrMatrix &transpose() const;
+
+  int m_rowCount;
+  int m_columnCount;
+  std::vector<int> m_rowOffsets;
+  std::vector<int> m_columnIndices;
+  std::vector<ValueType> m_values;
+
+  // Transpose of this matrix, constructed on first use
+  mutable std::unique_ptr<SparseCsrMatrix> m_transpose;
+  mutable std::once_flag m_transposeFlag;
+  /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
@@ -0,0 +1,66 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_treecode_options_hpp
+#define bempp_treecode_options_hpp
+
+#include "../common/common.hpp"
+
+namespace Bempp {
+
+/** \ingroup potential_operators
+ *  \brief Parameters of the treecode used to evaluate potentials.
+ *
+ *  \see EvaluationOptions::switchToTreecodeMode().
+ */
+class TreecodeOptions {
+public:
+  /** \brief Initialize treecode parameters to default values. */
+  TreecodeOptions();
+
+  /** \brief Degree of the polynomials interpolating the potential generated
+   *  by distant sources in each cluster of evaluation points.
+   *
+   *  The potential is evaluated at (interpolationOrder + 1)^3 Chebyshev
+   *  points of each cluster. Increasing it improves the accuracy
+   *  (approximately exponentially) at the price of higher cost.
+   *
+   *  Default value: 6. */
+  int interpolationOrder;
+
+  /** \brief Cluster-pair admissibility parameter.
+   *
+   *  A cluster of evaluation points and a cluster of sources interact through
+   *  interpolation if the diameter of the former does not exceed \p eta
+   *  times the distance between them. Smaller values improve the accuracy.
+   *
+   *  Default value: 1.0. */
+  double eta;
+
+  /** \brief Maximum number of points in the leaves of the cluster trees of
+   *  evaluation points and sources.
+   *
+   *  Default value: 64. */
+  int maxLeafSize;
+};
+
+} // namespace Bempp
+
+#endif
@@ -0,0 +1,422 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "treecode_potential_evaluator.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+#include "../hmat/bounding_box.hpp"
+#include "../hmat/cluster_tree.hpp"
+#include "../hmat/geometry.hpp"
+#include "../hmat/geometry_data_type.hpp"
+
+#include <boost/math/constants/constants.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
+
+namespace Bempp {
+
+/** \cond PRIVATE */
+template <typename ResultType>
+struct TreecodePotentialEvaluator<ResultType>::ClusterTree {
+  // Original indices of the points in the order used by the tree
+  std::vector<size_t> permutation;
+  // Node data; each node precedes its descendants
+  std::vector<std::array<size_t, 2>> indexRanges;
+  std::vector<int> parents;
+  std::vector<std::array<int, 2>> children; // -1 for leaves
+  std::vector<hmat::BoundingBox> boxes;
+  // Positions in `leaves` of the first and one past the last leaf of each
+  // node
+  std::vector<std::array<int, 2>> leafRanges;
+  std::vector<int> leaves;
+
+  size_t pointCount(int node) const {
+    return indexRanges[node][1] - indexRanges[node][0];
+  }
+  bool isLeaf(int node) const { return children[node][0] < 0; }
+};
+/** \endcond */
+
+namespace {
+
+template <typename Tree>
+int appendNode(const hmat::ClusterTreeNode<2> &node, int parent, Tree &tree) {
+  const int id = tree.parents.size();
+  tree.indexRanges.push_back(node.data().indexRange);
+  tree.parents.push_back(parent);
+  tree.children.push_back({{-1, -1}});
+  tree.leafRanges.push_back({{static_cast<int>(tree.leaves.size()), 0}});
+  if (node.isLeaf())
+    tree.leaves.push_back(id);
+  else
+    for (int i = 0; i < 2; ++i) {
+      const int child = appendNode(*node.child(i), id, tree);
+      tree.children[id][i] = child;
+    }
+  tree.leafRanges[id][1] = tree.leaves.size();
+  return id;
+}
+
+// Chebyshev points of the second kind in the interval [lo, hi], or its
+// midpoint if the interval is degenerate
+template <typename CoordinateType>
+void chebyshevPoints(double lo, double hi, int order,
+                     std::vector<CoordinateType> &points) {
+  const double mid = 0.5 * (lo + hi);
+  const double halfWidth = 0.5 * (hi - lo);
+  if (order == 0 || !(hi > lo)) {
+    points.assign(1, mid);
+    return;
+  }
+  const double pi = boost::math::constants::pi<double>();
+  points.resize(order + 1);
+  for (int k = 0; k <= order; ++k)
+    points[k] = mid + halfWidth * std::cos(pi * k / order);
+}
+
+// Values at x of the Lagrange polynomials interpolating at the Chebyshev
+// points `nodes`, computed with the barycentric formula
+template <typename CoordinateType>
+void lagrangeBasis(const std::vector<CoordinateType> &nodes, CoordinateType x,
+                   std::vector<CoordinateType> &values) {
+  const size_t n = nodes.size();
+  values.assign(n, 0.);
+  if (n == 1) {
+    values[0] = 1.;
+    return;
+  }
+  CoordinateType sum = 0.;
+  for (size_t k = 0; k < n; ++k) {
+    const CoordinateType diff = x - nodes[k];
+    if (diff == 0.) {
+      values.assign(n, 0.);
+      values[k] = 1.;
+      return;
+    }
+    CoordinateType weight = (k % 2) ? -1. : 1.;
+    if (k == 0 || k == n - 1)
+      weight *= 0.5;
+    values[k] = weight / diff;
+    sum += values[k];
+  }
+  for (size_t k = 0; k < n; ++k)
+    values[k] /= sum;
+}
+
+// Number of interpolation points in a box; flat boxes have fewer
+size_t interpolationPointCount(const hmat::BoundingBox &box, int order) {
+  const std::array<double, 6> &bounds = box.bounds();
+  size_t count = 1;
+  for (int dim = 0; dim < 3; ++dim)
+    if (bounds[2 * dim + 1] > bounds[2 * dim])
+      count *= order + 1;
+  return count;
+}
+
+template <typename CoordinateType>
+void tensorProductPoints(
+    const std::array<std::vector<CoordinateType>, 3> &nodes,
+    arma::Mat<CoordinateType> &points) {
+  const size_t n0 = nodes[0].size(), n1 = nodes[1].size(),
+               n2 = nodes[2].size();
+  points.set_size(3, n0 * n1 * n2);
+  for (size_t c = 0; c < n2; ++c)
+    for (size_t b = 0; b < n1; ++b)
+      for (size_t a = 0; a < n0; ++a) {
+        const size_t col = a + n0 * (b + n1 * c);
+        points(0, col) = nodes[0][a];
+        points(1, col) = nodes[1][b];
+        points(2, col) = nodes[2][c];
+      }
+}
+
+// Add to result the values at `points` of the tensor-product polynomial
+// taking the values `nodeValues` at the tensor-product Chebyshev points
+// generated by `nodes`
+template <typename CoordinateType, typename ResultType>
+void interpolate(const std::array<std::vector<CoordinateType>, 3> &nodes,
+                 const arma::Mat<ResultType> &nodeValues,
+                 const arma::Mat<CoordinateType> &points,
+                 arma::Mat<ResultType> &result) {
+  const size_t n0 = nodes[0].size(), n1 = nodes[1].size(),
+               n2 = nodes[2].size();
+  const size_t componentCount = nodeValues.n_rows;
+  std::array<std::vector<CoordinateType>, 3> basis;
+  for (size_t i = 0; i < points.n_cols; ++i) {
+    for (int dim = 0; dim < 3; ++dim)
+      lagrangeBasis(nodes[dim], points(dim, i), basis[dim]);
+    for (size_t c = 0; c < n2; ++c)
+      for (size_t b = 0; b < n1; ++b) {
+        const CoordinateType weightBC = basis[2][c] * basis[1][b];
+        if (weightBC == 0.)
+          continue;
+        for (size_t a = 0; a < n0; ++a) {
+          const CoordinateType weight = weightBC * basis[0][a];
+          const size_t col = a + n0 * (b + n1 * c);
+          for (size_t comp = 0; comp < componentCount; ++comp)
+            result(comp, i) += weight * nodeValues(comp, col);
+        }
+      }
+  }
+}
+
+} // namespace
+
+template <typename ResultType>
+TreecodePotentialEvaluator<ResultType>::TreecodePotentialEvaluator(
+    const Evaluator &evaluator, const TreecodeOptions &treecodeOptions,
+    const ParallelizationOptions &parallelOptions)
+    : m_evaluator(evaluator), m_options(treecodeOptions),
+      m_parallelOptions(parallelOptions) {
+  if (m_options.interpolationOrder < 0)
+    throw std::invalid_argument(
+        "TreecodePotentialEvaluator::TreecodePotentialEvaluator(): "
+        "interpolationOrder must not be negative");
+  if (!(m_options.eta > 0.))
+    throw std::invalid_argument(
+        "TreecodePotentialEvaluator::TreecodePotentialEvaluator(): "
+        "eta must be positive");
+  if (m_options.maxLeafSize < 1)
+    throw std::invalid_argument(
+        "TreecodePotentialEvaluator::TreecodePotentialEvaluator(): "
+        "maxLeafSize must be positive");
+
+  arma::Mat<CoordinateType> sourcePoints;
+  evaluator.getSourcePoints(Evaluator::FAR_FIELD, sourcePoints);
+  if (sourcePoints.n_rows != 3 || sourcePoints.n_cols == 0)
+    return; // positions of sources unknown; evaluate directly
+
+  std::unique_ptr<ClusterTree> sourceTree(new ClusterTree);
+  buildClusterTree(sourcePoints, *sourceTree);
+
+  const size_t leafCount = sourceTree->leaves.size();
+  m_leafEvaluators.resize(leafCount);
+  for (size_t leaf = 0; leaf < leafCount; ++leaf) {
+    const std::array<size_t, 2> &range =
+        sourceTree->indexRanges[sourceTree->leaves[leaf]];
+    std::vector<size_t> sourceIndices(
+        sourceTree->permutation.begin() + range[0],
+        sourceTree->permutation.begin() + range[1]);
+    m_leafEvaluators[leaf] =
+        evaluator.restrictToSources(Evaluator::FAR_FIELD, sourceIndices);
+    if (!m_leafEvaluators[leaf]) {
+      // restriction unsupported; evaluate directly
+      m_leafEvaluators.clear();
+      return;
+    }
+  }
+  m_sourceTree = std::move(sourceTree);
+}
+
+template <typename ResultType>
+TreecodePotentialEvaluator<ResultType>::~TreecodePotentialEvaluator() {}
+
+template <typename ResultType>
+void TreecodePotentialEvaluator<ResultType>::evaluate(
+    const arma::Mat<CoordinateType> &points,
+    arma::Mat<ResultType> &result) const {
+  if (!m_sourceTree || points.n_rows != 3 || points.n_cols == 0) {
+    evaluateDirectly(points, result);
+    return;
+  }
+
+  ClusterTree targetTree;
+  buildClusterTree(points, targetTree);
+  const ClusterTree &sourceTree = *m_sourceTree;
+  const int targetNodeCount = targetTree.parents.size();
+  const int order = m_options.interpolationOrder;
+
+  // Find the source clusters interacting with each target cluster through
+  // interpolation (far lists) and the source leaves interacting directly
+  // with each target leaf (near lists)
+  std::vector<std::vector<int>> farLists(targetNodeCount);
+  std::vector<std::vector<int>> nearLists(targetNodeCount);
+  std::vector<std::pair<int, int>> pairs(1, std::make_pair(0, 0));
+  while (!pairs.empty()) {
+    const int target = pairs.back().first;
+    const int source = pairs.back().second;
+    pairs.pop_back();
+    const hmat::BoundingBox &targetBox = targetTree.boxes[target];
+    const hmat::BoundingBox &sourceBox = sourceTree.boxes[source];
+    // Interpolation only pays off if it needs fewer evaluations than the
+    // direct approach
+    if (targetTree.pointCount(target) >
+            interpolationPointCount(targetBox, order) &&
+        targetBox.diameter() <= m_options.eta * targetBox.distance(sourceBox)) {
+      farLists[target].push_back(source);
+      continue;
+    }
+    const bool targetIsLeaf = targetTree.isLeaf(target);
+    const bool sourceIsLeaf = sourceTree.isLeaf(source);
+    if (targetIsLeaf && sourceIsLeaf)
+      nearLists[target].push_back(source);
+    else if (sourceIsLeaf ||
+             (!targetIsLeaf &&
+              targetBox.diameter() >= sourceBox.diameter()))
+      for (int i = 0; i < 2; ++i)
+        pairs.push_back(std::make_pair(targetTree.children[target][i], source));
+    else
+      for (int i = 0; i < 2; ++i)
+        pairs.push_back(std::make_pair(target, sourceTree.children[source][i]));
+  }
+
+  std::vector<int> farTargets;
+  for (int target = 0; target < targetNodeCount; ++target)
+    if (!farLists[target].empty())
+      farTargets.push_back(target);
+
+  int componentCount;
+  {
+    arma::Mat<ResultType> noValues;
+    m_evaluator.evaluate(Evaluator::FAR_FIELD,
+                         arma::Mat<CoordinateType>(3, 0), noValues);
+    componentCount = noValues.n_rows;
+  }
+
+  int maxThreadCount = 1;
+  if (!m_parallelOptions.isOpenClEnabled()) {
+    if (m_parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+      maxThreadCount = tbb::task_scheduler_init::automatic;
+    else
+      maxThreadCount = m_parallelOptions.maxThreadCount();
+  }
+  tbb::task_scheduler_init scheduler(maxThreadCount);
+
+  // Evaluate the far-field potential at the interpolation points of each
+  // target cluster
+  std::vector<std::array<std::vector<CoordinateType>, 3>> interpolationNodes(
+      targetNodeCount);
+  std::vector<arma::Mat<ResultType>> nodeValues(targetNodeCount);
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, farTargets.size()),
+      [&](const tbb::blocked_range<size_t> &r) {
+        arma::Mat<CoordinateType> proxyPoints;
+        arma::Mat<ResultType> leafValues;
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          const int target = farTargets[i];
+          const std::array<double, 6> &bounds =
+              targetTree.boxes[target].bounds();
+          for (int dim = 0; dim < 3; ++dim)
+            chebyshevPoints(bounds[2 * dim], bounds[2 * dim + 1], order,
+                            interpolationNodes[target][dim]);
+          tensorProductPoints(interpolationNodes[target], proxyPoints);
+          arma::Mat<ResultType> &values = nodeValues[target];
+          values.zeros(componentCount, proxyPoints.n_cols);
+          const std::vector<int> &farList = farLists[target];
+          for (size_t s = 0; s < farList.size(); ++s) {
+            const std::array<int, 2> &leafRange =
+                sourceTree.leafRanges[farList[s]];
+            for (int leaf = leafRange[0]; leaf < leafRange[1]; ++leaf) {
+              m_leafEvaluators[leaf]->evaluate(Evaluator::FAR_FIELD,
+                                               proxyPoints, leafValues);
+              values += leafValues;
+            }
+          }
+        }
+      });
+
+  // Add the near-field contributions and the interpolated far-field
+  // contributions of all ancestors of each target leaf
+  result.set_size(componentCount, points.n_cols);
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, targetTree.leaves.size()),
+      [&](const tbb::blocked_range<size_t> &r) {
+        arma::Mat<CoordinateType> leafPoints;
+        arma::Mat<ResultType> leafResult, leafValues;
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          const int target = targetTree.leaves[i];
+          const std::array<size_t, 2> &range = targetTree.indexRanges[target];
+          const size_t pointCount = range[1] - range[0];
+          leafPoints.set_size(3, pointCount);
+          for (size_t p = 0; p < pointCount; ++p)
+            leafPoints.col(p) =
+                points.col(targetTree.permutation[range[0] + p]);
+          leafResult.zeros(componentCount, pointCount);
+          const std::vector<int> &nearList = nearLists[target];
+          for (size_t s = 0; s < nearList.size(); ++s) {
+            const int leaf = sourceTree.leafRanges[nearList[s]][0];
+            m_leafEvaluators[leaf]->evaluate(Evaluator::FAR_FIELD, leafPoints,
+                                             leafValues);
+            leafResult += leafValues;
+          }
+          for (int node = target; node >= 0; node = targetTree.parents[node])
+            if (!farLists[node].empty())
+              interpolate(interpolationNodes[node], nodeValues[node],
+                          leafPoints, leafResult);
+          for (size_t p = 0; p < pointCount; ++p)
+            result.col(targetTree.permutation[range[0] + p]) =
+                leafResult.col(p);
+        }
+      });
+
+  // The leaf evaluators only provide far-field approximations of the
+  // contributions of their sources; correct those of the elements lying
+  // close to the evaluation points
+  m_evaluator.addNearFieldCorrections(points, result);
+}
+
+template <typename ResultType>
+void TreecodePotentialEvaluator<ResultType>::buildClusterTree(
+    const arma::Mat<CoordinateType> &points, ClusterTree &tree) const {
+  const size_t pointCount = points.n_cols;
+  hmat::Geometry geometry(pointCount);
+  for (size_t i = 0; i < pointCount; ++i) {
+    const std::array<double, 3> point = {
+        {points(0, i), points(1, i), points(2, i)}};
+    geometry[i] = hmat::make_shared<hmat::GeometryDataType>(
+        hmat::BoundingBox(point[0], point[0], point[1], point[1], point[2],
+                          point[2]),
+        point);
+  }
+  hmat::ClusterTree<2> hmatTree(geometry, m_options.maxLeafSize,
+                                hmat::CARDINALITY_SPLITTING);
+  tree.permutation = hmatTree.hMatDofToOriginalDofMap();
+  appendNode(*hmatTree.root(), -1, tree);
+
+  // Tight bounding boxes of the nodes; children follow their parents
+  const int nodeCount = tree.parents.size();
+  tree.boxes.resize(nodeCount);
+  for (int node = nodeCount - 1; node >= 0; --node) {
+    if (tree.isLeaf(node)) {
+      const std::array<size_t, 2> &range = tree.indexRanges[node];
+      tree.boxes[node] = geometry[tree.permutation[range[0]]]->boundingBox;
+      for (size_t p = range[0] + 1; p < range[1]; ++p)
+        tree.boxes[node].merge(geometry[tree.permutation[p]]->boundingBox);
+    } else {
+      tree.boxes[node] = tree.boxes[tree.children[node][0]];
+      tree.boxes[node].merge(tree.boxes[tree.children[node][1]]);
+    }
+  }
+}
+
+template <typename ResultType>
+void TreecodePotentialEvaluator<ResultType>::evaluateDirectly(
+    const arma::Mat<CoordinateType> &points,
+    arma::Mat<ResultType> &result) const {
+  m_evaluator.evaluate(Evaluator::NEAR_FIELD, points, result);
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(TreecodePotentialEvaluator);
+
+} // namespace Bempp
@@ -0,0 +1,101 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_treecode_potential_evaluator_hpp
+#define bempp_treecode_potential_evaluator_hpp
+
+#include "../common/common.hpp"
+
+#include "treecode_options.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "../fiber/evaluator_for_integral_operators.hpp"
+#include "../fiber/parallelization_options.hpp"
+#include "../fiber/scalar_traits.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace Bempp {
+
+using Fiber::ParallelizationOptions;
+
+/** \ingroup potential_operators
+ *  \brief Evaluator of potentials based on a kernel-independent treecode.
+ *
+ *  The sources of the potential (the quadrature points of the charge
+ *  distribution, as returned by
+ *  Fiber::EvaluatorForIntegralOperators::getSourcePoints()) and the
+ *  evaluation points are organised in cluster trees. The potential generated
+ *  by a source cluster in a well-separated cluster of evaluation points is
+ *  evaluated directly at the tensor-product Chebyshev points of the bounding
+ *  box of the latter and then interpolated to the individual evaluation
+ *  points; the remaining interactions are evaluated directly.
+ *
+ *  Only the ability to evaluate the potential of a subset of the sources is
+ *  required from the underlying evaluator, so that any kernel is supported.
+ *  If the evaluator does not provide it, all points are evaluated directly.
+ *
+ *  \see EvaluationOptions::switchToTreecodeMode(). */
+template <typename ResultType> class TreecodePotentialEvaluator {
+public:
+  typedef Fiber::EvaluatorForIntegralOperators<ResultType> Evaluator;
+  typedef typename Fiber::ScalarTraits<ResultType>::RealType CoordinateType;
+
+  /** \brief Constructor.
+   *
+   *  Build the cluster tree of the sources of the potential evaluated by \p
+   *  evaluator, which must remain alive as long as this object. */
+  TreecodePotentialEvaluator(const Evaluator &evaluator,
+                             const TreecodeOptions &treecodeOptions,
+                             const ParallelizationOptions &parallelOptions);
+
+  ~TreecodePotentialEvaluator();
+
+  /** \brief Evaluate the potential at \p points.
+   *
+   *  On output, the ith column of \p result contains the value of the
+   *  potential at the ith column of \p points. */
+  void evaluate(const arma::Mat<CoordinateType> &points,
+                arma::Mat<ResultType> &result) const;
+
+private:
+  /** \cond PRIVATE */
+  struct ClusterTree;
+
+  void buildClusterTree(const arma::Mat<CoordinateType> &points,
+                        ClusterTree &tree) const;
+  void evaluateDirectly(const arma::Mat<CoordinateType> &points,
+                        arma::Mat<ResultType> &result) const;
+
+  const Evaluator &m_evaluator;
+  TreecodeOptions m_options;
+  ParallelizationOptions m_parallelOptions;
+  std::unique_ptr<ClusterTree> m_sourceTree;
+  // Evaluators of the potential of the sources in individual leaves of
+  // m_sourceTree
+  std::vector<std::unique_ptr<Evaluator>> m_leafEvaluators;
+  /** \endcond */
+};
+
+} // namespace Bempp
+
+#endif
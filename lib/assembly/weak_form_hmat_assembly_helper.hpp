@@ -110,9 +110,9 @@ private:
 
   mutable tbb::atomic<size_t> m_accessedEntryCount;
 
-  typedef tbb::concurrent_unordered_map<
-      shared_ptr<const hmat::DefaultBlockClusterTreeNodeType>, CoordinateType,
-      std::hash<shared_ptr<const hmat::DefaultBlockClusterTreeNodeType>>> DistanceMap;
+  // Keyed by the flat index of the block cluster tree node
+  typedef tbb::concurrent_unordered_map<std::size_t, CoordinateType>
+      DistanceMap;
   mutable DistanceMap m_distancesCache;
 
   /** \endcond */
@@ -39,7 +39,7 @@ ParameterList GlobalParameters::parameterList() {
 
   parameters.set("potentialOperatorAssemblyType", std::string("dense"),
           "(string) Default assembly type for potential oeprators. "
-          "Allowed values are dense and hmat.");
+          "Allowed values are dense, hmat and treecode.");
 
   parameters.set("verbosityLevel",
           static_cast<int>(0),
@@ -51,6 +51,25 @@ ParameterList GlobalParameters::parameterList() {
           "(bool) If true then singular integrals are pre-calculated and cached "
           "before the boundary operator assembly");
 
+  parameters.set("enableCongruentSingularIntegralReuse",
+          false,
+          "(bool) If true then singular integrals are calculated only once "
+          "for each class of congruent pairs of adjacent flat triangles. "
+          "Only valid for kernels invariant under rigid motions (e.g. "
+          "Laplace, Helmholtz, Maxwell).");
+
+  parameters.set("kernelInterpolationAccuracy",
+          static_cast<double>(0),
+          "(double) Relative accuracy of kernels evaluated by interpolation "
+          "from a table (interpolated modified Helmholtz and Maxwell "
+          "kernels). If not positive, the best accuracy attainable in the "
+          "working precision is used.");
+
+  parameters.set("enableLockFreeDenseAssembly",
+          true,
+          "(bool) If true then dense weak forms are assembled by processing "
+          "groups of trial elements with disjoint DOFs in parallel, without "
+          "locking the global matrix.");
 
   parameters.set("enableBlasInQuadrature",
           std::string("auto"),
@@ -113,6 +132,11 @@ ParameterList GlobalParameters::parameterList() {
   hmatParameters.set("eta", static_cast<double>(1.2),
                      "(double) Specifies the block separation parameter eta");
 
+  hmatParameters.set("clusterSplitting", std::string("geometric"),
+                     "(string) Specifies how clusters are split. Allowed "
+                     "values are geometric (bisection of the bounding box) "
+                     "and cardinality (split at the median element)");
+
   hmatParameters.set("eps", static_cast<double>(1E-3),
           "(double) Specifies the accuracy of low-rank approximations");
 
@@ -120,7 +144,32 @@ ParameterList GlobalParameters::parameterList() {
           "(int) maximum rank of a low rank subblock");
 
   hmatParameters.set("defaultCompressionAlg",std::string("aca"),
-          "(string) Compression Algorithm");
+          "(string) Compression Algorithm. Allowed values are aca "
+          "(partially pivoted ACA), aca+ and dense");
+
+  hmatParameters.set("recompress", false,
+          "(bool) Truncate low-rank blocks to the accuracy eps by QR and "
+          "SVD after compression");
+
+  hmatParameters.set("coarsening", false,
+          "(bool) During recompression merge low-rank sibling blocks into "
+          "their parent block if this saves memory");
+
+  hmatParameters.set("acaSeed", static_cast<int>(0),
+          "(int) Seed for the random pivots of ACA. Results do not depend "
+          "on the number of threads");
+
+  ParameterList& treecodeParameters = parameters.sublist("Treecode");
+
+  treecodeParameters.set("interpolationOrder", static_cast<int>(6),
+          "(int) Degree of the Chebyshev interpolation of the potential "
+          "of distant sources in each cluster of evaluation points");
+
+  treecodeParameters.set("eta", static_cast<double>(1.0),
+          "(double) Specifies the cluster separation parameter eta");
+
+  treecodeParameters.set("maxLeafSize", static_cast<int>(64),
+          "(int) Maximum number of points in a leaf cluster");
 
   return parameters;
 }
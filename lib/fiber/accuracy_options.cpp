@@ -44,14 +44,18 @@ struct Equal {
 
 } // namespace
 
-AccuracyOptionsEx::AccuracyOptionsEx() {
+AccuracyOptionsEx::AccuracyOptionsEx()
+    : m_congruentSingularIntegralReuse(false),
+      m_kernelInterpolationAccuracy(0.) {
   m_singleRegular.push_back(std::make_pair(
       std::numeric_limits<double>::infinity(), QuadratureOptions()));
   m_doubleRegular.push_back(std::make_pair(
       std::numeric_limits<double>::infinity(), QuadratureOptions()));
 }
 
-AccuracyOptionsEx::AccuracyOptionsEx(const AccuracyOptions &oldStyleOpts) {
+AccuracyOptionsEx::AccuracyOptionsEx(const AccuracyOptions &oldStyleOpts)
+    : m_congruentSingularIntegralReuse(false),
+      m_kernelInterpolationAccuracy(0.) {
   m_singleRegular.push_back(std::make_pair(
       std::numeric_limits<double>::infinity(), oldStyleOpts.singleRegular));
   m_doubleRegular.push_back(std::make_pair(
@@ -73,6 +77,14 @@ AccuracyOptionsEx::singleRegular(double relativeDistance) const {
                            "internal error");
 }
 
+double AccuracyOptionsEx::singleRegularNearFieldDistance() const {
+  double result = 0.;
+  for (size_t i = 0; i < m_singleRegular.size(); ++i)
+    if (m_singleRegular[i].first < std::numeric_limits<double>::infinity())
+      result = std::max(result, m_singleRegular[i].first);
+  return result;
+}
+
 void AccuracyOptionsEx::setSingleRegular(int accuracyOrder,
                                          bool relativeToDefault) {
   m_singleRegular.clear();
@@ -334,4 +346,20 @@ void AccuracyOptionsEx::setDoubleSingular(int accuracyOrder,
     m_doubleSingular.setAbsoluteQuadratureOrder(accuracyOrder);
 }
 
+void AccuracyOptionsEx::enableCongruentSingularIntegralReuse(bool value) {
+  m_congruentSingularIntegralReuse = value;
+}
+
+bool AccuracyOptionsEx::isCongruentSingularIntegralReuseEnabled() const {
+  return m_congruentSingularIntegralReuse;
+}
+
+void AccuracyOptionsEx::setKernelInterpolationAccuracy(double accuracy) {
+  m_kernelInterpolationAccuracy = accuracy;
+}
+
+double AccuracyOptionsEx::kernelInterpolationAccuracy() const {
+  return m_kernelInterpolationAccuracy;
+}
+
 } // namespace Fiber
@@ -86,6 +86,12 @@ public:
    */
   const QuadratureOptions &singleRegular(double normalizedDistance) const;
 
+  /** \brief Return the largest normalized distance for which
+   *  singleRegular(normalizedDistance) may differ from singleRegular().
+   *
+   *  Zero is returned if the same options are used at all distances. */
+  double singleRegularNearFieldDistance() const;
+
   /** \brief Set the options controlling integration of functions
    *  on single elements.
    *
@@ -347,11 +353,52 @@ public:
    *  above the default level. */
   void setDoubleSingular(int accuracyOrder, bool relativeToDefault = true);
 
+  /** \brief Enable or disable the reuse of singular integrals over
+   *  congruent pairs of elements.
+   *
+   *  If enabled, singular integrals over pairs of adjacent flat triangles
+   *  are calculated only once for each class of pairs related by a proper
+   *  rigid motion (translation and rotation) and copied to the other pairs
+   *  of the class. This can considerably reduce the cost of the
+   *  precalculation of singular integrals on structured or uniformly refined
+   *  meshes.
+   *
+   *  \warning This option is only valid for kernels invariant under rigid
+   *  motions, i.e. depending only on the relative position of the test and
+   *  trial points and on the normals at these points, as is the case for the
+   *  Laplace, Helmholtz and Maxwell kernels. Do not enable it for operators
+   *  with position-dependent kernels.
+   *
+   *  By default, this option is disabled. */
+  void enableCongruentSingularIntegralReuse(bool value = true);
+
+  /** \brief Return whether singular integrals may be reused over congruent
+   *  pairs of elements.
+   *
+   *  See enableCongruentSingularIntegralReuse(). */
+  bool isCongruentSingularIntegralReuseEnabled() const;
+
+  /** \brief Set the relative accuracy of interpolated kernels.
+   *
+   *  Kernels evaluated by interpolation from a table, such as the
+   *  interpolated modified Helmholtz kernels, choose the density of the
+   *  table so that the interpolation error does not exceed \p accuracy
+   *  relative to the kernel value. A nonpositive value, the default, requests
+   *  the best accuracy attainable in the working precision. */
+  void setKernelInterpolationAccuracy(double accuracy);
+
+  /** \brief Return the relative accuracy of interpolated kernels.
+   *
+   *  See setKernelInterpolationAccuracy(). */
+  double kernelInterpolationAccuracy() const;
+
 private:
     /** \cond PRIVATE */
     t_range m_singleRegular;
     t_range m_doubleRegular;
     QuadratureOptions m_doubleSingular;
+    bool m_congruentSingularIntegralReuse;
+    double m_kernelInterpolationAccuracy;
     /** \endcond */
 };
 
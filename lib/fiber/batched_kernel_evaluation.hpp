@@ -0,0 +1,149 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_batched_kernel_evaluation_hpp
+#define fiber_batched_kernel_evaluation_hpp
+
+#include "../common/common.hpp"
+
+#include "_4d_array.hpp"
+#include "geometrical_data.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+
+namespace Fiber {
+
+/** \brief Number of test points processed together by
+ *  evaluateScalarKernelOnGridInBatches(). */
+const int KERNEL_BATCH_SIZE = 64;
+
+/** \brief Geometrical data of a batch of test points paired with a single
+ *  trial point, stored in structure-of-arrays form.
+ *
+ *  \c diff holds the components of (test point - trial point) and
+ *  \c distance their Euclidean norms. \c testNormal is only filled if the
+ *  test geometrical data contain normals, \c trialNormal only if the trial
+ *  data do. */
+template <typename CoordinateType> struct KernelBatch {
+  int size;
+  alignas(64) CoordinateType diff[3][KERNEL_BATCH_SIZE];
+  alignas(64) CoordinateType distance[KERNEL_BATCH_SIZE];
+  alignas(64) CoordinateType testNormal[3][KERNEL_BATCH_SIZE];
+  CoordinateType trialNormal[3];
+};
+
+/** \brief Evaluate a scalar kernel on the tensor product of the test and
+ *  trial points described by \p testGeomData and \p trialGeomData.
+ *
+ *  On output \p result is a 1 x 1 x testPointCount x trialPointCount
+ *  array. The test points are copied in blocks of
+ *  KERNEL_BATCH_SIZE into contiguous buffers so that the distance loops, as
+ *  well as the loops in \p batchFunctor, can be vectorised by the compiler.
+ *  \p batchFunctor is called as <tt>batchFunctor(batch, values)</tt> and
+ *  should write the kernel values for the <tt>batch.size</tt> test points of
+ *  \p batch to <tt>values[0], ..., values[batch.size - 1]</tt>. */
+template <typename CoordinateType, typename ValueType, typename BatchFunctor>
+void evaluateScalarKernelOnGridInBatches(
+    const GeometricalData<CoordinateType> &testGeomData,
+    const GeometricalData<CoordinateType> &trialGeomData,
+    _4dArray<ValueType> &result, BatchFunctor batchFunctor) {
+  const int coordCount = 3;
+  assert(testGeomData.dimWorld() == coordCount);
+  assert(trialGeomData.dimWorld() == coordCount);
+
+  const size_t testPointCount = testGeomData.pointCount();
+  const size_t trialPointCount = trialGeomData.pointCount();
+  result.set_size(1, 1, testPointCount, trialPointCount);
+
+  const bool hasTestNormals = testGeomData.normals.n_cols > 0;
+  const bool hasTrialNormals = trialGeomData.normals.n_cols > 0;
+
+  KernelBatch<CoordinateType> batch = KernelBatch<CoordinateType>();
+  alignas(64) CoordinateType testGlobals[3][KERNEL_BATCH_SIZE];
+  for (size_t start = 0; start < testPointCount; start += KERNEL_BATCH_SIZE) {
+    const int size = static_cast<int>(
+        std::min<size_t>(KERNEL_BATCH_SIZE, testPointCount - start));
+    batch.size = size;
+    for (int i = 0; i < size; ++i)
+      for (int c = 0; c < coordCount; ++c)
+        testGlobals[c][i] = testGeomData.globals(c, start + i);
+    if (hasTestNormals)
+      for (int i = 0; i < size; ++i)
+        for (int c = 0; c < coordCount; ++c)
+          batch.testNormal[c][i] = testGeomData.normals(c, start + i);
+
+    for (size_t trialIndex = 0; trialIndex < trialPointCount; ++trialIndex) {
+      for (int c = 0; c < coordCount; ++c) {
+        const CoordinateType trialGlobal = trialGeomData.globals(c, trialIndex);
+        for (int i = 0; i < size; ++i)
+          batch.diff[c][i] = testGlobals[c][i] - trialGlobal;
+      }
+      for (int i = 0; i < size; ++i)
+        batch.distance[i] = std::sqrt(batch.diff[0][i] * batch.diff[0][i] +
+                                      batch.diff[1][i] * batch.diff[1][i] +
+                                      batch.diff[2][i] * batch.diff[2][i]);
+      if (hasTrialNormals)
+        for (int c = 0; c < coordCount; ++c)
+          batch.trialNormal[c] = trialGeomData.normals(c, trialIndex);
+
+      batchFunctor(batch, &result(0, 0, start, trialIndex));
+    }
+  }
+}
+
+/** \brief Set <tt>result[i] = exp(-waveNumber * distance[i])</tt> for
+ *  <tt>i < size</tt>, with a real wave number. */
+template <typename CoordinateType>
+void evaluateExponentialDecayInBatch(CoordinateType waveNumber,
+                                     const CoordinateType *distance,
+                                     CoordinateType *result, int size) {
+  for (int i = 0; i < size; ++i)
+    result[i] = std::exp(-waveNumber * distance[i]);
+}
+
+/** \brief Set <tt>result[i] = exp(-waveNumber * distance[i])</tt> for
+ *  <tt>i < size</tt>, with a complex wave number.
+ *
+ *  The real and imaginary parts are evaluated in separate real loops, which
+ *  vectorise, and only combined into complex numbers at the end. */
+template <typename CoordinateType>
+void evaluateExponentialDecayInBatch(std::complex<CoordinateType> waveNumber,
+                                     const CoordinateType *distance,
+                                     std::complex<CoordinateType> *result,
+                                     int size) {
+  assert(size <= KERNEL_BATCH_SIZE);
+  alignas(64) CoordinateType re[KERNEL_BATCH_SIZE];
+  alignas(64) CoordinateType im[KERNEL_BATCH_SIZE];
+  const CoordinateType a = waveNumber.real(), b = waveNumber.imag();
+  for (int i = 0; i < size; ++i) {
+    const CoordinateType scale = std::exp(-a * distance[i]);
+    re[i] = scale * std::cos(b * distance[i]);
+    im[i] = -scale * std::sin(b * distance[i]);
+  }
+  for (int i = 0; i < size; ++i)
+    result[i] = std::complex<CoordinateType>(re[i], im[i]);
+}
+
+} // namespace Fiber
+
+#endif
@@ -0,0 +1,175 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_congruent_element_pairs_hpp
+#define fiber_congruent_element_pairs_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "raw_grid_geometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace Fiber {
+
+/** \brief Compute a key identifying a pair of flat triangles up to a proper
+ *  rigid motion.
+ *
+ *  The corners of both triangles are expressed, in their original order, in
+ *  a right-handed frame attached to the test triangle: its origin is the
+ *  first test corner, its x axis points to the second test corner and its z
+ *  axis is the test triangle normal. The local coordinates are then rounded
+ *  to a power-of-two quantum of roughly \p relativeTolerance times the
+ *  length of the first test edge. Two pairs obtain the same key if (and, up
+ *  to rounding, only if) one can be mapped onto the other by a rotation and
+ *  a translation that preserve the corner order.
+ *
+ *  \param[in] testCorners 3 x 3 matrix whose columns are the test corners.
+ *  \param[in] trialCorners 3 x 3 matrix whose columns are the trial corners.
+ *  \param[in] relativeTolerance Relative resolution of the key.
+ *  \param[out] key The computed key.
+ *
+ *  \return false if the key could not be computed because the elements are
+ *  not triangles embedded in 3D or the test triangle is degenerate. */
+template <typename CoordinateType>
+bool congruenceKey(const arma::Mat<CoordinateType> &testCorners,
+                   const arma::Mat<CoordinateType> &trialCorners,
+                   CoordinateType relativeTolerance,
+                   std::vector<long long> &key) {
+  if (testCorners.n_rows != 3 || testCorners.n_cols != 3 ||
+      trialCorners.n_rows != 3 || trialCorners.n_cols != 3)
+    return false;
+
+  CoordinateType origin[3], e1[3], e2[3], n[3];
+  for (int d = 0; d < 3; ++d) {
+    origin[d] = testCorners(d, 0);
+    e1[d] = testCorners(d, 1) - origin[d];
+    e2[d] = testCorners(d, 2) - origin[d];
+  }
+  n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+  n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+  n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+  const CoordinateType edgeLength =
+      std::sqrt(e1[0] * e1[0] + e1[1] * e1[1] + e1[2] * e1[2]);
+  const CoordinateType normalLength =
+      std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+  if (!(edgeLength > 0) || !(normalLength > 0))
+    return false;
+  for (int d = 0; d < 3; ++d) {
+    e1[d] /= edgeLength;
+    n[d] /= normalLength;
+  }
+  // Third axis of the frame: n x e1
+  e2[0] = n[1] * e1[2] - n[2] * e1[1];
+  e2[1] = n[2] * e1[0] - n[0] * e1[2];
+  e2[2] = n[0] * e1[1] - n[1] * e1[0];
+
+  // A power of two, so that congruent pairs, whose edge lengths differ only
+  // by round-off, almost always use the same quantum
+  const int exponent = std::ilogb(relativeTolerance * edgeLength);
+  const CoordinateType quantum = std::ldexp(CoordinateType(1), exponent);
+
+  key.resize(1 + 2 * 3 * 3);
+  key[0] = exponent;
+  size_t k = 1;
+  for (int element = 0; element < 2; ++element) {
+    const arma::Mat<CoordinateType> &corners =
+        element == 0 ? testCorners : trialCorners;
+    for (int corner = 0; corner < 3; ++corner) {
+      CoordinateType r[3];
+      for (int d = 0; d < 3; ++d)
+        r[d] = corners(d, corner) - origin[d];
+      key[k++] = std::llround((r[0] * e1[0] + r[1] * e1[1] + r[2] * e1[2]) /
+                              quantum);
+      key[k++] = std::llround((r[0] * e2[0] + r[1] * e2[1] + r[2] * e2[2]) /
+                              quantum);
+      key[k++] = std::llround((r[0] * n[0] + r[1] * n[1] + r[2] * n[2]) /
+                              quantum);
+    }
+  }
+  return true;
+}
+
+/** \brief Partition pairs of elements into classes of congruent pairs.
+ *
+ *  On return, <tt>representatives</tt> contains the indices (in \p pairs) of
+ *  one pair per class, in increasing order, and <tt>classIndices[i]</tt> is
+ *  the position in \p representatives of the representative of the class of
+ *  <tt>pairs[i]</tt>. Pairs for which congruenceKey() fails (e.g. because
+ *  the elements are not flat triangles) form singleton classes.
+ *
+ *  Pairs of the same class have equal integrals of any kernel invariant
+ *  under proper rigid motions, provided that the same shapesets and
+ *  quadrature rules are used for all of them. */
+template <typename CoordinateType>
+void findCongruentElementPairs(
+    const RawGridGeometry<CoordinateType> &testRawGeometry,
+    const RawGridGeometry<CoordinateType> &trialRawGeometry,
+    const std::vector<std::pair<int, int>> &pairs,
+    std::vector<int> &representatives, std::vector<int> &classIndices) {
+  const CoordinateType relativeTolerance =
+      std::max(CoordinateType(1e-10),
+               100 * std::numeric_limits<CoordinateType>::epsilon());
+  const bool flat = testRawGeometry.auxData().is_empty() &&
+                    trialRawGeometry.auxData().is_empty();
+
+  typedef std::map<std::vector<long long>, int> ClassMap;
+  ClassMap classes;
+  representatives.clear();
+  classIndices.resize(pairs.size());
+
+  arma::Mat<CoordinateType> testCorners(testRawGeometry.worldDimension(), 3);
+  arma::Mat<CoordinateType> trialCorners(trialRawGeometry.worldDimension(), 3);
+  std::vector<long long> key;
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    bool keyValid = false;
+    if (flat && testRawGeometry.elementCornerCount(pairs[i].first) == 3 &&
+        trialRawGeometry.elementCornerCount(pairs[i].second) == 3) {
+      for (int corner = 0; corner < 3; ++corner) {
+        testCorners.col(corner) = testRawGeometry.vertices().col(
+            testRawGeometry.elementCornerIndices()(corner, pairs[i].first));
+        trialCorners.col(corner) = trialRawGeometry.vertices().col(
+            trialRawGeometry.elementCornerIndices()(corner, pairs[i].second));
+      }
+      keyValid = congruenceKey(testCorners, trialCorners, relativeTolerance,
+                               key);
+    }
+    if (keyValid) {
+      std::pair<typename ClassMap::iterator, bool> inserted =
+          classes.insert(std::make_pair(key, int(representatives.size())));
+      if (inserted.second)
+        representatives.push_back(i);
+      classIndices[i] = inserted.first->second;
+    } else {
+      classIndices[i] = representatives.size();
+      representatives.push_back(i);
+    }
+  }
+}
+
+} // namespace Fiber
+
+#endif
@@ -78,6 +78,18 @@ namespace Fiber {
         // defined, the kernel behaves as if its estimated magnitude was 1
         // everywhere.
         CoordinateType estimateRelativeScale(CoordinateType distance) const;
+
+        // (Optional)
+        // Evaluate the kernels on the tensor product of all test and trial
+        // points at once, storing the result as in
+        // CollectionOfKernels::evaluateOnGrid. If this function is defined,
+        // it is used instead of calling evaluate() for each point pair, which
+        // lets scalar kernels process the points in vectorisable batches (see
+        // evaluateScalarKernelOnGridInBatches()).
+        void evaluateOnGrid(
+                const GeometricalData<CoordinateType>& testGeomData,
+                const GeometricalData<CoordinateType>& trialGeomData,
+                CollectionOf4dArrays<ValueType>& result) const;
     };
     \endcode
 
@@ -43,6 +43,7 @@
 namespace Fiber {
 
 FIBER_HAS_MEM_FUNC(estimateRelativeScale, hasEstimateRelativeScale);
+FIBER_HAS_MEM_FUNC(evaluateOnGrid, hasEvaluateOnGrid);
 
 // template <class Type>
 // class TypeHasEstimateRelativeScale
@@ -97,6 +98,41 @@ estimateRelativeScaleInternal(const Functor &functor,
   return 1.;
 }
 
+template <typename Functor>
+typename boost::enable_if<
+    hasEvaluateOnGrid<
+        Functor,
+        void (Functor::*)(
+            const GeometricalData<typename Functor::CoordinateType> &,
+            const GeometricalData<typename Functor::CoordinateType> &,
+            CollectionOf4dArrays<typename Functor::ValueType> &) const>,
+    bool>::type
+evaluateOnGridInternal(
+    const Functor &functor,
+    const GeometricalData<typename Functor::CoordinateType> &testGeomData,
+    const GeometricalData<typename Functor::CoordinateType> &trialGeomData,
+    CollectionOf4dArrays<typename Functor::ValueType> &result) {
+  functor.evaluateOnGrid(testGeomData, trialGeomData, result);
+  return true;
+}
+
+template <typename Functor>
+typename boost::disable_if<
+    hasEvaluateOnGrid<
+        Functor,
+        void (Functor::*)(
+            const GeometricalData<typename Functor::CoordinateType> &,
+            const GeometricalData<typename Functor::CoordinateType> &,
+            CollectionOf4dArrays<typename Functor::ValueType> &) const>,
+    bool>::type
+evaluateOnGridInternal(
+    const Functor &functor,
+    const GeometricalData<typename Functor::CoordinateType> &testGeomData,
+    const GeometricalData<typename Functor::CoordinateType> &trialGeomData,
+    CollectionOf4dArrays<typename Functor::ValueType> &result) {
+  return false;
+}
+
 // template<typename Functor>
 // typename boost::enable_if<TypeHasEstimateRelativeScale<Functor>,
 //                          typename Functor::CoordinateType>::type
@@ -146,6 +182,9 @@ void DefaultCollectionOfKernels<Functor>::evaluateOnGrid(
     const GeometricalData<CoordinateType> &testGeomData,
     const GeometricalData<CoordinateType> &trialGeomData,
     CollectionOf4dArrays<ValueType> &result) const {
+  if (evaluateOnGridInternal(m_functor, testGeomData, trialGeomData, result))
+    return;
+
   const size_t testPointCount = testGeomData.pointCount();
   const size_t trialPointCount = trialGeomData.pointCount();
   const size_t kernelCount = m_functor.kernelCount();
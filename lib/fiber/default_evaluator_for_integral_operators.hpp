@@ -46,6 +46,7 @@ class OpenClHandler;
 template <typename BasisFunctionType>
 class QuadratureDescriptorSelectorForPotentialOperators;
 template <typename CoordinateType> class SingleQuadratureRuleFamily;
+template <typename CoordinateType> class ElementBoxGrid;
 /** \endcond */
 
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
@@ -79,12 +80,41 @@ public:
   virtual void evaluate(Region region, const arma::Mat<CoordinateType> &points,
                         arma::Mat<ResultType> &result) const;
 
+  virtual void getSourcePoints(Region region,
+                               arma::Mat<CoordinateType> &points) const;
+
+  virtual std::unique_ptr<Base>
+  restrictToSources(Region region,
+                    const std::vector<size_t> &sourceIndices) const;
+
+  virtual void addNearFieldCorrections(const arma::Mat<CoordinateType> &points,
+                                       arma::Mat<ResultType> &result) const;
+
 private:
+  typedef typename GeometryFactory::Geometry Geometry;
+
+  DefaultEvaluatorForIntegralOperators(
+      const DefaultEvaluatorForIntegralOperators &parent, Region region,
+      const std::vector<size_t> &sourceIndices);
+
   void cacheTrialData();
   void calcTrialData(Region region, int kernelTrialGeomDeps,
                      GeometricalData<CoordinateType> &trialGeomData,
                      CollectionOf2dArrays<ResultType> &trialExprValues,
                      std::vector<CoordinateType> &weights) const;
+  void setupNearField();
+  int maxThreadCount() const;
+  bool addNearFieldCorrection(Geometry &geometry,
+                              const arma::Col<CoordinateType> &point,
+                              int element,
+                              arma::Col<ResultType> &correction) const;
+  void
+  integrateOverElement(Geometry &geometry,
+                       const GeometricalData<CoordinateType> &pointGeomData,
+                       int element,
+                       const arma::Mat<CoordinateType> &localPoints,
+                       const std::vector<CoordinateType> &localWeights,
+                       _2dArray<ResultType> &result) const;
 
 private:
   const shared_ptr<const GeometryFactory> m_geometryFactory;
@@ -105,12 +135,16 @@ private:
   const shared_ptr<const SingleQuadratureRuleFamily<CoordinateType>>
   m_quadRuleFamily;
 
-  Fiber::GeometricalData<CoordinateType> m_nearFieldTrialGeomData;
+  size_t m_kernelTrialGeomDeps;
   Fiber::GeometricalData<CoordinateType> m_farFieldTrialGeomData;
-  CollectionOf2dArrays<ResultType> m_nearFieldTrialTransfValues;
   CollectionOf2dArrays<ResultType> m_farFieldTrialTransfValues;
-  std::vector<CoordinateType> m_nearFieldWeights;
   std::vector<CoordinateType> m_farFieldWeights;
+
+  // Index of the elements whose contributions to the potential at nearby
+  // points are recalculated more accurately; null if there are none
+  shared_ptr<const ElementBoxGrid<CoordinateType>> m_nearFieldElements;
+  arma::Mat<CoordinateType> m_elementCenters;
+  std::vector<CoordinateType> m_elementSizes;
 };
 
 } // namespace Fiber
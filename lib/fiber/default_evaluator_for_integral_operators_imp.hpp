@@ -26,15 +26,18 @@
 #include "collection_of_basis_transformations.hpp"
 #include "geometrical_data.hpp"
 #include "collection_of_kernels.hpp"
+#include "element_box_grid.hpp"
 #include "collection_of_2d_arrays.hpp"
 #include "collection_of_3d_arrays.hpp"
 #include "collection_of_4d_arrays.hpp"
 #include "kernel_trial_integral.hpp"
 #include "numerical_quadrature.hpp"
 #include "opencl_handler.hpp"
+#include "quadrature_descriptor_selector_for_potential_operators.hpp"
 #include "raw_grid_geometry.hpp"
 #include "serial_blas_region.hpp"
 #include "shapeset.hpp"
+#include "single_quadrature_rule_family.hpp"
 
 #include <tbb/parallel_for.h>
 #include <tbb/task_scheduler_init.h>
@@ -95,6 +98,169 @@ private:
   size_t m_outputComponentCount;
 };
 
+// Copy the data of the points with indices sourceIndices from source to dest
+template <typename CoordinateType>
+void selectPoints(const GeometricalData<CoordinateType> &source,
+                  const std::vector<size_t> &sourceIndices,
+                  GeometricalData<CoordinateType> &dest) {
+  const size_t pointCount = sourceIndices.size();
+  if (!source.globals.is_empty()) {
+    dest.globals.set_size(source.globals.n_rows, pointCount);
+    for (size_t i = 0; i < pointCount; ++i)
+      dest.globals.col(i) = source.globals.col(sourceIndices[i]);
+  }
+  if (!source.integrationElements.is_empty()) {
+    dest.integrationElements.set_size(pointCount);
+    for (size_t i = 0; i < pointCount; ++i)
+      dest.integrationElements(i) =
+          source.integrationElements(sourceIndices[i]);
+  }
+  if (!source.normals.is_empty()) {
+    dest.normals.set_size(source.normals.n_rows, pointCount);
+    for (size_t i = 0; i < pointCount; ++i)
+      dest.normals.col(i) = source.normals.col(sourceIndices[i]);
+  }
+  const _3dArray<CoordinateType> *sourceArrays[] = {
+      &source.jacobiansTransposed, &source.jacobianInversesTransposed};
+  _3dArray<CoordinateType> *destArrays[] = {
+      &dest.jacobiansTransposed, &dest.jacobianInversesTransposed};
+  for (int a = 0; a < 2; ++a) {
+    const _3dArray<CoordinateType> &sourceArray = *sourceArrays[a];
+    if (sourceArray.is_empty())
+      continue;
+    _3dArray<CoordinateType> &destArray = *destArrays[a];
+    destArray.set_size(sourceArray.extent(0), sourceArray.extent(1),
+                       pointCount);
+    for (size_t i = 0; i < pointCount; ++i)
+      for (size_t c = 0; c < sourceArray.extent(1); ++c)
+        for (size_t r = 0; r < sourceArray.extent(0); ++r)
+          destArray(r, c, i) = sourceArray(r, c, sourceIndices[i]);
+  }
+  dest.domainIndex = source.domainIndex;
+}
+
+// Calculate the values and/or derivatives of the function expanded in the
+// shape functions whose data are stored in basisData with coefficients
+// localCoefficients
+template <typename BasisFunctionType, typename ResultType>
+void calcArgumentData(size_t basisDeps,
+                      const BasisData<BasisFunctionType> &basisData,
+                      const std::vector<ResultType> &localCoefficients,
+                      BasisData<ResultType> &argumentData) {
+  if (basisDeps & VALUES) {
+    argumentData.values.set_size(basisData.values.extent(0),
+                                 1, // just one function
+                                 basisData.values.extent(2));
+    std::fill(argumentData.values.begin(), argumentData.values.end(), 0.);
+    assert(localCoefficients.size() == basisData.values.extent(1));
+    for (size_t point = 0; point < basisData.values.extent(2); ++point)
+      for (size_t dim = 0; dim < basisData.values.extent(0); ++dim)
+        for (size_t fun = 0; fun < basisData.values.extent(1); ++fun)
+          argumentData.values(dim, 0, point) +=
+              basisData.values(dim, fun, point) * localCoefficients[fun];
+  }
+  if (basisDeps & DERIVATIVES) {
+    argumentData.derivatives.set_size(basisData.derivatives.extent(0),
+                                      basisData.derivatives.extent(1),
+                                      1, // just one function
+                                      basisData.derivatives.extent(3));
+    std::fill(argumentData.derivatives.begin(), argumentData.derivatives.end(),
+              0.);
+    assert(localCoefficients.size() == basisData.derivatives.extent(2));
+    for (size_t point = 0; point < basisData.derivatives.extent(3); ++point)
+      for (size_t dim = 0; dim < basisData.derivatives.extent(1); ++dim)
+        for (size_t comp = 0; comp < basisData.derivatives.extent(0); ++comp)
+          for (size_t fun = 0; fun < basisData.derivatives.extent(2); ++fun)
+            argumentData.derivatives(comp, dim, 0, point) +=
+                basisData.derivatives(comp, dim, fun, point) *
+                localCoefficients[fun];
+  }
+}
+
+
+// Contributions of elements lying closer to an evaluation point than this
+// multiple of their size are integrated over subelements
+const double SUBDIVISION_RELATIVE_DISTANCE = 2.;
+// Maximum number of element bisections during near-field integration
+const int MAX_SUBDIVISION_LEVEL = 4;
+
+// Append to (points, weights) the points and weights of the quadrature rule
+// (rulePoints, ruleWeights) mapped to the part of the reference element of
+// geometry spanned by the affine image of the reference triangle (or square)
+// with corners c0, c1 and c2, recursively subdividing that part while it is
+// close to point
+template <typename Geometry, typename CoordinateType>
+void appendSubdividedRule(const Geometry &geometry, bool triangle,
+                          const arma::Col<CoordinateType> &point,
+                          const arma::Col<CoordinateType> &c0,
+                          const arma::Col<CoordinateType> &c1,
+                          const arma::Col<CoordinateType> &c2, int level,
+                          const arma::Mat<CoordinateType> &rulePoints,
+                          const std::vector<CoordinateType> &ruleWeights,
+                          std::vector<CoordinateType> &points,
+                          std::vector<CoordinateType> &weights) {
+  if (level < MAX_SUBDIVISION_LEVEL) {
+    // Corners and centre of the current part in global coordinates
+    arma::Mat<CoordinateType> local(2, 4), global;
+    local.col(0) = c0;
+    local.col(1) = c1;
+    local.col(2) = c2;
+    local.col(3) = triangle ? arma::Col<CoordinateType>((c0 + c1 + c2) / 3.)
+                            : arma::Col<CoordinateType>((c1 + c2) / 2.);
+    geometry.local2global(local, global);
+    const CoordinateType size = std::max(
+        std::max(arma::norm(global.col(1) - global.col(0), 2),
+                 arma::norm(global.col(2) - global.col(0), 2)),
+        arma::norm(global.col(2) - global.col(1), 2));
+    const CoordinateType distance = arma::norm(point - global.col(3), 2);
+    if (distance < SUBDIVISION_RELATIVE_DISTANCE * size) {
+      const arma::Col<CoordinateType> m01 = (c0 + c1) / 2.;
+      const arma::Col<CoordinateType> m02 = (c0 + c2) / 2.;
+      if (triangle) {
+        const arma::Col<CoordinateType> m12 = (c1 + c2) / 2.;
+        appendSubdividedRule(geometry, triangle, point, c0, m01, m02,
+                             level + 1, rulePoints, ruleWeights, points,
+                             weights);
+        appendSubdividedRule(geometry, triangle, point, m01, c1, m12,
+                             level + 1, rulePoints, ruleWeights, points,
+                             weights);
+        appendSubdividedRule(geometry, triangle, point, m02, m12, c2,
+                             level + 1, rulePoints, ruleWeights, points,
+                             weights);
+        appendSubdividedRule(geometry, triangle, point, m12, m02, m01,
+                             level + 1, rulePoints, ruleWeights, points,
+                             weights);
+      } else {
+        const arma::Col<CoordinateType> m = (c1 + c2) / 2.;
+        const arma::Col<CoordinateType> m23 = m01 + (c2 - c0);
+        const arma::Col<CoordinateType> m13 = m02 + (c1 - c0);
+        appendSubdividedRule(geometry, triangle, point, c0, m01, m02,
+                             level + 1, rulePoints, ruleWeights, points,
+                             weights);
+        appendSubdividedRule(geometry, triangle, point, m01, c1, m, level + 1,
+                             rulePoints, ruleWeights, points, weights);
+        appendSubdividedRule(geometry, triangle, point, m02, m, c2, level + 1,
+                             rulePoints, ruleWeights, points, weights);
+        appendSubdividedRule(geometry, triangle, point, m, m13, m23,
+                             level + 1, rulePoints, ruleWeights, points,
+                             weights);
+      }
+      return;
+    }
+  }
+
+  // Map the rule affinely onto the current part
+  const arma::Col<CoordinateType> e1 = c1 - c0, e2 = c2 - c0;
+  const CoordinateType det = std::abs(e1(0) * e2(1) - e1(1) * e2(0));
+  for (size_t i = 0; i < ruleWeights.size(); ++i) {
+    points.push_back(c0(0) + e1(0) * rulePoints(0, i) +
+                     e2(0) * rulePoints(1, i));
+    points.push_back(c0(1) + e1(1) * rulePoints(0, i) +
+                     e2(1) * rulePoints(1, i));
+    weights.push_back(ruleWeights[i] * det);
+  }
+}
+
 } // namespace
 
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
@@ -147,6 +313,71 @@ DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType, ResultType,
   cacheTrialData();
 }
 
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType, ResultType,
+                                     GeometryFactory>::
+    DefaultEvaluatorForIntegralOperators(
+        const DefaultEvaluatorForIntegralOperators &parent, Region region,
+        const std::vector<size_t> &sourceIndices)
+    : m_geometryFactory(parent.m_geometryFactory),
+      m_rawGeometry(parent.m_rawGeometry),
+      m_trialShapesets(parent.m_trialShapesets), m_kernels(parent.m_kernels),
+      m_trialTransformations(parent.m_trialTransformations),
+      m_integral(parent.m_integral),
+      m_argumentLocalCoefficients(parent.m_argumentLocalCoefficients),
+      m_openClHandler(parent.m_openClHandler),
+      m_parallelizationOptions(parent.m_parallelizationOptions),
+      m_quadDescSelector(parent.m_quadDescSelector),
+      m_quadRuleFamily(parent.m_quadRuleFamily),
+      m_kernelTrialGeomDeps(parent.m_kernelTrialGeomDeps) {
+  // The sources are the same in both regions
+  const GeometricalData<CoordinateType> &geomData =
+      parent.m_farFieldTrialGeomData;
+  const CollectionOf2dArrays<ResultType> &transfValues =
+      parent.m_farFieldTrialTransfValues;
+  const std::vector<CoordinateType> &weights = parent.m_farFieldWeights;
+
+  const size_t pointCount = sourceIndices.size();
+  selectPoints(geomData, sourceIndices, m_farFieldTrialGeomData);
+  m_farFieldTrialTransfValues.set_size(transfValues.size());
+  for (size_t transf = 0; transf < transfValues.size(); ++transf) {
+    const _2dArray<ResultType> &values = transfValues[transf];
+    _2dArray<ResultType> &selectedValues = m_farFieldTrialTransfValues[transf];
+    selectedValues.set_size(values.extent(0), pointCount);
+    for (size_t i = 0; i < pointCount; ++i)
+      for (size_t dim = 0; dim < values.extent(0); ++dim)
+        selectedValues(dim, i) = values(dim, sourceIndices[i]);
+  }
+  m_farFieldWeights.resize(pointCount);
+  for (size_t i = 0; i < pointCount; ++i)
+    m_farFieldWeights[i] = weights[sourceIndices[i]];
+
+  // m_nearFieldElements is left null: the contributions of the selected
+  // sources are not corrected
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+void DefaultEvaluatorForIntegralOperators<
+    BasisFunctionType, KernelType, ResultType,
+    GeometryFactory>::getSourcePoints(Region region,
+                                      arma::Mat<CoordinateType> &points) const {
+  // The sources are the same in both regions
+  points = m_farFieldTrialGeomData.globals;
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+std::unique_ptr<EvaluatorForIntegralOperators<ResultType>>
+DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType, ResultType,
+                                     GeometryFactory>::
+    restrictToSources(Region region,
+                      const std::vector<size_t> &sourceIndices) const {
+  return std::unique_ptr<EvaluatorForIntegralOperators<ResultType>>(
+      new DefaultEvaluatorForIntegralOperators(*this, region, sourceIndices));
+}
+
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
           typename GeometryFactory>
 void DefaultEvaluatorForIntegralOperators<
@@ -160,18 +391,13 @@ void DefaultEvaluatorForIntegralOperators<
   result.set_size(outputComponentCount, pointCount);
   result.fill(0.);
 
+  // In the near field, the far-field approximation is evaluated first and
+  // then corrected for the elements close to individual points
   const GeometricalData<CoordinateType> &trialGeomData =
-      (region == EvaluatorForIntegralOperators<ResultType>::NEAR_FIELD)
-          ? m_nearFieldTrialGeomData
-          : m_farFieldTrialGeomData;
+      m_farFieldTrialGeomData;
   const CollectionOf2dArrays<ResultType> &trialTransfValues =
-      (region == EvaluatorForIntegralOperators<ResultType>::NEAR_FIELD)
-          ? m_nearFieldTrialTransfValues
-          : m_farFieldTrialTransfValues;
-  const std::vector<CoordinateType> &weights =
-      (region == EvaluatorForIntegralOperators<ResultType>::NEAR_FIELD)
-          ? m_nearFieldWeights
-          : m_farFieldWeights;
+      m_farFieldTrialTransfValues;
+  const std::vector<CoordinateType> &weights = m_farFieldWeights;
 
   // Do things in chunks -- in order to avoid creating
   // too large arrays of kernel values
@@ -184,15 +410,7 @@ void DefaultEvaluatorForIntegralOperators<
       std::max(1ul, 10 * 1024 * 1024 / kernelValuesSizePerEvalPoint);
   const size_t chunkCount = (pointCount + chunkSize - 1) / chunkSize;
 
-  int maxThreadCount = 1;
-  if (!m_parallelizationOptions.isOpenClEnabled()) {
-    if (m_parallelizationOptions.maxThreadCount() ==
-        ParallelizationOptions::AUTO)
-      maxThreadCount = tbb::task_scheduler_init::automatic;
-    else
-      maxThreadCount = m_parallelizationOptions.maxThreadCount();
-  }
-  tbb::task_scheduler_init scheduler(maxThreadCount);
+  tbb::task_scheduler_init scheduler(maxThreadCount());
   typedef EvaluationLoopBody<BasisFunctionType, KernelType, ResultType> Body;
   {
     Fiber::SerialBlasRegion region;
@@ -201,6 +419,9 @@ void DefaultEvaluatorForIntegralOperators<
                            weights, *m_kernels, *m_integral, result));
   }
 
+  if (region == EvaluatorForIntegralOperators<ResultType>::NEAR_FIELD)
+    addNearFieldCorrections(points, result);
+
   //    // Old serial version
   //    CollectionOf4dArrays<KernelType> kernelValues;
   //    GeometricalData<CoordinateType> evalPointGeomData;
@@ -234,13 +455,13 @@ DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType, ResultType,
         "potentials cannot contain kernels that depend on other test data "
         "than global coordinates");
 
+  m_kernelTrialGeomDeps = trialGeomDeps;
   calcTrialData(EvaluatorForIntegralOperators<ResultType>::FAR_FIELD,
                 trialGeomDeps, m_farFieldTrialGeomData,
                 m_farFieldTrialTransfValues, m_farFieldWeights);
-  // near field is currently not treated in any special way
-  calcTrialData(EvaluatorForIntegralOperators<ResultType>::FAR_FIELD,
-                trialGeomDeps, m_nearFieldTrialGeomData,
-                m_nearFieldTrialTransfValues, m_nearFieldWeights);
+  // The near field reuses the far-field data and is corrected on the fly
+  // for the elements lying close to the evaluation points
+  setupNearField();
 }
 
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
@@ -323,15 +544,6 @@ void DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType,
     activeShapeset.evaluate(basisDeps, localQuadPoints, ALL_DOFS, basisData);
 
     BasisData<ResultType> argumentData;
-    if (basisDeps & VALUES)
-      argumentData.values.set_size(basisData.values.extent(0),
-                                   1, // just one function
-                                   basisData.values.extent(2));
-    if (basisDeps & DERIVATIVES)
-      argumentData.derivatives.set_size(basisData.derivatives.extent(0),
-                                        basisData.derivatives.extent(1),
-                                        1, // just one function
-                                        basisData.derivatives.extent(3));
 
     // Loop over elements and process those that use the active shapeset
     CollectionOf3dArrays<ResultType> trialValues;
@@ -345,28 +557,7 @@ void DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType,
 
       // Calculate the argument function's values and/or derivatives
       // at quadrature points in the current element
-      if (basisDeps & VALUES) {
-        std::fill(argumentData.values.begin(), argumentData.values.end(), 0.);
-        assert(localCoefficients.size() == basisData.values.extent(1));
-        for (size_t point = 0; point < basisData.values.extent(2); ++point)
-          for (size_t dim = 0; dim < basisData.values.extent(0); ++dim)
-            for (size_t fun = 0; fun < basisData.values.extent(1); ++fun)
-              argumentData.values(dim, 0, point) +=
-                  basisData.values(dim, fun, point) * localCoefficients[fun];
-      }
-      if (basisDeps & DERIVATIVES) {
-        std::fill(argumentData.derivatives.begin(),
-                  argumentData.derivatives.end(), 0.);
-        assert(localCoefficients.size() == basisData.derivatives.extent(2));
-        for (size_t point = 0; point < basisData.derivatives.extent(3); ++point)
-          for (size_t dim = 0; dim < basisData.derivatives.extent(1); ++dim)
-            for (size_t comp = 0; comp < basisData.derivatives.extent(0);
-                 ++comp)
-              for (size_t fun = 0; fun < basisData.derivatives.extent(2); ++fun)
-                argumentData.derivatives(comp, dim, 0, point) +=
-                    basisData.derivatives(comp, dim, fun, point) *
-                    localCoefficients[fun];
-      }
+      calcArgumentData(basisDeps, basisData, localCoefficients, argumentData);
 
       // Get geometrical data
       m_rawGeometry->setupGeometry(e, *geometry);
@@ -497,4 +688,222 @@ void DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType,
   }
 }
 
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+int DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType,
+                                         ResultType,
+                                         GeometryFactory>::maxThreadCount()
+    const {
+  if (m_parallelizationOptions.isOpenClEnabled())
+    return 1;
+  if (m_parallelizationOptions.maxThreadCount() ==
+      ParallelizationOptions::AUTO)
+    return tbb::task_scheduler_init::automatic;
+  return m_parallelizationOptions.maxThreadCount();
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+void
+DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType, ResultType,
+                                     GeometryFactory>::setupNearField() {
+  const int elementCount = m_rawGeometry->elementCount();
+  const int worldDim = m_rawGeometry->worldDimension();
+  if (worldDim != 3 || elementCount == 0)
+    return; // the box grid is three-dimensional
+
+  const arma::Mat<CoordinateType> &vertices = m_rawGeometry->vertices();
+  const arma::Mat<int> &cornerIndices = m_rawGeometry->elementCornerIndices();
+
+  m_elementCenters.set_size(worldDim, elementCount);
+  m_elementSizes.resize(elementCount);
+  arma::Mat<CoordinateType> boxes(6, elementCount);
+  bool anyNearField = false;
+  for (int e = 0; e < elementCount; ++e) {
+    const int cornerCount = m_rawGeometry->elementCornerCount(e);
+    m_elementCenters.col(e).fill(0.);
+    CoordinateType size = 0.;
+    for (int i = 0; i < cornerCount; ++i) {
+      const int vertex = cornerIndices(i, e);
+      m_elementCenters.col(e) += vertices.col(vertex);
+      for (int j = 0; j < i; ++j)
+        size = std::max(
+            size, arma::norm(vertices.col(vertex) -
+                                 vertices.col(cornerIndices(j, e)),
+                             2));
+    }
+    m_elementCenters.col(e) /= cornerCount;
+    m_elementSizes[e] = size;
+
+    // Points outside the bounding box of the element enlarged by this
+    // distance get the far-field contribution of the element
+    const CoordinateType nearFieldDistance =
+        std::max<CoordinateType>(m_quadDescSelector->nearFieldDistance(e),
+                                 SUBDIVISION_RELATIVE_DISTANCE * size);
+    anyNearField = anyNearField || nearFieldDistance > 0.;
+    for (int dim = 0; dim < worldDim; ++dim) {
+      CoordinateType lo = vertices(dim, cornerIndices(0, e));
+      CoordinateType hi = lo;
+      for (int i = 1; i < cornerCount; ++i) {
+        lo = std::min(lo, vertices(dim, cornerIndices(i, e)));
+        hi = std::max(hi, vertices(dim, cornerIndices(i, e)));
+      }
+      boxes(2 * dim, e) = lo - nearFieldDistance;
+      boxes(2 * dim + 1, e) = hi + nearFieldDistance;
+    }
+  }
+  if (anyNearField)
+    m_nearFieldElements.reset(new ElementBoxGrid<CoordinateType>(boxes));
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+void DefaultEvaluatorForIntegralOperators<
+    BasisFunctionType, KernelType, ResultType,
+    GeometryFactory>::addNearFieldCorrections(const arma::Mat<CoordinateType> &
+                                                  points,
+                                              arma::Mat<ResultType> &result)
+    const {
+  if (!m_nearFieldElements)
+    return;
+  const size_t pointCount = points.n_cols;
+  if (points.n_rows != 3 || result.n_cols != pointCount)
+    throw std::invalid_argument(
+        "DefaultEvaluatorForIntegralOperators::addNearFieldCorrections(): "
+        "incorrect dimensions of 'points' or 'result'");
+
+  tbb::task_scheduler_init scheduler(maxThreadCount());
+  Fiber::SerialBlasRegion region;
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, pointCount),
+      [&](const tbb::blocked_range<size_t> &r) {
+        std::unique_ptr<Geometry> geometry(m_geometryFactory->make());
+        std::vector<int> elements;
+        arma::Col<CoordinateType> point(3);
+        arma::Col<ResultType> correction(result.n_rows);
+        for (size_t i = r.begin(); i < r.end(); ++i) {
+          m_nearFieldElements->findBoxesContaining(points.colptr(i),
+                                                   elements);
+          point = points.col(i);
+          for (size_t k = 0; k < elements.size(); ++k) {
+            if (addNearFieldCorrection(*geometry, point, elements[k],
+                                       correction))
+              result.col(i) += correction;
+          }
+        }
+      });
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+bool DefaultEvaluatorForIntegralOperators<
+    BasisFunctionType, KernelType, ResultType,
+    GeometryFactory>::addNearFieldCorrection(Geometry &geometry,
+                                             const arma::Col<CoordinateType> &
+                                                 point,
+                                             int element,
+                                             arma::Col<ResultType> &correction)
+    const {
+  const Shapeset<BasisFunctionType> &shapeset = *(*m_trialShapesets)[element];
+  const int cornerCount = m_rawGeometry->elementCornerCount(element);
+  const SingleQuadratureDescriptor nearDesc =
+      m_quadDescSelector->quadratureDescriptor(point, element, -1.);
+  const SingleQuadratureDescriptor farDesc =
+      m_quadDescSelector->farFieldQuadratureDescriptor(shapeset, cornerCount);
+  const CoordinateType distance =
+      arma::norm(point - m_elementCenters.col(element), 2);
+  if (nearDesc == farDesc &&
+      distance >= SUBDIVISION_RELATIVE_DISTANCE * m_elementSizes[element])
+    return false; // the far-field approximation is accurate enough
+
+  m_rawGeometry->setupGeometry(element, geometry);
+  GeometricalData<CoordinateType> pointGeomData;
+  pointGeomData.globals = point;
+
+  // Contribution of the element integrated accurately, with a rule of the
+  // order chosen by the quadrature descriptor selector applied to the
+  // element subdivided adaptively around the evaluation point
+  arma::Mat<CoordinateType> rulePoints;
+  std::vector<CoordinateType> ruleWeights;
+  m_quadRuleFamily->fillQuadraturePointsAndWeights(nearDesc, rulePoints,
+                                                   ruleWeights);
+  const bool triangle = cornerCount == 3;
+  arma::Col<CoordinateType> c0(2), c1(2), c2(2);
+  c0.fill(0.);
+  c1(0) = 1.;
+  c1(1) = 0.;
+  c2(0) = 0.;
+  c2(1) = 1.;
+  std::vector<CoordinateType> nearPoints, nearWeights;
+  appendSubdividedRule(geometry, triangle, point, c0, c1, c2, 0, rulePoints,
+                       ruleWeights, nearPoints, nearWeights);
+  const arma::Mat<CoordinateType> nearLocalPoints(&nearPoints[0], 2,
+                                                  nearWeights.size());
+  _2dArray<ResultType> nearValue;
+  integrateOverElement(geometry, pointGeomData, element, nearLocalPoints,
+                       nearWeights, nearValue);
+
+  // Contribution of the element already included in the far-field result
+  m_quadRuleFamily->fillQuadraturePointsAndWeights(farDesc, rulePoints,
+                                                   ruleWeights);
+  _2dArray<ResultType> farValue;
+  integrateOverElement(geometry, pointGeomData, element, rulePoints,
+                       ruleWeights, farValue);
+
+  for (size_t dim = 0; dim < correction.n_rows; ++dim)
+    correction(dim) = nearValue(dim, 0) - farValue(dim, 0);
+  return true;
+}
+
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+void DefaultEvaluatorForIntegralOperators<BasisFunctionType, KernelType,
+                                          ResultType, GeometryFactory>::
+    integrateOverElement(Geometry &geometry,
+                         const GeometricalData<CoordinateType> &pointGeomData,
+                         int element,
+                         const arma::Mat<CoordinateType> &localPoints,
+                         const std::vector<CoordinateType> &localWeights,
+                         _2dArray<ResultType> &result) const {
+  size_t basisDeps = 0;
+  size_t trialGeomDeps = m_kernelTrialGeomDeps;
+  m_trialTransformations->addDependencies(basisDeps, trialGeomDeps);
+  trialGeomDeps |= INTEGRATION_ELEMENTS;
+
+  // Trial data, calculated as in calcTrialData()
+  BasisData<BasisFunctionType> basisData;
+  (*m_trialShapesets)[element]->evaluate(basisDeps, localPoints, ALL_DOFS,
+                                         basisData);
+  BasisData<ResultType> argumentData;
+  calcArgumentData(basisDeps, basisData,
+                   (*m_argumentLocalCoefficients)[element], argumentData);
+
+  GeometricalData<CoordinateType> trialGeomData;
+  geometry.getData(trialGeomDeps, localPoints, trialGeomData);
+  if (trialGeomDeps & DOMAIN_INDEX)
+    trialGeomData.domainIndex = m_rawGeometry->domainIndex(element);
+
+  CollectionOf3dArrays<ResultType> trialValues;
+  m_trialTransformations->evaluate(argumentData, trialGeomData, trialValues);
+  const size_t pointCount = localWeights.size();
+  CollectionOf2dArrays<ResultType> trialTransfValues(trialValues.size());
+  for (size_t transf = 0; transf < trialValues.size(); ++transf) {
+    const size_t dimCount = trialValues[transf].extent(0);
+    trialTransfValues[transf].set_size(dimCount, pointCount);
+    for (size_t point = 0; point < pointCount; ++point)
+      for (size_t dim = 0; dim < dimCount; ++dim)
+        trialTransfValues[transf](dim, point) =
+            trialValues[transf](dim, 0, point);
+  }
+  std::vector<CoordinateType> weights(pointCount);
+  for (size_t point = 0; point < pointCount; ++point)
+    weights[point] =
+        localWeights[point] * trialGeomData.integrationElements(point);
+
+  CollectionOf4dArrays<KernelType> kernelValues;
+  m_kernels->evaluateOnGrid(pointGeomData, trialGeomData, kernelValues);
+  m_integral->evaluate(trialGeomData, kernelValues, trialTransfValues, weights,
+                       result);
+}
+
 } // namespace Fiber
@@ -37,6 +37,7 @@
 
 #include <boost/static_assert.hpp>
 #include <boost/tuple/tuple_comparison.hpp>
+#include <tbb/atomic.h>
 #include <tbb/concurrent_unordered_map.h>
 #include <tbb/mutex.h>
 #include <cstring>
@@ -49,6 +50,7 @@ namespace Fiber {
 
 /** \cond FORWARD_DECL */
 class OpenClHandler;
+struct AdjacentElementPairs;
 template <typename CoordinateType> class CollectionOfShapesetTransformations;
 template <typename ValueType> class CollectionOfKernels;
 template <typename BasisFunctionType, typename KernelType, typename ResultType>
@@ -117,49 +119,17 @@ private:
   typedef DefaultLocalAssemblerForOperatorsOnSurfacesUtilities<
       BasisFunctionType> Utilities;
 
-  /** \brief Alternative comparison functor for pairs.
-   *
-   *  This functor can be used to sort pairs according to the second member
-   *  and then, in case of equality, according to the first member. */
-  template <typename T1, typename T2> struct alternative_less {
-    bool operator()(const std::pair<T1, T2> &a,
-                    const std::pair<T1, T2> &b) const {
-      return a.second < b.second ||
-             (!(b.second < a.second) && a.first < b.first);
-    }
-  };
-
-  /** \brief Comparison functor for element-index pairs.
-   *
-   *  This functor sorts element index pairs first after the trial element
-   *  index (second member) and then, in case of equality, after the test
-   *  element index (first member) */
-  typedef alternative_less<typename ElementIndexPair::first_type,
-                           typename ElementIndexPair::second_type>
-  ElementIndexPairCompare;
-
-  /** \brief Set of element index pairs.
-   *
-   *  The alternative sorting (first after the trial element index) is used
-   *  because profiling has shown that evaluateLocalWeakForms is called more
-   *  often in the TEST_TRIAL mode (with a single trial element index) than
-   *  in the TRIAL_TEST mode. Therefore the singular integral cache is
-   *  indexed with trial element index, and this sorting mode makes it easier
-   *  to construct such cache. */
-  typedef std::set<ElementIndexPair, ElementIndexPairCompare>
-  ElementIndexPairSet;
-
   bool testAndTrialGridsAreIdentical() const;
 
   void cacheSingularLocalWeakForms();
-  void findPairsOfAdjacentElements(ElementIndexPairSet &pairs) const;
-  void cacheLocalWeakForms(const ElementIndexPairSet &elementIndexPairs);
+  void cacheLocalWeakForms(const AdjacentElementPairs &elementIndexPairs);
 
   const Integrator &selectIntegrator(int testElementIndex,
                                      int trialElementIndex,
                                      CoordinateType nominalDistance = -1.);
 
   const Integrator &getIntegrator(const DoubleQuadratureDescriptor &index);
+  int regularIntegratorSlot(const DoubleQuadratureDescriptor &desc) const;
 
 private:
   shared_ptr<const GeometryFactory> m_testGeometryFactory;
@@ -189,6 +159,20 @@ private:
   IntegratorMap m_testKernelTrialIntegrators;
   mutable tbb::mutex m_integratorCreationMutex;
 
+  /** \brief Integrators for pairs of disjoint elements.
+   *
+   *  Regular integrators are requested for almost every element pair, so
+   *  those with small quadrature orders are additionally stored in this
+   *  table, indexed by regularIntegratorSlot(), which avoids hashing the
+   *  quadrature descriptor. The integrators are owned by
+   *  m_testKernelTrialIntegrators. */
+  enum {
+    MAX_REGULAR_ORDER = 16,
+    REGULAR_INTEGRATOR_SLOT_COUNT =
+        2 * 2 * MAX_REGULAR_ORDER * MAX_REGULAR_ORDER
+  };
+  tbb::atomic<Integrator *> m_regularIntegrators[REGULAR_INTEGRATOR_SLOT_COUNT];
+
   enum {
     INVALID_INDEX = INT_MAX
   };
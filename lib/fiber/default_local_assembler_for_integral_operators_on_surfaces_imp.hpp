@@ -23,11 +23,13 @@
 // Keep IDEs happy
 #include "default_local_assembler_for_integral_operators_on_surfaces.hpp"
 
+#include "congruent_element_pairs.hpp"
 #include "double_quadrature_rule_family.hpp"
 #include "nonseparable_numerical_test_kernel_trial_integrator.hpp"
 #include "quadrature_descriptor_selector_for_integral_operators.hpp"
 #include "separable_numerical_test_kernel_trial_integrator.hpp"
 #include "serial_blas_region.hpp"
+#include "singular_pair_registry.hpp"
 
 #include <tbb/parallel_for.h>
 #include <tbb/task_scheduler_init.h>
@@ -120,6 +122,8 @@ DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
                                                     *testShapesets);
   Utilities::checkConsistencyOfGeometryAndShapesets(*trialRawGeometry,
                                                     *trialShapesets);
+  for (int i = 0; i < REGULAR_INTEGRATOR_SLOT_COUNT; ++i)
+    m_regularIntegrators[i] = 0;
 
   if (cacheSingularIntegrals)
     cacheSingularLocalWeakForms();
@@ -376,63 +380,27 @@ template <typename BasisFunctionType, typename KernelType, typename ResultType,
 void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
     BasisFunctionType, KernelType, ResultType,
     GeometryFactory>::cacheSingularLocalWeakForms() {
-  ElementIndexPairSet elementIndexPairs;
-  findPairsOfAdjacentElements(elementIndexPairs);
-  cacheLocalWeakForms(elementIndexPairs);
-}
-
-/** \brief Fill \p pairs with the list of pairs of indices of elements
-        sharing at least one vertex. */
-template <typename BasisFunctionType, typename KernelType, typename ResultType,
-          typename GeometryFactory>
-void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
-    BasisFunctionType, KernelType, ResultType,
-    GeometryFactory>::findPairsOfAdjacentElements(ElementIndexPairSet &pairs)
-    const {
-  pairs.clear();
-
   if (!testAndTrialGridsAreIdentical())
     return; // we assume that nonidentical grids are always disjoint
 
-  const RawGridGeometry<CoordinateType> &rawGeometry = *m_testRawGeometry;
-
-  const arma::Mat<CoordinateType> &vertices = rawGeometry.vertices();
-  const arma::Mat<int> &elementCornerIndices =
-      rawGeometry.elementCornerIndices();
-
-  const int vertexCount = vertices.n_cols;
-  const int elementCount = elementCornerIndices.n_cols;
-  const int maxCornerCount = elementCornerIndices.n_rows;
-
-  typedef std::vector<int> ElementIndexVector;
-  // ith entry: set of elements sharing vertex number i
-  std::vector<ElementIndexVector> elementsAdjacentToVertex(vertexCount);
-
-  for (int e = 0; e < elementCount; ++e)
-    for (int v = 0; v < maxCornerCount; ++v) {
-      const int index = elementCornerIndices(v, e);
-      if (index >= 0)
-        elementsAdjacentToVertex[index].push_back(e);
-    }
-
-  // Loop over vertex indices
-  for (int v = 0; v < vertexCount; ++v) {
-    const ElementIndexVector &adjacentElements = elementsAdjacentToVertex[v];
-    // Add to pairs each pair of elements adjacent to vertex v
-    const int adjacentElementCount = adjacentElements.size();
-    for (int e1 = 0; e1 < adjacentElementCount; ++e1)
-      for (int e2 = 0; e2 < adjacentElementCount; ++e2)
-        pairs.insert(
-            ElementIndexPair(adjacentElements[e1], adjacentElements[e2]));
-  }
+  SingularPairRegistry &registry = SingularPairRegistry::instance();
+  shared_ptr<const AdjacentElementPairs> elementIndexPairs =
+      registry.adjacentElementPairs(m_testRawGeometry->elementCornerIndices());
+  if (m_verbosityLevel >= VerbosityLevel::HIGH)
+    std::cout << "Adjacent element pairs reused from the singular pair "
+                 "registry in " << registry.hitCount() << " out of "
+              << registry.lookupCount() << " lookups" << std::endl;
+  cacheLocalWeakForms(*elementIndexPairs);
 }
 
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
           typename GeometryFactory>
 void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
     BasisFunctionType, KernelType, ResultType,
-    GeometryFactory>::cacheLocalWeakForms(const ElementIndexPairSet &
-                                              elementIndexPairs) {
+    GeometryFactory>::cacheLocalWeakForms(const AdjacentElementPairs &
+                                              adjacentElementPairs) {
+  const std::vector<ElementIndexPair> &elementIndexPairs =
+      adjacentElementPairs.pairs;
   tbb::tick_count start = tbb::tick_count::now();
 
   if (elementIndexPairs.empty())
@@ -441,23 +409,7 @@ void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
   if (m_verbosityLevel >= VerbosityLevel::DEFAULT)
     std::cout << "Precalculating singular integrals..." << std::endl;
 
-  // Get the maximum number of neighbours a trial element can have.
-  // This will be used to allocate a cache of correct size.
-  // This loops assumes that elementIndexPairs are sorted after the trial
-  // element index first.
-  size_t maxNeighbourCount = 0;
-  for (typename ElementIndexPairSet::const_iterator it =
-           elementIndexPairs.begin();
-       it != elementIndexPairs.end(); /* nothing */) {
-    int curTrialElementIndex = it->second;
-    size_t neighbourCount = 1;
-    for (++it;
-         it != elementIndexPairs.end() && it->second == curTrialElementIndex;
-         ++it) {
-      ++neighbourCount;
-    }
-    maxNeighbourCount = std::max(maxNeighbourCount, neighbourCount);
-  }
+  const size_t maxNeighbourCount = adjacentElementPairs.maxNeighbourCount;
 
   // Allocate cache and initialize all test element indices to INVALID_INDEX
   size_t trialElementCount = m_trialRawGeometry->elementCount();
@@ -473,7 +425,8 @@ void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
   const int elementPairCount = elementIndexPairs.size();
   std::vector<QuadVariant> quadVariants(elementPairCount);
 
-  typedef typename ElementIndexPairSet::const_iterator ElementIndexPairIterator;
+  typedef typename std::vector<ElementIndexPair>::const_iterator
+      ElementIndexPairIterator;
   typedef typename std::vector<QuadVariant>::iterator QuadVariantIterator;
   {
     ElementIndexPairIterator pairIt = elementIndexPairs.begin();
@@ -513,6 +466,13 @@ void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
   }
   tbb::task_scheduler_init scheduler(maxThreadCount);
 
+  const bool reuseCongruentPairs =
+      m_quadDescSelector->singularIntegralsOfCongruentPairsAreEqual();
+  std::vector<int> representatives, classIndices;
+  std::vector<ElementIndexPair> representativePairs;
+  std::vector<arma::Mat<ResultType> *> representativeResults;
+  size_t uniquePairCount = 0;
+
   // Now loop over unique quadrature variants
   for (typename QuadVariantSet::const_iterator it = uniqueQuadVariants.begin();
        it != uniqueQuadVariants.end(); ++it) {
@@ -525,25 +485,16 @@ void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
     // according to the current quadrature variant
     activeElementPairs.clear();
     activeLocalResults.clear();
-    {
-      ElementIndexPairIterator pairIt = elementIndexPairs.begin();
-      QuadVariantIterator qvIt = quadVariants.begin();
-      size_t neighbourIndex = 0;                    // Cache row index
-      size_t curTrialElementIndex = pairIt->second; // Cache column index
-      for (; pairIt != elementIndexPairs.end(); ++pairIt, ++qvIt) {
-        if (pairIt->second != curTrialElementIndex) {
-          // Go to the next column of cache
-          curTrialElementIndex = pairIt->second;
-          neighbourIndex = 0;
-        }
-        if (*qvIt == activeQuadVariant) {
-          activeElementPairs.push_back(*pairIt);
-          m_cache(neighbourIndex, curTrialElementIndex).first = pairIt->first;
-          activeLocalResults.push_back(
-              &m_cache(neighbourIndex, curTrialElementIndex).second);
-        }
-        // Increment cache row index
-        ++neighbourIndex;
+    for (int i = 0; i < elementPairCount; ++i) {
+      if (quadVariants[i] == activeQuadVariant) {
+        const ElementIndexPair &pair = elementIndexPairs[i];
+        // Cache row and column index
+        const int neighbourIndex = adjacentElementPairs.neighbourIndices[i];
+        const int trialElementIndex = pair.second;
+        activeElementPairs.push_back(pair);
+        m_cache(neighbourIndex, trialElementIndex).first = pair.first;
+        activeLocalResults.push_back(
+            &m_cache(neighbourIndex, trialElementIndex).second);
       }
     }
 
@@ -552,16 +503,45 @@ void DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
     // activeIntegrator.integrate(activeElementPairs, activeTestShapeset,
     //                            activeTrialShapeset, localResult);
 
+    // If allowed, integrate only over one element pair per class of
+    // congruent pairs and copy the result to the other members of the class
+    if (reuseCongruentPairs) {
+      findCongruentElementPairs(*m_testRawGeometry, *m_trialRawGeometry,
+                                activeElementPairs, representatives,
+                                classIndices);
+      representativePairs.clear();
+      representativeResults.clear();
+      for (size_t i = 0; i < representatives.size(); ++i) {
+        representativePairs.push_back(activeElementPairs[representatives[i]]);
+        representativeResults.push_back(
+            activeLocalResults[representatives[i]]);
+      }
+      uniquePairCount += representatives.size();
+    }
+    const std::vector<ElementIndexPair> &pairsToIntegrate =
+        reuseCongruentPairs ? representativePairs : activeElementPairs;
+    const std::vector<arma::Mat<ResultType> *> &resultsToIntegrate =
+        reuseCongruentPairs ? representativeResults : activeLocalResults;
+
     typedef SingularIntegralCalculatorLoopBody<BasisFunctionType, KernelType,
                                                ResultType> Body;
     {
       Fiber::SerialBlasRegion region;
       tbb::parallel_for(
-          tbb::blocked_range<size_t>(0, activeElementPairs.size()),
-          Body(activeIntegrator, activeElementPairs, activeTestShapeset,
-               activeTrialShapeset, activeLocalResults));
+          tbb::blocked_range<size_t>(0, pairsToIntegrate.size()),
+          Body(activeIntegrator, pairsToIntegrate, activeTestShapeset,
+               activeTrialShapeset, resultsToIntegrate));
     }
+
+    if (reuseCongruentPairs)
+      for (size_t i = 0; i < activeElementPairs.size(); ++i)
+        if (representatives[classIndices[i]] != int(i))
+          *activeLocalResults[i] = *representativeResults[classIndices[i]];
   }
+  if (reuseCongruentPairs && m_verbosityLevel >= VerbosityLevel::DEFAULT)
+    std::cout << "Singular integrals calculated for " << uniquePairCount
+              << " classes of congruent element pairs out of "
+              << elementPairCount << " pairs" << std::endl;
   tbb::tick_count end = tbb::tick_count::now();
   if (m_verbosityLevel >= VerbosityLevel::DEFAULT)
     std::cout << "Precalculation of singular integrals took "
@@ -587,6 +567,12 @@ const TestKernelTrialIntegrator<BasisFunctionType, KernelType, ResultType> &
 DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
     BasisFunctionType, KernelType, ResultType,
     GeometryFactory>::getIntegrator(const DoubleQuadratureDescriptor &desc) {
+  const int slot = regularIntegratorSlot(desc);
+  if (slot >= 0) {
+    if (const Integrator *integrator = m_regularIntegrators[slot])
+      return *integrator;
+  }
+
   typename IntegratorMap::iterator it = m_testKernelTrialIntegrators.find(desc);
   // Note: as far as I understand TBB's docs, .end() keeps pointing to the
   // same element even if another thread inserts a new element into the map
@@ -646,7 +632,31 @@ DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
       it = result.first;
     }
   }
+  if (slot >= 0)
+    m_regularIntegrators[slot] = it->second;
   return *it->second;
 }
 
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+inline int DefaultLocalAssemblerForIntegralOperatorsOnSurfaces<
+    BasisFunctionType, KernelType, ResultType, GeometryFactory>::
+    regularIntegratorSlot(const DoubleQuadratureDescriptor &desc) const {
+  const ElementPairTopology &topology = desc.topology;
+  if (topology.type != ElementPairTopology::Disjoint ||
+      desc.testOrder < 0 || desc.testOrder >= MAX_REGULAR_ORDER ||
+      desc.trialOrder < 0 || desc.trialOrder >= MAX_REGULAR_ORDER)
+    return -1;
+  const int testVertexCountIndex = topology.testVertexCount - 3;
+  const int trialVertexCountIndex = topology.trialVertexCount - 3;
+  if (testVertexCountIndex < 0 || testVertexCountIndex > 1 ||
+      trialVertexCountIndex < 0 || trialVertexCountIndex > 1)
+    return -1;
+  return ((2 * testVertexCountIndex + trialVertexCountIndex) *
+              MAX_REGULAR_ORDER +
+          desc.testOrder) *
+             MAX_REGULAR_ORDER +
+         desc.trialOrder;
+}
+
 } // namespace Fiber
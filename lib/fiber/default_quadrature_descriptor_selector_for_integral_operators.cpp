@@ -21,11 +21,14 @@
 #include "default_quadrature_descriptor_selector_for_integral_operators.hpp"
 
 #include "default_local_assembler_for_operators_on_surfaces_utilities.hpp"
+#include "element_adjacency.hpp"
 #include "explicit_instantiation.hpp"
 #include "quadrature_options.hpp"
 #include "raw_grid_geometry.hpp"
 #include "shapeset.hpp"
 
+#include "../common/boost_make_shared_fwd.hpp"
+
 namespace Fiber {
 
 template <typename BasisFunctionType>
@@ -59,21 +62,44 @@ inline bool DefaultQuadratureDescriptorSelectorForIntegralOperators<
 template <typename BasisFunctionType>
 void DefaultQuadratureDescriptorSelectorForIntegralOperators<
     BasisFunctionType>::precalculateElementSizesAndCenters() {
-  CoordinateType averageTestElementSize;
-  Utilities::precalculateElementSizesAndCentersForSingleGrid(
-      *m_testRawGeometry, m_testElementSizesSquared, m_testElementCenters,
-      averageTestElementSize);
+  shared_ptr<ElementSizesAndCenters> testElements =
+      boost::make_shared<ElementSizesAndCenters>();
+  precalculateElementSizesAndCentersForSingleGrid(*m_testRawGeometry,
+                                                  *testElements);
+  m_testElements = testElements;
   if (testAndTrialGridsAreIdentical()) {
-    m_trialElementSizesSquared = m_testElementSizesSquared;
-    m_trialElementCenters = m_testElementCenters;
-    m_averageElementSize = averageTestElementSize;
+    m_adjacency = boost::make_shared<ElementAdjacency>(
+        m_testRawGeometry->elementCornerIndices());
+    m_trialElements = m_testElements;
+    m_averageElementSize = m_testElements->averageSize;
   } else {
-    CoordinateType averageTrialElementSize;
-    Utilities::precalculateElementSizesAndCentersForSingleGrid(
-        *m_trialRawGeometry, m_trialElementSizesSquared, m_trialElementCenters,
-        averageTrialElementSize);
+    shared_ptr<ElementSizesAndCenters> trialElements =
+        boost::make_shared<ElementSizesAndCenters>();
+    precalculateElementSizesAndCentersForSingleGrid(*m_trialRawGeometry,
+                                                    *trialElements);
+    m_trialElements = trialElements;
     m_averageElementSize =
-        (averageTestElementSize + averageTrialElementSize) / 2.;
+        (m_testElements->averageSize + m_trialElements->averageSize) / 2.;
+  }
+}
+
+template <typename BasisFunctionType>
+void DefaultQuadratureDescriptorSelectorForIntegralOperators<
+    BasisFunctionType>::
+    precalculateElementSizesAndCentersForSingleGrid(
+        const RawGridGeometry<CoordinateType> &rawGeometry,
+        ElementSizesAndCenters &elements) {
+  arma::Mat<CoordinateType> centers;
+  Utilities::precalculateElementSizesAndCentersForSingleGrid(
+      rawGeometry, elements.sizesSquared, centers, elements.averageSize);
+  const size_t elementCount = centers.n_cols;
+  elements.centerX.resize(elementCount);
+  elements.centerY.resize(elementCount);
+  elements.centerZ.resize(elementCount);
+  for (size_t e = 0; e < elementCount; ++e) {
+    elements.centerX[e] = centers(0, e);
+    elements.centerY[e] = centers(1, e);
+    elements.centerZ[e] = centers(2, e);
   }
 }
 
@@ -86,17 +112,13 @@ DefaultQuadratureDescriptorSelectorForIntegralOperators<
     const {
   DoubleQuadratureDescriptor desc;
 
-  // Get corner indices of the specified elements
-  arma::Col<int> testElementCornerIndices =
-      m_testRawGeometry->elementCornerIndices(testElementIndex);
-  arma::Col<int> trialElementCornerIndices =
-      m_trialRawGeometry->elementCornerIndices(trialElementIndex);
-  if (testAndTrialGridsAreIdentical()) {
-    desc.topology = determineElementPairTopologyIn3D(testElementCornerIndices,
-                                                     trialElementCornerIndices);
+  if (m_adjacency) {
+    desc.topology = m_adjacency->topology(testElementIndex, trialElementIndex);
   } else {
-    desc.topology.testVertexCount = testElementCornerIndices.n_rows;
-    desc.topology.trialVertexCount = trialElementCornerIndices.n_rows;
+    desc.topology.testVertexCount =
+        m_testRawGeometry->elementCornerCount(testElementIndex);
+    desc.topology.trialVertexCount =
+        m_trialRawGeometry->elementCornerCount(trialElementIndex);
     desc.topology.type = ElementPairTopology::Disjoint;
   }
 
@@ -133,9 +155,9 @@ void DefaultQuadratureDescriptorSelectorForIntegralOperators<
   CoordinateType normalisedDistance;
   if (nominalDistance < 0.) {
     CoordinateType testElementSizeSquared =
-        m_testElementSizesSquared[testElementIndex];
+        m_testElements->sizesSquared[testElementIndex];
     CoordinateType trialElementSizeSquared =
-        m_trialElementSizesSquared[trialElementIndex];
+        m_trialElements->sizesSquared[trialElementIndex];
     CoordinateType distanceSquared =
         elementDistanceSquared(testElementIndex, trialElementIndex);
     CoordinateType normalisedDistanceSquared =
@@ -151,6 +173,13 @@ void DefaultQuadratureDescriptorSelectorForIntegralOperators<
   trialQuadOrder = options.quadratureOrder(trialQuadOrder);
 }
 
+template <typename BasisFunctionType>
+bool DefaultQuadratureDescriptorSelectorForIntegralOperators<
+    BasisFunctionType>::singularIntegralsOfCongruentPairsAreEqual() const {
+  // The order of singular quadrature rules depends only on the shapesets
+  return m_accuracyOptions.isCongruentSingularIntegralReuseEnabled();
+}
+
 template <typename BasisFunctionType>
 int DefaultQuadratureDescriptorSelectorForIntegralOperators<
     BasisFunctionType>::singularOrder(int elementIndex,
@@ -175,14 +204,15 @@ inline typename DefaultQuadratureDescriptorSelectorForIntegralOperators<
 DefaultQuadratureDescriptorSelectorForIntegralOperators<
     BasisFunctionType>::elementDistanceSquared(int testElementIndex,
                                                int trialElementIndex) const {
-  CoordinateType result = 0.;
-  const int dimWorld = 3;
-  for (int d = 0; d < dimWorld; ++d) {
-    CoordinateType diff = m_trialElementCenters(d, trialElementIndex) -
-                          m_testElementCenters(d, testElementIndex);
-    result += diff * diff;
-  }
-  return result;
+  const ElementSizesAndCenters &test = *m_testElements;
+  const ElementSizesAndCenters &trial = *m_trialElements;
+  const CoordinateType diffX =
+      trial.centerX[trialElementIndex] - test.centerX[testElementIndex];
+  const CoordinateType diffY =
+      trial.centerY[trialElementIndex] - test.centerY[testElementIndex];
+  const CoordinateType diffZ =
+      trial.centerZ[trialElementIndex] - test.centerZ[testElementIndex];
+  return diffX * diffX + diffY * diffY + diffZ * diffZ;
 }
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS(
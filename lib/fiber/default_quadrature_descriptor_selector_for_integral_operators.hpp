@@ -27,8 +27,11 @@
 #include "accuracy_options.hpp"
 #include "scalar_traits.hpp"
 
+#include <vector>
+
 namespace Fiber {
 
+class ElementAdjacency;
 template <typename BasisFunctionType> class Shapeset;
 template <typename CoordinateType> class RawGridGeometry;
 template <typename BasisFunctionType>
@@ -59,6 +62,8 @@ public:
   quadratureDescriptor(int testElementIndex, int trialElementIndex,
                        CoordinateType nominalDistance) const;
 
+  virtual bool singularIntegralsOfCongruentPairsAreEqual() const;
+
 private:
   /** \cond PRIVATE */
   typedef DefaultLocalAssemblerForOperatorsOnSurfacesUtilities<
@@ -69,8 +74,19 @@ private:
     TRIAL
   };
 
+  /** \brief Squared sizes and centres of the elements of a grid, stored as
+   *  separate arrays. */
+  struct ElementSizesAndCenters {
+    std::vector<CoordinateType> sizesSquared;
+    std::vector<CoordinateType> centerX, centerY, centerZ;
+    CoordinateType averageSize;
+  };
+
   bool testAndTrialGridsAreIdentical() const;
   void precalculateElementSizesAndCenters();
+  static void precalculateElementSizesAndCentersForSingleGrid(
+      const RawGridGeometry<CoordinateType> &rawGeometry,
+      ElementSizesAndCenters &elements);
   void getRegularOrders(int testElementIndex, int trialElementIndex,
                         int &testQuadOrder, int &trialQuadOrder,
                         CoordinateType nominalDistance) const;
@@ -86,10 +102,11 @@ private:
   m_trialShapesets;
   AccuracyOptionsEx m_accuracyOptions;
 
-  std::vector<CoordinateType> m_testElementSizesSquared;
-  std::vector<CoordinateType> m_trialElementSizesSquared;
-  arma::Mat<CoordinateType> m_testElementCenters;
-  arma::Mat<CoordinateType> m_trialElementCenters;
+  // Neighbours of the elements; only set if the test and trial grids are
+  // identical
+  shared_ptr<const ElementAdjacency> m_adjacency;
+  shared_ptr<const ElementSizesAndCenters> m_testElements;
+  shared_ptr<const ElementSizesAndCenters> m_trialElements;
   CoordinateType m_averageElementSize;
   /** \endcond */
 };
@@ -118,6 +118,15 @@ DefaultQuadratureDescriptorSelectorForPotentialOperators<BasisFunctionType>::
   return desc;
 }
 
+template <typename BasisFunctionType>
+typename DefaultQuadratureDescriptorSelectorForPotentialOperators<
+    BasisFunctionType>::CoordinateType
+DefaultQuadratureDescriptorSelectorForPotentialOperators<
+    BasisFunctionType>::nearFieldDistance(int trialElementIndex) const {
+  return m_accuracyOptions.singleRegularNearFieldDistance() *
+         sqrt(m_elementSizesSquared[trialElementIndex]);
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS(
     DefaultQuadratureDescriptorSelectorForPotentialOperators);
 
@@ -0,0 +1,118 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "element_adjacency.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Fiber {
+
+ElementAdjacency::ElementAdjacency(const arma::Mat<int> &elementCornerIndices) {
+  const int elementCount = elementCornerIndices.n_cols;
+  const int maxCornerCount = elementCornerIndices.n_rows;
+  if (maxCornerCount > MAX_CORNER_COUNT)
+    throw std::invalid_argument("ElementAdjacency::ElementAdjacency(): "
+                                "elements may have at most 4 corners");
+
+  m_cornerIndices.assign(elementCount * MAX_CORNER_COUNT, -1);
+  m_cornerCounts.resize(elementCount);
+  int vertexCount = 0;
+  for (int e = 0; e < elementCount; ++e) {
+    int cornerCount = 0;
+    for (; cornerCount < maxCornerCount; ++cornerCount) {
+      const int vertex = elementCornerIndices(cornerCount, e);
+      if (vertex < 0)
+        break;
+      m_cornerIndices[e * MAX_CORNER_COUNT + cornerCount] = vertex;
+      vertexCount = std::max(vertexCount, vertex + 1);
+    }
+    m_cornerCounts[e] = cornerCount;
+  }
+
+  // Elements adjacent to each vertex, in CSR format
+  std::vector<int> vertexOffsets(vertexCount + 1, 0);
+  for (int e = 0; e < elementCount; ++e)
+    for (int c = 0; c < m_cornerCounts[e]; ++c)
+      ++vertexOffsets[m_cornerIndices[e * MAX_CORNER_COUNT + c] + 1];
+  for (int v = 0; v < vertexCount; ++v)
+    vertexOffsets[v + 1] += vertexOffsets[v];
+  std::vector<int> vertexElements(vertexOffsets[vertexCount]);
+  {
+    std::vector<int> position(vertexOffsets.begin(), vertexOffsets.end() - 1);
+    for (int e = 0; e < elementCount; ++e)
+      for (int c = 0; c < m_cornerCounts[e]; ++c)
+        vertexElements[position[m_cornerIndices[e * MAX_CORNER_COUNT + c]]++] =
+            e;
+  }
+
+  // Each neighbour appears in the lists of the element's corners as many
+  // times as the number of vertices it shares with the element
+  m_offsets.resize(elementCount + 1);
+  m_offsets[0] = 0;
+  std::vector<int> candidates;
+  for (int e = 0; e < elementCount; ++e) {
+    candidates.clear();
+    for (int c = 0; c < m_cornerCounts[e]; ++c) {
+      const int v = m_cornerIndices[e * MAX_CORNER_COUNT + c];
+      candidates.insert(candidates.end(),
+                        vertexElements.begin() + vertexOffsets[v],
+                        vertexElements.begin() + vertexOffsets[v + 1]);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    for (size_t i = 0; i < candidates.size();) {
+      size_t j = i + 1;
+      while (j < candidates.size() && candidates[j] == candidates[i])
+        ++j;
+      m_neighbours.push_back(candidates[i]);
+      m_sharedVertexCounts.push_back(j - i);
+      i = j;
+    }
+    m_offsets[e + 1] = m_neighbours.size();
+  }
+}
+
+int ElementAdjacency::sharedVertexCount(int testElement,
+                                        int trialElement) const {
+  const int *begin = neighboursBegin(testElement);
+  const int *end = neighboursEnd(testElement);
+  const int *it = std::lower_bound(begin, end, trialElement);
+  if (it == end || *it != trialElement)
+    return 0;
+  return m_sharedVertexCounts[it - &m_neighbours[0]];
+}
+
+ElementPairTopology ElementAdjacency::topology(int testElement,
+                                               int trialElement) const {
+  if (sharedVertexCount(testElement, trialElement) == 0) {
+    ElementPairTopology topology;
+    topology.type = ElementPairTopology::Disjoint;
+    topology.testVertexCount = m_cornerCounts[testElement];
+    topology.trialVertexCount = m_cornerCounts[trialElement];
+    return topology;
+  }
+  return determineElementPairTopologyIn3D(
+      cornerIndices(testElement), m_cornerCounts[testElement],
+      cornerIndices(trialElement), m_cornerCounts[trialElement]);
+}
+
+} // namespace Fiber
@@ -0,0 +1,95 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_element_adjacency_hpp
+#define fiber_element_adjacency_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "element_pair_topology.hpp"
+
+#include <vector>
+
+namespace Fiber {
+
+/** \brief Vertex and edge neighbours of the elements of a grid.
+ *
+ *  The neighbours of each element, i.e. the elements (including itself)
+ *  sharing at least one vertex with it, are stored in compressed sparse row
+ *  format, sorted after element index, together with the number of shared
+ *  vertices (1 for vertex neighbours, 2 for edge neighbours). The corner
+ *  indices of the elements are stored contiguously as well, so that the
+ *  topology of any pair of elements can be determined without allocating
+ *  memory. */
+class ElementAdjacency {
+public:
+  /** \brief Constructor.
+   *
+   *  \param[in] elementCornerIndices
+   *    Matrix whose columns contain the corner indices of consecutive
+   *    elements, padded with negative numbers, as returned by
+   *    RawGridGeometry::elementCornerIndices(). */
+  explicit ElementAdjacency(const arma::Mat<int> &elementCornerIndices);
+
+  /** \brief Number of elements. */
+  int elementCount() const { return m_cornerCounts.size(); }
+
+  /** \brief Number of corners of element \p element. */
+  int cornerCount(int element) const { return m_cornerCounts[element]; }
+
+  /** \brief Pointer to the corner indices of element \p element. */
+  const int *cornerIndices(int element) const {
+    return &m_cornerIndices[element * MAX_CORNER_COUNT];
+  }
+
+  /** \brief Pointer to the first neighbour of element \p element. */
+  const int *neighboursBegin(int element) const {
+    return &m_neighbours[0] + m_offsets[element];
+  }
+
+  /** \brief Pointer past the last neighbour of element \p element. */
+  const int *neighboursEnd(int element) const {
+    return &m_neighbours[0] + m_offsets[element + 1];
+  }
+
+  /** \brief Number of vertices shared by two elements (0 if they are
+   *  disjoint). */
+  int sharedVertexCount(int testElement, int trialElement) const;
+
+  /** \brief Configuration of a pair of elements. */
+  ElementPairTopology topology(int testElement, int trialElement) const;
+
+private:
+  /** \cond PRIVATE */
+  enum {
+    MAX_CORNER_COUNT = 4
+  };
+  std::vector<int> m_cornerIndices;
+  std::vector<unsigned char> m_cornerCounts;
+  std::vector<int> m_offsets;
+  std::vector<int> m_neighbours;
+  std::vector<unsigned char> m_sharedVertexCounts;
+  /** \endcond */
+};
+
+} // namespace Fiber
+
+#endif
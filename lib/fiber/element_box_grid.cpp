@@ -0,0 +1,150 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "element_box_grid.hpp"
+
+#include "explicit_instantiation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Fiber {
+
+template <typename CoordinateType>
+ElementBoxGrid<CoordinateType>::ElementBoxGrid(
+    const arma::Mat<CoordinateType> &boxes)
+    : m_boxes(boxes) {
+  if (boxes.n_rows != 6)
+    throw std::invalid_argument("ElementBoxGrid::ElementBoxGrid(): "
+                                "boxes must have six rows");
+  const int boxCount = boxes.n_cols;
+  m_cellSize = 0.;
+  for (int dim = 0; dim < 3; ++dim) {
+    m_origin[dim] = 0.;
+    m_cellCounts[dim] = 1;
+  }
+  m_offsets.assign(2, 0);
+  if (boxCount == 0)
+    return;
+
+  // Choose the size of the cells equal to the average extent of the boxes,
+  // but make sure that there are not many more cells than boxes
+  CoordinateType upper[3], averageExtent = 0.;
+  for (int dim = 0; dim < 3; ++dim) {
+    m_origin[dim] = boxes(2 * dim, 0);
+    upper[dim] = boxes(2 * dim + 1, 0);
+  }
+  for (int e = 0; e < boxCount; ++e) {
+    CoordinateType extent = 0.;
+    for (int dim = 0; dim < 3; ++dim) {
+      m_origin[dim] = std::min(m_origin[dim], boxes(2 * dim, e));
+      upper[dim] = std::max(upper[dim], boxes(2 * dim + 1, e));
+      extent = std::max(extent, boxes(2 * dim + 1, e) - boxes(2 * dim, e));
+    }
+    averageExtent += extent;
+  }
+  averageExtent /= boxCount;
+  CoordinateType maxExtent = 0.;
+  for (int dim = 0; dim < 3; ++dim)
+    maxExtent = std::max(maxExtent, upper[dim] - m_origin[dim]);
+  if (!(maxExtent > 0.))
+    maxExtent = 1.;
+  m_cellSize = averageExtent > 0. ? averageExtent : maxExtent;
+  const double maxCellCount = 8. * boxCount + 64.;
+  while (true) {
+    double cellCount = 1.;
+    for (int dim = 0; dim < 3; ++dim) {
+      m_cellCounts[dim] = std::max(
+          1, static_cast<int>(std::ceil((upper[dim] - m_origin[dim]) /
+                                        m_cellSize)));
+      cellCount *= m_cellCounts[dim];
+    }
+    if (cellCount <= maxCellCount)
+      break;
+    m_cellSize *= 2.;
+  }
+
+  // Count the boxes overlapping each cell and then store their indices
+  const int cellCount = m_cellCounts[0] * m_cellCounts[1] * m_cellCounts[2];
+  m_offsets.assign(cellCount + 1, 0);
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 1) {
+      for (int cell = 0; cell < cellCount; ++cell)
+        m_offsets[cell + 1] += m_offsets[cell];
+      m_elements.resize(m_offsets[cellCount]);
+    }
+    std::vector<int> fill(m_offsets.begin(), m_offsets.end() - 1);
+    for (int e = 0; e < boxCount; ++e) {
+      int first[3], last[3];
+      for (int dim = 0; dim < 3; ++dim) {
+        cellIndex(dim, boxes(2 * dim, e), first[dim]);
+        cellIndex(dim, boxes(2 * dim + 1, e), last[dim]);
+      }
+      for (int k = first[2]; k <= last[2]; ++k)
+        for (int j = first[1]; j <= last[1]; ++j)
+          for (int i = first[0]; i <= last[0]; ++i) {
+            const int cell = i + m_cellCounts[0] * (j + m_cellCounts[1] * k);
+            if (pass == 0)
+              ++m_offsets[cell + 1];
+            else
+              m_elements[fill[cell]++] = e;
+          }
+    }
+  }
+}
+
+template <typename CoordinateType>
+bool ElementBoxGrid<CoordinateType>::cellIndex(int dim,
+                                               CoordinateType coordinate,
+                                               int &index) const {
+  const CoordinateType position = (coordinate - m_origin[dim]) / m_cellSize;
+  const bool inside = position >= 0. && position <= m_cellCounts[dim];
+  index = std::min(std::max(static_cast<int>(std::floor(position)), 0),
+                   m_cellCounts[dim] - 1);
+  return inside;
+}
+
+template <typename CoordinateType>
+void ElementBoxGrid<CoordinateType>::findBoxesContaining(
+    const CoordinateType *point, std::vector<int> &elements) const {
+  elements.clear();
+  if (m_boxes.n_cols == 0)
+    return;
+  int index[3];
+  for (int dim = 0; dim < 3; ++dim)
+    if (!cellIndex(dim, point[dim], index[dim]))
+      return;
+  const int cell =
+      index[0] + m_cellCounts[0] * (index[1] + m_cellCounts[1] * index[2]);
+  for (int i = m_offsets[cell]; i < m_offsets[cell + 1]; ++i) {
+    const int e = m_elements[i];
+    bool inside = true;
+    for (int dim = 0; dim < 3 && inside; ++dim)
+      inside = m_boxes(2 * dim, e) <= point[dim] &&
+               point[dim] <= m_boxes(2 * dim + 1, e);
+    if (inside)
+      elements.push_back(e);
+  }
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT_REAL_ONLY(ElementBoxGrid);
+
+} // namespace Fiber
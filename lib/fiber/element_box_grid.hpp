@@ -0,0 +1,78 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_element_box_grid_hpp
+#define fiber_element_box_grid_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+
+#include <vector>
+
+namespace Fiber {
+
+/** \brief Spatial index of axis-aligned boxes associated with the elements of
+ *  a grid.
+ *
+ *  The boxes are sorted into the cells of a uniform Cartesian grid covering
+ *  all of them; each box is stored in every cell it overlaps, in compressed
+ *  sparse row format. The boxes containing a given point can then be found
+ *  by checking only the boxes stored in the cell containing that point.
+ *
+ *  This is used to find the elements lying close to the points at which a
+ *  potential is evaluated, by indexing the bounding boxes of the elements
+ *  enlarged by the radius of their near field. */
+template <typename CoordinateType> class ElementBoxGrid {
+public:
+  /** \brief Constructor.
+   *
+   *  \param[in] boxes
+   *    Matrix whose columns contain the bounds (xmin, xmax, ymin, ymax,
+   *    zmin, zmax) of the boxes of consecutive elements. */
+  explicit ElementBoxGrid(const arma::Mat<CoordinateType> &boxes);
+
+  /** \brief Number of boxes. */
+  int boxCount() const { return m_boxes.n_cols; }
+
+  /** \brief Find the boxes containing a point.
+   *
+   *  \param[in] point Pointer to the three coordinates of the point.
+   *  \param[out] elements Indices of the boxes (elements) containing
+   *    \p point, in ascending order. */
+  void findBoxesContaining(const CoordinateType *point,
+                           std::vector<int> &elements) const;
+
+private:
+  /** \cond PRIVATE */
+  bool cellIndex(int dim, CoordinateType coordinate, int &index) const;
+
+  arma::Mat<CoordinateType> m_boxes;
+  CoordinateType m_origin[3];
+  CoordinateType m_cellSize;
+  int m_cellCounts[3];
+  std::vector<int> m_offsets;
+  std::vector<int> m_elements;
+  /** \endcond */
+};
+
+} // namespace Fiber
+
+#endif
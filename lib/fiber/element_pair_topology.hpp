@@ -101,9 +101,16 @@ struct ElementPairTopology {
   }
 };
 
-inline ElementPairTopology determineElementPairTopologyIn3D(
-    const arma::Col<int> &testElementCornerIndices,
-    const arma::Col<int> &trialElementCornerIndices) {
+/** \brief Determine the configuration of a pair of elements from the
+ *  indices of their corners.
+ *
+ *  This overload reads the corner indices from plain arrays and does not
+ *  allocate memory. */
+inline ElementPairTopology
+determineElementPairTopologyIn3D(const int *testElementCornerIndices,
+                                 int testElementCornerCount,
+                                 const int *trialElementCornerIndices,
+                                 int trialElementCornerCount) {
   ElementPairTopology topology;
 
 // Determine number of element corners
@@ -111,10 +118,10 @@ inline ElementPairTopology determineElementPairTopologyIn3D(
   const int MIN_VERTEX_COUNT = 3;
 #endif
   const int MAX_VERTEX_COUNT = 4;
-  topology.testVertexCount = testElementCornerIndices.n_rows;
+  topology.testVertexCount = testElementCornerCount;
   assert(MIN_VERTEX_COUNT <= topology.testVertexCount &&
          topology.testVertexCount <= MAX_VERTEX_COUNT);
-  topology.trialVertexCount = trialElementCornerIndices.n_rows;
+  topology.trialVertexCount = trialElementCornerCount;
   assert(MIN_VERTEX_COUNT <= topology.trialVertexCount &&
          topology.trialVertexCount <= MAX_VERTEX_COUNT);
 
@@ -125,8 +132,8 @@ inline ElementPairTopology determineElementPairTopologyIn3D(
 
   for (int trialV = 0; trialV < topology.trialVertexCount; ++trialV)
     for (int testV = 0; testV < topology.testVertexCount; ++testV)
-      if (testElementCornerIndices(testV) ==
-          trialElementCornerIndices(trialV)) {
+      if (testElementCornerIndices[testV] ==
+          trialElementCornerIndices[trialV]) {
         testSharedVertices[hits] = testV;
         trialSharedVertices[hits] = trialV;
         ++hits;
@@ -163,6 +170,14 @@ inline ElementPairTopology determineElementPairTopologyIn3D(
   return topology;
 }
 
+inline ElementPairTopology determineElementPairTopologyIn3D(
+    const arma::Col<int> &testElementCornerIndices,
+    const arma::Col<int> &trialElementCornerIndices) {
+  return determineElementPairTopologyIn3D(
+      testElementCornerIndices.memptr(), testElementCornerIndices.n_rows,
+      trialElementCornerIndices.memptr(), trialElementCornerIndices.n_rows);
+}
+
 } // namespace Fiber
 
 #endif
@@ -26,6 +26,9 @@
 
 #include "../common/common.hpp"
 
+#include <memory>
+#include <vector>
+
 namespace Fiber {
 
 template <typename ResultType> class EvaluatorForIntegralOperators {
@@ -39,8 +42,60 @@ public:
 
   virtual ~EvaluatorForIntegralOperators() {}
 
+  /** \brief Evaluate the potential at \p points.
+   *
+   *  If \p region is FAR_FIELD, the points are assumed to lie far from the
+   *  surface and the potential is evaluated with the far-field quadrature
+   *  rules. If it is NEAR_FIELD, the contributions of elements lying close to
+   *  individual points are integrated more accurately. */
   virtual void evaluate(Region region, const arma::Mat<CoordinateType> &points,
                         arma::Mat<ResultType> &result) const = 0;
+
+  /** \brief Add near-field corrections to a potential evaluated in the far
+   *  field.
+   *
+   *  Add to \p result, containing the potential evaluated at \p points in
+   *  the FAR_FIELD region, the difference between the contributions of the
+   *  elements close to \p points integrated accurately and with far-field
+   *  quadrature rules.
+   *
+   *  The default implementation does nothing. */
+  virtual void addNearFieldCorrections(const arma::Mat<CoordinateType> &points,
+                                       arma::Mat<ResultType> &result) const {}
+
+  /** \brief Get the positions of the sources of the potential.
+   *
+   *  The potential is evaluated as a sum of contributions of sources located
+   *  at the quadrature points of the trial elements. This function stores
+   *  the coordinates of these points in the columns of \p points.
+   *
+   *  The default implementation returns an empty matrix, meaning that the
+   *  positions of the sources are unknown. */
+  virtual void getSourcePoints(Region region,
+                               arma::Mat<CoordinateType> &points) const {
+    points.reset();
+  }
+
+  /** \brief Return an evaluator of the potential generated by a subset of
+   *  the sources.
+   *
+   *  \param[in] region Region whose sources should be used.
+   *  \param[in] sourceIndices Indices of the sources to keep, i.e. of
+   *    columns of the matrix returned by getSourcePoints().
+   *
+   *  The returned evaluator evaluates the contribution of the selected
+   *  sources in both regions without near-field corrections; these can be
+   *  added afterwards with addNearFieldCorrections() of the original
+   *  evaluator. This is used by evaluators treating clusters of sources
+   *  separately, such as the treecode.
+   *
+   *  The default implementation returns a null pointer, meaning that the
+   *  operation is not supported. */
+  virtual std::unique_ptr<EvaluatorForIntegralOperators<ResultType>>
+  restrictToSources(Region region,
+                    const std::vector<size_t> &sourceIndices) const {
+    return std::unique_ptr<EvaluatorForIntegralOperators<ResultType>>();
+  }
 };
 
 } // namespace Fiber
@@ -26,6 +26,8 @@
 #include "scalar_traits.hpp"
 
 #include "../common/armadillo_fwd.hpp"
+#include <stdexcept>
+#include <vector>
 
 namespace Fiber {
 
@@ -86,6 +88,45 @@ public:
    */
   virtual void evaluate(const GeometricalData<CoordinateType> &geomData,
                         arma::Mat<ValueType> &result) const = 0;
+
+  /** \brief Return true if evaluate() may be called concurrently from
+   *  several threads.
+   *
+   *  The default implementation returns true. Functions that are not
+   *  reentrant, e.g. those calling an interpreter that must not be entered
+   *  from several threads at once, should override it to return false;
+   *  they are then always evaluated on a single thread. */
+  virtual bool isThreadSafe() const { return true; }
+
+  /** \brief Return true if the function implements evaluateBatch().
+   *
+   *  The default implementation returns false. Functions with a high cost
+   *  per call, e.g. those calling an interpreter, should implement
+   *  evaluateBatch() and override this method to return true; integrators
+   *  then evaluate them once for the points of many elements. */
+  virtual bool isBatchEvaluationSupported() const { return false; }
+
+  /** \brief Evaluate the function at points lying on several elements.
+   *
+   *  \param[in] geomData
+   *    Geometrical data related to the points of all elements, concatenated
+   *    element by element. Only the global coordinates and the normals are
+   *    set, if requested by addGeometricalDependencies();
+   *    <tt>geomData.domainIndex</tt> is unused.
+   *  \param[in] domainIndices
+   *    Domain index of the element containing each point.
+   *  \param[out] result
+   *    On output, <tt>result(i, j)</tt> should contain the <em>i</em>th
+   *    component of the function at the <em>j</em>th point.
+   *
+   *  Only called if isBatchEvaluationSupported() returns true. The default
+   *  implementation throws std::runtime_error. */
+  virtual void evaluateBatch(const GeometricalData<CoordinateType> &geomData,
+                             const std::vector<int> &domainIndices,
+                             arma::Mat<ValueType> &result) const {
+    throw std::runtime_error("Function::evaluateBatch(): "
+                             "batch evaluation is not supported");
+  }
 };
 
 } // namespace Fiber
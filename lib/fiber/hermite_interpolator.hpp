@@ -4,17 +4,24 @@
 #include "../common/common.hpp"
 #include "scalar_traits.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 #include <vector>
 
 namespace Fiber {
 
+/** \brief Piecewise cubic Hermite interpolation on a uniform grid.
+ *
+ *  The values and the derivatives (premultiplied by the grid spacing) are
+ *  stored interleaved in a single table, so that the four numbers needed to
+ *  interpolate in one interval are adjacent in memory. */
 template <typename ValueType> class HermiteInterpolator {
 public:
   typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
 
-  HermiteInterpolator() : m_start(0.), m_end(0.), m_n(0), m_interval(0.) {}
+  HermiteInterpolator()
+      : m_start(0.), m_end(0.), m_n(0), m_interval(0.), m_invInterval(0.) {}
 
   CoordinateType rangeStart() { return m_start; }
   CoordinateType rangeEnd() { return m_end; }
@@ -36,22 +43,42 @@ public:
     m_end = end;
     m_n = values.size();
     m_interval = (end - start) / (m_n - 1);
-    m_values = values;
-    m_derivatives = derivatives;
+    m_invInterval = (m_n - 1) / (end - start);
+    m_table.resize(2 * m_n);
+    for (int i = 0; i < m_n; ++i) {
+      m_table[2 * i] = values[i];
+      m_table[2 * i + 1] = derivatives[i] * m_interval;
+    }
   }
 
   ValueType evaluate(CoordinateType x) const {
     assert(x >= m_start && x <= m_end);
-    CoordinateType fpn;
-    const CoordinateType t = std::modf((x - m_start) / m_interval, &fpn);
-    const int n = int(fpn);
-    assert(n >= 0 && n < m_n);
+    return evaluateScaled((x - m_start) * m_invInterval);
+  }
+
+  /** \brief Evaluate the interpolant at the \p count points \p x, storing
+   *  the results in \p result. */
+  void evaluate(const CoordinateType *x, ValueType *result, int count) const {
+    const CoordinateType start = m_start, invInterval = m_invInterval;
+    for (int i = 0; i < count; ++i) {
+      assert(x[i] >= m_start && x[i] <= m_end);
+      result[i] = evaluateScaled((x[i] - start) * invInterval);
+    }
+  }
+
+private:
+  ValueType evaluateScaled(CoordinateType s) const {
+    // The last interval is closed, so that m_end can be evaluated too
+    const int n = std::min(static_cast<int>(s), m_n - 2);
+    const CoordinateType t = s - n;
+    assert(n >= 0);
     assert(t >= 0 && t <= 1);
     // Adapted from the chfev routine from SLATEC
-    const ValueType f_1 = m_values[n];
-    const ValueType f_2 = m_values[n + 1];
-    const ValueType d_1 = m_derivatives[n] * m_interval;
-    const ValueType d_2 = m_derivatives[n + 1] * m_interval;
+    const ValueType *entry = &m_table[2 * n];
+    const ValueType f_1 = entry[0];
+    const ValueType d_1 = entry[1];
+    const ValueType f_2 = entry[2];
+    const ValueType d_2 = entry[3];
     const ValueType Delta = f_2 - f_1;
     const ValueType Delta_1 = d_1 - Delta;
     const ValueType Delta_2 = d_2 - Delta;
@@ -60,13 +87,12 @@ public:
     return f_1 + t * (d_1 + t * (c_2 + t * c_3));
   }
 
-private:
   /** \cond PRIVATE */
   CoordinateType m_start, m_end;
   int m_n;
-  CoordinateType m_interval;
-  std::vector<ValueType> m_values;
-  std::vector<ValueType> m_derivatives;
+  CoordinateType m_interval, m_invInterval;
+  // f_0, h f'_0, f_1, h f'_1, ..., where h = m_interval
+  std::vector<ValueType> m_table;
   /** \endcond */
 };
 
@@ -30,8 +30,11 @@ void initializeInterpolatorForModifiedHelmholtz3dKernels(
   typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
   const CoordinateType minDist = 0.;
   const CoordinateType wavelength = 2. * M_PI / std::abs(waveNumber);
-  const int pointCount =
-      (maxDist - minDist) / wavelength * interpPtsPerWavelength + 1;
+  if (interpPtsPerWavelength <= 0)
+    interpPtsPerWavelength =
+        modifiedHelmholtz3dInterpolationDensity(CoordinateType(0.));
+  const int pointCount = std::max(
+      2, int((maxDist - minDist) / wavelength * interpPtsPerWavelength + 1));
   std::vector<ValueType> values(pointCount), derivatives(pointCount);
   for (int i = 0; i < pointCount; ++i) {
     CoordinateType dist =
@@ -4,8 +4,36 @@
 #include "../common/common.hpp"
 #include "hermite_interpolator.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace Fiber {
 
+/** \brief Return the number of interpolation points per wavelength needed to
+ *  approximate exp(-k r) by piecewise cubic Hermite interpolation with a
+ *  given relative accuracy.
+ *
+ *  The interpolation error on an interval of length h is bounded by
+ *  h^4 |k|^4 / 384 relative to the function value, so the density does not
+ *  depend on k when measured per wavelength 2 pi / |k|. \p relativeAccuracy
+ *  is clamped to 100 times the machine epsilon of \p CoordinateType; a
+ *  nonpositive value requests that accuracy. */
+template <typename CoordinateType>
+int modifiedHelmholtz3dInterpolationDensity(CoordinateType relativeAccuracy) {
+  const CoordinateType minAccuracy =
+      100 * std::numeric_limits<CoordinateType>::epsilon();
+  relativeAccuracy = std::max(relativeAccuracy, minAccuracy);
+  const CoordinateType stepTimesWaveNumber =
+      std::pow(384 * relativeAccuracy, CoordinateType(0.25));
+  return static_cast<int>(std::ceil(2. * M_PI / stepTimesWaveNumber));
+}
+
+/** \brief Tabulate exp(-k r) and its derivative for 0 <= r <= \p maxDist.
+ *
+ *  If \p interpPtsPerWavelength is not positive, the density is chosen by
+ *  modifiedHelmholtz3dInterpolationDensity() for the best accuracy attainable
+ *  in the working precision. */
 template <typename ValueType>
 void initializeInterpolatorForModifiedHelmholtz3dKernels(
     ValueType waveNumber, typename ScalarTraits<ValueType>::RealType maxDist,
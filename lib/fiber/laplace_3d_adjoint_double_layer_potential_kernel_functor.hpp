@@ -23,6 +23,8 @@
 
 #include "../common/common.hpp"
 
+#include "batched_kernel_evaluation.hpp"
+#include "collection_of_4d_arrays.hpp"
 #include "geometrical_data.hpp"
 #include "scalar_traits.hpp"
 
@@ -75,6 +77,27 @@ public:
     result[0](0, 0) = -numeratorSum / (static_cast<CoordinateType>(4. * M_PI) *
                                        distanceSq * distance);
   }
+
+  /** \brief Evaluate the kernel on the tensor product of the test and trial
+   *  points, processing the test points in vectorisable batches. */
+  void evaluateOnGrid(const GeometricalData<CoordinateType> &testGeomData,
+                      const GeometricalData<CoordinateType> &trialGeomData,
+                      CollectionOf4dArrays<ValueType> &result) const {
+    const CoordinateType factor = static_cast<CoordinateType>(1. / (4. * M_PI));
+    result.set_size(1);
+    evaluateScalarKernelOnGridInBatches(
+        testGeomData, trialGeomData, result[0],
+        [factor](const KernelBatch<CoordinateType> &batch, ValueType *values) {
+          for (int i = 0; i < batch.size; ++i) {
+            const CoordinateType numerator =
+                batch.diff[0][i] * batch.testNormal[0][i] +
+                batch.diff[1][i] * batch.testNormal[1][i] +
+                batch.diff[2][i] * batch.testNormal[2][i];
+            const CoordinateType distance = batch.distance[i];
+            values[i] = -factor * numerator / (distance * distance * distance);
+          }
+        });
+  }
 };
 
 } // namespace Fiber
@@ -23,6 +23,8 @@
 
 #include "../common/common.hpp"
 
+#include "batched_kernel_evaluation.hpp"
+#include "collection_of_4d_arrays.hpp"
 #include "geometrical_data.hpp"
 #include "scalar_traits.hpp"
 
@@ -71,6 +73,21 @@ public:
     }
     result[0](0, 0) = static_cast<CoordinateType>(1. / (4. * M_PI)) / sqrt(sum);
   }
+
+  /** \brief Evaluate the kernel on the tensor product of the test and trial
+   *  points, processing the test points in vectorisable batches. */
+  void evaluateOnGrid(const GeometricalData<CoordinateType> &testGeomData,
+                      const GeometricalData<CoordinateType> &trialGeomData,
+                      CollectionOf4dArrays<ValueType> &result) const {
+    const CoordinateType factor = static_cast<CoordinateType>(1. / (4. * M_PI));
+    result.set_size(1);
+    evaluateScalarKernelOnGridInBatches(
+        testGeomData, trialGeomData, result[0],
+        [factor](const KernelBatch<CoordinateType> &batch, ValueType *values) {
+          for (int i = 0; i < batch.size; ++i)
+            values[i] = factor / batch.distance[i];
+        });
+  }
 };
 
 } // namespace Fiber
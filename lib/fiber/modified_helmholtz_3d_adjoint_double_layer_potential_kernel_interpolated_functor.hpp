@@ -23,6 +23,8 @@
 
 #include "../common/common.hpp"
 
+#include "batched_kernel_evaluation.hpp"
+#include "collection_of_4d_arrays.hpp"
 #include "geometrical_data.hpp"
 #include "hermite_interpolator.hpp"
 #include "initialize_interpolator_for_modified_helmholtz_3d_kernels.hpp"
@@ -94,6 +96,35 @@ public:
         (m_waveNumber * dist + static_cast<CoordinateType>(1.0)) * v;
   }
 
+  /** \brief Evaluate the kernel on the tensor product of the test and trial
+   *  points, processing the test points in batches. */
+  void evaluateOnGrid(const GeometricalData<CoordinateType> &testGeomData,
+                      const GeometricalData<CoordinateType> &trialGeomData,
+                      CollectionOf4dArrays<ValueType> &result) const {
+    result.set_size(1);
+    evaluateScalarKernelOnGridInBatches(
+        testGeomData, trialGeomData, result[0],
+        [this](const KernelBatch<CoordinateType> &batch, ValueType *values) {
+          evaluateBatch(batch, values);
+        });
+  }
+
+  /** \brief Evaluate the kernel at the point pairs of \p batch. */
+  void evaluateBatch(const KernelBatch<CoordinateType> &batch,
+                     ValueType *values) const {
+    m_interpolator.evaluate(batch.distance, values, batch.size);
+    const CoordinateType factor = static_cast<CoordinateType>(1. / (4. * M_PI));
+    for (int i = 0; i < batch.size; ++i) {
+      const CoordinateType numerator =
+          batch.diff[0][i] * batch.testNormal[0][i] +
+          batch.diff[1][i] * batch.testNormal[1][i] +
+          batch.diff[2][i] * batch.testNormal[2][i];
+      const CoordinateType dist = batch.distance[i];
+      values[i] *= -factor * numerator / (dist * dist * dist) *
+                   (m_waveNumber * dist + static_cast<CoordinateType>(1.));
+    }
+  }
+
   CoordinateType estimateRelativeScale(CoordinateType distance) const {
     // This function is called rarely, invoking exp() here does little harm.
     return exp(-realPart(m_waveNumber) * distance);
@@ -23,6 +23,8 @@
 
 #include "../common/common.hpp"
 
+#include "batched_kernel_evaluation.hpp"
+#include "collection_of_4d_arrays.hpp"
 #include "geometrical_data.hpp"
 #include "scalar_traits.hpp"
 
@@ -86,6 +88,33 @@ public:
         exp(-m_waveNumber * distance);
   }
 
+  /** \brief Evaluate the kernel on the tensor product of the test and trial
+   *  points, processing the test points in vectorisable batches. */
+  void evaluateOnGrid(const GeometricalData<CoordinateType> &testGeomData,
+                      const GeometricalData<CoordinateType> &trialGeomData,
+                      CollectionOf4dArrays<ValueType> &result) const {
+    const CoordinateType factor = static_cast<CoordinateType>(1. / (4. * M_PI));
+    const ValueType waveNumber = m_waveNumber;
+    result.set_size(1);
+    evaluateScalarKernelOnGridInBatches(
+        testGeomData, trialGeomData, result[0],
+        [factor, waveNumber](const KernelBatch<CoordinateType> &batch,
+                             ValueType *values) {
+          evaluateExponentialDecayInBatch(waveNumber, batch.distance, values,
+                                          batch.size);
+          for (int i = 0; i < batch.size; ++i) {
+            const CoordinateType numerator =
+                batch.diff[0][i] * batch.trialNormal[0] +
+                batch.diff[1][i] * batch.trialNormal[1] +
+                batch.diff[2][i] * batch.trialNormal[2];
+            const CoordinateType distance = batch.distance[i];
+            values[i] *= factor * numerator / (distance * distance) *
+                         (waveNumber +
+                          static_cast<CoordinateType>(1.) / distance);
+          }
+        });
+  }
+
   CoordinateType estimateRelativeScale(CoordinateType distance) const {
     return exp(-realPart(m_waveNumber) * distance);
   }
@@ -23,11 +23,14 @@
 
 #include "../common/common.hpp"
 
+#include "collection_of_4d_arrays.hpp"
 #include "geometrical_data.hpp"
 #include "scalar_traits.hpp"
 
 #include "modified_helmholtz_3d_single_layer_potential_kernel_interpolated_functor.hpp"
 
+#include <algorithm>
+
 namespace Fiber {
 
 /** \ingroup modified_helmholtz_3d
@@ -79,6 +82,23 @@ public:
         result[0](0, 0) * m_slpKernel.waveNumber() * m_slpKernel.waveNumber();
   }
 
+  void evaluateOnGrid(const GeometricalData<CoordinateType> &testGeomData,
+                      const GeometricalData<CoordinateType> &trialGeomData,
+                      CollectionOf4dArrays<ValueType> &result) const {
+    result.set_size(2);
+    evaluateScalarKernelOnGridInBatches(
+        testGeomData, trialGeomData, result[0],
+        [this](const KernelBatch<CoordinateType> &batch, ValueType *values) {
+          m_slpKernel.evaluateBatch(batch, values);
+        });
+    const ValueType waveNumberSq =
+        m_slpKernel.waveNumber() * m_slpKernel.waveNumber();
+    result[1].set_size(result[0].extent(0), result[0].extent(1),
+                       result[0].extent(2), result[0].extent(3));
+    std::transform(result[0].begin(), result[0].end(), result[1].begin(),
+                   [waveNumberSq](ValueType v) { return v * waveNumberSq; });
+  }
+
   CoordinateType estimateRelativeScale(CoordinateType distance) const {
     return m_slpKernel.estimateRelativeScale(distance);
   }
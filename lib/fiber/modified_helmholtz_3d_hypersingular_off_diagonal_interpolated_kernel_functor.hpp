@@ -23,6 +23,8 @@
 
 #include "../common/common.hpp"
 
+#include "batched_kernel_evaluation.hpp"
+#include "collection_of_4d_arrays.hpp"
 #include "geometrical_data.hpp"
 #include "hermite_interpolator.hpp"
 #include "initialize_interpolator_for_modified_helmholtz_3d_kernels.hpp"
@@ -105,6 +107,41 @@ public:
         v;
   }
 
+  /** \brief Evaluate the kernel on the tensor product of the test and trial
+   *  points, processing the test points in batches. */
+  void evaluateOnGrid(const GeometricalData<CoordinateType> &testGeomData,
+                      const GeometricalData<CoordinateType> &trialGeomData,
+                      CollectionOf4dArrays<ValueType> &result) const {
+    result.set_size(1);
+    evaluateScalarKernelOnGridInBatches(
+        testGeomData, trialGeomData, result[0],
+        [this](const KernelBatch<CoordinateType> &batch, ValueType *values) {
+          evaluateBatch(batch, values);
+        });
+  }
+
+  /** \brief Evaluate the kernel at the point pairs of \p batch. */
+  void evaluateBatch(const KernelBatch<CoordinateType> &batch,
+                     ValueType *values) const {
+    m_interpolator.evaluate(batch.distance, values, batch.size);
+    const CoordinateType factor = static_cast<CoordinateType>(1. / (4. * M_PI));
+    const CoordinateType ONE = 1., THREE = 3.;
+    for (int i = 0; i < batch.size; ++i) {
+      CoordinateType nTest_diff = 0., nTrial_diff = 0., nTest_nTrial = 0.;
+      for (int c = 0; c < 3; ++c) {
+        nTest_diff += batch.diff[c][i] * batch.testNormal[c][i];
+        nTrial_diff += batch.diff[c][i] * batch.trialNormal[c];
+        nTest_nTrial += batch.testNormal[c][i] * batch.trialNormal[c];
+      }
+      const CoordinateType distance = batch.distance[i];
+      const CoordinateType distanceSq = distance * distance;
+      const ValueType kr = m_waveNumber * distance;
+      values[i] *= factor / (distance * distanceSq * distanceSq) *
+                   (-distanceSq * nTest_nTrial * (ONE + kr) +
+                    nTest_diff * nTrial_diff * (THREE + THREE * kr + kr * kr));
+    }
+  }
+
   CoordinateType estimateRelativeScale(CoordinateType distance) const {
     return exp(-realPart(m_waveNumber) * distance);
   }
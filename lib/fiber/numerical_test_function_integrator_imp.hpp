@@ -32,8 +32,10 @@
 #include "raw_grid_geometry.hpp"
 #include "types.hpp"
 
-#include <stdexcept>
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
+#include <vector>
 
 namespace Fiber {
 
@@ -76,10 +78,14 @@ void NumericalTestFunctionIntegrator<
   const size_t pointCount = m_localQuadPoints.n_cols;
   const size_t elementCount = elementIndices.size();
 
-  if (pointCount == 0 || elementCount == 0)
+  if (elementCount == 0)
     return;
-  // TODO: in the (pathological) case that pointCount == 0 but
-  // elementCount != 0, set elements of result to 0.
+  // Integrals over no quadrature points vanish. This also keeps the column
+  // ranges of the points of each element below from being empty.
+  if (pointCount == 0) {
+    result.zeros(testShapeset.size(), elementCount);
+    return;
+  }
 
   // Evaluate constants
   const int componentCount = m_testTransformations.resultDimension(0);
@@ -110,21 +116,64 @@ void NumericalTestFunctionIntegrator<
   testShapeset.evaluate(testBasisDeps, m_localQuadPoints, ALL_DOFS,
                         testBasisData);
 
+  // Functions that support it are evaluated once for the points of all
+  // elements. The geometrical data of each element are then kept for the
+  // integration below rather than computed again.
+  const bool batch = m_function.isBatchEvaluationSupported();
+  std::vector<GeometricalData<CoordinateType>> elementGeomData;
+  arma::Mat<UserFunctionType> batchFunctionValues;
+  if (batch) {
+    const int worldDim = m_rawGeometry.worldDimension();
+    GeometricalData<CoordinateType> batchGeomData;
+    if (geomDeps & GLOBALS)
+      batchGeomData.globals.set_size(worldDim, pointCount * elementCount);
+    if (geomDeps & NORMALS)
+      batchGeomData.normals.set_size(worldDim, pointCount * elementCount);
+    std::vector<int> domainIndices(pointCount * elementCount);
+    elementGeomData.resize(elementCount);
+    for (size_t e = 0; e < elementCount; ++e) {
+      const int elementIndex = elementIndices[e];
+      const int domainIndex = m_rawGeometry.domainIndex(elementIndex);
+      GeometricalData<CoordinateType> &data = elementGeomData[e];
+      m_rawGeometry.setupGeometry(elementIndex, *geometry);
+      geometry->getData(geomDeps, m_localQuadPoints, data);
+      if (geomDeps & DOMAIN_INDEX)
+        data.domainIndex = domainIndex;
+
+      const size_t first = e * pointCount, last = first + pointCount - 1;
+      if (geomDeps & GLOBALS)
+        batchGeomData.globals.cols(first, last) = data.globals;
+      if (geomDeps & NORMALS)
+        batchGeomData.normals.cols(first, last) = data.normals;
+      std::fill(domainIndices.begin() + first, domainIndices.begin() + last + 1,
+                domainIndex);
+    }
+    m_function.evaluateBatch(batchGeomData, domainIndices,
+                             batchFunctionValues);
+  }
+
   // Iterate over the elements
   for (size_t e = 0; e < elementCount; ++e) {
-    const int elementIndex = elementIndices[e];
-    m_rawGeometry.setupGeometry(elementIndex, *geometry);
-    geometry->getData(geomDeps, m_localQuadPoints, geomData);
-    if (geomDeps & DOMAIN_INDEX)
-      geomData.domainIndex = m_rawGeometry.domainIndex(elementIndex);
-    m_testTransformations.evaluate(testBasisData, geomData, testValues);
-    m_function.evaluate(geomData, functionValues);
+    const GeometricalData<CoordinateType> *data = &geomData;
+    if (batch) {
+      data = &elementGeomData[e];
+      functionValues = batchFunctionValues.cols(e * pointCount,
+                                                (e + 1) * pointCount - 1);
+    } else {
+      const int elementIndex = elementIndices[e];
+      m_rawGeometry.setupGeometry(elementIndex, *geometry);
+      geometry->getData(geomDeps, m_localQuadPoints, geomData);
+      if (geomDeps & DOMAIN_INDEX)
+        geomData.domainIndex = m_rawGeometry.domainIndex(elementIndex);
+      m_function.evaluate(geomData, functionValues);
+    }
+    m_testTransformations.evaluate(testBasisData, *data, testValues);
 
     for (int testDof = 0; testDof < testDofCount; ++testDof) {
       ResultType sum = 0.;
       for (size_t point = 0; point < pointCount; ++point)
         for (int dim = 0; dim < componentCount; ++dim)
-          sum += m_quadWeights[point] * geomData.integrationElements(point) *
+          sum += m_quadWeights[point] * data->integrationElements(point) *
                  conjugate(testValues[0](dim, testDof, point)) *
                  functionValues(dim, point);
       result(testDof, e) = sum;
@@ -53,6 +53,16 @@ public:
   virtual DoubleQuadratureDescriptor
   quadratureDescriptor(int testElementIndex, int trialElementIndex,
                        CoordinateType nominalDistance) const = 0;
+
+  /** \brief Return true if singular integrals over pairs of adjacent
+   *  elements related by a proper rigid motion may be calculated only once.
+   *
+   *  The default implementation returns false. Selectors returning true
+   *  must choose the same quadrature rule for all congruent element pairs
+   *  with the same shapesets. */
+  virtual bool singularIntegralsOfCongruentPairsAreEqual() const {
+    return false;
+  }
 };
 
 } // namespace Fiber
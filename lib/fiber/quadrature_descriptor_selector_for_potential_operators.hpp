@@ -75,6 +75,21 @@ public:
   virtual SingleQuadratureDescriptor
   farFieldQuadratureDescriptor(const Shapeset<BasisFunctionType> &trialShapeset,
                                int trialElementCornerCount) const = 0;
+
+  /** \brief Return the radius of the near field of element \p
+   *  trialElementIndex.
+   *
+   *  quadratureDescriptor() should return the same descriptor as
+   *  farFieldQuadratureDescriptor() for all points lying farther than this
+   *  distance from the center of the element. Evaluators of potentials use
+   *  this to find the elements whose contributions need to be integrated
+   *  more accurately.
+   *
+   *  The default implementation returns zero, i.e. all points are treated
+   *  as lying in the far field. */
+  virtual CoordinateType nearFieldDistance(int trialElementIndex) const {
+    return 0.;
+  }
 };
 
 } // namespace Fiber
@@ -25,6 +25,8 @@
 
 #include "../common/armadillo_fwd.hpp"
 
+#include <cmath>
+
 namespace Fiber {
 
 template <typename CoordinateType> class RawGridGeometry {
@@ -75,6 +77,39 @@ public:
     return m_domainIndices[elementIndex];
   }
 
+  /** \brief True if computeAffineElementData() has stored the Jacobians,
+   *  integration elements and normals of the elements. */
+  bool hasAffineElementData() const {
+    return elementCount() > 0 &&
+           m_elementIntegrationElements.n_elem == size_t(elementCount());
+  }
+
+  /** \brief Transposed Jacobians of the elements.
+
+    Column \p e contains the transposed Jacobian of element \p e stored in
+    column-major order, i.e. its (\p i + \p gridDim * \p j)th entry is the
+    derivative of the \p j'th global coordinate with respect to the \p i'th
+    local coordinate. Empty unless hasAffineElementData() is true. */
+  const arma::Mat<CoordinateType> &elementJacobiansTransposed() const {
+    return m_elementJacobiansTransposed;
+  }
+
+  /** \brief Integration elements (ratios of global to reference element
+   *  measures) of the elements. Empty unless hasAffineElementData() is
+   *  true. */
+  const arma::Row<CoordinateType> &elementIntegrationElements() const {
+    return m_elementIntegrationElements;
+  }
+
+  /** \brief Unit normals of the elements.
+
+    Column \p e contains the normal of element \p e, oriented as in
+    Geometry::getNormals(). Empty unless hasAffineElementData() is true and
+    the grid dimension is one less than the world dimension. */
+  const arma::Mat<CoordinateType> &elementNormals() const {
+    return m_elementNormals;
+  }
+
   // Non-const accessors (currently needed for construction)
 
   arma::Mat<CoordinateType> &vertices() { return m_vertices; }
@@ -85,6 +120,69 @@ public:
 
   std::vector<int> &domainIndices() { return m_domainIndices; }
 
+  /** \brief Compute the Jacobians, integration elements and normals of all
+    elements.
+
+    These quantities are constant on each element only if the element is a
+    simplex with straight edges. If any element has more than
+    gridDimension() + 1 corners or carries auxiliary data, nothing is stored
+    and hasAffineElementData() remains false. */
+  void computeAffineElementData() {
+    m_elementJacobiansTransposed.reset();
+    m_elementIntegrationElements.reset();
+    m_elementNormals.reset();
+
+    const int elementCount = this->elementCount();
+    if (elementCount == 0 || m_auxData.n_rows > 0)
+      return;
+    for (int e = 0; e < elementCount; ++e)
+      if (elementCornerCount(e) != m_gridDim + 1)
+        return;
+
+    arma::Mat<CoordinateType> jacobians(m_gridDim * m_worldDim, elementCount);
+    arma::Row<CoordinateType> integrationElements(elementCount);
+    arma::Mat<CoordinateType> normals;
+    const bool hasNormals = m_gridDim == m_worldDim - 1;
+    if (hasNormals)
+      normals.set_size(m_worldDim, elementCount);
+
+    for (int e = 0; e < elementCount; ++e) {
+      const int origin = m_elementCornerIndices(0, e);
+      CoordinateType *jt = jacobians.colptr(e);
+      for (int i = 0; i < m_gridDim; ++i) {
+        const int corner = m_elementCornerIndices(i + 1, e);
+        for (int j = 0; j < m_worldDim; ++j)
+          jt[i + m_gridDim * j] = m_vertices(j, corner) - m_vertices(j, origin);
+      }
+
+      // sqrt(det(jt * jt^T)); the normal formulas follow
+      // ConcreteGeometry::calculateNormals()
+      CoordinateType n[3] = {0., 0., 0.};
+      CoordinateType integrationElement;
+      if (m_gridDim == 2 && m_worldDim == 3) {
+        n[0] = jt[2] * jt[5] - jt[4] * jt[3];
+        n[1] = jt[4] * jt[1] - jt[0] * jt[5];
+        n[2] = jt[0] * jt[3] - jt[2] * jt[1];
+        integrationElement = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      } else if (m_gridDim == 1 && m_worldDim == 2) {
+        n[0] = jt[1];
+        n[1] = jt[0];
+        integrationElement = std::sqrt(n[0] * n[0] + n[1] * n[1]);
+      } else {
+        arma::Mat<CoordinateType> jtMat(jt, m_gridDim, m_worldDim, false);
+        integrationElement = std::sqrt(arma::det(jtMat * jtMat.t()));
+      }
+      integrationElements(e) = integrationElement;
+      if (hasNormals)
+        for (int j = 0; j < m_worldDim; ++j)
+          normals(j, e) = m_worldDim == 1 ? 1. : n[j] / integrationElement;
+    }
+
+    m_elementJacobiansTransposed.swap(jacobians);
+    m_elementIntegrationElements.swap(integrationElements);
+    m_elementNormals.swap(normals);
+  }
+
   // Auxiliary functions
 
   template <typename Geometry>
@@ -108,6 +206,9 @@ private:
   arma::Mat<int> m_elementCornerIndices;
   arma::Mat<char> m_auxData;
   std::vector<int> m_domainIndices;
+  arma::Mat<CoordinateType> m_elementJacobiansTransposed;
+  arma::Row<CoordinateType> m_elementIntegrationElements;
+  arma::Mat<CoordinateType> m_elementNormals;
 };
 
 } // namespace Fiber
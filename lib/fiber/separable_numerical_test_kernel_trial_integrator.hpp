@@ -26,7 +26,12 @@
 #include "bempp/common/config_opencl.hpp"
 
 #include "test_kernel_trial_integrator.hpp"
+#include "basis_data.hpp"
+#include "collection_of_3d_arrays.hpp"
+#include "collection_of_4d_arrays.hpp"
+#include "geometrical_data.hpp"
 
+#include <memory>
 #include <tbb/enumerable_thread_specific.h>
 
 namespace Fiber {
@@ -86,6 +91,22 @@ public:
             const std::vector<arma::Mat<ResultType> *> &result) const;
 
 private:
+  typedef typename GeometryFactory::Geometry Geometry;
+
+  /** \brief Work arrays of integrateCpu().
+   *
+   *  Each thread keeps its own instance between calls, so that the arrays
+   *  only need to be reallocated when their sizes change. */
+  struct Scratch {
+    BasisData<BasisFunctionType> testBasisData, trialBasisData;
+    GeometricalData<CoordinateType> testGeomData, trialGeomData;
+    CollectionOf3dArrays<BasisFunctionType> testValues, trialValues;
+    CollectionOf4dArrays<KernelType> kernelValues;
+    std::unique_ptr<Geometry> testGeometry, trialGeometry;
+  };
+
+  Scratch &scratch() const;
+
   void integrateCpu(CallVariant callVariant,
                     const std::vector<int> &elementIndicesA, int elementIndexB,
                     const Shapeset<BasisFunctionType> &basisA,
@@ -146,8 +167,7 @@ private:
 
   std::vector<GeometricalData<CoordinateType>> m_cachedTestGeomData;
   std::vector<GeometricalData<CoordinateType>> m_cachedTrialGeomData;
-  mutable tbb::enumerable_thread_specific<GeometricalData<CoordinateType>>
-  m_testGeomData, m_trialGeomData;
+  mutable tbb::enumerable_thread_specific<Scratch> m_scratch;
 
 #ifdef WITH_OPENCL
   cl::Buffer *clTestQuadPoints;
@@ -164,6 +164,21 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
   }
 }
 
+template <typename BasisFunctionType, typename KernelType, typename ResultType,
+          typename GeometryFactory>
+typename SeparableNumericalTestKernelTrialIntegrator<
+    BasisFunctionType, KernelType, ResultType, GeometryFactory>::Scratch &
+SeparableNumericalTestKernelTrialIntegrator<
+    BasisFunctionType, KernelType, ResultType, GeometryFactory>::scratch()
+    const {
+  Scratch &result = m_scratch.local();
+  if (!m_cacheGeometricalData && !result.testGeometry) {
+    result.testGeometry = m_testGeometryFactory.make();
+    result.trialGeometry = m_trialGeometryFactory.make();
+  }
+  return result;
+}
+
 template <typename BasisFunctionType, typename KernelType, typename ResultType,
           typename GeometryFactory>
 void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
@@ -213,9 +228,11 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
   const int testDofCount = callVariant == TEST_TRIAL ? dofCountA : dofCountB;
   const int trialDofCount = callVariant == TEST_TRIAL ? dofCountB : dofCountA;
 
-  BasisData<BasisFunctionType> testBasisData, trialBasisData;
-  GeometricalData<CoordinateType> *testGeomData = &m_testGeomData.local();
-  GeometricalData<CoordinateType> *trialGeomData = &m_trialGeomData.local();
+  Scratch &work = scratch();
+  BasisData<BasisFunctionType> &testBasisData = work.testBasisData;
+  BasisData<BasisFunctionType> &trialBasisData = work.trialBasisData;
+  GeometricalData<CoordinateType> *testGeomData = &work.testGeomData;
+  GeometricalData<CoordinateType> *trialGeomData = &work.trialGeomData;
   const GeometricalData<CoordinateType> *constTestGeomData = testGeomData;
   const GeometricalData<CoordinateType> *constTrialGeomData = trialGeomData;
 
@@ -227,25 +244,25 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
   m_kernels.addGeometricalDependencies(testGeomDeps, trialGeomDeps);
   m_integral.addGeometricalDependencies(testGeomDeps, trialGeomDeps);
 
-  typedef typename GeometryFactory::Geometry Geometry;
-  std::unique_ptr<Geometry> geometryA, geometryB;
+  Geometry *geometryA = 0, *geometryB = 0;
   const RawGridGeometry<CoordinateType> *rawGeometryA = 0, *rawGeometryB = 0;
   if (!m_cacheGeometricalData) {
     if (callVariant == TEST_TRIAL) {
-      geometryA = m_testGeometryFactory.make();
-      geometryB = m_trialGeometryFactory.make();
+      geometryA = work.testGeometry.get();
+      geometryB = work.trialGeometry.get();
       rawGeometryA = &m_testRawGeometry;
       rawGeometryB = &m_trialRawGeometry;
     } else {
-      geometryA = m_trialGeometryFactory.make();
-      geometryB = m_testGeometryFactory.make();
+      geometryA = work.trialGeometry.get();
+      geometryB = work.testGeometry.get();
       rawGeometryA = &m_trialRawGeometry;
       rawGeometryB = &m_testRawGeometry;
     }
   }
 
-  CollectionOf3dArrays<BasisFunctionType> testValues, trialValues;
-  CollectionOf4dArrays<KernelType> kernelValues;
+  CollectionOf3dArrays<BasisFunctionType> &testValues = work.testValues;
+  CollectionOf3dArrays<BasisFunctionType> &trialValues = work.trialValues;
+  CollectionOf4dArrays<KernelType> &kernelValues = work.kernelValues;
 
   for (size_t i = 0; i < result.size(); ++i) {
     assert(result[i]);
@@ -716,9 +733,11 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
   const int testDofCount = testShapeset.size();
   const int trialDofCount = trialShapeset.size();
 
-  BasisData<BasisFunctionType> testBasisData, trialBasisData;
-  GeometricalData<CoordinateType> *testGeomData = &m_testGeomData.local();
-  GeometricalData<CoordinateType> *trialGeomData = &m_trialGeomData.local();
+  Scratch &work = scratch();
+  BasisData<BasisFunctionType> &testBasisData = work.testBasisData;
+  BasisData<BasisFunctionType> &trialBasisData = work.trialBasisData;
+  GeometricalData<CoordinateType> *testGeomData = &work.testGeomData;
+  GeometricalData<CoordinateType> *trialGeomData = &work.trialGeomData;
   const GeometricalData<CoordinateType> *constTestGeomData = testGeomData;
   const GeometricalData<CoordinateType> *constTrialGeomData = trialGeomData;
 
@@ -730,16 +749,12 @@ void SeparableNumericalTestKernelTrialIntegrator<BasisFunctionType, KernelType,
   m_kernels.addGeometricalDependencies(testGeomDeps, trialGeomDeps);
   m_integral.addGeometricalDependencies(testGeomDeps, trialGeomDeps);
 
-  typedef typename GeometryFactory::Geometry Geometry;
-  std::unique_ptr<Geometry> testGeometry;
-  std::unique_ptr<Geometry> trialGeometry;
-  if (!m_cacheGeometricalData) {
-    testGeometry = m_testGeometryFactory.make();
-    trialGeometry = m_trialGeometryFactory.make();
-  }
+  Geometry *testGeometry = work.testGeometry.get();
+  Geometry *trialGeometry = work.trialGeometry.get();
 
-  CollectionOf3dArrays<BasisFunctionType> testValues, trialValues;
-  CollectionOf4dArrays<KernelType> kernelValues;
+  CollectionOf3dArrays<BasisFunctionType> &testValues = work.testValues;
+  CollectionOf3dArrays<BasisFunctionType> &trialValues = work.trialValues;
+  CollectionOf4dArrays<KernelType> &kernelValues = work.kernelValues;
 
   for (size_t i = 0; i < result.size(); ++i) {
     assert(result[i]);
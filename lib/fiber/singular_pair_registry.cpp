@@ -0,0 +1,152 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "singular_pair_registry.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "../common/boost_make_shared_fwd.hpp"
+
+#include <algorithm>
+
+namespace Fiber {
+
+namespace {
+
+bool lessByTrialElement(const std::pair<int, int> &a,
+                        const std::pair<int, int> &b) {
+  return a.second < b.second || (a.second == b.second && a.first < b.first);
+}
+
+} // namespace
+
+SingularPairRegistry &SingularPairRegistry::instance() {
+  static SingularPairRegistry registry;
+  return registry;
+}
+
+SingularPairRegistry::SingularPairRegistry() {
+  m_lookupCount = 0;
+  m_hitCount = 0;
+}
+
+shared_ptr<const AdjacentElementPairs>
+SingularPairRegistry::adjacentElementPairs(
+    const arma::Mat<int> &elementCornerIndices) {
+  ++m_lookupCount;
+  const std::size_t hash = connectivityHash(elementCornerIndices);
+  {
+    tbb::mutex::scoped_lock lock(m_mutex);
+    for (std::list<Entry>::iterator it = m_entries.begin();
+         it != m_entries.end(); ++it) {
+      const arma::Mat<int> &cornerIndices = *it->elementCornerIndices;
+      if (it->hash == hash &&
+          cornerIndices.n_rows == elementCornerIndices.n_rows &&
+          cornerIndices.n_cols == elementCornerIndices.n_cols &&
+          std::equal(cornerIndices.begin(), cornerIndices.end(),
+                     elementCornerIndices.begin())) {
+        m_entries.splice(m_entries.begin(), m_entries, it);
+        ++m_hitCount;
+        return m_entries.front().pairs;
+      }
+    }
+  }
+
+  // Build the list outside the lock; if another thread registers the same
+  // grid meanwhile, both lists are equal and either can be kept
+  Entry entry;
+  entry.hash = hash;
+  entry.elementCornerIndices =
+      boost::make_shared<arma::Mat<int>>(elementCornerIndices);
+  entry.pairs = findAdjacentElementPairs(elementCornerIndices);
+
+  tbb::mutex::scoped_lock lock(m_mutex);
+  m_entries.push_front(entry);
+  if (m_entries.size() > MAX_ENTRY_COUNT)
+    m_entries.pop_back();
+  return entry.pairs;
+}
+
+std::size_t SingularPairRegistry::lookupCount() const { return m_lookupCount; }
+
+std::size_t SingularPairRegistry::hitCount() const { return m_hitCount; }
+
+void SingularPairRegistry::clear() {
+  tbb::mutex::scoped_lock lock(m_mutex);
+  m_entries.clear();
+}
+
+std::size_t
+SingularPairRegistry::connectivityHash(const arma::Mat<int> &cornerIndices) {
+  // FNV-1a
+  std::size_t hash = 14695981039346656037ULL;
+  for (const int *it = cornerIndices.begin(); it != cornerIndices.end();
+       ++it) {
+    hash ^= static_cast<std::size_t>(*it);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+shared_ptr<const AdjacentElementPairs>
+SingularPairRegistry::findAdjacentElementPairs(
+    const arma::Mat<int> &elementCornerIndices) {
+  const int elementCount = elementCornerIndices.n_cols;
+  const int maxCornerCount = elementCornerIndices.n_rows;
+  const int vertexCount =
+      elementCornerIndices.is_empty() ? 0 : elementCornerIndices.max() + 1;
+
+  // ith entry: elements sharing vertex number i
+  std::vector<std::vector<int>> elementsAdjacentToVertex(vertexCount);
+  for (int e = 0; e < elementCount; ++e)
+    for (int v = 0; v < maxCornerCount; ++v) {
+      const int index = elementCornerIndices(v, e);
+      if (index >= 0)
+        elementsAdjacentToVertex[index].push_back(e);
+    }
+
+  shared_ptr<AdjacentElementPairs> result =
+      boost::make_shared<AdjacentElementPairs>();
+  std::vector<std::pair<int, int>> &pairs = result->pairs;
+  for (int v = 0; v < vertexCount; ++v) {
+    const std::vector<int> &adjacentElements = elementsAdjacentToVertex[v];
+    const int adjacentElementCount = adjacentElements.size();
+    for (int e1 = 0; e1 < adjacentElementCount; ++e1)
+      for (int e2 = 0; e2 < adjacentElementCount; ++e2)
+        pairs.push_back(
+            std::make_pair(adjacentElements[e1], adjacentElements[e2]));
+  }
+  std::sort(pairs.begin(), pairs.end(), lessByTrialElement);
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  result->neighbourIndices.resize(pairs.size());
+  result->maxNeighbourCount = 0;
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    const int neighbourIndex =
+        (i > 0 && pairs[i - 1].second == pairs[i].second)
+            ? result->neighbourIndices[i - 1] + 1
+            : 0;
+    result->neighbourIndices[i] = neighbourIndex;
+    result->maxNeighbourCount =
+        std::max(result->maxNeighbourCount, neighbourIndex + 1);
+  }
+  return result;
+}
+
+} // namespace Fiber
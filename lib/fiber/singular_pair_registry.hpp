@@ -0,0 +1,111 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef fiber_singular_pair_registry_hpp
+#define fiber_singular_pair_registry_hpp
+
+#include "../common/common.hpp"
+
+#include "../common/armadillo_fwd.hpp"
+#include "shared_ptr.hpp"
+
+#include <tbb/atomic.h>
+#include <tbb/mutex.h>
+
+#include <cstddef>
+#include <list>
+#include <utility>
+#include <vector>
+
+namespace Fiber {
+
+/** \brief Pairs of elements of a grid sharing at least one vertex.
+ *
+ *  The pairs (test element index, trial element index) are sorted after the
+ *  trial element index first and then after the test element index.
+ *  <tt>neighbourIndices[i]</tt> is the position of <tt>pairs[i]</tt> among
+ *  the pairs with the same trial element, and \p maxNeighbourCount the
+ *  largest number of pairs sharing a trial element. This is the layout of the
+ *  singular integral cache of
+ *  DefaultLocalAssemblerForIntegralOperatorsOnSurfaces, which is indexed with
+ *  the trial element index. */
+struct AdjacentElementPairs {
+  std::vector<std::pair<int, int>> pairs;
+  std::vector<int> neighbourIndices;
+  int maxNeighbourCount;
+};
+
+/** \brief Process-wide registry of the adjacent element pairs of grids.
+ *
+ *  Local assemblers of integral operators need the list of adjacent element
+ *  pairs to precalculate singular integrals. Operators discretised on the
+ *  same grid (e.g. the four operators of a Calderon projector) obtain it
+ *  from this registry, so that it is built only once. Grids are identified
+ *  by the connectivity of their elements, which is all the list depends
+ *  on. The lists of the few most recently used grids are kept.
+ *
+ *  This class is thread-safe. */
+class SingularPairRegistry {
+public:
+  /** \brief Return the registry. */
+  static SingularPairRegistry &instance();
+
+  /** \brief Return the adjacent element pairs of the grid whose elements
+   *  have the corners listed in the columns of \p elementCornerIndices.
+   *
+   *  Negative corner indices are ignored. */
+  shared_ptr<const AdjacentElementPairs>
+  adjacentElementPairs(const arma::Mat<int> &elementCornerIndices);
+
+  /** \brief Number of calls to adjacentElementPairs() so far. */
+  std::size_t lookupCount() const;
+  /** \brief Number of calls to adjacentElementPairs() that reused a list. */
+  std::size_t hitCount() const;
+
+  /** \brief Remove all lists from the registry. */
+  void clear();
+
+private:
+  /** \cond PRIVATE */
+  SingularPairRegistry();
+
+  struct Entry {
+    std::size_t hash;
+    shared_ptr<const arma::Mat<int>> elementCornerIndices;
+    shared_ptr<const AdjacentElementPairs> pairs;
+  };
+
+  static std::size_t connectivityHash(const arma::Mat<int> &cornerIndices);
+  static shared_ptr<const AdjacentElementPairs>
+  findAdjacentElementPairs(const arma::Mat<int> &elementCornerIndices);
+
+  static const std::size_t MAX_ENTRY_COUNT = 4;
+
+  tbb::mutex m_mutex;
+  // Most recently used entries first
+  std::list<Entry> m_entries;
+  tbb::atomic<std::size_t> m_lookupCount;
+  tbb::atomic<std::size_t> m_hitCount;
+  /** \endcond */
+};
+
+} // namespace Fiber
+
+#endif
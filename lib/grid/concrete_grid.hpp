@@ -33,11 +33,13 @@
 #include "concrete_geometry_factory.hpp"
 #include "concrete_grid_view.hpp"
 #include "concrete_id_set.hpp"
+#include "raw_geometry_cache.hpp"
 
 #include <dune/grid/common/gridview.hh>
 
 #include <armadillo>
 
+#include <map>
 #include <memory>
 
 namespace Bempp {
@@ -169,13 +171,14 @@ public:
   virtual std::unique_ptr<GridView> levelView(size_t level) const {
     return std::unique_ptr<GridView>(
         new ConcreteGridView<typename DuneGrid::LevelGridView>(
-            m_dune_grid->levelView(level), m_domain_index));
+            m_dune_grid->levelView(level), m_domain_index,
+            rawGeometryCache(level)));
   }
 
   virtual std::unique_ptr<GridView> leafView() const {
     return std::unique_ptr<GridView>(
         new ConcreteGridView<typename DuneGrid::LeafGridView>(
-            m_dune_grid->leafView(), m_domain_index));
+            m_dune_grid->leafView(), m_domain_index, rawGeometryCache(-1)));
   }
 
   /** @}
@@ -254,8 +257,21 @@ private:
   // (unclear what to do with the pointer to the grid)
   ConcreteGrid(const ConcreteGrid &);
   ConcreteGrid &operator=(const ConcreteGrid &);
+
+  // Cache of the raw geometry shared by all views of the given level
+  // (-1 stands for the leaf)
+  shared_ptr<RawGeometryCache> rawGeometryCache(int level) const {
+    tbb::mutex::scoped_lock lock(m_rawGeometryCacheMutex);
+    shared_ptr<RawGeometryCache> &cache = m_rawGeometryCaches[level];
+    if (!cache)
+      cache = boost::make_shared<RawGeometryCache>();
+    return cache;
+  }
+
   mutable shared_ptr<Grid> m_barycentricGrid;
   mutable tbb::mutex m_barycentricSpaceMutex;
+  mutable std::map<int, shared_ptr<RawGeometryCache>> m_rawGeometryCaches;
+  mutable tbb::mutex m_rawGeometryCacheMutex;
 };
 
 } // namespace Bempp
@@ -29,6 +29,7 @@
 #include "concrete_index_set.hpp"
 #include "concrete_range_entity_iterator.hpp"
 #include "concrete_vtk_writer.hpp"
+#include "raw_geometry_cache.hpp"
 #include "reverse_element_mapper.hpp"
 
 namespace Bempp {
@@ -45,15 +46,26 @@ private:
   const DomainIndex &m_domain_index;
   mutable ReverseElementMapper m_reverse_element_mapper;
   mutable bool m_reverse_element_mapper_is_up_to_date;
+  shared_ptr<RawGeometryCache> m_raw_geometry_cache;
 
 public:
-  /** \brief Constructor */
+  /** \brief Constructor.
+
+    If \p raw_geometry_cache is null, the view gets a cache of its own;
+    otherwise the raw geometry is shared with all views created with the
+    same cache, which must describe the same set of elements. */
   explicit ConcreteGridView(const DuneGridView &dune_gv,
-                            const DomainIndex &domain_index)
+                            const DomainIndex &domain_index,
+                            const shared_ptr<RawGeometryCache> &
+                                raw_geometry_cache =
+                                    shared_ptr<RawGeometryCache>())
       : m_dune_gv(dune_gv), m_index_set(&dune_gv.indexSet()),
         m_element_mapper(dune_gv), m_domain_index(domain_index),
         m_reverse_element_mapper(*this),
-        m_reverse_element_mapper_is_up_to_date(false) {}
+        m_reverse_element_mapper_is_up_to_date(false),
+        m_raw_geometry_cache(raw_geometry_cache
+                                 ? raw_geometry_cache
+                                 : boost::make_shared<RawGeometryCache>()) {}
 
   /** \brief Read-only access to the underlying Dune grid view object. */
   const DuneGridView &duneGridView() const { return m_dune_gv; }
@@ -170,6 +182,15 @@ private:
       arma::Mat<float> &vertices, arma::Mat<int> &elementCorners,
       arma::Mat<char> &auxData, std::vector<int> *domainIndices) const;
 
+  virtual shared_ptr<const Fiber::RawGridGeometry<double>>
+  rawGeometryDoubleImpl() const {
+    return m_raw_geometry_cache->rawGeometry<double>(*this);
+  }
+  virtual shared_ptr<const Fiber::RawGridGeometry<float>>
+  rawGeometryFloatImpl() const {
+    return m_raw_geometry_cache->rawGeometry<float>(*this);
+  }
+
   template <typename CoordinateType>
   void getRawElementDataImpl(arma::Mat<CoordinateType> &vertices,
                              arma::Mat<int> &elementCorners,
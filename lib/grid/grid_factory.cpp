@@ -21,13 +21,21 @@
 #include "grid_factory.hpp"
 #include "concrete_grid.hpp"
 #include "dune.hpp"
+#include "entity.hpp"
+#include "entity_iterator.hpp"
+#include "grid_view.hpp"
+#include "index_set.hpp"
 #include "structured_grid_factory.hpp"
 
 #include "../common/to_string.hpp"
+#include "../io/gmsh.hpp"
 
-#include <dune/grid/io/file/gmshreader.hh>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace Bempp {
@@ -35,6 +43,49 @@ namespace Bempp {
 // Default grid typedef
 typedef ConcreteGrid<Default2dIn3dDuneGrid> Default2dIn3dGrid;
 
+namespace {
+
+// Insert two zero bits before each of the 21 lowest bits of x
+std::uint64_t spreadBits(std::uint64_t x) {
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffffULL;
+  x = (x | x << 16) & 0x1f0000ff0000ffULL;
+  x = (x | x << 8) & 0x100f00f00f00f00fULL;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+  x = (x | x << 2) & 0x1249249249249249ULL;
+  return x;
+}
+
+// Return the indices of the columns of points (3D points) sorted along a
+// Morton curve through their bounding box
+std::vector<size_t> mortonOrder(const arma::Mat<double> &points) {
+  const size_t pointCount = points.n_cols;
+  std::vector<size_t> order(pointCount);
+  if (pointCount == 0)
+    return order;
+
+  const arma::Col<double> lower = arma::min(points, 1);
+  const arma::Col<double> upper = arma::max(points, 1);
+  const double extent = arma::max(upper - lower);
+  // The same scale in all directions keeps the curve isotropic
+  const double scale = extent > 0. ? double((1 << 21) - 1) / extent : 0.;
+
+  std::vector<std::pair<std::uint64_t, size_t>> codes(pointCount);
+  for (size_t i = 0; i < pointCount; ++i) {
+    std::uint64_t code = 0;
+    for (int d = 0; d < 3; ++d)
+      code |= spreadBits(std::uint64_t((points(d, i) - lower(d)) * scale))
+              << d;
+    codes[i] = std::make_pair(code, i);
+  }
+  std::sort(codes.begin(), codes.end());
+  for (size_t i = 0; i < pointCount; ++i)
+    order[i] = codes[i].second;
+  return order;
+}
+
+} // namespace
+
 shared_ptr<Grid>
 GridFactory::createStructuredGrid(const GridParameters &params,
                                   const arma::Col<double> &lowerLeft,
@@ -89,19 +140,9 @@ shared_ptr<Grid> GridFactory::importGmshGrid(const GridParameters &params,
                                              bool insertBoundarySegments) {
   std::vector<int> boundaryId2PhysicalEntity;
   std::vector<int> elementIndex2PhysicalEntity;
-
-  if (params.topology == GridParameters::TRIANGULAR) {
-    Default2dIn3dDuneGrid *duneGrid =
-        Dune::GmshReader<Default2dIn3dDuneGrid>::read(
-            fileName, boundaryId2PhysicalEntity, elementIndex2PhysicalEntity,
-            verbose, insertBoundarySegments);
-    return shared_ptr<Grid>(new Default2dIn3dGrid(
-        duneGrid, params.topology, elementIndex2PhysicalEntity,
-        true)); // true -> owns Dune grid
-  }
-  else
-    throw std::invalid_argument("GridFactory::importGmshGrid(): "
-                                "unsupported grid topology");
+  return importGmshGrid(params, fileName, boundaryId2PhysicalEntity,
+                        elementIndex2PhysicalEntity, verbose,
+                        insertBoundarySegments);
 }
 
 shared_ptr<Grid>
@@ -110,18 +151,96 @@ GridFactory::importGmshGrid(const GridParameters &params,
                             std::vector<int> &boundaryId2PhysicalEntity,
                             std::vector<int> &elementIndex2PhysicalEntity,
                             bool verbose, bool insertBoundarySegments) {
-  if (params.topology == GridParameters::TRIANGULAR) {
-    Default2dIn3dDuneGrid *duneGrid =
-        Dune::GmshReader<Default2dIn3dDuneGrid>::read(
-            fileName, boundaryId2PhysicalEntity, elementIndex2PhysicalEntity,
-            verbose, insertBoundarySegments);
-    return shared_ptr<Grid>(new Default2dIn3dGrid(
-        duneGrid, params.topology, elementIndex2PhysicalEntity,
-        true)); // true -> owns Dune grid
-  }
-  else
+  if (params.topology != GridParameters::TRIANGULAR)
     throw std::invalid_argument("GridFactory::importGmshGrid(): "
                                 "unsupported grid topology");
+
+  const GmshData gmshData = GmshData::read(fileName, -1 /* all types */,
+                                           -1 /* all entities */, verbose);
+  const std::vector<double> &nodeCoordinates = gmshData.nodeCoordinates();
+  const std::vector<int> &elementTypes = gmshData.elementTypes();
+  const std::vector<int> &physicalEntities =
+      gmshData.elementPhysicalEntities();
+  const std::vector<int> &offsets = gmshData.elementNodeOffsets();
+  const std::vector<int> &elementNodes = gmshData.elementNodes();
+  const int triangleType = 2, lineType = 1;
+  const int secondOrderTriangleType = 9, secondOrderLineType = 8;
+  auto isTriangle = [](int type) {
+    return type == triangleType || type == secondOrderTriangleType;
+  };
+
+  // Replace node indices by node positions and find the nodes used by
+  // triangles. Only the corners of second-order triangles, which come first,
+  // become vertices; their mid-edge nodes are ignored.
+  std::vector<int> cornerPositions;
+  cornerPositions.reserve(elementNodes.size());
+  std::vector<int> vertexNumbers(gmshData.numberOfNodes(), -1);
+  for (size_t i = 0; i < elementTypes.size(); ++i) {
+    if (!isTriangle(elementTypes[i]))
+      continue;
+    const int nodeCount = elementTypes[i] == triangleType ? 3 : 6;
+    if (offsets[i + 1] - offsets[i] != nodeCount)
+      throw std::runtime_error("GridFactory::importGmshGrid(): "
+                               "triangle with wrong number of nodes");
+    for (int j = offsets[i]; j < offsets[i] + 3; ++j) {
+      const int position = gmshData.nodePosition(elementNodes[j]);
+      if (position == -1)
+        throw std::runtime_error("GridFactory::importGmshGrid(): "
+                                 "element refers to a nonexistent node");
+      cornerPositions.push_back(position);
+      vertexNumbers[position] = 0;
+    }
+  }
+  if (cornerPositions.empty())
+    throw std::runtime_error("GridFactory::importGmshGrid(): "
+                             "no triangles found in " +
+                             fileName);
+
+  // Vertices are numbered in the order in which they appear in the file
+  arma::Mat<double> vertices(3, gmshData.numberOfNodes());
+  int vertexCount = 0;
+  for (size_t i = 0; i < vertexNumbers.size(); ++i) {
+    if (vertexNumbers[i] == -1)
+      continue;
+    vertexNumbers[i] = vertexCount;
+    for (int d = 0; d < 3; ++d)
+      vertices(d, vertexCount) = nodeCoordinates[3 * i + d];
+    ++vertexCount;
+  }
+  vertices.resize(3, vertexCount);
+
+  arma::Mat<int> elementCorners(3, cornerPositions.size() / 3);
+  for (size_t i = 0; i < cornerPositions.size(); ++i)
+    elementCorners[i] = vertexNumbers[cornerPositions[i]];
+
+  std::vector<int> trianglePhysicalEntities;
+  trianglePhysicalEntities.reserve(elementCorners.n_cols);
+  boundaryId2PhysicalEntity.clear();
+  for (size_t i = 0; i < elementTypes.size(); ++i) {
+    if (isTriangle(elementTypes[i]))
+      trianglePhysicalEntities.push_back(physicalEntities[i]);
+    else if (elementTypes[i] == lineType ||
+             elementTypes[i] == secondOrderLineType)
+      boundaryId2PhysicalEntity.push_back(physicalEntities[i]);
+  }
+
+  shared_ptr<Grid> grid = createGridFromConnectivityArrays(
+      params, vertices, elementCorners, trianglePhysicalEntities);
+
+  // The grid may number its elements differently from the file (e.g. in
+  // Morton order), so take the physical entities from the grid's domain
+  // indices, which have been permuted accordingly.
+  std::unique_ptr<GridView> view = grid->leafView();
+  const IndexSet &indexSet = view->indexSet();
+  elementIndex2PhysicalEntity.resize(trianglePhysicalEntities.size());
+  std::unique_ptr<EntityIterator<0>> it = view->entityIterator<0>();
+  while (!it->finished()) {
+    const Entity<0> &entity = it->entity();
+    elementIndex2PhysicalEntity[indexSet.entityIndex(entity)] =
+        entity.domain();
+    it->next();
+  }
+  return grid;
 }
 
 shared_ptr<Grid> GridFactory::createGridFromConnectivityArrays(
@@ -146,31 +265,63 @@ shared_ptr<Grid> GridFactory::createGridFromConnectivityArrays(
         "'domainIndices' must either be empty or contain as many "
         "elements as 'elementCorners' has columns");
 
+  const size_t vertexCount = vertices.n_cols;
+  const size_t elementCount = elementCorners.n_cols;
+  for (size_t i = 0; i < elementCount; ++i)
+    if (elementCorners(0, i) < 0 || elementCorners(0, i) >= vertexCount ||
+        elementCorners(1, i) < 0 || elementCorners(1, i) >= vertexCount ||
+        elementCorners(2, i) < 0 || elementCorners(2, i) >= vertexCount)
+      throw std::invalid_argument("createGridFromConnectivityArrays(): invalid "
+                                  "vertex index in element #" +
+                                  toString(i));
+
+  // Order of insertion of vertices and elements
+  std::vector<size_t> vertexOrder, elementOrder;
+  if (params.ordering == GridParameters::MORTON_ORDER) {
+    vertexOrder = mortonOrder(vertices);
+    arma::Mat<double> barycentres(dimWorld, elementCount);
+    for (size_t i = 0; i < elementCount; ++i)
+      barycentres.col(i) = (vertices.col(elementCorners(0, i)) +
+                            vertices.col(elementCorners(1, i)) +
+                            vertices.col(elementCorners(2, i))) /
+                           3.;
+    elementOrder = mortonOrder(barycentres);
+  } else {
+    vertexOrder.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+      vertexOrder[i] = i;
+    elementOrder.resize(elementCount);
+    for (size_t i = 0; i < elementCount; ++i)
+      elementOrder[i] = i;
+  }
+
   shared_ptr<Dune::GridFactory<Default2dIn3dDuneGrid>> factory(
          new Dune::GridFactory<Default2dIn3dDuneGrid>());
 
-  for (size_t i = 0; i < vertices.n_cols; ++i) {
+  std::vector<unsigned int> vertexInsertionIndices(vertexCount);
+  for (size_t i = 0; i < vertexCount; ++i) {
+    const size_t vertex = vertexOrder[i];
     Dune::FieldVector<double, dimWorld> v;
-    v[0] = vertices(0, i);
-    v[1] = vertices(1, i);
-    v[2] = vertices(2, i);
+    v[0] = vertices(0, vertex);
+    v[1] = vertices(1, vertex);
+    v[2] = vertices(2, vertex);
     factory->insertVertex(v);
+    vertexInsertionIndices[vertex] = i;
   }
 
   const GeometryType type(GeometryType::simplex, dimGrid);
-  const size_t vertexCount = vertices.n_cols;
   std::vector<unsigned int> corners(3);
-  for (size_t i = 0; i < elementCorners.n_cols; ++i) {
-    if (elementCorners(0, i) < 0 || elementCorners(0, i) >= vertexCount ||
-        elementCorners(1, i) < 0 || elementCorners(1, i) >= vertexCount ||
-        elementCorners(2, i) < 0 || elementCorners(2, i) >= vertexCount)
-      throw std::invalid_argument("createGridFromConnectivityArrays(): invalid "
-                                  "vertex index in element #" +
-                                  toString(i));
-    corners[0] = elementCorners(0, i);
-    corners[1] = elementCorners(1, i);
-    corners[2] = elementCorners(2, i);
+  std::vector<int> insertedDomainIndices;
+  if (!domainIndices.empty())
+    insertedDomainIndices.reserve(elementCount);
+  for (size_t i = 0; i < elementCount; ++i) {
+    const size_t element = elementOrder[i];
+    corners[0] = vertexInsertionIndices[elementCorners(0, element)];
+    corners[1] = vertexInsertionIndices[elementCorners(1, element)];
+    corners[2] = vertexInsertionIndices[elementCorners(2, element)];
     factory->insertElement(type, corners);
+    if (!domainIndices.empty())
+      insertedDomainIndices.push_back(domainIndices[element]);
   }
   shared_ptr<Grid> result;
   if (domainIndices.empty())
@@ -179,7 +330,7 @@ shared_ptr<Grid> GridFactory::createGridFromConnectivityArrays(
   else
     result.reset(
         new Default2dIn3dGrid(factory,GridParameters::TRIANGULAR,
-                              domainIndices));
+                              insertedDomainIndices));
   return result;
 }
 
@@ -77,13 +77,21 @@ public:
     \param[in] params Parameters of the grid to be constructed.
     \param[in] fileName Name of the Gmsh file.
     \param[in] verbose  Output diagnostic information.
-    \param[in] insertBoundarySegments
+    \param[in] insertBoundarySegments Ignored; kept for backward
+    compatibility.
+
+    Files in the ASCII and binary variants of the MSH 2.2 format are
+    supported. The grid is made of the triangles (elements of type 2) and
+    second-order triangles (type 9) stored in the file; its vertices are the
+    corner nodes of these triangles, so second-order triangles are imported
+    as flat triangles. Vertices and elements are inserted in the order in
+    which they appear in the file or, if \p params.ordering is
+    GridParameters::MORTON_ORDER, along a Morton curve. The domain index of
+    each element is its physical entity.
 
-    \bug Ask Dune developers about the significance of insertBoundarySegments.
     \see <a href>http://geuz.org/gmsh/</a> for information about the Gmsh file
     format.
-    \see Dune::GmshReader documentation for information about the supported Gmsh
-    features.
+    \see GmshData::read()
   */
   static shared_ptr<Grid> importGmshGrid(const GridParameters &params,
                                          const std::string &fileName,
@@ -94,17 +102,17 @@ public:
 
     \param[in] params Parameters of the grid to be constructed.
     \param[in] fileName Name of the Gmsh file.
-    \param[in] boundaryId2PhysicalEntity
-    \param[in] elementIndex2PhysicalEntity
+    \param[out] boundaryId2PhysicalEntity Physical entities of the line
+    elements (types 1 and 8) of the file, in the order of the file.
+    \param[out] elementIndex2PhysicalEntity Physical entities of the
+    triangles, indexed by the element indices of the grid's leaf view. These
+    agree with the order of the file unless \p params.ordering is
+    GridParameters::MORTON_ORDER.
     \param[in] verbose  Output diagnostic information.
-    \param[in] insertBoundarySegments
+    \param[in] insertBoundarySegments Ignored; kept for backward
+    compatibility.
 
-    \bug Ask Dune developers about the significance of the undocumented
-    parameters.
-    \see <a href>http://geuz.org/gmsh/</a> for information about the Gmsh file
-    format.
-    \see Dune::GmshReader documentation for information about the supported Gmsh
-    features.
+    \see The other overload of importGmshGrid() for details.
   */
   static shared_ptr<Grid>
   importGmshGrid(const GridParameters &params, const std::string &fileName,
@@ -127,6 +135,10 @@ public:
    *    the ith element. By default, this argument is set to an empty vector,
    *    in which case all elements are taken to belong to domain 0.
    *
+   *  If \p params.ordering is GridParameters::MORTON_ORDER, the vertices
+   *  and elements are renumbered along a Morton curve before being inserted
+   *  into the grid; otherwise they are inserted in the order of the arrays.
+   *
    *  \note Currently only grids with triangular topology are supported.
    */
   static shared_ptr<Grid> createGridFromConnectivityArrays(
@@ -48,6 +48,18 @@ struct GridParameters {
         embedded in a three-dimensional space*/
     TETRAHEDRAL
   } topology;
+
+  /** \brief Order of the vertices and elements of the grid */
+  enum Ordering {
+    /** \brief order of the input arrays or file */
+    INPUT_ORDER,
+    /** \brief vertices sorted along a Morton (Z-order) space-filling curve,
+        elements along the same curve through their barycentres, so that
+        elements close to each other in space are also close in memory */
+    MORTON_ORDER
+  } ordering;
+
+  GridParameters() : ordering(INPUT_ORDER) {}
 };
 
 } // namespace Bempp
@@ -26,11 +26,18 @@
 #include "entity_iterator.hpp"
 
 #include "../common/armadillo_fwd.hpp"
+#include "../common/shared_ptr.hpp"
 #include <boost/utility/enable_if.hpp>
 #include <dune/grid/io/file/vtk/vtkwriter.hh>
 #include <memory>
 #include <stdexcept>
 
+/** \cond FORWARD_DECL */
+namespace Fiber {
+template <typename CoordinateType> class RawGridGeometry;
+} // namespace Fiber
+/** \endcond */
+
 namespace Bempp {
 
 /** \cond FORWARD_DECL */
@@ -147,6 +154,17 @@ public:
                          arma::Mat<char> &auxData,
                          std::vector<int> &domainIndices) const;
 
+  /** \brief Get raw data describing the geometry of all codim-0 entities
+    contained in this grid view, including their domain indices and, for
+    simplicial grids, the Jacobians, integration elements and normals of the
+    elements (see Fiber::RawGridGeometry::computeAffineElementData()).
+
+    The data are computed on first use and shared by all views of the same
+    grid level (or of the leaf of the grid). \p CoordinateType can be float
+    or double. */
+  template <typename CoordinateType>
+  shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> rawGeometry() const;
+
   /** \brief Mapping from codim-0 entity index to entity pointer.
 
     Note that this object is *not* updated when the grid is adapted. In that
@@ -177,6 +195,11 @@ private:
       arma::Mat<float> &vertices, arma::Mat<int> &elementCorners,
       arma::Mat<char> &auxData, std::vector<int> *domainIndices) const = 0;
 
+  virtual shared_ptr<const Fiber::RawGridGeometry<double>>
+  rawGeometryDoubleImpl() const = 0;
+  virtual shared_ptr<const Fiber::RawGridGeometry<float>>
+  rawGeometryFloatImpl() const = 0;
+
   /** \brief Iterator over entities of codimension 0 contained in this view. */
   virtual std::unique_ptr<EntityIterator<0>> entityCodim0Iterator() const = 0;
   /** \brief Iterator over entities of codimension 1 contained in this view. */
@@ -214,6 +237,18 @@ inline void GridView::getRawElementData(arma::Mat<float> &vertices,
   getRawElementDataFloatImpl(vertices, elementCorners, auxData, &domainIndices);
 }
 
+template <>
+inline shared_ptr<const Fiber::RawGridGeometry<double>>
+GridView::rawGeometry<double>() const {
+  return rawGeometryDoubleImpl();
+}
+
+template <>
+inline shared_ptr<const Fiber::RawGridGeometry<float>>
+GridView::rawGeometry<float>() const {
+  return rawGeometryFloatImpl();
+}
+
 template <>
 inline std::unique_ptr<EntityIterator<0>> GridView::entityIterator<0>() const {
   return entityCodim0Iterator();
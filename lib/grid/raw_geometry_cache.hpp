@@ -0,0 +1,77 @@
+// Copyright (C) 2011-2012 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_raw_geometry_cache_hpp
+#define bempp_raw_geometry_cache_hpp
+
+#include "../common/common.hpp"
+#include "../common/boost_make_shared_fwd.hpp"
+#include "../common/shared_ptr.hpp"
+#include "../fiber/raw_grid_geometry.hpp"
+#include "grid_view.hpp"
+
+#include <tbb/mutex.h>
+
+namespace Bempp {
+
+/** \ingroup grid_internal
+ *  \brief Lazily computed raw geometry of a grid view.
+
+  A single cache is shared by all views of the leaf (or of a given level) of
+  a grid, so that the vertices, element corners, domain indices and affine
+  element data are gathered from Dune only once and then shared, read-only,
+  by all objects assembled on that grid. */
+class RawGeometryCache {
+public:
+  template <typename CoordinateType>
+  shared_ptr<const Fiber::RawGridGeometry<CoordinateType>>
+  rawGeometry(const GridView &view) {
+    tbb::mutex::scoped_lock lock(m_mutex);
+    shared_ptr<const Fiber::RawGridGeometry<CoordinateType>> &geometry =
+        cached(static_cast<CoordinateType *>(0));
+    if (!geometry) {
+      shared_ptr<Fiber::RawGridGeometry<CoordinateType>> newGeometry =
+          boost::make_shared<Fiber::RawGridGeometry<CoordinateType>>(
+              view.dim(), view.dimWorld());
+      view.getRawElementData(
+          newGeometry->vertices(), newGeometry->elementCornerIndices(),
+          newGeometry->auxData(), newGeometry->domainIndices());
+      newGeometry->computeAffineElementData();
+      geometry = newGeometry;
+    }
+    return geometry;
+  }
+
+private:
+  shared_ptr<const Fiber::RawGridGeometry<float>> &cached(float *) {
+    return m_floatGeometry;
+  }
+  shared_ptr<const Fiber::RawGridGeometry<double>> &cached(double *) {
+    return m_doubleGeometry;
+  }
+
+  tbb::mutex m_mutex;
+  shared_ptr<const Fiber::RawGridGeometry<float>> m_floatGeometry;
+  shared_ptr<const Fiber::RawGridGeometry<double>> m_doubleGeometry;
+};
+
+} // namespace Bempp
+
+#endif
@@ -4,11 +4,12 @@
 #define HMAT_BLOCK_CLUSTER_TREE_HPP
 
 #include "common.hpp"
-#include "simple_tree_node.hpp"
 #include "bounding_box.hpp"
 #include "geometry.hpp"
 #include "cluster_tree.hpp"
 
+#include <vector>
+
 namespace hmat {
 
 typedef std::function<bool(const BoundingBox &, const BoundingBox &)>
@@ -27,8 +28,44 @@ template <int N> struct BlockClusterTreeNodeData {
   bool admissible;
 };
 
-template <int N >
-using BlockClusterTreeNode = SimpleTreeNode<BlockClusterTreeNodeData<N>, N *N>;
+// Node of the flat representation of a block cluster tree. The children of
+// a node are stored consecutively, starting at firstChild. Leafs are
+// numbered densely in depth-first order.
+struct FlatBlockClusterTreeNode {
+  // An enumerator rather than a static data member, so that NONE can be
+  // bound to const references without an out-of-class definition.
+  enum : std::size_t { NONE = static_cast<std::size_t>(-1) };
+
+  IndexRangeType rowIndexRange;
+  IndexRangeType columnIndexRange;
+  std::size_t parent;
+  std::size_t firstChild;
+  std::size_t leafId;
+  bool admissible;
+
+  bool isLeaf() const { return firstChild == NONE; }
+};
+
+template <int N> class BlockClusterTree;
+
+// Node of a block cluster tree. The tree stores its nodes in flat arrays;
+// a node is a lightweight handle to one of them and is only valid as long as
+// its tree exists.
+template <int N> class BlockClusterTreeNode {
+public:
+  BlockClusterTreeNode(const BlockClusterTree<N> &tree, std::size_t flatNode);
+
+  const BlockClusterTreeNodeData<N> &data() const;
+  bool isLeaf() const;
+  BlockClusterTreeNode<N> child(int i) const;
+
+  // Index of the node in the flat representation of its tree.
+  std::size_t flatNode() const;
+
+private:
+  const BlockClusterTree<N> *m_tree;
+  std::size_t m_flatNode;
+};
 
 typedef BlockClusterTreeNode<2> DefaultBlockClusterTreeNodeType;
 
@@ -39,6 +76,17 @@ public:
                    const shared_ptr<const ClusterTree<N>> &columnClusterTree,
                    int maxBlockSize,
                    const AdmissibilityFunction &admissibilityFunction);
+  // Tree with the structure given by a flat representation, e.g. read from a
+  // file. Only the fields firstChild and admissible of the flat nodes are
+  // used; the children of a block are formed from the children of its row
+  // and column clusters.
+  BlockClusterTree(const shared_ptr<const ClusterTree<N>> &rowClusterTree,
+                   const shared_ptr<const ClusterTree<N>> &columnClusterTree,
+                   const std::vector<FlatBlockClusterTreeNode> &flatNodes);
+
+  // The nodes refer to the tree they belong to.
+  BlockClusterTree(const BlockClusterTree<N> &) = delete;
+  BlockClusterTree<N> &operator=(const BlockClusterTree<N> &) = delete;
 
 //  void writeToPdfFile(const std::string &fname, double widthInPoints,
 //                      double heightInPoints) const;
@@ -46,23 +94,44 @@ public:
   std::size_t rows() const;
   std::size_t columns() const;
 
-  shared_ptr<const BlockClusterTreeNode<N>> root() const;
-  shared_ptr<BlockClusterTreeNode<N>> root();
+  BlockClusterTreeNode<N> root() const;
 
   shared_ptr<const ClusterTree<N>> rowClusterTree() const;
   shared_ptr<const ClusterTree<N>> columnClusterTree() const;
 
-  std::vector<shared_ptr<const BlockClusterTreeNode<N>>> leafNodes() const;
-  std::vector<shared_ptr<BlockClusterTreeNode<N>>> leafNodes();
+  // The leafs in the order of their leaf ids.
+  const std::vector<BlockClusterTreeNode<N>> &leafNodes() const;
+
+  // Flat representation of the tree. The root has index 0.
+  const std::vector<FlatBlockClusterTreeNode> &flatNodes() const;
+  std::size_t numberOfLeafs() const;
+  // Index of the flat node with the given leaf id.
+  std::size_t leafFlatNode(std::size_t leafId) const;
+  BlockClusterTreeNode<N> node(std::size_t flatNode) const;
+  const BlockClusterTreeNodeData<N> &nodeData(std::size_t flatNode) const;
 
 private:
   void initializeBlockClusterTree(
       const AdmissibilityFunction &admissibilityFunction, int maxBlockSize);
+  static void splitBlockClusterTreeNode(
+      std::size_t flatNode, std::vector<FlatBlockClusterTreeNode> &flatNodes,
+      std::vector<BlockClusterTreeNodeData<N>> &nodeData,
+      const AdmissibilityFunction &admissibilityFunction, int maxBlockSize);
+  static void appendNode(const BlockClusterTreeNodeData<N> &data,
+                         std::size_t parent,
+                         std::vector<FlatBlockClusterTreeNode> &flatNodes,
+                         std::vector<BlockClusterTreeNodeData<N>> &nodeData);
+  void initializeBlockClusterTree(
+      const std::vector<FlatBlockClusterTreeNode> &flatNodes);
+  void initializeLeafs();
 
   shared_ptr<const ClusterTree<N>> m_rowClusterTree;
   shared_ptr<const ClusterTree<N>> m_columnClusterTree;
 
-  shared_ptr<BlockClusterTreeNode<N>> m_root;
+  // The structure of the tree and the clusters of each node
+  std::vector<FlatBlockClusterTreeNode> m_flatNodes;
+  std::vector<BlockClusterTreeNodeData<N>> m_nodeData;
+  std::vector<BlockClusterTreeNode<N>> m_leafNodes;
 };
 
 template <int N>
@@ -4,6 +4,13 @@
 #define HMAT_BLOCK_CLUSTER_TREE_IMPL_HPP
 
 #include "block_cluster_tree.hpp"
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <stdexcept>
+
+#include <tbb/parallel_for.h>
 //#include "cairo/cairo.h"
 //#include "cairo/cairo-pdf.h"
 
@@ -17,6 +24,31 @@ BlockClusterTreeNodeData<N>::BlockClusterTreeNodeData(
     : rowClusterTreeNode(rowClusterTreeNode),
       columnClusterTreeNode(columnClusterTreeNode), admissible(admissible) {}
 
+template <int N>
+BlockClusterTreeNode<N>::BlockClusterTreeNode(const BlockClusterTree<N> &tree,
+                                              std::size_t flatNode)
+    : m_tree(&tree), m_flatNode(flatNode) {}
+
+template <int N>
+const BlockClusterTreeNodeData<N> &BlockClusterTreeNode<N>::data() const {
+  return m_tree->nodeData(m_flatNode);
+}
+
+template <int N> bool BlockClusterTreeNode<N>::isLeaf() const {
+  return m_tree->flatNodes()[m_flatNode].isLeaf();
+}
+
+template <int N>
+BlockClusterTreeNode<N> BlockClusterTreeNode<N>::child(int i) const {
+  return BlockClusterTreeNode<N>(*m_tree,
+                                 m_tree->flatNodes()[m_flatNode].firstChild +
+                                     i);
+}
+
+template <int N> std::size_t BlockClusterTreeNode<N>::flatNode() const {
+  return m_flatNode;
+}
+
 template <int N>
 BlockClusterTree<N>::BlockClusterTree(
     const shared_ptr<const ClusterTree<N>> &rowClusterTree,
@@ -25,6 +57,18 @@ BlockClusterTree<N>::BlockClusterTree(
     : m_rowClusterTree(rowClusterTree), m_columnClusterTree(columnClusterTree) {
 
   initializeBlockClusterTree(admissibilityFunction, maxBlockSize);
+  initializeLeafs();
+}
+
+template <int N>
+BlockClusterTree<N>::BlockClusterTree(
+    const shared_ptr<const ClusterTree<N>> &rowClusterTree,
+    const shared_ptr<const ClusterTree<N>> &columnClusterTree,
+    const std::vector<FlatBlockClusterTreeNode> &flatNodes)
+    : m_rowClusterTree(rowClusterTree), m_columnClusterTree(columnClusterTree) {
+
+  initializeBlockClusterTree(flatNodes);
+  initializeLeafs();
 }
 
 //template <int N>
@@ -88,13 +132,8 @@ template <int N> std::size_t BlockClusterTree<N>::columns() const {
 }
 
 template <int N>
-shared_ptr<const BlockClusterTreeNode<N>> BlockClusterTree<N>::root() const {
-  return m_root;
-}
-
-template <int N>
-shared_ptr<BlockClusterTreeNode<N>> BlockClusterTree<N>::root() {
-  return m_root;
+BlockClusterTreeNode<N> BlockClusterTree<N>::root() const {
+  return BlockClusterTreeNode<N>(*this, 0);
 }
 
 template <int N>
@@ -110,84 +149,248 @@ BlockClusterTree<N>::columnClusterTree() const {
 }
 
 template <int N>
-std::vector<shared_ptr<const BlockClusterTreeNode<N>>>
+const std::vector<BlockClusterTreeNode<N>> &
 BlockClusterTree<N>::leafNodes() const {
-  return m_root->leafNodes();
+  return m_leafNodes;
 }
 
 template <int N>
-std::vector<shared_ptr<BlockClusterTreeNode<N>>>
-BlockClusterTree<N>::leafNodes() {
-  return m_root->leafNodes();
+const std::vector<FlatBlockClusterTreeNode> &
+BlockClusterTree<N>::flatNodes() const {
+  return m_flatNodes;
+}
+
+template <int N> std::size_t BlockClusterTree<N>::numberOfLeafs() const {
+  return m_leafNodes.size();
 }
 
 template <int N>
-void BlockClusterTree<N>::initializeBlockClusterTree(
-    const AdmissibilityFunction &admissibilityFunction, int maxBlockSize) {
+std::size_t BlockClusterTree<N>::leafFlatNode(std::size_t leafId) const {
+  return m_leafNodes[leafId].flatNode();
+}
 
-  std::function<void(const shared_ptr<BlockClusterTreeNode<N>> &)>
-  splittingFunction;
+template <int N>
+BlockClusterTreeNode<N> BlockClusterTree<N>::node(std::size_t flatNode) const {
+  return BlockClusterTreeNode<N>(*this, flatNode);
+}
 
-  splittingFunction =
-      [this, &admissibilityFunction, &splittingFunction, &maxBlockSize](
-          const shared_ptr<BlockClusterTreeNode<N>> &node) {
+template <int N>
+const BlockClusterTreeNodeData<N> &
+BlockClusterTree<N>::nodeData(std::size_t flatNode) const {
+  return m_nodeData[flatNode];
+}
 
-    auto nodeData = node->data();
+template <int N> void BlockClusterTree<N>::initializeLeafs() {
 
-    // Adjust admissibility condition to only accept blocks smaller than
-    // maxBlockSize
+  // Number the leafs in depth-first order. Unlike the flat nodes, in which
+  // the children of a node form one consecutive group, this visits all
+  // leafs below a child before the next child.
 
-    auto rowClusterTreeNodeIndexRange =
-        nodeData.rowClusterTreeNode->data().indexRange;
-    auto columnClusterTreeNodeIndexRange =
-        nodeData.columnClusterTreeNode->data().indexRange;
-    auto rowBlockSize =
-        rowClusterTreeNodeIndexRange[1] - rowClusterTreeNodeIndexRange[0];
-    auto columnBlockSize =
-        columnClusterTreeNodeIndexRange[1] - columnClusterTreeNodeIndexRange[0];
+  m_leafNodes.clear();
 
-    if (columnBlockSize > maxBlockSize || rowBlockSize > maxBlockSize)
-      nodeData.admissible = false;
+  std::function<void(std::size_t)> numberImpl;
+  numberImpl = [this, &numberImpl](std::size_t index) {
+    FlatBlockClusterTreeNode &flatNode = m_flatNodes[index];
+    if (flatNode.isLeaf()) {
+      flatNode.leafId = m_leafNodes.size();
+      m_leafNodes.push_back(BlockClusterTreeNode<N>(*this, index));
+      return;
+    }
+    flatNode.leafId = FlatBlockClusterTreeNode::NONE;
+    for (int i = 0; i < N * N; ++i)
+      numberImpl(flatNode.firstChild + i);
+  };
+  numberImpl(0);
+}
 
-    // If admissible do not refine further
+template <int N>
+void BlockClusterTree<N>::appendNode(
+    const BlockClusterTreeNodeData<N> &data, std::size_t parent,
+    std::vector<FlatBlockClusterTreeNode> &flatNodes,
+    std::vector<BlockClusterTreeNodeData<N>> &nodeData) {
+
+  FlatBlockClusterTreeNode flatNode;
+  flatNode.rowIndexRange = data.rowClusterTreeNode->data().indexRange;
+  flatNode.columnIndexRange = data.columnClusterTreeNode->data().indexRange;
+  flatNode.parent = parent;
+  flatNode.firstChild = FlatBlockClusterTreeNode::NONE;
+  flatNode.leafId = FlatBlockClusterTreeNode::NONE;
+  flatNode.admissible = data.admissible;
+  flatNodes.push_back(flatNode);
+  nodeData.push_back(data);
+}
 
-    if (nodeData.admissible)
-      return;
+template <int N>
+void BlockClusterTree<N>::initializeBlockClusterTree(
+    const AdmissibilityFunction &admissibilityFunction, int maxBlockSize) {
 
-    auto rowClusterData = nodeData.rowClusterTreeNode->data();
-    auto columnClusterData = nodeData.columnClusterTreeNode->data();
+  bool admissible =
+      admissibilityFunction(m_rowClusterTree->root()->data().boundingBox,
+                            m_columnClusterTree->root()->data().boundingBox);
+  m_flatNodes.clear();
+  m_nodeData.clear();
+  appendNode(BlockClusterTreeNodeData<N>(m_rowClusterTree->root(),
+                                         m_columnClusterTree->root(),
+                                         admissible),
+             FlatBlockClusterTreeNode::NONE, m_flatNodes, m_nodeData);
+  splitBlockClusterTreeNode(0, m_flatNodes, m_nodeData, admissibilityFunction,
+                            maxBlockSize);
+}
 
-    // If row or column cluster is leaf do not refine further
+template <int N>
+void BlockClusterTree<N>::initializeBlockClusterTree(
+    const std::vector<FlatBlockClusterTreeNode> &flatNodes) {
 
-    if (nodeData.rowClusterTreeNode->isLeaf() ||
-        nodeData.columnClusterTreeNode->isLeaf())
-      return;
+  if (flatNodes.empty())
+    throw std::invalid_argument("BlockClusterTree::BlockClusterTree(): "
+                                "empty list of flat nodes");
 
-    // Create the block clusters
+  // The nodes are appended in the same order as during splitting, so each
+  // group of children must start where the given flat nodes say.
 
-    for (int rowCount = 0; rowCount < N; ++rowCount) {
-      auto rowChild = nodeData.rowClusterTreeNode->child(rowCount);
+  std::function<void(std::size_t)> buildImpl;
+  buildImpl = [this, &flatNodes, &buildImpl](std::size_t index) {
+    const FlatBlockClusterTreeNode &flatNode = flatNodes[index];
+    if (flatNode.isLeaf())
+      return;
+    const auto nodeData = m_nodeData[index];
+    if (nodeData.rowClusterTreeNode->isLeaf() ||
+        nodeData.columnClusterTreeNode->isLeaf() ||
+        flatNode.firstChild != m_flatNodes.size() ||
+        flatNode.firstChild + N * N > flatNodes.size())
+      throw std::invalid_argument("BlockClusterTree::BlockClusterTree(): "
+                                  "flat nodes do not match the cluster trees");
+    m_flatNodes[index].firstChild = flatNode.firstChild;
+    for (int rowCount = 0; rowCount < N; ++rowCount)
       for (int columnCount = 0; columnCount < N; ++columnCount) {
-        auto columnChild = nodeData.columnClusterTreeNode->child(columnCount);
-        auto rowBoundingBox = rowClusterData.boundingBox;
-        auto columnBoundingBox = columnClusterData.boundingBox;
-        node->addChild(
-            BlockClusterTreeNodeData<N>(
-                rowChild, columnChild,
-                admissibilityFunction(rowBoundingBox, columnBoundingBox)),
-            N * rowCount + columnCount);
-        splittingFunction(node->child(N * rowCount + columnCount));
+        int i = N * rowCount + columnCount;
+        appendNode(BlockClusterTreeNodeData<N>(
+                       nodeData.rowClusterTreeNode->child(rowCount),
+                       nodeData.columnClusterTreeNode->child(columnCount),
+                       flatNodes[flatNode.firstChild + i].admissible),
+                   index, m_flatNodes, m_nodeData);
       }
-    }
+    for (int i = 0; i < N * N; ++i)
+      buildImpl(flatNode.firstChild + i);
   };
 
-  bool admissible =
-      admissibilityFunction(m_rowClusterTree->root()->data().boundingBox,
-                            m_columnClusterTree->root()->data().boundingBox);
-  m_root = shared_ptr<BlockClusterTreeNode<N>>(
-      new BlockClusterTreeNode<N>(BlockClusterTreeNodeData<N>(
-          m_rowClusterTree->root(), m_columnClusterTree->root(), admissible)));
-  splittingFunction(m_root);
+  m_flatNodes.clear();
+  m_nodeData.clear();
+  appendNode(BlockClusterTreeNodeData<N>(m_rowClusterTree->root(),
+                                         m_columnClusterTree->root(),
+                                         flatNodes[0].admissible),
+             FlatBlockClusterTreeNode::NONE, m_flatNodes, m_nodeData);
+  buildImpl(0);
+
+  bool consistent = (m_flatNodes.size() == flatNodes.size());
+  for (std::size_t i = 0; consistent && i < flatNodes.size(); ++i)
+    consistent = (m_flatNodes[i].rowIndexRange == flatNodes[i].rowIndexRange &&
+                  m_flatNodes[i].columnIndexRange ==
+                      flatNodes[i].columnIndexRange);
+  if (!consistent)
+    throw std::invalid_argument("BlockClusterTree::BlockClusterTree(): "
+                                "flat nodes do not match the cluster trees");
+}
+
+template <int N>
+void BlockClusterTree<N>::splitBlockClusterTreeNode(
+    std::size_t flatNode, std::vector<FlatBlockClusterTreeNode> &flatNodes,
+    std::vector<BlockClusterTreeNodeData<N>> &nodeData,
+    const AdmissibilityFunction &admissibilityFunction, int maxBlockSize) {
+
+  // Subtrees of blocks with fewer rows or columns are built by the calling
+  // task.
+  const std::size_t parallelSplittingThreshold = 1024;
+
+  // A copy: blocks larger than maxBlockSize are refined if possible, but a
+  // block that cannot be refined keeps its admissibility. The copy also
+  // stays valid while children are appended to the arrays.
+
+  auto data = nodeData[flatNode];
+
+  // Adjust admissibility condition to only accept blocks smaller than
+  // maxBlockSize
+
+  auto rowClusterTreeNodeIndexRange =
+      data.rowClusterTreeNode->data().indexRange;
+  auto columnClusterTreeNodeIndexRange =
+      data.columnClusterTreeNode->data().indexRange;
+  std::size_t rowBlockSize =
+      rowClusterTreeNodeIndexRange[1] - rowClusterTreeNodeIndexRange[0];
+  std::size_t columnBlockSize =
+      columnClusterTreeNodeIndexRange[1] - columnClusterTreeNodeIndexRange[0];
+
+  if (columnBlockSize > static_cast<std::size_t>(maxBlockSize) ||
+      rowBlockSize > static_cast<std::size_t>(maxBlockSize))
+    data.admissible = false;
+
+  // If admissible do not refine further
+
+  if (data.admissible)
+    return;
+
+  // If row or column cluster is leaf do not refine further
+
+  if (data.rowClusterTreeNode->isLeaf() ||
+      data.columnClusterTreeNode->isLeaf())
+    return;
+
+  // Create the block clusters as one consecutive group
+
+  std::size_t firstChild = flatNodes.size();
+  flatNodes[flatNode].firstChild = firstChild;
+  for (int rowCount = 0; rowCount < N; ++rowCount) {
+    auto rowChild = data.rowClusterTreeNode->child(rowCount);
+    for (int columnCount = 0; columnCount < N; ++columnCount) {
+      auto columnChild = data.columnClusterTreeNode->child(columnCount);
+      appendNode(BlockClusterTreeNodeData<N>(
+                     rowChild, columnChild,
+                     admissibilityFunction(rowChild->data().boundingBox,
+                                           columnChild->data().boundingBox)),
+                 flatNode, flatNodes, nodeData);
+    }
+  }
+
+  if (std::min(rowBlockSize, columnBlockSize) <= parallelSplittingThreshold) {
+    for (int i = 0; i < N * N; ++i)
+      splitBlockClusterTreeNode(firstChild + i, flatNodes, nodeData,
+                                admissibilityFunction, maxBlockSize);
+    return;
+  }
+
+  // The subtrees of the children are independent of each other. Each is
+  // built in arrays of its own, whose first entry is the child, and then
+  // appended in the order of the children, which gives the same layout as
+  // the serial construction.
+
+  std::array<std::vector<FlatBlockClusterTreeNode>, N * N> subtreeFlatNodes;
+  std::array<std::vector<BlockClusterTreeNodeData<N>>, N * N> subtreeNodeData;
+  tbb::parallel_for(0, N * N, [&](int i) {
+    appendNode(nodeData[firstChild + i], FlatBlockClusterTreeNode::NONE,
+               subtreeFlatNodes[i], subtreeNodeData[i]);
+    splitBlockClusterTreeNode(0, subtreeFlatNodes[i], subtreeNodeData[i],
+                              admissibilityFunction, maxBlockSize);
+  });
+
+  for (int i = 0; i < N * N; ++i) {
+    const std::size_t child = firstChild + i;
+    const std::size_t offset = flatNodes.size() - 1;
+    auto toGlobal = [child, offset](std::size_t index) {
+      if (index == FlatBlockClusterTreeNode::NONE)
+        return index;
+      return index == 0 ? child : offset + index;
+    };
+    const auto &subtree = subtreeFlatNodes[i];
+    flatNodes[child].firstChild = toGlobal(subtree[0].firstChild);
+    for (std::size_t index = 1; index < subtree.size(); ++index) {
+      FlatBlockClusterTreeNode node = subtree[index];
+      node.parent = toGlobal(node.parent);
+      node.firstChild = toGlobal(node.firstChild);
+      flatNodes.push_back(node);
+    }
+    nodeData.insert(end(nodeData), begin(subtreeNodeData[i]) + 1,
+                    end(subtreeNodeData[i]));
+  }
 }
 
 template <int N>
@@ -20,6 +20,14 @@ struct ClusterTreeNodeData {
   BoundingBox boundingBox;
 };
 
+enum ClusterSplittingStrategy {
+  // Bisect the bounding box of a cluster along its largest dimension.
+  GEOMETRIC_SPLITTING,
+  // Split a cluster at the median of the element centers along the largest
+  // dimension of its bounding box, giving clusters of equal cardinality.
+  CARDINALITY_SPLITTING
+};
+
 template <int N> using ClusterTreeNode = SimpleTreeNode<ClusterTreeNodeData, N>;
 
 typedef ClusterTreeNode<2> DefaultClusterTreeNodeType;
@@ -27,7 +35,11 @@ typedef ClusterTreeNode<2> DefaultClusterTreeNodeType;
 template <int N> class ClusterTree {
 
 public:
-  ClusterTree(const Geometry &geometry, int minBlockSize);
+  ClusterTree(const Geometry &geometry, int minBlockSize,
+              ClusterSplittingStrategy splittingStrategy = GEOMETRIC_SPLITTING);
+  // Tree with a given node structure, e.g. read from a file
+  ClusterTree(const shared_ptr<ClusterTreeNode<N>> &root,
+              const DofPermutation &dofPermutation);
 
   const shared_ptr<const ClusterTreeNode<N>> root() const;
   const shared_ptr<ClusterTreeNode<N>> root();
@@ -49,7 +61,12 @@ private:
   void splitClusterTreeByGeometry(const Geometry &geometry,
                                   DofPermutation &dofPermutation,
                                   int minBlockSize);
+  void splitClusterTreeNode(const shared_ptr<ClusterTreeNode<N>> &node,
+                            const Geometry &geometry, IndexSetType &indexSet,
+                            DofPermutation &dofPermutation,
+                            int minBlockSize) const;
 
+  ClusterSplittingStrategy m_splittingStrategy;
   shared_ptr<ClusterTreeNode<N>> m_root;
   DofPermutation m_dofPermutation;
 };
@@ -11,8 +11,12 @@
 
 #include "cluster_tree.hpp"
 
+#include <algorithm>
 #include <functional>
 #include <cassert>
+#include <stdexcept>
+
+#include <tbb/parallel_invoke.h>
 
 namespace hmat {
 
@@ -21,13 +25,25 @@ inline ClusterTreeNodeData::ClusterTreeNodeData(
     : indexRange(indexRange), boundingBox(boundingBox) {}
 
 template <int N>
-ClusterTree<N>::ClusterTree(const Geometry &geometry, int minBlockSize)
-    : m_root(initializeClusterTree(geometry)),
+ClusterTree<N>::ClusterTree(const Geometry &geometry, int minBlockSize,
+                            ClusterSplittingStrategy splittingStrategy)
+    : m_splittingStrategy(splittingStrategy),
+      m_root(initializeClusterTree(geometry)),
       m_dofPermutation(geometry.size()) {
 
   splitClusterTreeByGeometry(geometry, m_dofPermutation, minBlockSize);
 }
 
+template <int N>
+ClusterTree<N>::ClusterTree(const shared_ptr<ClusterTreeNode<N>> &root,
+                            const DofPermutation &dofPermutation)
+    : m_splittingStrategy(GEOMETRIC_SPLITTING), m_root(root),
+      m_dofPermutation(dofPermutation) {
+  if (dofPermutation.numberOfDofs() != numberOfDofs())
+    throw std::invalid_argument("ClusterTree::ClusterTree(): "
+                                "DOF permutation does not match the tree");
+}
+
 template <int N> std::size_t ClusterTree<N>::numberOfDofs() const {
   return (m_root->data().indexRange[1] - m_root->data().indexRange[0]);
 }
@@ -68,95 +84,120 @@ ClusterTree<N>::originalDofToHMatDofMap() const {
 }
 
 template <>
-inline void
-ClusterTree<2>::splitClusterTreeByGeometry(const Geometry &geometry,
-                                           DofPermutation &dofPermutation,
-                                           int minBlockSize) {
-
-  std::function<void(const shared_ptr<ClusterTreeNode<2>> & clusterTreeNode,
-                     const IndexSetType & indexSet)> splittingFun;
-
-  splittingFun = [&dofPermutation, &geometry, minBlockSize, &splittingFun](
-      const shared_ptr<ClusterTreeNode<2>> &clusterTreeNode,
-      const IndexSetType &indexSet) {
-
-    std::size_t indexSetSize = indexSet.size();
-
-    assert(indexSetSize == clusterTreeNode->data().indexRange[1] -
-                               clusterTreeNode->data().indexRange[0]);
-
-    if (indexSetSize > minBlockSize) {
-
-      IndexSetType firstIndexSet;
-      IndexSetType secondIndexSet;
-
-      // Figure out the right dim
-
-      assert(clusterTreeNode->data().boundingBox.diameter() != 0);
-
-      auto dim = clusterTreeNode->data().boundingBox.maxDimension();
-
-      auto bounds = clusterTreeNode->data().boundingBox.bounds();
-      auto boxes = clusterTreeNode->data().boundingBox.divide(dim, .5);
-
-      auto firstBoundingBox = boxes.first;
-      auto secondBoundingBox = boxes.second;
+inline void ClusterTree<2>::splitClusterTreeNode(
+    const shared_ptr<ClusterTreeNode<2>> &clusterTreeNode,
+    const Geometry &geometry, IndexSetType &indexSet,
+    DofPermutation &dofPermutation, int minBlockSize) const {
+
+  // Subtrees with fewer indices are built by the calling task.
+  const std::size_t parallelSplittingThreshold = 4096;
+
+  const IndexRangeType indexRange = clusterTreeNode->data().indexRange;
+  const std::size_t indexSetSize = indexRange[1] - indexRange[0];
+  auto first = begin(indexSet) + indexRange[0];
+  auto last = begin(indexSet) + indexRange[1];
+
+  // Clusters of a single index cannot be split, whatever minBlockSize is.
+  if (indexSetSize <= static_cast<std::size_t>(std::max(minBlockSize, 1))) {
+
+    BoundingBox b;
+    for (auto it = first; it != last; ++it)
+      b.merge(geometry[*it]->boundingBox);
+
+    clusterTreeNode->data().boundingBox = b;
+    for (std::size_t hMatDof = indexRange[0]; hMatDof < indexRange[1];
+         ++hMatDof)
+      dofPermutation.addDofIndexPair(indexSet[hMatDof], hMatDof);
+    return;
+  }
+
+  BoundingBox &boundingBox = clusterTreeNode->data().boundingBox;
+  std::pair<BoundingBox, BoundingBox> boxes;
+  IndexSetType::iterator pivot;
+
+  if (m_splittingStrategy == CARDINALITY_SPLITTING) {
+
+    auto dim = boundingBox.maxDimension();
+    pivot = first + indexSetSize / 2;
+    std::nth_element(first, pivot, last,
+                     [&geometry, dim](std::size_t i, std::size_t j) {
+      return geometry[i]->center[dim] < geometry[j]->center[dim];
+    });
+
+    auto bounds = boundingBox.bounds();
+    double width = bounds[2 * dim + 1] - bounds[2 * dim];
+    double f = (width > 0)
+                   ? (geometry[*pivot]->center[dim] - bounds[2 * dim]) / width
+                   : .5;
+    boxes = boundingBox.divide(dim, std::min(1., std::max(0., f)));
+
+  } else {
+
+    // Bisect the bounding box until both halves contain elements.
+
+    while (true) {
+
+      assert(boundingBox.diameter() != 0);
+
+      auto dim = boundingBox.maxDimension();
+      boxes = boundingBox.divide(dim, .5);
+      auto ubound = boxes.first.bounds()[2 * dim + 1];
+
+      pivot = std::partition(first, last, [&geometry, dim, ubound](
+                                              std::size_t index) {
+        return geometry[index]->center[dim] < ubound;
+      });
+
+      if (pivot == first)
+        boundingBox = boxes.second;
+      else if (pivot == last)
+        boundingBox = boxes.first;
+      else
+        break;
+    }
+  }
 
-      auto ubound = firstBoundingBox.bounds()[2 * dim + 1];
+  IndexRangeType newRangeFirst = indexRange;
+  IndexRangeType newRangeSecond = indexRange;
 
-      for (auto index : indexSet) {
-        auto centerValue = geometry[index]->center[dim];
-        if (centerValue < ubound)
-          firstIndexSet.push_back(index);
-        else
-          secondIndexSet.push_back(index);
-      }
+  newRangeFirst[1] = newRangeSecond[0] = indexRange[0] + (pivot - first);
 
-      if (secondIndexSet.size() == 0) {
-        clusterTreeNode->data().boundingBox = firstBoundingBox;
-        splittingFun(clusterTreeNode, indexSet);
-        return;
-      }
-      if (firstIndexSet.size() == 0) {
-        clusterTreeNode->data().boundingBox = secondBoundingBox;
-        splittingFun(clusterTreeNode, indexSet);
-        return;
-      }
+  clusterTreeNode->addChild(ClusterTreeNodeData(newRangeFirst, boxes.first),
+                            0);
+  clusterTreeNode->addChild(ClusterTreeNodeData(newRangeSecond, boxes.second),
+                            1);
 
-      auto pivot = firstIndexSet.size();
+  auto splitChild = [&](int i) {
+    splitClusterTreeNode(clusterTreeNode->child(i), geometry, indexSet,
+                         dofPermutation, minBlockSize);
+  };
 
-      IndexRangeType newRangeFirst = clusterTreeNode->data().indexRange;
-      IndexRangeType newRangeSecond = clusterTreeNode->data().indexRange;
+  // The children work on disjoint slices of the index set and write
+  // disjoint entries of the DOF permutation.
 
-      newRangeFirst[1] = newRangeSecond[0] = newRangeFirst[0] + pivot;
+  if (indexSetSize > parallelSplittingThreshold)
+    tbb::parallel_invoke([&] { splitChild(0); }, [&] { splitChild(1); });
+  else {
+    splitChild(0);
+    splitChild(1);
+  }
 
-      clusterTreeNode->addChild(
-          ClusterTreeNodeData(newRangeFirst, firstBoundingBox), 0);
-      clusterTreeNode->addChild(
-          ClusterTreeNodeData(newRangeSecond, secondBoundingBox), 1);
-      splittingFun(clusterTreeNode->child(0), firstIndexSet);
-      splittingFun(clusterTreeNode->child(1), secondIndexSet);
+  boundingBox = clusterTreeNode->child(0)->data().boundingBox;
+  boundingBox.merge(clusterTreeNode->child(1)->data().boundingBox);
+}
 
-      clusterTreeNode->data().boundingBox =
-          clusterTreeNode->child(0)->data().boundingBox;
-      clusterTreeNode->data().boundingBox.merge(
-          clusterTreeNode->child(1)->data().boundingBox);
-    } else {
+template <>
+inline void
+ClusterTree<2>::splitClusterTreeByGeometry(const Geometry &geometry,
+                                           DofPermutation &dofPermutation,
+                                           int minBlockSize) {
 
-      BoundingBox b;
-      for (const auto &elem : indexSet)
-        b.merge(geometry[elem]->boundingBox);
+  // All nodes work on slices of a single index set, which is partitioned
+  // in place.
 
-      clusterTreeNode->data().boundingBox = b;
-      int originalIndexCount = 0;
-      const auto &indexRange = clusterTreeNode->data().indexRange;
-      for (int hMatDof = indexRange[0]; hMatDof < indexRange[1]; ++hMatDof) {
-        dofPermutation.addDofIndexPair(indexSet[originalIndexCount], hMatDof);
-        ++originalIndexCount;
-      }
-    }
-  };
-  splittingFun(m_root, fillIndexRange(0, geometry.size()));
+  IndexSetType indexSet = fillIndexRange(0, geometry.size());
+  splitClusterTreeNode(m_root, geometry, indexSet, dofPermutation,
+                       minBlockSize);
 }
 
 template <int N>
@@ -9,7 +9,7 @@
 #include "data_accessor.hpp"
 #include "compressed_matrix.hpp"
 #include <armadillo>
-#include <unordered_map>
+#include <vector>
 
 namespace hmat {
 
@@ -24,6 +24,11 @@ public:
   HMatrix(const shared_ptr<BlockClusterTree<N>> &blockClusterTree);
   HMatrix(const shared_ptr<BlockClusterTree<N>> &blockClusterTree,
           const HMatrixCompressor<ValueType, N> &hMatrixCompressor);
+  // H-matrix with given leaf data, e.g. read from a file. leafFlatNodes
+  // contains the flat block cluster tree node of each entry of leafData.
+  HMatrix(const shared_ptr<BlockClusterTree<N>> &blockClusterTree,
+          const std::vector<std::size_t> &leafFlatNodes,
+          const std::vector<shared_ptr<HMatrixData<ValueType>>> &leafData);
 
   std::size_t rows() const override;
   std::size_t columns() const override;
@@ -32,6 +37,20 @@ public:
   bool isInitialized() const;
   void reset();
 
+  // Truncate all low-rank blocks to relative accuracy eps. If coarsen is
+  // true, sibling blocks that are all low-rank are afterwards merged into
+  // their parent block whenever this reduces the storage.
+  void recompress(double eps, bool coarsen = false);
+
+  double memSizeKb() const;
+  std::size_t numberOfLeafs() const;
+
+  shared_ptr<const BlockClusterTree<N>> blockClusterTree() const;
+  // Flat block cluster tree node and data of a leaf. After coarsening, a leaf
+  // may correspond to a non-leaf node of the block cluster tree.
+  std::size_t leafFlatNode(std::size_t leaf) const;
+  shared_ptr<const HMatrixData<ValueType>> leafData(std::size_t leaf) const;
+
   void apply(const arma::Mat<ValueType> &X, arma::Mat<ValueType> &Y,
              TransposeMode trans, ValueType alpha, ValueType beta) const
       override;
@@ -44,9 +63,42 @@ public:
                            RowColSelector rowOrColumn) const override;
 
 private:
+  // A contiguous range of output indices together with the leafs
+  // contributing to it. The ranges of all output blocks are disjoint.
+  struct OutputBlock {
+    IndexRangeType outputRange;
+    std::vector<std::size_t> leafIndices;
+  };
+
+  // Work arrays of apply(). They are allocated for each call: a thread
+  // waiting in one of the parallel loops of apply() may steal a task that
+  // applies the same H-matrix, so the arrays cannot be shared per thread.
+  struct ApplyBuffers {
+    arma::Mat<ValueType> x;
+    arma::Mat<ValueType> y;
+    std::vector<arma::Mat<ValueType>> workspaces;
+  };
+
+  shared_ptr<const ClusterTree<N>>
+  clusterTree(RowColSelector rowOrColumn) const;
+
+  void initializeOutputBlocks(RowColSelector rowOrColumn,
+                              std::vector<OutputBlock> &outputBlocks) const;
+
+  bool coarsenBlock(std::size_t flatNode, double eps,
+                    std::vector<std::size_t> &leafIndices);
+
+  void permuteRows(const arma::Mat<ValueType> &mat,
+                   const std::vector<std::size_t> &sourceRows,
+                   arma::Mat<ValueType> &result, ValueType alpha,
+                   ValueType beta) const;
+
   shared_ptr<BlockClusterTree<N>> m_blockClusterTree;
-  std::unordered_map<shared_ptr<BlockClusterTreeNode<N>>,
-                     shared_ptr<HMatrixData<ValueType>>> m_hMatrixData;
+  // Flat block cluster tree nodes of the leafs and their data
+  std::vector<std::size_t> m_leafNodes;
+  std::vector<shared_ptr<HMatrixData<ValueType>>> m_leafData;
+  std::vector<OutputBlock> m_rowBlocks;
+  std::vector<OutputBlock> m_columnBlocks;
 };
 }
 
@@ -7,34 +7,85 @@
 #include "hmatrix_compressor.hpp"
 #include "hmatrix_dense_compressor.hpp"
 #include "data_accessor.hpp"
-#include <set>
+#include "scalar_traits.hpp"
+#include <random>
+#include <vector>
 
 namespace hmat {
 
+enum AcaVariant {
+  // Partially pivoted ACA: the next pivot row is the largest entry of the
+  // last computed column.
+  ACA_PARTIAL_PIVOTING,
+  // ACA+: pivots are chosen from a reference row and a reference column,
+  // which makes the method robust for blocks with zero rows or columns.
+  ACA_PLUS
+};
+
 template <typename ValueType, int N>
 class HMatrixAcaCompressor : public HMatrixCompressor<ValueType, N> {
 public:
   HMatrixAcaCompressor(const DataAccessor<ValueType, N> &dataAccessor,
                        double eps, unsigned int maxRank,
+                       AcaVariant variant = ACA_PARTIAL_PIVOTING,
+                       unsigned int seed = 0,
                        unsigned int resizeThreshold = 10);
 
   void compressBlock(const BlockClusterTreeNode<N> &blockClusterTreeNode,
                      shared_ptr<HMatrixData<ValueType>> &hMatrixData) const
       override;
 
+  double estimateBlockCost(const BlockClusterTreeNode<N> &blockClusterTreeNode)
+      const override;
+
 private:
+  typedef typename ScalarTraits<ValueType>::RealType RealType;
+
+  static constexpr std::size_t NO_INDEX = static_cast<std::size_t>(-1);
+
+  // A pivot smaller than this times the largest previous pivot is treated
+  // as zero.
+  static constexpr double RELATIVE_ZERO_PIVOT = 1E-12;
+
+  // Compute rows/columns [rowIndexRange) x [columnIndexRange) of the block
+  // minus the first rank terms of the low-rank approximation A * B.
   void evaluateMatMinusLowRank(
       const BlockClusterTreeNode<N> &blockClusterTreeNode,
       const IndexRangeType &rowIndexRange,
       const IndexRangeType &columnIndexRange, arma::Mat<ValueType> &data,
-      const arma::Mat<ValueType> &A, const arma::Mat<ValueType> &B) const;
+      const arma::Mat<ValueType> &A, const arma::Mat<ValueType> &B,
+      std::size_t rank) const;
+
+  void evaluateRow(const BlockClusterTreeNode<N> &blockClusterTreeNode,
+                   std::size_t row, arma::Mat<ValueType> &data,
+                   const arma::Mat<ValueType> &A,
+                   const arma::Mat<ValueType> &B, std::size_t rank) const;
+
+  void evaluateColumn(const BlockClusterTreeNode<N> &blockClusterTreeNode,
+                      std::size_t column, arma::Mat<ValueType> &data,
+                      const arma::Mat<ValueType> &A,
+                      const arma::Mat<ValueType> &B, std::size_t rank) const;
+
+  // Append the term a * b to A * B, enlarging the capacity of A and B
+  // geometrically, and update the squared Frobenius norm of A * B.
+  static void appendTerm(const arma::Mat<ValueType> &a,
+                         const arma::Mat<ValueType> &b, arma::Mat<ValueType> &A,
+                         arma::Mat<ValueType> &B, std::size_t rank,
+                         RealType &frobeniusNormSquared);
+
+  static std::size_t maxAbsIndex(const arma::Mat<ValueType> &data,
+                                 const std::vector<bool> &excluded);
+
+  static bool isNegligible(RealType value, RealType scale);
 
-  static std::size_t randomIndex(const IndexRangeType &range,
-                                 std::set<std::size_t> &previousIndices);
+  static std::size_t randomIndex(std::mt19937 &generator,
+                                 const std::vector<bool> &excluded);
 
   const DataAccessor<ValueType, N> &m_dataAccessor;
   double m_eps;
   unsigned int m_maxRank;
+  AcaVariant m_variant;
+  unsigned int m_seed;
   unsigned int m_resizeThreshold;
   HMatrixDenseCompressor<ValueType, N> m_hMatrixDenseCompressor;
 };
@@ -40,85 +40,192 @@ void HMatrixAcaCompressor<ValueType, N>::compressBlock(
   arma::Mat<ValueType> &B =
       static_cast<HMatrixLowRankData<ValueType> *>(hMatrixData.get())->B();
 
-  A.resize(numberOfRows, m_resizeThreshold);
-  B.resize(m_resizeThreshold, numberOfColumns);
-
-  std::set<std::size_t> previousRowIndices;
-  std::set<std::size_t> previousColumnIndices;
-
   std::size_t iterationLimit =
       std::min(static_cast<std::size_t>(m_maxRank),
                std::min(numberOfRows, numberOfColumns));
 
-  std::size_t rankCount = 0;
+  std::size_t capacity =
+      std::min(static_cast<std::size_t>(m_resizeThreshold), iterationLimit);
+  A.set_size(numberOfRows, capacity);
+  B.set_size(capacity, numberOfColumns);
 
-  std::size_t sizeMultiplier = 0;
+  // Seed the generator with the block position, so that the result does
+  // not depend on the order in which the blocks are compressed.
 
-  for (int i = 0; i < iterationLimit; ++i) {
+  std::seed_seq seedSequence{m_seed,
+                             static_cast<unsigned int>(rowClusterRange[0]),
+                             static_cast<unsigned int>(rowClusterRange[1]),
+                             static_cast<unsigned int>(columnClusterRange[0]),
+                             static_cast<unsigned int>(columnClusterRange[1])};
+  std::mt19937 generator(seedSequence);
 
-    std::size_t row = randomIndex(rowClusterRange, previousRowIndices);
+  std::vector<bool> usedRows(numberOfRows, false);
+  std::vector<bool> usedColumns(numberOfColumns, false);
 
-    // Compute complete row
+  arma::Mat<ValueType> row;
+  arma::Mat<ValueType> column;
 
-    arma::Mat<ValueType> newRow;
-    arma::Mat<ValueType> newCol;
+  // Reference row and column of ACA+ and their residuals
 
-    IndexRangeType rowIndexRange = {{row, row + 1}};
-    IndexRangeType columnIndexRange = columnClusterRange;
+  std::size_t referenceRow = NO_INDEX;
+  std::size_t referenceColumn = NO_INDEX;
+  arma::Mat<ValueType> referenceRowData;
+  arma::Mat<ValueType> referenceColumnData;
 
-    evaluateMatMinusLowRank(blockClusterTreeNode, rowIndexRange,
-                            columnIndexRange, newRow, A, B);
+  std::size_t nextRow = randomIndex(generator, usedRows);
 
-    arma::uword maxRowInd;
-    arma::uword maxColInd;
+  RealType frobeniusNormSquared = 0;
+  std::size_t rankCount = 0;
 
-    arma::Mat<typename ScalarTraits<ValueType>::RealType> absMat =
-        arma::abs(newRow);
+  // Largest pivot accepted so far. Pivots and residuals are compared to it
+  // rather than to an absolute threshold, so that the compression does not
+  // depend on the scaling of the kernel. Before the first pivot only exact
+  // zeros are rejected.
+  RealType pivotScale = 0;
+
+  while (rankCount < iterationLimit) {
+
+    std::size_t pivotRow;
+    std::size_t pivotColumn;
+
+    if (m_variant == ACA_PARTIAL_PIVOTING) {
+
+      if (nextRow == NO_INDEX)
+        break;
+
+      pivotRow = nextRow;
+      evaluateRow(blockClusterTreeNode, pivotRow, row, A, B, rankCount);
+      usedRows[pivotRow] = true;
+
+      pivotColumn = maxAbsIndex(row, usedColumns);
+      if (pivotColumn == NO_INDEX)
+        break;
+      if (isNegligible(std::abs(row(0, pivotColumn)), pivotScale)) {
+        // Row is effectively zero, restart from a random row
+        nextRow = randomIndex(generator, usedRows);
+        continue;
+      }
+
+      evaluateColumn(blockClusterTreeNode, pivotColumn, column, A, B,
+                     rankCount);
+    } else {
+
+      if (referenceRow == NO_INDEX) {
+        referenceRow = randomIndex(generator, usedRows);
+        if (referenceRow == NO_INDEX)
+          break;
+        evaluateRow(blockClusterTreeNode, referenceRow, referenceRowData, A, B,
+                    rankCount);
+      }
+      if (referenceColumn == NO_INDEX) {
+        referenceColumn = randomIndex(generator, usedColumns);
+        if (referenceColumn == NO_INDEX)
+          break;
+        evaluateColumn(blockClusterTreeNode, referenceColumn,
+                       referenceColumnData, A, B, rankCount);
+      }
+
+      std::size_t rowCandidate = maxAbsIndex(referenceColumnData, usedRows);
+      std::size_t columnCandidate = maxAbsIndex(referenceRowData, usedColumns);
+      if (rowCandidate == NO_INDEX || columnCandidate == NO_INDEX)
+        break;
+
+      RealType rowCandidateValue = std::abs(referenceColumnData(rowCandidate, 0));
+      RealType columnCandidateValue =
+          std::abs(referenceRowData(0, columnCandidate));
+
+      if (isNegligible(std::max(rowCandidateValue, columnCandidateValue),
+                       pivotScale)) {
+        // The residual vanishes on both references, so they cannot
+        // contribute any further pivots. Pick new ones.
+        usedRows[referenceRow] = true;
+        usedColumns[referenceColumn] = true;
+        referenceRow = referenceColumn = NO_INDEX;
+        continue;
+      }
+
+      if (columnCandidateValue >= rowCandidateValue) {
+        pivotColumn = columnCandidate;
+        evaluateColumn(blockClusterTreeNode, pivotColumn, column, A, B,
+                       rankCount);
+        pivotRow = maxAbsIndex(column, usedRows);
+        evaluateRow(blockClusterTreeNode, pivotRow, row, A, B, rankCount);
+      } else {
+        pivotRow = rowCandidate;
+        evaluateRow(blockClusterTreeNode, pivotRow, row, A, B, rankCount);
+        pivotColumn = maxAbsIndex(row, usedColumns);
+        evaluateColumn(blockClusterTreeNode, pivotColumn, column, A, B,
+                       rankCount);
+      }
+
+      usedRows[pivotRow] = true;
+      if (isNegligible(std::abs(row(0, pivotColumn)), pivotScale)) {
+        usedColumns[pivotColumn] = true;
+        continue;
+      }
+    }
 
-    if (absMat.max(maxRowInd, maxColInd) < 1E-12)
-      continue; // Row is effectively zero
+    usedColumns[pivotColumn] = true;
 
-    auto pivot = newRow(0, maxColInd);
+    pivotScale = std::max(pivotScale, RealType(std::abs(row(0, pivotColumn))));
+    row /= row(0, pivotColumn);
 
-    newRow = newRow / (pivot);
+    appendTerm(column, row, A, B, rankCount, frobeniusNormSquared);
+    rankCount++;
 
-    // Now evaluate column
+    RealType termNorm = arma::norm(column, "fro") * arma::norm(row, "fro");
+
+    if (m_variant == ACA_PARTIAL_PIVOTING) {
+      nextRow = maxAbsIndex(column, usedRows);
+    } else {
+      // Update the residuals of the references. A reference that has
+      // been used as a pivot is now zero and needs to be replaced.
+      referenceRowData -= column(referenceRow, 0) * row;
+      referenceColumnData -= column * row(0, referenceColumn);
+      if (usedRows[referenceRow])
+        referenceRow = NO_INDEX;
+      if (usedColumns[referenceColumn])
+        referenceColumn = NO_INDEX;
+    }
 
-    maxColInd += columnClusterRange[0]; // Map back to original variables
-    rowIndexRange = rowClusterRange;
-    columnIndexRange = {{maxColInd, maxColInd + 1}};
+    if (termNorm <= m_eps * std::sqrt(frobeniusNormSquared))
+      break;
+  }
 
-    evaluateMatMinusLowRank(blockClusterTreeNode, rowIndexRange,
-                            columnIndexRange, newCol, A, B);
+  A.resize(numberOfRows, rankCount);
+  B.resize(rankCount, numberOfColumns);
+}
 
-    auto frobeniousNorm = hMatrixData->frobeniusNorm();
+template <typename ValueType, int N>
+double HMatrixAcaCompressor<ValueType, N>::estimateBlockCost(
+    const BlockClusterTreeNode<N> &blockClusterTreeNode) const {
 
-    if (rankCount == A.n_cols) {
-      sizeMultiplier++;
-      A.insert_cols(sizeMultiplier * m_resizeThreshold, m_resizeThreshold);
-      B.insert_rows(sizeMultiplier * m_resizeThreshold, m_resizeThreshold);
-    }
+  if (!blockClusterTreeNode.data().admissible)
+    return m_hMatrixDenseCompressor.estimateBlockCost(blockClusterTreeNode);
 
-    A.col(rankCount) = newCol;
-    B.row(rankCount) = newRow;
+  IndexRangeType rowClusterRange;
+  IndexRangeType columnClusterRange;
+  std::size_t numberOfRows;
+  std::size_t numberOfColumns;
 
-    rankCount++;
+  getBlockClusterTreeNodeDimensions(blockClusterTreeNode, rowClusterRange,
+                                    columnClusterRange, numberOfRows,
+                                    numberOfColumns);
 
-    if (arma::norm(newCol, 2) * arma::norm(newRow, 2) < m_eps * frobeniousNorm)
-      break;
-  }
-  if (A.n_cols - rankCount > 0) {
-    A.shed_cols(rankCount, A.n_cols - 1);
-    B.shed_rows(rankCount, B.n_rows - 1);
-  }
+  std::size_t rank = std::min(static_cast<std::size_t>(m_maxRank),
+                              std::min(numberOfRows, numberOfColumns));
+
+  return static_cast<double>(numberOfRows + numberOfColumns) * rank;
 }
 
 template <typename ValueType, int N>
 HMatrixAcaCompressor<ValueType, N>::HMatrixAcaCompressor(
     const DataAccessor<ValueType, N> &dataAccessor, double eps,
-    unsigned int maxRank, unsigned int resizeThreshold)
+    unsigned int maxRank, AcaVariant variant, unsigned int seed,
+    unsigned int resizeThreshold)
     : m_dataAccessor(dataAccessor), m_eps(eps), m_maxRank(maxRank),
-      m_resizeThreshold(resizeThreshold),
+      m_variant(variant), m_seed(seed),
+      m_resizeThreshold(std::max(resizeThreshold, 1u)),
       m_hMatrixDenseCompressor(dataAccessor) {}
 
 template <typename ValueType, int N>
@@ -126,7 +233,7 @@ void HMatrixAcaCompressor<ValueType, N>::evaluateMatMinusLowRank(
     const BlockClusterTreeNode<N> &blockClusterTreeNode,
     const IndexRangeType &rowIndexRange, const IndexRangeType &columnIndexRange,
     arma::Mat<ValueType> &data, const arma::Mat<ValueType> &A,
-    const arma::Mat<ValueType> &B) const {
+    const arma::Mat<ValueType> &B, std::size_t rank) const {
 
   auto rowClusterRange =
       blockClusterTreeNode.data().rowClusterTreeNode->data().indexRange;
@@ -136,44 +243,131 @@ void HMatrixAcaCompressor<ValueType, N>::evaluateMatMinusLowRank(
   m_dataAccessor.computeMatrixBlock(rowIndexRange, columnIndexRange,
                                     blockClusterTreeNode, data);
 
+  if (rank == 0)
+    return;
+
   auto rowStart = rowIndexRange[0] - rowClusterRange[0];
   auto rowEnd = rowIndexRange[1] - rowClusterRange[0];
 
   auto colStart = columnIndexRange[0] - columnClusterRange[0];
   auto colEnd = columnIndexRange[1] - columnClusterRange[0];
 
-  data = data - A.submat(rowStart, 0, rowEnd - 1, A.n_cols - 1) *
-                    B.submat(0, colStart, B.n_rows - 1, colEnd - 1);
+  // Subtract all previous terms at once (a single GEMV/GEMM call)
+  data -= A.submat(rowStart, 0, rowEnd - 1, rank - 1) *
+          B.submat(0, colStart, rank - 1, colEnd - 1);
 }
 
 template <typename ValueType, int N>
-std::size_t HMatrixAcaCompressor<ValueType, N>::randomIndex(
-    const IndexRangeType &range, std::set<std::size_t> &previousIndices) {
+void HMatrixAcaCompressor<ValueType, N>::evaluateRow(
+    const BlockClusterTreeNode<N> &blockClusterTreeNode, std::size_t row,
+    arma::Mat<ValueType> &data, const arma::Mat<ValueType> &A,
+    const arma::Mat<ValueType> &B, std::size_t rank) const {
 
-  std::size_t numberOfPossibleIndices =
-      range[1] - range[0] - previousIndices.size();
-  static std::random_device generator;
-  std::uniform_int_distribution<std::size_t> distribution(
-      0, numberOfPossibleIndices - 1);
+  auto rowClusterRange =
+      blockClusterTreeNode.data().rowClusterTreeNode->data().indexRange;
+  auto columnClusterRange =
+      blockClusterTreeNode.data().columnClusterTreeNode->data().indexRange;
 
-  std::size_t ind = distribution(generator); // New random position
+  IndexRangeType rowIndexRange = {
+      {rowClusterRange[0] + row, rowClusterRange[0] + row + 1}};
 
-  // Turn the random position into a previously not used index in the range.
+  evaluateMatMinusLowRank(blockClusterTreeNode, rowIndexRange,
+                          columnClusterRange, data, A, B, rank);
+}
+
+template <typename ValueType, int N>
+void HMatrixAcaCompressor<ValueType, N>::evaluateColumn(
+    const BlockClusterTreeNode<N> &blockClusterTreeNode, std::size_t column,
+    arma::Mat<ValueType> &data, const arma::Mat<ValueType> &A,
+    const arma::Mat<ValueType> &B, std::size_t rank) const {
+
+  auto rowClusterRange =
+      blockClusterTreeNode.data().rowClusterTreeNode->data().indexRange;
+  auto columnClusterRange =
+      blockClusterTreeNode.data().columnClusterTreeNode->data().indexRange;
+
+  IndexRangeType columnIndexRange = {
+      {columnClusterRange[0] + column, columnClusterRange[0] + column + 1}};
+
+  evaluateMatMinusLowRank(blockClusterTreeNode, rowClusterRange,
+                          columnIndexRange, data, A, B, rank);
+}
+
+template <typename ValueType, int N>
+void HMatrixAcaCompressor<ValueType, N>::appendTerm(
+    const arma::Mat<ValueType> &a, const arma::Mat<ValueType> &b,
+    arma::Mat<ValueType> &A, arma::Mat<ValueType> &B, std::size_t rank,
+    RealType &frobeniusNormSquared) {
+
+  if (rank == A.n_cols) {
+    std::size_t newCapacity = std::max<std::size_t>(1, 2 * A.n_cols);
+    A.resize(A.n_rows, newCapacity);
+    B.resize(newCapacity, B.n_cols);
+  }
+
+  // ||S + a * b||^2 = ||S||^2 + 2 Re <S, a * b> + ||a||^2 ||b||^2, where
+  // <S, a * b> = sum_l (a_l^H a) (b b_l^H) for S = sum_l a_l * b_l.
+
+  if (rank > 0) {
+    arma::Mat<ValueType> aProducts = A.cols(0, rank - 1).t() * a;
+    arma::Mat<ValueType> bProducts = arma::conj(B.rows(0, rank - 1) * b.t());
+    frobeniusNormSquared += 2 * std::real(arma::accu(aProducts % bProducts));
+  }
+
+  RealType aNorm = arma::norm(a, "fro");
+  RealType bNorm = arma::norm(b, "fro");
+  frobeniusNormSquared += aNorm * aNorm * bNorm * bNorm;
+  frobeniusNormSquared = std::max(frobeniusNormSquared, RealType(0));
 
-  std::size_t newIndex = range[0];
+  A.col(rank) = a;
+  B.row(rank) = b;
+}
 
-  std::size_t count = 0;
-  while (count <= ind) {
-    if (!previousIndices.count(newIndex)) {
-      count++;
-      if (count <= ind)
-        newIndex++;
+template <typename ValueType, int N>
+std::size_t
+HMatrixAcaCompressor<ValueType, N>::maxAbsIndex(const arma::Mat<ValueType> &data,
+                                                const std::vector<bool> &excluded) {
+
+  std::size_t result = NO_INDEX;
+  RealType maxValue = -1;
+  for (std::size_t i = 0; i < data.n_elem; ++i) {
+    if (excluded[i])
       continue;
+    RealType value = std::abs(data(i));
+    if (value > maxValue) {
+      maxValue = value;
+      result = i;
     }
-    newIndex++;
   }
-  previousIndices.insert(newIndex);
-  return newIndex;
+  return result;
+}
+
+template <typename ValueType, int N>
+bool HMatrixAcaCompressor<ValueType, N>::isNegligible(RealType value,
+                                                      RealType scale) {
+  return value <= RELATIVE_ZERO_PIVOT * scale;
+}
+
+template <typename ValueType, int N>
+std::size_t
+HMatrixAcaCompressor<ValueType, N>::randomIndex(std::mt19937 &generator,
+                                                const std::vector<bool> &excluded) {
+
+  std::size_t numberOfPossibleIndices =
+      std::count(begin(excluded), end(excluded), false);
+  if (numberOfPossibleIndices == 0)
+    return NO_INDEX;
+
+  std::uniform_int_distribution<std::size_t> distribution(
+      0, numberOfPossibleIndices - 1);
+  std::size_t position = distribution(generator);
+
+  // Turn the random position into a previously not used index.
+
+  for (std::size_t i = 0; i < excluded.size(); ++i)
+    if (!excluded[i] && position-- == 0)
+      return i;
+  return NO_INDEX;
 }
 }
 
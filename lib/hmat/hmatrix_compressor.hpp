@@ -16,7 +16,14 @@ public:
   virtual void
   compressBlock(const BlockClusterTreeNode<N> &blockClusterTreeNode,
                 shared_ptr<HMatrixData<ValueType>> &hMatrixData) const = 0;
+
+  // Estimated number of matrix entries evaluated by compressBlock(). Only
+  // used to schedule the most expensive blocks first.
+  virtual double
+  estimateBlockCost(const BlockClusterTreeNode<N> &blockClusterTreeNode) const;
 };
 }
 
+#include "hmatrix_compressor_impl.hpp"
+
 #endif
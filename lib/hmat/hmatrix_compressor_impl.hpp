@@ -0,0 +1,27 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_COMPRESSOR_IMPL_HPP
+#define HMAT_HMATRIX_COMPRESSOR_IMPL_HPP
+
+#include "hmatrix_compressor.hpp"
+
+namespace hmat {
+
+template <typename ValueType, int N>
+double HMatrixCompressor<ValueType, N>::estimateBlockCost(
+    const BlockClusterTreeNode<N> &blockClusterTreeNode) const {
+
+  IndexRangeType rowClusterRange;
+  IndexRangeType columnClusterRange;
+  std::size_t numberOfRows;
+  std::size_t numberOfColumns;
+
+  getBlockClusterTreeNodeDimensions(blockClusterTreeNode, rowClusterRange,
+                                    columnClusterRange, numberOfRows,
+                                    numberOfColumns);
+
+  return static_cast<double>(numberOfRows) * numberOfColumns;
+}
+}
+
+#endif
@@ -19,6 +19,20 @@ public:
                      arma::subview<ValueType> &Y, TransposeMode trans,
                      ValueType alpha, ValueType beta) const = 0;
 
+  // Two-stage application used by HMatrix::apply(). The first stage computes
+  // any intermediate product not depending on the output indices. The second
+  // stage adds op(block)(rowRange, :) * X to Y, where op is determined by
+  // trans and Y has rowRange[1] - rowRange[0] rows.
+  virtual void computeApplyWorkspace(const arma::subview<ValueType> &X,
+                                     arma::Mat<ValueType> &workspace,
+                                     TransposeMode trans) const = 0;
+
+  virtual void applyToRows(const arma::subview<ValueType> &X,
+                           const arma::Mat<ValueType> &workspace,
+                           arma::subview<ValueType> &Y,
+                           const IndexRangeType &rowRange,
+                           TransposeMode trans) const = 0;
+
   virtual int rows() const = 0;
   virtual int cols() const = 0;
   virtual int rank() const = 0;
@@ -12,6 +12,12 @@ namespace hmat {
 template <typename ValueType>
 class HMatrixDenseData : public HMatrixData<ValueType> {
 public:
+  HMatrixDenseData();
+  // Use external memory (e.g. a memory-mapped file) for the matrix. The
+  // memory must outlive the object; it is copied only if the matrix is
+  // resized.
+  HMatrixDenseData(ValueType *data, int rows, int cols);
+
   void apply(const arma::Mat<ValueType> &X, arma::Mat<ValueType> &Y,
              TransposeMode trans, ValueType alpha, ValueType beta) const
       override;
@@ -20,6 +26,15 @@ public:
              TransposeMode trans, ValueType alpha, ValueType beta) const
       override;
 
+  void computeApplyWorkspace(const arma::subview<ValueType> &X,
+                             arma::Mat<ValueType> &workspace,
+                             TransposeMode trans) const override;
+
+  void applyToRows(const arma::subview<ValueType> &X,
+                   const arma::Mat<ValueType> &workspace,
+                   arma::subview<ValueType> &Y, const IndexRangeType &rowRange,
+                   TransposeMode trans) const override;
+
   const arma::Mat<ValueType> &A() const;
   arma::Mat<ValueType> &A();
 
@@ -10,6 +10,13 @@
 
 namespace hmat {
 
+template <typename ValueType> HMatrixDenseData<ValueType>::HMatrixDenseData() {}
+
+template <typename ValueType>
+HMatrixDenseData<ValueType>::HMatrixDenseData(ValueType *data, int rows,
+                                              int cols)
+    : m_A(data, rows, cols, false /* copy_aux_mem */, false /* strict */) {}
+
 template <typename ValueType>
 void HMatrixDenseData<ValueType>::apply(const arma::Mat<ValueType> &X,
                                         arma::Mat<ValueType> &Y,
@@ -44,6 +51,32 @@ void HMatrixDenseData<ValueType>::apply(const arma::subview<ValueType> &X,
     Y = alpha * m_A.t() * X + beta * Y;
 }
 
+template <typename ValueType>
+void HMatrixDenseData<ValueType>::computeApplyWorkspace(
+    const arma::subview<ValueType> &X, arma::Mat<ValueType> &workspace,
+    TransposeMode trans) const {
+  workspace.reset();
+}
+
+template <typename ValueType>
+void HMatrixDenseData<ValueType>::applyToRows(
+    const arma::subview<ValueType> &X, const arma::Mat<ValueType> &workspace,
+    arma::subview<ValueType> &Y, const IndexRangeType &rowRange,
+    TransposeMode trans) const {
+
+  auto first = rowRange[0];
+  auto last = rowRange[1] - 1;
+
+  if (trans == TransposeMode::NOTRANS)
+    Y += m_A.rows(first, last) * X;
+  else if (trans == TransposeMode::TRANS)
+    Y += arma::strans(m_A.cols(first, last)) * X;
+  else if (trans == TransposeMode::CONJ)
+    Y += arma::conj(m_A.rows(first, last)) * X;
+  else
+    Y += arma::trans(m_A.cols(first, last)) * X;
+}
+
 template <typename ValueType>
 const arma::Mat<ValueType> &HMatrixDenseData<ValueType>::A() const {
   return m_A;
@@ -6,8 +6,18 @@
 #include "hmatrix.hpp"
 #include "hmatrix_data.hpp"
 #include "hmatrix_dense_data.hpp"
+#include "hmatrix_low_rank_data.hpp"
 
 #include <algorithm>
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include <tbb/atomic.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_scheduler_init.h>
 
 namespace hmat {
 
@@ -24,6 +34,34 @@ HMatrix<ValueType, N>::HMatrix(
   initialize(hMatrixCompressor);
 }
 
+template <typename ValueType, int N>
+HMatrix<ValueType, N>::HMatrix(
+    const shared_ptr<BlockClusterTree<N>> &blockClusterTree,
+    const std::vector<std::size_t> &leafFlatNodes,
+    const std::vector<shared_ptr<HMatrixData<ValueType>>> &leafData)
+    : m_blockClusterTree(blockClusterTree), m_leafNodes(leafFlatNodes),
+      m_leafData(leafData) {
+
+  if (leafFlatNodes.size() != leafData.size())
+    throw std::invalid_argument("HMatrix::HMatrix(): "
+                                "leafFlatNodes and leafData differ in size");
+  const auto &flatNodes = m_blockClusterTree->flatNodes();
+  for (std::size_t leaf = 0; leaf < m_leafNodes.size(); ++leaf) {
+    if (m_leafNodes[leaf] >= flatNodes.size() || !m_leafData[leaf])
+      throw std::invalid_argument("HMatrix::HMatrix(): invalid leaf");
+    const FlatBlockClusterTreeNode &node = flatNodes[m_leafNodes[leaf]];
+    if (static_cast<std::size_t>(m_leafData[leaf]->rows()) !=
+            node.rowIndexRange[1] - node.rowIndexRange[0] ||
+        static_cast<std::size_t>(m_leafData[leaf]->cols()) !=
+            node.columnIndexRange[1] - node.columnIndexRange[0])
+      throw std::invalid_argument("HMatrix::HMatrix(): "
+                                  "leaf data has wrong dimensions");
+  }
+
+  initializeOutputBlocks(ROW, m_rowBlocks);
+  initializeOutputBlocks(COL, m_columnBlocks);
+}
+
 template <typename ValueType, int N>
 std::size_t HMatrix<ValueType, N>::rows() const {
   return m_blockClusterTree->rows();
@@ -40,45 +78,298 @@ void HMatrix<ValueType, N>::initialize(
 
   reset();
 
-  for (auto node : m_blockClusterTree->leafNodes()) {
-    shared_ptr<HMatrixData<ValueType>> nodeData;
-    hMatrixCompressor.compressBlock(*node, nodeData);
-    m_hMatrixData[node] = nodeData;
-  }
+  const auto &leafNodes = m_blockClusterTree->leafNodes();
+  std::size_t numberOfLeafs = leafNodes.size();
+  m_leafNodes.resize(numberOfLeafs);
+  for (std::size_t leaf = 0; leaf < numberOfLeafs; ++leaf)
+    m_leafNodes[leaf] = leafNodes[leaf].flatNode();
+
+  // Sort the leafs by decreasing cost so that the large dense blocks
+  // do not end up being compressed last by a single thread.
+
+  std::vector<double> costs(numberOfLeafs);
+  for (std::size_t i = 0; i < numberOfLeafs; ++i)
+    costs[i] = hMatrixCompressor.estimateBlockCost(leafNodes[i]);
+
+  std::vector<std::size_t> jobs(numberOfLeafs);
+  for (std::size_t i = 0; i < numberOfLeafs; ++i)
+    jobs[i] = i;
+  std::stable_sort(begin(jobs), end(jobs),
+                   [&costs](std::size_t first, std::size_t second) {
+    return costs[first] > costs[second];
+  });
+
+  // Each iteration takes the next job from the sorted list instead of the
+  // job with its own index. This keeps the processing order independent of
+  // how the scheduler splits the range. The number of threads is controlled
+  // by the caller through tbb::task_scheduler_init.
+
+  m_leafData.resize(numberOfLeafs);
+  tbb::atomic<std::size_t> nextJob;
+  nextJob = 0;
+
+  tbb::parallel_for(tbb::blocked_range<std::size_t>(0, numberOfLeafs),
+                    [&](const tbb::blocked_range<std::size_t> &r) {
+    for (std::size_t i = r.begin(); i != r.end(); ++i) {
+      std::size_t job = jobs[nextJob++];
+      hMatrixCompressor.compressBlock(leafNodes[job], m_leafData[job]);
+    }
+  });
+
+  initializeOutputBlocks(ROW, m_rowBlocks);
+  initializeOutputBlocks(COL, m_columnBlocks);
 }
+
 template <typename ValueType, int N> void HMatrix<ValueType, N>::reset() {
-  m_hMatrixData.clear();
+  m_leafNodes.clear();
+  m_leafData.clear();
+  m_rowBlocks.clear();
+  m_columnBlocks.clear();
 }
 
 template <typename ValueType, int N>
 bool HMatrix<ValueType, N>::isInitialized() const {
-  return (!m_hMatrixData.empty());
+  return (!m_leafData.empty());
 }
 
 template <typename ValueType, int N>
-arma::Mat<ValueType>
-HMatrix<ValueType, N>::permuteMatToHMatDofs(const arma::Mat<ValueType> &mat,
-                                            RowColSelector rowOrColumn) const {
+void HMatrix<ValueType, N>::recompress(double eps, bool coarsen) {
+
+  tbb::parallel_for(tbb::blocked_range<std::size_t>(0, m_leafData.size()),
+                    [&](const tbb::blocked_range<std::size_t> &r) {
+    for (std::size_t leaf = r.begin(); leaf != r.end(); ++leaf) {
+      auto lowRankData =
+          dynamic_cast<HMatrixLowRankData<ValueType> *>(m_leafData[leaf].get());
+      if (lowRankData)
+        lowRankData->recompress(eps);
+    }
+  });
 
-  arma::Mat<ValueType> permutedDofs(mat.n_rows, mat.n_cols);
+  if (!coarsen)
+    return;
 
-  shared_ptr<const ClusterTree<N>> clusterTree;
+  // Position in m_leafData of the data of each flat node.
 
+  std::vector<std::size_t> leafIndices(m_blockClusterTree->flatNodes().size(),
+                                       FlatBlockClusterTreeNode::NONE);
+  for (std::size_t leaf = 0; leaf < m_leafNodes.size(); ++leaf)
+    leafIndices[m_leafNodes[leaf]] = leaf;
+
+  coarsenBlock(0, eps, leafIndices);
+
+  // Remove the leafs that were merged into their parents.
+
+  std::size_t numberOfLeafs = 0;
+  for (std::size_t leaf = 0; leaf < m_leafNodes.size(); ++leaf)
+    if (m_leafData[leaf]) {
+      m_leafNodes[numberOfLeafs] = m_leafNodes[leaf];
+      m_leafData[numberOfLeafs] = m_leafData[leaf];
+      ++numberOfLeafs;
+    }
+  m_leafNodes.resize(numberOfLeafs);
+  m_leafData.resize(numberOfLeafs);
+
+  initializeOutputBlocks(ROW, m_rowBlocks);
+  initializeOutputBlocks(COL, m_columnBlocks);
+}
+
+template <typename ValueType, int N>
+bool HMatrix<ValueType, N>::coarsenBlock(std::size_t flatNode, double eps,
+                                         std::vector<std::size_t> &leafIndices) {
+
+  // Returns true if the node is now a low-rank leaf of the H-matrix.
+
+  const auto &flatNodes = m_blockClusterTree->flatNodes();
+  const FlatBlockClusterTreeNode &node = flatNodes[flatNode];
+
+  if (node.isLeaf())
+    return (leafIndices[flatNode] != FlatBlockClusterTreeNode::NONE &&
+            dynamic_cast<HMatrixLowRankData<ValueType> *>(
+                m_leafData[leafIndices[flatNode]].get()));
+
+  bool allChildrenLowRank = true;
+  for (int i = 0; i < N * N; ++i)
+    allChildrenLowRank = coarsenBlock(node.firstChild + i, eps, leafIndices) &&
+                         allChildrenLowRank;
+  if (!allChildrenLowRank)
+    return false;
+
+  // Embed the factors of the children into factors of the parent block.
+
+  std::size_t numberOfRows = node.rowIndexRange[1] - node.rowIndexRange[0];
+  std::size_t numberOfColumns =
+      node.columnIndexRange[1] - node.columnIndexRange[0];
+
+  std::size_t totalRank = 0;
+  double childrenMemSizeKb = 0;
+  for (int i = 0; i < N * N; ++i) {
+    const auto &childData = m_leafData[leafIndices[node.firstChild + i]];
+    totalRank += childData->rank();
+    childrenMemSizeKb += childData->memSizeKb();
+  }
+
+  shared_ptr<HMatrixLowRankData<ValueType>> mergedData(
+      new HMatrixLowRankData<ValueType>());
+  mergedData->A().zeros(numberOfRows, totalRank);
+  mergedData->B().zeros(totalRank, numberOfColumns);
+
+  std::size_t rankOffset = 0;
+  for (int i = 0; i < N * N; ++i) {
+    const FlatBlockClusterTreeNode &child = flatNodes[node.firstChild + i];
+    const auto &childData = static_cast<const HMatrixLowRankData<ValueType> &>(
+        *m_leafData[leafIndices[node.firstChild + i]]);
+    std::size_t rank = childData.rank();
+    if (rank == 0)
+      continue;
+    std::size_t rowOffset = child.rowIndexRange[0] - node.rowIndexRange[0];
+    std::size_t columnOffset =
+        child.columnIndexRange[0] - node.columnIndexRange[0];
+    mergedData->A().submat(rowOffset, rankOffset,
+                           rowOffset + childData.rows() - 1,
+                           rankOffset + rank - 1) = childData.A();
+    mergedData->B().submat(rankOffset, columnOffset, rankOffset + rank - 1,
+                           columnOffset + childData.cols() - 1) = childData.B();
+    rankOffset += rank;
+  }
+
+  mergedData->recompress(eps);
+
+  if (mergedData->memSizeKb() > childrenMemSizeKb)
+    return false;
+
+  for (int i = 0; i < N * N; ++i) {
+    m_leafData[leafIndices[node.firstChild + i]].reset();
+    leafIndices[node.firstChild + i] = FlatBlockClusterTreeNode::NONE;
+  }
+
+  leafIndices[flatNode] = m_leafNodes.size();
+  m_leafNodes.push_back(flatNode);
+  m_leafData.push_back(mergedData);
+  return true;
+}
+
+template <typename ValueType, int N>
+double HMatrix<ValueType, N>::memSizeKb() const {
+  double result = 0;
+  for (const auto &data : m_leafData)
+    result += data->memSizeKb();
+  return result;
+}
+
+template <typename ValueType, int N>
+std::size_t HMatrix<ValueType, N>::numberOfLeafs() const {
+  return m_leafData.size();
+}
+
+template <typename ValueType, int N>
+shared_ptr<const BlockClusterTree<N>>
+HMatrix<ValueType, N>::blockClusterTree() const {
+  return m_blockClusterTree;
+}
+
+template <typename ValueType, int N>
+std::size_t HMatrix<ValueType, N>::leafFlatNode(std::size_t leaf) const {
+  return m_leafNodes.at(leaf);
+}
+
+template <typename ValueType, int N>
+shared_ptr<const HMatrixData<ValueType>>
+HMatrix<ValueType, N>::leafData(std::size_t leaf) const {
+  return m_leafData.at(leaf);
+}
+
+template <typename ValueType, int N>
+shared_ptr<const ClusterTree<N>>
+HMatrix<ValueType, N>::clusterTree(RowColSelector rowOrColumn) const {
   if (rowOrColumn == ROW)
-    clusterTree = m_blockClusterTree->rowClusterTree();
+    return m_blockClusterTree->rowClusterTree();
   else
-    clusterTree = m_blockClusterTree->columnClusterTree();
+    return m_blockClusterTree->columnClusterTree();
+}
 
-  if (clusterTree->numberOfDofs() != mat.n_rows)
-    throw std::runtime_error("HMatrix::permuteMatToHMatDofs: "
-                             "Input matrix has wrong number of rows.");
+template <typename ValueType, int N>
+void HMatrix<ValueType, N>::initializeOutputBlocks(
+    RowColSelector rowOrColumn, std::vector<OutputBlock> &outputBlocks) const {
+
+  // Cut the cluster tree into disjoint clusters small enough to give each
+  // thread several of them to work on. Leafs of the block cluster tree whose
+  // output cluster is larger than a cut cluster are split between several
+  // output blocks.
+
+  auto tree = clusterTree(rowOrColumn);
+  std::size_t maxBlockSize = std::max<std::size_t>(
+      1, tree->numberOfDofs() /
+             (16 * tbb::task_scheduler_init::default_num_threads()));
+
+  outputBlocks.clear();
+
+  std::function<void(const shared_ptr<const ClusterTreeNode<N>> &)> cutImpl;
+  cutImpl = [&outputBlocks, &cutImpl, maxBlockSize](
+      const shared_ptr<const ClusterTreeNode<N>> &node) {
+    const auto &indexRange = node->data().indexRange;
+    if (node->isLeaf() || indexRange[1] - indexRange[0] <= maxBlockSize) {
+      outputBlocks.push_back(OutputBlock());
+      outputBlocks.back().outputRange = indexRange;
+    } else
+      for (int i = 0; i < N; ++i)
+        cutImpl(node->child(i));
+  };
+  cutImpl(tree->root());
+
+  // The cut clusters are ordered by their first index.
+
+  std::vector<std::size_t> blockStarts(outputBlocks.size());
+  for (std::size_t i = 0; i < outputBlocks.size(); ++i)
+    blockStarts[i] = outputBlocks[i].outputRange[0];
+
+  const auto &flatNodes = m_blockClusterTree->flatNodes();
+  for (std::size_t leaf = 0; leaf < m_leafNodes.size(); ++leaf) {
+    const FlatBlockClusterTreeNode &node = flatNodes[m_leafNodes[leaf]];
+    const IndexRangeType &outputRange =
+        (rowOrColumn == ROW) ? node.rowIndexRange : node.columnIndexRange;
+    std::size_t block =
+        std::upper_bound(begin(blockStarts), end(blockStarts), outputRange[0]) -
+        begin(blockStarts) - 1;
+    for (; block < outputBlocks.size() && blockStarts[block] < outputRange[1];
+         ++block)
+      outputBlocks[block].leafIndices.push_back(leaf);
+  }
+}
 
-  for (std::size_t i = 0; i < mat.n_rows; ++i) {
-    auto permutedIndex = clusterTree->mapOriginalDofToHMatDof(i);
-    for (std::size_t j = 0; j < mat.n_cols; ++j)
-      permutedDofs(permutedIndex, j) = mat(i, j);
+template <typename ValueType, int N>
+void HMatrix<ValueType, N>::permuteRows(
+    const arma::Mat<ValueType> &mat, const std::vector<std::size_t> &sourceRows,
+    arma::Mat<ValueType> &result, ValueType alpha, ValueType beta) const {
+
+  // result.row(i) = alpha * mat.row(sourceRows[i]) + beta * result.row(i),
+  // implemented as a column-wise gather so that the writes are contiguous.
+
+  const std::size_t numberOfRows = sourceRows.size();
+  for (std::size_t j = 0; j < mat.n_cols; ++j) {
+    const ValueType *in = mat.colptr(j);
+    ValueType *out = result.colptr(j);
+    if (beta == ValueType(0))
+      for (std::size_t i = 0; i < numberOfRows; ++i)
+        out[i] = alpha * in[sourceRows[i]];
+    else
+      for (std::size_t i = 0; i < numberOfRows; ++i)
+        out[i] = alpha * in[sourceRows[i]] + beta * out[i];
   }
+}
 
+template <typename ValueType, int N>
+arma::Mat<ValueType>
+HMatrix<ValueType, N>::permuteMatToHMatDofs(const arma::Mat<ValueType> &mat,
+                                            RowColSelector rowOrColumn) const {
+
+  auto tree = clusterTree(rowOrColumn);
+
+  if (tree->numberOfDofs() != mat.n_rows)
+    throw std::runtime_error("HMatrix::permuteMatToHMatDofs: "
+                             "Input matrix has wrong number of rows.");
+
+  arma::Mat<ValueType> permutedDofs(mat.n_rows, mat.n_cols);
+  permuteRows(mat, tree->hMatDofToOriginalDofMap(), permutedDofs, 1, 0);
   return permutedDofs;
 }
 
@@ -86,25 +377,14 @@ template <typename ValueType, int N>
 arma::Mat<ValueType> HMatrix<ValueType, N>::permuteMatToOriginalDofs(
     const arma::Mat<ValueType> &mat, RowColSelector rowOrColumn) const {
 
-  arma::Mat<ValueType> originalDofs(mat.n_rows, mat.n_cols);
-
-  shared_ptr<const ClusterTree<N>> clusterTree;
-
-  if (rowOrColumn == ROW)
-    clusterTree = m_blockClusterTree->rowClusterTree();
-  else
-    clusterTree = m_blockClusterTree->columnClusterTree();
+  auto tree = clusterTree(rowOrColumn);
 
-  if (clusterTree->numberOfDofs() != mat.n_rows)
+  if (tree->numberOfDofs() != mat.n_rows)
     throw std::runtime_error("HMatrix::permuteMatToOriginalDofs: "
                              "Input matrix has wrong number of rows.");
 
-  for (std::size_t i = 0; i < mat.n_rows; ++i) {
-    auto originalIndex = clusterTree->mapHMatDofToOriginalDof(i);
-    for (std::size_t j = 0; j < mat.n_cols; ++j)
-      originalDofs(originalIndex, j) = mat(i, j);
-  }
-
+  arma::Mat<ValueType> originalDofs(mat.n_rows, mat.n_cols);
+  permuteRows(mat, tree->originalDofToHMatDofMap(), originalDofs, 1, 0);
   return originalDofs;
 }
 
@@ -113,47 +393,74 @@ void HMatrix<ValueType, N>::apply(const arma::Mat<ValueType> &X,
                                   arma::Mat<ValueType> &Y, TransposeMode trans,
                                   ValueType alpha, ValueType beta) const {
 
-  if (beta == ValueType(0))
-    Y.zeros();
-  else
-    Y *= beta;
-
-  arma::Mat<ValueType> xPermuted;
-  arma::Mat<ValueType> yPermuted;
-
-  if (trans == TransposeMode::NOTRANS) {
-
-    xPermuted = permuteMatToHMatDofs(X, COL);
-    yPermuted = permuteMatToHMatDofs(Y, ROW);
-  } else {
-    xPermuted = permuteMatToHMatDofs(X, ROW);
-    yPermuted = permuteMatToHMatDofs(Y, COL);
-  }
-
-  std::for_each(begin(m_hMatrixData), end(m_hMatrixData),
-                [trans, alpha, beta, &xPermuted, &yPermuted, this](
-                    const std::pair<shared_ptr<BlockClusterTreeNode<N>>,
-                                    shared_ptr<HMatrixData<ValueType>>>
-                        elem) {
-
-    IndexRangeType inputRange;
-    IndexRangeType outputRange;
-    if (trans == TransposeMode::NOTRANS) {
-      inputRange = elem.first->data().columnClusterTreeNode->data().indexRange;
-      outputRange = elem.first->data().rowClusterTreeNode->data().indexRange;
-    } else {
-      inputRange = elem.first->data().rowClusterTreeNode->data().indexRange;
-      outputRange = elem.first->data().columnClusterTreeNode->data().indexRange;
+  const bool transposed = (trans == TRANS || trans == CONJTRANS);
+  auto inputTree = clusterTree(transposed ? ROW : COL);
+  auto outputTree = clusterTree(transposed ? COL : ROW);
+  const std::vector<OutputBlock> &outputBlocks =
+      transposed ? m_columnBlocks : m_rowBlocks;
+
+  if (X.n_rows != inputTree->numberOfDofs() ||
+      Y.n_rows != outputTree->numberOfDofs() || X.n_cols != Y.n_cols)
+    throw std::runtime_error("HMatrix::apply: "
+                             "Input matrices have incompatible dimensions.");
+
+  const auto &flatNodes = m_blockClusterTree->flatNodes();
+
+  // All columns of X are processed together, so that the leaf
+  // operations below are matrix-matrix products.
+
+  ApplyBuffers buffers;
+  buffers.x.set_size(X.n_rows, X.n_cols);
+  permuteRows(X, inputTree->hMatDofToOriginalDofMap(), buffers.x, 1, 0);
+  buffers.y.zeros(Y.n_rows, Y.n_cols);
+  buffers.workspaces.resize(m_leafData.size());
+
+  // First stage: products that do not involve the output indices, such as
+  // B * x for a low-rank block A * B. Each leaf writes only its own
+  // workspace.
+
+  tbb::parallel_for(tbb::blocked_range<std::size_t>(0, m_leafData.size()),
+                    [&](const tbb::blocked_range<std::size_t> &r) {
+    for (std::size_t leaf = r.begin(); leaf != r.end(); ++leaf) {
+      const FlatBlockClusterTreeNode &node = flatNodes[m_leafNodes[leaf]];
+      const IndexRangeType &inputRange =
+          transposed ? node.rowIndexRange : node.columnIndexRange;
+      const arma::subview<ValueType> xData =
+          buffers.x.rows(inputRange[0], inputRange[1] - 1);
+      m_leafData[leaf]->computeApplyWorkspace(xData, buffers.workspaces[leaf],
+                                              trans);
     }
+  });
 
-    arma::subview<ValueType> xData =
-        xPermuted.rows(inputRange[0], inputRange[1] - 1);
-    arma::subview<ValueType> yData =
-        yPermuted.rows(outputRange[0], outputRange[1] - 1);
-    elem.second->apply(xData, yData, trans, alpha, 1);
+  // Second stage: each output block is owned by a single task, which adds
+  // the contributions of all leafs overlapping it.
+
+  tbb::parallel_for(tbb::blocked_range<std::size_t>(0, outputBlocks.size()),
+                    [&](const tbb::blocked_range<std::size_t> &r) {
+    for (std::size_t block = r.begin(); block != r.end(); ++block) {
+      const IndexRangeType &blockRange = outputBlocks[block].outputRange;
+      for (auto leaf : outputBlocks[block].leafIndices) {
+        const FlatBlockClusterTreeNode &node = flatNodes[m_leafNodes[leaf]];
+        const IndexRangeType &inputRange =
+            transposed ? node.rowIndexRange : node.columnIndexRange;
+        const IndexRangeType &outputRange =
+            transposed ? node.columnIndexRange : node.rowIndexRange;
+        std::size_t start = std::max(blockRange[0], outputRange[0]);
+        std::size_t stop = std::min(blockRange[1], outputRange[1]);
+        IndexRangeType localRange = {
+            {start - outputRange[0], stop - outputRange[0]}};
+
+        const arma::subview<ValueType> xData =
+            buffers.x.rows(inputRange[0], inputRange[1] - 1);
+        arma::subview<ValueType> yData = buffers.y.rows(start, stop - 1);
+        m_leafData[leaf]->applyToRows(xData, buffers.workspaces[leaf], yData,
+                                      localRange, trans);
+      }
+    }
   });
 
-  Y = this->permuteMatToOriginalDofs(yPermuted, ROW);
+  permuteRows(buffers.y, outputTree->originalDofToHMatDofMap(), Y, alpha,
+              beta);
 }
 }
 
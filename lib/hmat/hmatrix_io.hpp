@@ -0,0 +1,51 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_IO_HPP
+#define HMAT_HMATRIX_IO_HPP
+
+#include "common.hpp"
+#include "hmatrix.hpp"
+
+#include <string>
+
+namespace hmat {
+
+// Binary file format of H-matrices (version 1)
+//
+// The file starts with a 64-byte header: the magic string "BEMPPHM",
+// the format version, a byte order mark, the branching factor N, a value
+// type code, the size of the metadata section, the offset and size of the
+// data section and FNV-1a checksums of both sections. The metadata section
+// follows the header and contains the row and column cluster trees (DOF
+// permutation and nodes in depth-first order), the flat nodes of the block
+// cluster tree and a table of the leafs. The data section holds the dense
+// matrices and low-rank factors of the leafs in column-major order, each
+// array aligned to 64 bytes.
+//
+// Integers and floating-point numbers are stored in the native byte order;
+// files cannot be exchanged between machines of different endianness.
+
+// Write an H-matrix to a file. The data are written to a temporary file in
+// the same directory, which then replaces the target by rename(), so that
+// H-matrices loaded from the previous contents of the target stay valid.
+template <typename ValueType, int N>
+void saveHMatrix(const HMatrix<ValueType, N> &hMatrix,
+                 const std::string &fileName);
+
+// Read an H-matrix from a file written by saveHMatrix(). The file is
+// memory-mapped and the leaf data refer directly to the mapped pages, so
+// loading costs only the parsing of the metadata and pages are read on
+// first use. The mapping is private: modifications of the H-matrix (e.g. by
+// recompress()) do not affect the file.
+//
+// The checksum of the metadata is always verified. Verifying the checksum
+// of the data section requires reading the whole file and is done only if
+// verifyData is true.
+template <typename ValueType, int N>
+shared_ptr<HMatrix<ValueType, N>> loadHMatrix(const std::string &fileName,
+                                              bool verifyData = false);
+}
+
+#include "hmatrix_io_impl.hpp"
+
+#endif // HMAT_HMATRIX_IO_HPP
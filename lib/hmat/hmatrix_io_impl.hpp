@@ -0,0 +1,463 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_IO_IMPL_HPP
+#define HMAT_HMATRIX_IO_IMPL_HPP
+
+#include "hmatrix_io.hpp"
+#include "block_cluster_tree.hpp"
+#include "cluster_tree.hpp"
+#include "dof_permutation.hpp"
+#include "hmatrix_data.hpp"
+#include "hmatrix_dense_data.hpp"
+#include "hmatrix_low_rank_data.hpp"
+
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hmat {
+
+namespace hmatrix_io_detail {
+
+const char fileMagic[8] = {'B', 'E', 'M', 'P', 'P', 'H', 'M', '\0'};
+const std::uint32_t fileVersion = 1;
+const std::uint32_t byteOrderMark = 0x01020304;
+const std::size_t dataAlignment = 64;
+
+enum LeafType : std::uint64_t { DENSE_LEAF = 0, LOW_RANK_LEAF = 1 };
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byteOrderMark;
+  std::uint32_t branchingFactor;
+  std::uint32_t valueType;
+  std::uint64_t metadataSize;
+  std::uint64_t dataOffset;
+  std::uint64_t dataSize;
+  std::uint64_t metadataChecksum;
+  std::uint64_t dataChecksum;
+};
+
+static_assert(sizeof(FileHeader) == 64, "unexpected size of the file header");
+
+template <typename ValueType> struct ValueTypeCode;
+template <> struct ValueTypeCode<float> {
+  static const std::uint32_t value = 1;
+};
+template <> struct ValueTypeCode<double> {
+  static const std::uint32_t value = 2;
+};
+template <> struct ValueTypeCode<std::complex<float>> {
+  static const std::uint32_t value = 3;
+};
+template <> struct ValueTypeCode<std::complex<double>> {
+  static const std::uint32_t value = 4;
+};
+
+// 64-bit FNV-1a hash; pass the previous result as hash to continue it.
+inline std::uint64_t checksum(const char *data, std::size_t size,
+                              std::uint64_t hash = 14695981039346656037ULL) {
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+inline std::size_t alignedOffset(std::size_t offset) {
+  return (offset + dataAlignment - 1) / dataAlignment * dataAlignment;
+}
+
+class MetadataWriter {
+public:
+  void write(std::uint64_t value) { append(&value, sizeof(value)); }
+  void writeDouble(double value) { append(&value, sizeof(value)); }
+  const std::vector<char> &buffer() const { return m_buffer; }
+
+private:
+  void append(const void *data, std::size_t size) {
+    const char *bytes = static_cast<const char *>(data);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+  }
+
+  std::vector<char> m_buffer;
+};
+
+class MetadataReader {
+public:
+  MetadataReader(const char *begin, const char *end)
+      : m_pos(begin), m_end(end) {}
+
+  std::uint64_t read() {
+    std::uint64_t value;
+    extract(&value, sizeof(value));
+    return value;
+  }
+
+  double readDouble() {
+    double value;
+    extract(&value, sizeof(value));
+    return value;
+  }
+
+private:
+  void extract(void *data, std::size_t size) {
+    if (static_cast<std::size_t>(m_end - m_pos) < size)
+      throw std::runtime_error("loadHMatrix(): metadata section is truncated");
+    std::memcpy(data, m_pos, size);
+    m_pos += size;
+  }
+
+  const char *m_pos;
+  const char *m_end;
+};
+
+// Private read-write mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &fileName)
+      : m_data(nullptr), m_size(0) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd == -1)
+      throw std::runtime_error("loadHMatrix(): cannot open file " + fileName);
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == -1 || fileStat.st_size == 0) {
+      close(fd);
+      throw std::runtime_error("loadHMatrix(): cannot read file " + fileName);
+    }
+    m_size = fileStat.st_size;
+    void *data =
+        mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+      throw std::runtime_error("loadHMatrix(): cannot map file " + fileName);
+    m_data = static_cast<char *>(data);
+  }
+
+  ~MappedFile() { munmap(m_data, m_size); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  char *data() const { return m_data; }
+  std::size_t size() const { return m_size; }
+
+private:
+  char *m_data;
+  std::size_t m_size;
+};
+
+template <int N>
+void writeClusterTree(const ClusterTree<N> &tree, MetadataWriter &writer) {
+
+  writer.write(tree.numberOfDofs());
+  for (auto originalDof : tree.hMatDofToOriginalDofMap())
+    writer.write(originalDof);
+
+  std::function<void(const shared_ptr<const ClusterTreeNode<N>> &)> writeImpl;
+  writeImpl = [&writer, &writeImpl](
+      const shared_ptr<const ClusterTreeNode<N>> &node) {
+    const auto &data = node->data();
+    writer.write(data.indexRange[0]);
+    writer.write(data.indexRange[1]);
+    for (auto bound : data.boundingBox.bounds())
+      writer.writeDouble(bound);
+    writer.write(node->isLeaf() ? 0 : 1);
+    if (!node->isLeaf())
+      for (int i = 0; i < N; ++i)
+        writeImpl(node->child(i));
+  };
+  writeImpl(tree.root());
+}
+
+template <int N>
+shared_ptr<const ClusterTree<N>> readClusterTree(MetadataReader &reader) {
+
+  const std::size_t numberOfDofs = reader.read();
+  DofPermutation dofPermutation(numberOfDofs);
+  std::vector<bool> found(numberOfDofs, false);
+  for (std::size_t hMatDof = 0; hMatDof < numberOfDofs; ++hMatDof) {
+    std::size_t originalDof = reader.read();
+    if (originalDof >= numberOfDofs || found[originalDof])
+      throw std::runtime_error("loadHMatrix(): invalid DOF permutation");
+    found[originalDof] = true;
+    dofPermutation.addDofIndexPair(originalDof, hMatDof);
+  }
+
+  auto readNodeData = [&reader, numberOfDofs]() {
+    IndexRangeType indexRange;
+    indexRange[0] = reader.read();
+    indexRange[1] = reader.read();
+    if (indexRange[0] > indexRange[1] || indexRange[1] > numberOfDofs)
+      throw std::runtime_error("loadHMatrix(): invalid cluster tree node");
+    std::array<double, 6> bounds;
+    for (auto &bound : bounds)
+      bound = reader.readDouble();
+    return ClusterTreeNodeData(indexRange, BoundingBox(bounds));
+  };
+
+  std::function<void(const shared_ptr<ClusterTreeNode<N>> &)> readImpl;
+  readImpl = [&reader, &readNodeData, &readImpl](
+      const shared_ptr<ClusterTreeNode<N>> &node) {
+    if (reader.read() == 0)
+      return;
+    for (int i = 0; i < N; ++i) {
+      node->addChild(readNodeData(), i);
+      readImpl(node->child(i));
+    }
+  };
+
+  auto root = make_shared<ClusterTreeNode<N>>(readNodeData());
+  readImpl(root);
+  return make_shared<ClusterTree<N>>(root, dofPermutation);
+}
+
+template <typename ValueType>
+void writeArray(std::ofstream &out, const arma::Mat<ValueType> &mat,
+                std::size_t &position, std::uint64_t &hash) {
+
+  static const char zeros[dataAlignment] = {};
+  std::size_t padding = alignedOffset(position) - position;
+  out.write(zeros, padding);
+  hash = checksum(zeros, padding, hash);
+  position += padding;
+
+  const char *bytes = reinterpret_cast<const char *>(mat.memptr());
+  std::size_t size = mat.n_elem * sizeof(ValueType);
+  out.write(bytes, size);
+  hash = checksum(bytes, size, hash);
+  position += size;
+}
+}
+
+template <typename ValueType, int N>
+void saveHMatrix(const HMatrix<ValueType, N> &hMatrix,
+                 const std::string &fileName) {
+
+  using namespace hmatrix_io_detail;
+
+  if (!hMatrix.isInitialized())
+    throw std::invalid_argument("saveHMatrix(): "
+                                "H-matrix is not initialized");
+
+  const auto blockClusterTree = hMatrix.blockClusterTree();
+  const auto &flatNodes = blockClusterTree->flatNodes();
+
+  // Metadata. The data offsets of the leafs are relative to the start of the
+  // data section and are computed in the same way as the padding written by
+  // writeArray().
+
+  MetadataWriter writer;
+  writeClusterTree(*blockClusterTree->rowClusterTree(), writer);
+  writeClusterTree(*blockClusterTree->columnClusterTree(), writer);
+
+  writer.write(flatNodes.size());
+  for (const auto &node : flatNodes) {
+    writer.write(node.rowIndexRange[0]);
+    writer.write(node.rowIndexRange[1]);
+    writer.write(node.columnIndexRange[0]);
+    writer.write(node.columnIndexRange[1]);
+    writer.write(node.firstChild);
+    writer.write(node.admissible ? 1 : 0);
+  }
+
+  std::vector<const arma::Mat<ValueType> *> arrays;
+  std::size_t dataSize = 0;
+  auto addArray = [&arrays, &dataSize](const arma::Mat<ValueType> &array) {
+    arrays.push_back(&array);
+    dataSize = alignedOffset(dataSize);
+    std::size_t offset = dataSize;
+    dataSize += array.n_elem * sizeof(ValueType);
+    return offset;
+  };
+
+  writer.write(hMatrix.numberOfLeafs());
+  for (std::size_t leaf = 0; leaf < hMatrix.numberOfLeafs(); ++leaf) {
+    auto data = hMatrix.leafData(leaf);
+    std::uint64_t type;
+    std::size_t offset;
+    if (auto dense =
+            dynamic_cast<const HMatrixDenseData<ValueType> *>(data.get())) {
+      type = DENSE_LEAF;
+      offset = addArray(dense->A());
+    } else if (auto lowRank =
+                   dynamic_cast<const HMatrixLowRankData<ValueType> *>(
+                       data.get())) {
+      type = LOW_RANK_LEAF;
+      offset = addArray(lowRank->A());
+      addArray(lowRank->B());
+    } else
+      throw std::invalid_argument("saveHMatrix(): "
+                                  "unsupported type of leaf data");
+    writer.write(hMatrix.leafFlatNode(leaf));
+    writer.write(type);
+    writer.write(data->rows());
+    writer.write(data->cols());
+    writer.write(data->rank());
+    writer.write(offset);
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+  header.version = fileVersion;
+  header.byteOrderMark = byteOrderMark;
+  header.branchingFactor = N;
+  header.valueType = ValueTypeCode<ValueType>::value;
+  header.metadataSize = writer.buffer().size();
+  header.dataOffset = alignedOffset(sizeof(FileHeader) + header.metadataSize);
+  header.dataSize = dataSize;
+  header.metadataChecksum =
+      checksum(writer.buffer().data(), writer.buffer().size());
+  header.dataChecksum = 0;
+
+  // A loaded H-matrix maps its file into memory, so the target must not be
+  // truncated; it is replaced by a new file once that is complete.
+  const std::string tempFileName =
+      fileName + ".tmp" + std::to_string(static_cast<long>(::getpid()));
+  try {
+    std::ofstream out(tempFileName.c_str(),
+                      std::ios::binary | std::ios::trunc);
+    if (!out)
+      throw std::runtime_error("saveHMatrix(): cannot open file " +
+                               tempFileName);
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(writer.buffer().data(), writer.buffer().size());
+    static const char zeros[dataAlignment] = {};
+    out.write(zeros,
+              header.dataOffset - sizeof(FileHeader) - header.metadataSize);
+
+    std::size_t position = 0;
+    std::uint64_t hash = checksum(nullptr, 0);
+    for (auto array : arrays)
+      writeArray(out, *array, position, hash);
+    if (position != dataSize)
+      throw std::logic_error("saveHMatrix(): inconsistent data layout");
+
+    // The data checksum is known only now; rewrite the header.
+
+    header.dataChecksum = hash;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.close();
+    if (!out)
+      throw std::runtime_error("saveHMatrix(): error writing file " +
+                               tempFileName);
+
+    if (std::rename(tempFileName.c_str(), fileName.c_str()) != 0)
+      throw std::runtime_error("saveHMatrix(): cannot replace file " +
+                               fileName);
+  } catch (...) {
+    std::remove(tempFileName.c_str());
+    throw;
+  }
+}
+
+template <typename ValueType, int N>
+shared_ptr<HMatrix<ValueType, N>> loadHMatrix(const std::string &fileName,
+                                              bool verifyData) {
+
+  using namespace hmatrix_io_detail;
+
+  shared_ptr<MappedFile> file(new MappedFile(fileName));
+
+  FileHeader header;
+  if (file->size() < sizeof(header))
+    throw std::runtime_error("loadHMatrix(): file is too short");
+  std::memcpy(&header, file->data(), sizeof(header));
+
+  if (std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0)
+    throw std::runtime_error("loadHMatrix(): not an H-matrix file");
+  if (header.version != fileVersion)
+    throw std::runtime_error("loadHMatrix(): unsupported file version");
+  if (header.byteOrderMark != byteOrderMark)
+    throw std::runtime_error("loadHMatrix(): file has a different byte order");
+  if (header.branchingFactor != N)
+    throw std::runtime_error("loadHMatrix(): file has a different "
+                             "branching factor");
+  if (header.valueType != ValueTypeCode<ValueType>::value)
+    throw std::runtime_error("loadHMatrix(): file has a different value type");
+  if (sizeof(header) + header.metadataSize > header.dataOffset ||
+      header.dataOffset % dataAlignment != 0 ||
+      header.dataOffset + header.dataSize > file->size())
+    throw std::runtime_error("loadHMatrix(): file is truncated");
+
+  const char *metadata = file->data() + sizeof(header);
+  if (checksum(metadata, header.metadataSize) != header.metadataChecksum)
+    throw std::runtime_error("loadHMatrix(): metadata checksum mismatch");
+  char *data = file->data() + header.dataOffset;
+  if (verifyData && checksum(data, header.dataSize) != header.dataChecksum)
+    throw std::runtime_error("loadHMatrix(): data checksum mismatch");
+
+  MetadataReader reader(metadata, metadata + header.metadataSize);
+  auto rowClusterTree = readClusterTree<N>(reader);
+  auto columnClusterTree = readClusterTree<N>(reader);
+
+  std::vector<FlatBlockClusterTreeNode> flatNodes(reader.read());
+  for (auto &node : flatNodes) {
+    node.rowIndexRange[0] = reader.read();
+    node.rowIndexRange[1] = reader.read();
+    node.columnIndexRange[0] = reader.read();
+    node.columnIndexRange[1] = reader.read();
+    node.parent = FlatBlockClusterTreeNode::NONE;
+    node.firstChild = reader.read();
+    node.leafId = FlatBlockClusterTreeNode::NONE;
+    node.admissible = (reader.read() != 0);
+  }
+  auto blockClusterTree = make_shared<BlockClusterTree<N>>(
+      rowClusterTree, columnClusterTree, flatNodes);
+
+  // The leaf data refer to the mapped memory, which they keep alive.
+
+  const std::size_t numberOfLeafs = reader.read();
+  std::vector<std::size_t> leafFlatNodes(numberOfLeafs);
+  std::vector<shared_ptr<HMatrixData<ValueType>>> leafData(numberOfLeafs);
+  for (std::size_t leaf = 0; leaf < numberOfLeafs; ++leaf) {
+    leafFlatNodes[leaf] = reader.read();
+    const std::uint64_t type = reader.read();
+    const std::size_t rows = reader.read();
+    const std::size_t cols = reader.read();
+    const std::size_t rank = reader.read();
+    const std::size_t offset = reader.read();
+
+    std::size_t sizeA = (type == DENSE_LEAF ? cols : rank) * rows;
+    std::size_t offsetB =
+        alignedOffset(offset + sizeA * sizeof(ValueType));
+    std::size_t end = (type == DENSE_LEAF)
+                          ? offset + sizeA * sizeof(ValueType)
+                          : offsetB + rank * cols * sizeof(ValueType);
+    if (offset % dataAlignment != 0 || end > header.dataSize)
+      throw std::runtime_error("loadHMatrix(): invalid leaf data offset");
+
+    ValueType *dataA = reinterpret_cast<ValueType *>(data + offset);
+    if (type == DENSE_LEAF)
+      leafData[leaf] = shared_ptr<HMatrixDenseData<ValueType>>(
+          new HMatrixDenseData<ValueType>(dataA, rows, cols),
+          [file](HMatrixDenseData<ValueType> *p) { delete p; });
+    else if (type == LOW_RANK_LEAF) {
+      ValueType *dataB = reinterpret_cast<ValueType *>(data + offsetB);
+      leafData[leaf] = shared_ptr<HMatrixLowRankData<ValueType>>(
+          new HMatrixLowRankData<ValueType>(dataA, dataB, rows, cols, rank),
+          [file](HMatrixLowRankData<ValueType> *p) { delete p; });
+    } else
+      throw std::runtime_error("loadHMatrix(): unknown type of leaf data");
+  }
+
+  return make_shared<HMatrix<ValueType, N>>(blockClusterTree, leafFlatNodes,
+                                            leafData);
+}
+}
+
+#endif // HMAT_HMATRIX_IO_IMPL_HPP
@@ -13,6 +13,13 @@ template <typename ValueType>
 class HMatrixLowRankData : public HMatrixData<ValueType> {
 
 public:
+  HMatrixLowRankData();
+  // Use external memory (e.g. a memory-mapped file) for the factors A and B,
+  // stored in column-major order. The memory must outlive the object; it is
+  // copied only if the factors are resized.
+  HMatrixLowRankData(ValueType *dataA, ValueType *dataB, int rows, int cols,
+                     int rank);
+
   void apply(const arma::Mat<ValueType> &X, arma::Mat<ValueType> &Y,
              TransposeMode trans, ValueType alpha, ValueType beta) const
       override;
@@ -21,6 +28,15 @@ public:
              TransposeMode trans, ValueType alpha, ValueType beta) const
       override;
 
+  void computeApplyWorkspace(const arma::subview<ValueType> &X,
+                             arma::Mat<ValueType> &workspace,
+                             TransposeMode trans) const override;
+
+  void applyToRows(const arma::subview<ValueType> &X,
+                   const arma::Mat<ValueType> &workspace,
+                   arma::subview<ValueType> &Y, const IndexRangeType &rowRange,
+                   TransposeMode trans) const override;
+
   const arma::Mat<ValueType> &A() const;
   arma::Mat<ValueType> &A();
 
@@ -35,6 +51,11 @@ public:
 
   double memSizeKb() const override;
 
+  // Truncate A * B to the smallest rank whose relative error in the
+  // Frobenius norm does not exceed eps. Both factors are orthogonalised
+  // by QR decompositions and the small core matrix is truncated by SVD.
+  void recompress(double eps);
+
 private:
   arma::Mat<ValueType> m_A;
   arma::Mat<ValueType> m_B;
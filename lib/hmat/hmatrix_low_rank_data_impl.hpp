@@ -7,6 +7,16 @@
 
 namespace hmat {
 
+template <typename ValueType>
+HMatrixLowRankData<ValueType>::HMatrixLowRankData() {}
+
+template <typename ValueType>
+HMatrixLowRankData<ValueType>::HMatrixLowRankData(ValueType *dataA,
+                                                  ValueType *dataB, int rows,
+                                                  int cols, int rank)
+    : m_A(dataA, rows, rank, false /* copy_aux_mem */, false /* strict */),
+      m_B(dataB, rank, cols, false /* copy_aux_mem */, false /* strict */) {}
+
 template <typename ValueType>
 const arma::Mat<ValueType> &HMatrixLowRankData<ValueType>::A() const {
   return m_A;
@@ -27,6 +37,43 @@ arma::Mat<ValueType> &HMatrixLowRankData<ValueType>::B() {
   return m_B;
 }
 
+template <typename ValueType>
+void HMatrixLowRankData<ValueType>::computeApplyWorkspace(
+    const arma::subview<ValueType> &X, arma::Mat<ValueType> &workspace,
+    TransposeMode trans) const {
+
+  if (trans == TransposeMode::NOTRANS)
+    workspace = m_B * X;
+  else if (trans == TransposeMode::TRANS)
+    workspace = m_A.st() * X;
+  else if (trans == TransposeMode::CONJ)
+    workspace = arma::conj(m_B) * X;
+  else
+    workspace = m_A.t() * X;
+}
+
+template <typename ValueType>
+void HMatrixLowRankData<ValueType>::applyToRows(
+    const arma::subview<ValueType> &X, const arma::Mat<ValueType> &workspace,
+    arma::subview<ValueType> &Y, const IndexRangeType &rowRange,
+    TransposeMode trans) const {
+
+  if (this->rank() == 0)
+    return;
+
+  auto first = rowRange[0];
+  auto last = rowRange[1] - 1;
+
+  if (trans == TransposeMode::NOTRANS)
+    Y += m_A.rows(first, last) * workspace;
+  else if (trans == TransposeMode::TRANS)
+    Y += arma::strans(m_B.cols(first, last)) * workspace;
+  else if (trans == TransposeMode::CONJ)
+    Y += arma::conj(m_A.rows(first, last)) * workspace;
+  else
+    Y += arma::trans(m_B.cols(first, last)) * workspace;
+}
+
 template <typename ValueType> int HMatrixLowRankData<ValueType>::rows() const {
   return m_A.n_rows;
 }
@@ -64,6 +111,55 @@ double HMatrixLowRankData<ValueType>::memSizeKb() const {
          (1.0 * 1024);
 }
 
+template <typename ValueType>
+void HMatrixLowRankData<ValueType>::recompress(double eps) {
+
+  typedef typename ScalarTraits<ValueType>::RealType RealType;
+
+  if (this->rank() == 0)
+    return;
+
+  // A * B = QA * RA * RB^H * QB^H = (QA * U) * S * (QB * V)^H
+
+  arma::Mat<ValueType> QA, RA, QB, RB;
+  arma::qr_econ(QA, RA, m_A);
+  arma::qr_econ(QB, RB, arma::Mat<ValueType>(m_B.t()));
+
+  arma::Mat<ValueType> U, V;
+  arma::Col<RealType> s;
+  arma::svd_econ(U, s, V, arma::Mat<ValueType>(RA * RB.t()));
+
+  // Find the smallest rank whose tail of squared singular values stays
+  // below eps^2 times the squared norm of the block.
+
+  RealType threshold = eps * eps * arma::accu(arma::square(s));
+  std::size_t newRank = s.n_elem;
+  RealType tail = 0;
+  while (newRank > 0 && tail + s(newRank - 1) * s(newRank - 1) <= threshold) {
+    tail += s(newRank - 1) * s(newRank - 1);
+    --newRank;
+  }
+
+  if (newRank >= static_cast<std::size_t>(this->rank()))
+    return;
+
+  auto rows = this->rows();
+  auto cols = this->cols();
+
+  if (newRank == 0) {
+    m_A.set_size(rows, 0);
+    m_B.set_size(0, cols);
+    return;
+  }
+
+  arma::Mat<ValueType> US = U.cols(0, newRank - 1);
+  for (std::size_t j = 0; j < newRank; ++j)
+    US.col(j) *= s(j);
+
+  m_A = QA * US;
+  m_B = V.cols(0, newRank - 1).t() * QB.t();
+}
+
 template <typename ValueType>
 void HMatrixLowRankData<ValueType>::apply(const arma::Mat<ValueType> &X,
                                           arma::Mat<ValueType> &Y,
@@ -0,0 +1,88 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_LU_HPP
+#define HMAT_HMATRIX_LU_HPP
+
+#include "common.hpp"
+#include "hmatrix.hpp"
+#include "hmatrix_data.hpp"
+#include "hmatrix_low_rank_data.hpp"
+
+#include <armadillo>
+#include <memory>
+#include <vector>
+
+namespace hmat {
+
+template <typename ValueType, int N> class HMatrixLu;
+
+template <typename ValueType>
+using DefaultHMatrixLuType = HMatrixLu<ValueType, 2>;
+
+// Approximate LU decomposition of an H-matrix computed by truncated
+// H-matrix arithmetic. The factors have the block structure of the
+// H-matrix; every low-rank block created or updated during the
+// factorisation is truncated to the relative accuracy eps.
+//
+// Diagonal blocks stored as dense matrices are factorised with partial
+// pivoting restricted to the rows of the block. A diagonal block whose
+// children do not form square diagonal sub-blocks (which may happen if the
+// row and column cluster trees differ) is converted to a dense matrix and
+// factorised as a whole.
+template <typename ValueType, int N> class HMatrixLu {
+public:
+  HMatrixLu(const HMatrix<ValueType, N> &hMatrix, double eps);
+  ~HMatrixLu();
+
+  std::size_t rows() const;
+  std::size_t columns() const;
+
+  double eps() const;
+  double memSizeKb() const;
+  // Number of leaf blocks of the factors stored in low-rank form
+  std::size_t numberOfLowRankBlocks() const;
+
+  // Overwrite X with inv(M) * X, where M is the factorised matrix. The rows
+  // of X are numbered as the original (not H-matrix) dofs.
+  void solve(arma::Mat<ValueType> &X) const;
+
+private:
+  struct Block;
+
+  void initializeBlock(const HMatrix<ValueType, N> &hMatrix,
+                       const std::vector<std::size_t> &leafIndices,
+                       std::size_t flatNode, Block &block) const;
+
+  // In-place factorisation of a diagonal block
+  void factorize(Block &block) const;
+
+  // B = inv(L) * B and B = B * inv(U), where L and U are the factors of
+  // the factorised diagonal block lu
+  void solveLower(const Block &lu, Block &block) const;
+  void solveUpperFromRight(const Block &lu, Block &block) const;
+
+  // The same for dense matrices, plus X = inv(U) * X
+  void solveLower(const Block &lu, arma::Mat<ValueType> &X) const;
+  void solveUpper(const Block &lu, arma::Mat<ValueType> &X) const;
+  void solveUpperFromRight(const Block &lu, arma::Mat<ValueType> &X) const;
+
+  // C += alpha * A * B
+  void addProduct(Block &C, ValueType alpha, const Block &A,
+                  const Block &B) const;
+  // C += alpha * U * V
+  void addLowRank(Block &C, ValueType alpha, const arma::Mat<ValueType> &U,
+                  const arma::Mat<ValueType> &V) const;
+  // Low-rank approximation of A * B
+  void lowRankProduct(const Block &A, const Block &B,
+                      HMatrixLowRankData<ValueType> &result) const;
+
+  double m_eps;
+  shared_ptr<const ClusterTree<N>> m_rowClusterTree;
+  shared_ptr<const ClusterTree<N>> m_columnClusterTree;
+  std::unique_ptr<Block> m_root;
+};
+}
+
+#include "hmatrix_lu_impl.hpp"
+
+#endif // HMAT_HMATRIX_LU_HPP
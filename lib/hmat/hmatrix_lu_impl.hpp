@@ -0,0 +1,688 @@
+// vi: set et ts=4 sw=2 sts=2:
+
+#ifndef HMAT_HMATRIX_LU_IMPL_HPP
+#define HMAT_HMATRIX_LU_IMPL_HPP
+
+#include "hmatrix_lu.hpp"
+#include "hmatrix_dense_data.hpp"
+#include "hmatrix_low_rank_data.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace hmat {
+
+// Node of the block tree of the factors. A leaf stores its data (dense or
+// low-rank), except for factorised dense diagonal blocks, which store
+// P^T * L * U instead. Non-leaf blocks have N * N children in row-major
+// order.
+template <typename ValueType, int N> struct HMatrixLu<ValueType, N>::Block {
+  IndexRangeType rowRange;
+  IndexRangeType columnRange;
+  shared_ptr<HMatrixData<ValueType>> data;
+  std::vector<std::unique_ptr<Block>> children;
+  arma::Mat<ValueType> lower;
+  arma::Mat<ValueType> upper;
+  arma::Mat<ValueType> permutation;
+
+  std::size_t rows() const { return rowRange[1] - rowRange[0]; }
+  std::size_t cols() const { return columnRange[1] - columnRange[0]; }
+  bool isLeaf() const { return children.empty(); }
+  bool isFactorized() const { return isLeaf() && !data; }
+
+  Block &child(int i, int j) { return *children[N * i + j]; }
+  const Block &child(int i, int j) const { return *children[N * i + j]; }
+
+  HMatrixDenseData<ValueType> *denseData() const {
+    return dynamic_cast<HMatrixDenseData<ValueType> *>(data.get());
+  }
+  HMatrixLowRankData<ValueType> *lowRankData() const {
+    return dynamic_cast<HMatrixLowRankData<ValueType> *>(data.get());
+  }
+
+  // Offsets of the ranges of a child relative to this block
+  std::size_t rowOffset(const Block &c) const {
+    return c.rowRange[0] - rowRange[0];
+  }
+  std::size_t columnOffset(const Block &c) const {
+    return c.columnRange[0] - columnRange[0];
+  }
+
+  arma::Mat<ValueType> toDense() const {
+    if (auto dense = denseData())
+      return dense->A();
+    if (auto lowRank = lowRankData()) {
+      if (lowRank->rank() == 0)
+        return arma::zeros<arma::Mat<ValueType>>(rows(), cols());
+      return lowRank->A() * lowRank->B();
+    }
+    arma::Mat<ValueType> result(rows(), cols());
+    for (const auto &c : children)
+      if (c->rows() > 0 && c->cols() > 0)
+        result.submat(rowOffset(*c), columnOffset(*c),
+                      rowOffset(*c) + c->rows() - 1,
+                      columnOffset(*c) + c->cols() - 1) = c->toDense();
+    return result;
+  }
+
+  // Replace the contents of the block by a dense matrix
+  void makeDense(const arma::Mat<ValueType> &mat) {
+    shared_ptr<HMatrixDenseData<ValueType>> dense(
+        new HMatrixDenseData<ValueType>());
+    dense->A() = mat;
+    data = dense;
+    children.clear();
+  }
+
+  // Y += alpha * op(block) * X, where op is the identity (NOTRANS) or the
+  // transposition (TRANS)
+  void addTimes(const arma::Mat<ValueType> &X, arma::Mat<ValueType> &Y,
+                TransposeMode trans, ValueType alpha) const {
+    if (X.n_cols == 0)
+      return;
+    if (auto dense = denseData()) {
+      if (trans == NOTRANS)
+        Y += alpha * (dense->A() * X);
+      else
+        Y += alpha * (dense->A().st() * X);
+      return;
+    }
+    if (auto lowRank = lowRankData()) {
+      if (lowRank->rank() == 0)
+        return;
+      if (trans == NOTRANS)
+        Y += alpha * (lowRank->A() * (lowRank->B() * X));
+      else
+        Y += alpha * (lowRank->B().st() * (lowRank->A().st() * X));
+      return;
+    }
+    for (const auto &c : children) {
+      if (c->rows() == 0 || c->cols() == 0)
+        continue;
+      std::size_t inOffset = (trans == NOTRANS) ? columnOffset(*c)
+                                                : rowOffset(*c);
+      std::size_t inSize = (trans == NOTRANS) ? c->cols() : c->rows();
+      std::size_t outOffset = (trans == NOTRANS) ? rowOffset(*c)
+                                                 : columnOffset(*c);
+      std::size_t outSize = (trans == NOTRANS) ? c->rows() : c->cols();
+      arma::Mat<ValueType> x = X.rows(inOffset, inOffset + inSize - 1);
+      arma::Mat<ValueType> y = Y.rows(outOffset, outOffset + outSize - 1);
+      c->addTimes(x, y, trans, alpha);
+      Y.rows(outOffset, outOffset + outSize - 1) = y;
+    }
+  }
+
+  std::size_t numberOfLowRankBlocks() const {
+    if (lowRankData())
+      return 1;
+    std::size_t result = 0;
+    for (const auto &c : children)
+      result += c->numberOfLowRankBlocks();
+    return result;
+  }
+
+  double memSizeKb() const {
+    double result = sizeof(ValueType) *
+                    (lower.n_elem + upper.n_elem + permutation.n_elem) /
+                    (1.0 * 1024);
+    if (data)
+      result += data->memSizeKb();
+    for (const auto &c : children)
+      result += c->memSizeKb();
+    return result;
+  }
+};
+
+template <typename ValueType, int N>
+HMatrixLu<ValueType, N>::HMatrixLu(const HMatrix<ValueType, N> &hMatrix,
+                                   double eps)
+    : m_eps(eps),
+      m_rowClusterTree(hMatrix.blockClusterTree()->rowClusterTree()),
+      m_columnClusterTree(hMatrix.blockClusterTree()->columnClusterTree()) {
+
+  if (hMatrix.rows() != hMatrix.columns())
+    throw std::invalid_argument("HMatrixLu::HMatrixLu(): "
+                                "H-matrix must be square");
+  if (!hMatrix.isInitialized())
+    throw std::invalid_argument("HMatrixLu::HMatrixLu(): "
+                                "H-matrix is not initialized");
+
+  const auto &flatNodes = hMatrix.blockClusterTree()->flatNodes();
+  std::vector<std::size_t> leafIndices(flatNodes.size(),
+                                       FlatBlockClusterTreeNode::NONE);
+  for (std::size_t leaf = 0; leaf < hMatrix.numberOfLeafs(); ++leaf)
+    leafIndices[hMatrix.leafFlatNode(leaf)] = leaf;
+
+  m_root.reset(new Block);
+  initializeBlock(hMatrix, leafIndices, 0, *m_root);
+  factorize(*m_root);
+}
+
+template <typename ValueType, int N> HMatrixLu<ValueType, N>::~HMatrixLu() {}
+
+template <typename ValueType, int N>
+std::size_t HMatrixLu<ValueType, N>::rows() const {
+  return m_root->rows();
+}
+
+template <typename ValueType, int N>
+std::size_t HMatrixLu<ValueType, N>::columns() const {
+  return m_root->cols();
+}
+
+template <typename ValueType, int N>
+double HMatrixLu<ValueType, N>::eps() const {
+  return m_eps;
+}
+
+template <typename ValueType, int N>
+double HMatrixLu<ValueType, N>::memSizeKb() const {
+  return m_root->memSizeKb();
+}
+
+template <typename ValueType, int N>
+std::size_t HMatrixLu<ValueType, N>::numberOfLowRankBlocks() const {
+  return m_root->numberOfLowRankBlocks();
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::initializeBlock(
+    const HMatrix<ValueType, N> &hMatrix,
+    const std::vector<std::size_t> &leafIndices, std::size_t flatNode,
+    Block &block) const {
+
+  const FlatBlockClusterTreeNode &node =
+      hMatrix.blockClusterTree()->flatNodes()[flatNode];
+  block.rowRange = node.rowIndexRange;
+  block.columnRange = node.columnIndexRange;
+
+  // The data of the leafs are copied, since the factorisation overwrites
+  // them.
+
+  if (leafIndices[flatNode] != FlatBlockClusterTreeNode::NONE) {
+    auto data = hMatrix.leafData(leafIndices[flatNode]);
+    if (auto dense =
+            dynamic_cast<const HMatrixDenseData<ValueType> *>(data.get()))
+      block.data.reset(new HMatrixDenseData<ValueType>(*dense));
+    else if (auto lowRank = dynamic_cast<const HMatrixLowRankData<ValueType> *>(
+                 data.get()))
+      block.data.reset(new HMatrixLowRankData<ValueType>(*lowRank));
+    else
+      throw std::runtime_error("HMatrixLu::initializeBlock(): "
+                               "unsupported type of block data");
+    return;
+  }
+
+  if (node.isLeaf())
+    throw std::runtime_error("HMatrixLu::initializeBlock(): "
+                             "H-matrix leaf without data");
+  block.children.resize(N * N);
+  for (int i = 0; i < N * N; ++i) {
+    block.children[i].reset(new Block);
+    initializeBlock(hMatrix, leafIndices, node.firstChild + i,
+                    *block.children[i]);
+  }
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::factorize(Block &block) const {
+
+  bool squareDiagonal = !block.isLeaf();
+  for (int i = 0; i < N && squareDiagonal; ++i)
+    squareDiagonal =
+        (block.child(i, i).rowRange == block.child(i, i).columnRange);
+
+  if (!squareDiagonal) {
+    arma::Mat<ValueType> mat = block.toDense();
+    if (!arma::lu(block.lower, block.upper, block.permutation, mat))
+      throw std::runtime_error("HMatrixLu::factorize(): "
+                               "LU decomposition of a dense block failed");
+    block.data.reset();
+    block.children.clear();
+    return;
+  }
+
+  for (int i = 0; i < N; ++i) {
+    Block &diagonal = block.child(i, i);
+    factorize(diagonal);
+
+    // Blocks to the right of the diagonal block become blocks of U, blocks
+    // below it become blocks of L. All of them are independent.
+
+    const int offDiagonalCount = N - 1 - i;
+    tbb::parallel_for(tbb::blocked_range<int>(0, 2 * offDiagonalCount, 1),
+                      [&](const tbb::blocked_range<int> &r) {
+      for (int task = r.begin(); task != r.end(); ++task) {
+        if (task < offDiagonalCount)
+          solveLower(diagonal, block.child(i, i + 1 + task));
+        else
+          solveUpperFromRight(diagonal,
+                              block.child(i + 1 + task - offDiagonalCount, i));
+      }
+    });
+
+    // Update the Schur complement; each task owns one target block.
+
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, offDiagonalCount * offDiagonalCount, 1),
+        [&](const tbb::blocked_range<int> &r) {
+          for (int task = r.begin(); task != r.end(); ++task) {
+            int k = i + 1 + task / offDiagonalCount;
+            int j = i + 1 + task % offDiagonalCount;
+            addProduct(block.child(k, j), ValueType(-1), block.child(k, i),
+                       block.child(i, j));
+          }
+        });
+  }
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::solveLower(const Block &lu, Block &block) const {
+
+  if (block.rows() == 0 || block.cols() == 0)
+    return;
+
+  if (auto lowRank = block.lowRankData()) {
+    solveLower(lu, lowRank->A());
+    return;
+  }
+
+  bool aligned = !lu.isFactorized() && !block.isLeaf();
+  for (int i = 0; i < N && aligned; ++i)
+    aligned = (block.child(i, 0).rowRange == lu.child(i, i).rowRange);
+
+  if (!aligned) {
+    if (!block.denseData())
+      block.makeDense(block.toDense());
+    solveLower(lu, block.denseData()->A());
+    return;
+  }
+
+  // Forward substitution, independently for each block column
+
+  tbb::parallel_for(tbb::blocked_range<int>(0, N, 1),
+                    [&](const tbb::blocked_range<int> &r) {
+    for (int j = r.begin(); j != r.end(); ++j)
+      for (int i = 0; i < N; ++i) {
+        solveLower(lu.child(i, i), block.child(i, j));
+        for (int k = i + 1; k < N; ++k)
+          addProduct(block.child(k, j), ValueType(-1), lu.child(k, i),
+                     block.child(i, j));
+      }
+  });
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::solveUpperFromRight(const Block &lu,
+                                                  Block &block) const {
+
+  if (block.rows() == 0 || block.cols() == 0)
+    return;
+
+  if (auto lowRank = block.lowRankData()) {
+    solveUpperFromRight(lu, lowRank->B());
+    return;
+  }
+
+  bool aligned = !lu.isFactorized() && !block.isLeaf();
+  for (int j = 0; j < N && aligned; ++j)
+    aligned = (block.child(0, j).columnRange == lu.child(j, j).columnRange);
+
+  if (!aligned) {
+    if (!block.denseData())
+      block.makeDense(block.toDense());
+    solveUpperFromRight(lu, block.denseData()->A());
+    return;
+  }
+
+  // Forward substitution, independently for each block row
+
+  tbb::parallel_for(tbb::blocked_range<int>(0, N, 1),
+                    [&](const tbb::blocked_range<int> &r) {
+    for (int i = r.begin(); i != r.end(); ++i)
+      for (int j = 0; j < N; ++j) {
+        solveUpperFromRight(lu.child(j, j), block.child(i, j));
+        for (int k = j + 1; k < N; ++k)
+          addProduct(block.child(i, k), ValueType(-1), block.child(i, j),
+                     lu.child(j, k));
+      }
+  });
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::solveLower(const Block &lu,
+                                         arma::Mat<ValueType> &X) const {
+  if (X.n_cols == 0 || X.n_rows == 0)
+    return;
+
+  if (lu.isFactorized()) {
+    X = arma::solve(arma::trimatl(lu.lower), lu.permutation * X);
+    return;
+  }
+
+  for (int i = 0; i < N; ++i) {
+    const Block &diagonal = lu.child(i, i);
+    if (diagonal.rows() == 0)
+      continue;
+    std::size_t first = lu.rowOffset(diagonal);
+    arma::Mat<ValueType> xi = X.rows(first, first + diagonal.rows() - 1);
+    solveLower(diagonal, xi);
+    X.rows(first, first + diagonal.rows() - 1) = xi;
+    for (int k = i + 1; k < N; ++k) {
+      const Block &l = lu.child(k, i);
+      if (l.rows() == 0)
+        continue;
+      std::size_t firstK = lu.rowOffset(l);
+      arma::Mat<ValueType> xk = X.rows(firstK, firstK + l.rows() - 1);
+      l.addTimes(xi, xk, NOTRANS, ValueType(-1));
+      X.rows(firstK, firstK + l.rows() - 1) = xk;
+    }
+  }
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::solveUpper(const Block &lu,
+                                         arma::Mat<ValueType> &X) const {
+  if (X.n_cols == 0 || X.n_rows == 0)
+    return;
+
+  if (lu.isFactorized()) {
+    X = arma::solve(arma::trimatu(lu.upper), X);
+    return;
+  }
+
+  for (int i = N - 1; i >= 0; --i) {
+    const Block &diagonal = lu.child(i, i);
+    if (diagonal.rows() == 0)
+      continue;
+    std::size_t first = lu.rowOffset(diagonal);
+    arma::Mat<ValueType> xi = X.rows(first, first + diagonal.rows() - 1);
+    for (int k = i + 1; k < N; ++k) {
+      const Block &u = lu.child(i, k);
+      if (u.cols() == 0)
+        continue;
+      std::size_t firstK = lu.columnOffset(u);
+      arma::Mat<ValueType> xk = X.rows(firstK, firstK + u.cols() - 1);
+      u.addTimes(xk, xi, NOTRANS, ValueType(-1));
+    }
+    solveUpper(diagonal, xi);
+    X.rows(first, first + diagonal.rows() - 1) = xi;
+  }
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::solveUpperFromRight(
+    const Block &lu, arma::Mat<ValueType> &X) const {
+  if (X.n_cols == 0 || X.n_rows == 0)
+    return;
+
+  // X * inv(U) = (inv(U^T) * X^T)^T, U^T being lower triangular
+
+  if (lu.isFactorized()) {
+    arma::Mat<ValueType> upperTransposed = lu.upper.st();
+    arma::Mat<ValueType> xTransposed = X.st();
+    X = arma::solve(arma::trimatl(upperTransposed), xTransposed).st();
+    return;
+  }
+
+  for (int j = 0; j < N; ++j) {
+    const Block &diagonal = lu.child(j, j);
+    if (diagonal.cols() == 0)
+      continue;
+    std::size_t first = lu.columnOffset(diagonal);
+    arma::Mat<ValueType> xj = X.cols(first, first + diagonal.cols() - 1);
+    solveUpperFromRight(diagonal, xj);
+    X.cols(first, first + diagonal.cols() - 1) = xj;
+    arma::Mat<ValueType> xjTransposed = xj.st();
+    for (int k = j + 1; k < N; ++k) {
+      const Block &u = lu.child(j, k);
+      if (u.cols() == 0)
+        continue;
+      std::size_t firstK = lu.columnOffset(u);
+      arma::Mat<ValueType> xkTransposed =
+          X.cols(firstK, firstK + u.cols() - 1).st();
+      u.addTimes(xjTransposed, xkTransposed, TRANS, ValueType(-1));
+      X.cols(firstK, firstK + u.cols() - 1) = xkTransposed.st();
+    }
+  }
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::addProduct(Block &C, ValueType alpha,
+                                         const Block &A,
+                                         const Block &B) const {
+
+  if (C.rows() == 0 || C.cols() == 0 || A.cols() == 0)
+    return;
+
+  bool aligned = !C.isLeaf() && !A.isLeaf() && !B.isLeaf();
+  for (int i = 0; i < N && aligned; ++i)
+    aligned = (A.child(i, 0).rowRange == C.child(i, 0).rowRange &&
+               B.child(0, i).columnRange == C.child(0, i).columnRange &&
+               A.child(0, i).columnRange == B.child(i, 0).rowRange);
+
+  if (aligned) {
+    // Each task owns one block of C
+    tbb::parallel_for(tbb::blocked_range<int>(0, N * N, 1),
+                      [&](const tbb::blocked_range<int> &r) {
+      for (int task = r.begin(); task != r.end(); ++task) {
+        int i = task / N;
+        int j = task % N;
+        for (int k = 0; k < N; ++k)
+          addProduct(C.child(i, j), alpha, A.child(i, k), B.child(k, j));
+      }
+    });
+    return;
+  }
+
+  if (auto dense = C.denseData()) {
+    // One of the dimensions of a dense block is small, so the product is
+    // evaluated by applying A or B to the other factor made dense.
+    if (C.rows() <= C.cols()) {
+      arma::Mat<ValueType> productTransposed(C.cols(), C.rows());
+      productTransposed.zeros();
+      B.addTimes(arma::Mat<ValueType>(A.toDense().st()), productTransposed,
+                 TRANS, alpha);
+      dense->A() += productTransposed.st();
+    } else
+      A.addTimes(B.toDense(), dense->A(), NOTRANS, alpha);
+    return;
+  }
+
+  HMatrixLowRankData<ValueType> product;
+  lowRankProduct(A, B, product);
+  addLowRank(C, alpha, product.A(), product.B());
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::addLowRank(Block &C, ValueType alpha,
+                                         const arma::Mat<ValueType> &U,
+                                         const arma::Mat<ValueType> &V) const {
+
+  if (U.n_cols == 0 || C.rows() == 0 || C.cols() == 0)
+    return;
+
+  if (auto lowRank = C.lowRankData()) {
+    std::size_t oldRank = lowRank->rank();
+    std::size_t newRank = oldRank + U.n_cols;
+    arma::Mat<ValueType> newA(C.rows(), newRank);
+    arma::Mat<ValueType> newB(newRank, C.cols());
+    if (oldRank > 0) {
+      newA.cols(0, oldRank - 1) = lowRank->A();
+      newB.rows(0, oldRank - 1) = lowRank->B();
+    }
+    newA.cols(oldRank, newRank - 1) = alpha * U;
+    newB.rows(oldRank, newRank - 1) = V;
+    lowRank->A() = std::move(newA);
+    lowRank->B() = std::move(newB);
+    lowRank->recompress(m_eps);
+    return;
+  }
+
+  if (auto dense = C.denseData()) {
+    dense->A() += alpha * (U * V);
+    return;
+  }
+
+  for (const auto &c : C.children) {
+    if (c->rows() == 0 || c->cols() == 0)
+      continue;
+    std::size_t rowOffset = C.rowOffset(*c);
+    std::size_t columnOffset = C.columnOffset(*c);
+    arma::Mat<ValueType> u = U.rows(rowOffset, rowOffset + c->rows() - 1);
+    arma::Mat<ValueType> v =
+        V.cols(columnOffset, columnOffset + c->cols() - 1);
+    addLowRank(*c, alpha, u, v);
+  }
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::lowRankProduct(
+    const Block &A, const Block &B,
+    HMatrixLowRankData<ValueType> &result) const {
+
+  const std::size_t rows = A.rows();
+  const std::size_t cols = B.cols();
+
+  if (auto lowRank = A.lowRankData()) {
+    // (U * V) * B = U * (B^T * V^T)^T
+    arma::Mat<ValueType> productTransposed(cols, lowRank->rank());
+    productTransposed.zeros();
+    B.addTimes(arma::Mat<ValueType>(lowRank->B().st()), productTransposed,
+               TRANS, ValueType(1));
+    result.A() = lowRank->A();
+    result.B() = productTransposed.st();
+    return;
+  }
+
+  if (auto lowRank = B.lowRankData()) {
+    arma::Mat<ValueType> product(rows, lowRank->rank());
+    product.zeros();
+    A.addTimes(lowRank->A(), product, NOTRANS, ValueType(1));
+    result.A() = std::move(product);
+    result.B() = lowRank->B();
+    return;
+  }
+
+  bool aligned = !A.isLeaf() && !B.isLeaf();
+  for (int k = 0; k < N && aligned; ++k)
+    aligned = (A.child(0, k).columnRange == B.child(k, 0).rowRange);
+
+  if (!aligned) {
+    // At least one factor is dense, hence one of the dimensions of A or B
+    // is small. The factorisation of the product keeps the rank at most
+    // equal to that dimension.
+    const std::size_t inner = A.cols();
+    if (inner <= std::min(rows, cols)) {
+      result.A() = A.toDense();
+      result.B() = B.toDense();
+    } else if (rows <= cols) {
+      arma::Mat<ValueType> productTransposed(cols, rows);
+      productTransposed.zeros();
+      B.addTimes(arma::Mat<ValueType>(A.toDense().st()), productTransposed,
+                 TRANS, ValueType(1));
+      result.A() = arma::eye<arma::Mat<ValueType>>(rows, rows);
+      result.B() = productTransposed.st();
+    } else {
+      arma::Mat<ValueType> product(rows, cols);
+      product.zeros();
+      A.addTimes(B.toDense(), product, NOTRANS, ValueType(1));
+      result.A() = std::move(product);
+      result.B() = arma::eye<arma::Mat<ValueType>>(cols, cols);
+    }
+    result.recompress(m_eps);
+    return;
+  }
+
+  // Both factors are subdivided: agglomerate the products of the
+  // sub-blocks into a single low-rank matrix.
+
+  std::vector<HMatrixLowRankData<ValueType>> products(N * N);
+  std::size_t totalRank = 0;
+  for (int i = 0; i < N; ++i)
+    for (int j = 0; j < N; ++j) {
+      HMatrixLowRankData<ValueType> &product = products[N * i + j];
+      const std::size_t blockRows = A.child(i, 0).rows();
+      const std::size_t blockCols = B.child(0, j).cols();
+      product.A().set_size(blockRows, 0);
+      product.B().set_size(0, blockCols);
+      if (blockRows == 0 || blockCols == 0)
+        continue;
+      for (int k = 0; k < N; ++k) {
+        if (A.child(i, k).cols() == 0)
+          continue;
+        HMatrixLowRankData<ValueType> term;
+        lowRankProduct(A.child(i, k), B.child(k, j), term);
+        std::size_t oldRank = product.rank();
+        std::size_t newRank = oldRank + term.rank();
+        if (newRank == oldRank)
+          continue;
+        arma::Mat<ValueType> newA(blockRows, newRank);
+        arma::Mat<ValueType> newB(newRank, blockCols);
+        if (oldRank > 0) {
+          newA.cols(0, oldRank - 1) = product.A();
+          newB.rows(0, oldRank - 1) = product.B();
+        }
+        newA.cols(oldRank, newRank - 1) = term.A();
+        newB.rows(oldRank, newRank - 1) = term.B();
+        product.A() = std::move(newA);
+        product.B() = std::move(newB);
+      }
+      product.recompress(m_eps);
+      totalRank += product.rank();
+    }
+
+  result.A().zeros(rows, totalRank);
+  result.B().zeros(totalRank, cols);
+  std::size_t rankOffset = 0;
+  for (int i = 0; i < N; ++i)
+    for (int j = 0; j < N; ++j) {
+      const HMatrixLowRankData<ValueType> &product = products[N * i + j];
+      std::size_t rank = product.rank();
+      if (rank == 0)
+        continue;
+      std::size_t rowOffset = A.rowOffset(A.child(i, 0));
+      std::size_t columnOffset = B.columnOffset(B.child(0, j));
+      result.A().submat(rowOffset, rankOffset, rowOffset + product.rows() - 1,
+                        rankOffset + rank - 1) = product.A();
+      result.B().submat(rankOffset, columnOffset, rankOffset + rank - 1,
+                        columnOffset + product.cols() - 1) = product.B();
+      rankOffset += rank;
+    }
+  result.recompress(m_eps);
+}
+
+template <typename ValueType, int N>
+void HMatrixLu<ValueType, N>::solve(arma::Mat<ValueType> &X) const {
+
+  if (X.n_rows != rows())
+    throw std::invalid_argument("HMatrixLu::solve(): "
+                                "matrix has wrong number of rows");
+
+  // Permute to H-matrix dofs, solve L * U * Y = P * X and permute back.
+  // The solution is indexed by the dofs of the column cluster tree.
+
+  const std::vector<std::size_t> &rowHMatDofToOriginalDof =
+      m_rowClusterTree->hMatDofToOriginalDofMap();
+  const std::vector<std::size_t> &columnOriginalDofToHMatDof =
+      m_columnClusterTree->originalDofToHMatDofMap();
+
+  arma::Mat<ValueType> Y(X.n_rows, X.n_cols);
+  for (std::size_t j = 0; j < X.n_cols; ++j)
+    for (std::size_t i = 0; i < X.n_rows; ++i)
+      Y(i, j) = X(rowHMatDofToOriginalDof[i], j);
+
+  solveLower(*m_root, Y);
+  solveUpper(*m_root, Y);
+
+  for (std::size_t j = 0; j < X.n_cols; ++j)
+    for (std::size_t i = 0; i < X.n_rows; ++i)
+      X(i, j) = Y(columnOriginalDofToHMatDof[i], j);
+}
+}
+
+#endif // HMAT_HMATRIX_LU_IMPL_HPP
@@ -11,6 +11,7 @@
 namespace hmat {
 
 using boost::shared_ptr;
+using boost::allocate_shared;
 using boost::make_shared;
 using boost::enable_shared_from_this;
 using boost::weak_ptr;
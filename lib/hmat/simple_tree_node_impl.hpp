@@ -8,6 +8,9 @@
 #include <stdexcept>
 #include <cassert>
 #include <functional>
+#include <memory>
+
+#include <tbb/scalable_allocator.h>
 
 #include "simple_tree_node.hpp"
 
@@ -55,8 +58,11 @@ void SimpleTreeNode<T, N>::addChild(const T &data, int i) {
 
   assert(i < N);
 
-  m_children[i] =
-      make_shared<SimpleTreeNode<T, N>>(this->shared_from_this(), data);
+  // Nodes are created concurrently during tree construction. The scalable
+  // allocator serves them from per-thread memory pools.
+  m_children[i] = allocate_shared<SimpleTreeNode<T, N>>(
+      tbb::scalable_allocator<SimpleTreeNode<T, N>>(),
+      this->shared_from_this(), data);
 }
 
 template <typename T, int N>
@@ -23,8 +23,10 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
-#include "boost/tokenizer.hpp"
-#include "boost/lexical_cast.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
 #include "../fiber/explicit_instantiation.hpp"
 #include "../space/space.hpp"
 #include "../space/piecewise_constant_scalar_space.hpp"
@@ -45,20 +47,263 @@
 #include "../common/complex_aux.hpp"
 #include "../common/acc.hpp"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace {
 
-typedef std::vector<std::string> StringVector;
+// Number of nodes of an element of the given type of the MSH 2.2 format, or
+// 0 if the type is unknown
+int numberOfElementNodes(int elementType) {
+
+  static const int counts[] = {0,  2,  3, 4, 4,  8,  6,  5,  3,  6,  9,
+                               10, 27, 18, 14, 1,  8,  20, 15, 13, 9,  10,
+                               12, 15, 15, 21, 4,  5,  6,  20, 35, 56};
+  if (elementType < 1 || elementType >= sizeof(counts) / sizeof(counts[0]))
+    return 0;
+  return counts[elementType];
+}
+
+// Replace the segment of the flat array values delimited by offsets[position]
+// and offsets[position + 1] by newValues
+void replaceSegment(std::vector<int> &values, std::vector<int> &offsets,
+                    int position, const std::vector<int> &newValues) {
+
+  const int begin = offsets[position];
+  const int end = offsets[position + 1];
+  const int shift = static_cast<int>(newValues.size()) - (end - begin);
+  if (shift == 0) {
+    std::copy(newValues.begin(), newValues.end(), values.begin() + begin);
+    return;
+  }
+  values.erase(values.begin() + begin, values.begin() + end);
+  values.insert(values.begin() + begin, newValues.begin(), newValues.end());
+  for (int i = position + 1; i < offsets.size(); ++i)
+    offsets[i] += shift;
+}
+
+template <typename T>
+void writeBinary(std::ostream &output, const T *values, std::size_t count) {
 
-StringVector stringTokens(std::string input) {
+  output.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+}
+
+template <typename T> void writeBinary(std::ostream &output, T value) {
 
-  StringVector result;
-  boost::char_delimiters_separator<char> separator(false, " ");
-  boost::tokenizer<boost::char_delimiters_separator<char>> tok(input,
-                                                               separator);
-  boost::tokenizer<>::iterator it;
-  for (it = tok.begin(); it != tok.end(); ++it)
-    result.push_back(*it);
-  return result;
+  writeBinary(output, &value, 1);
+}
+
+// Read-only memory mapping of a file
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &fileName)
+      : m_data(nullptr), m_size(0) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd == -1)
+      throw std::runtime_error("GmshData::read(): Cannot open file " +
+                               fileName + ".");
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == -1) {
+      close(fd);
+      throw std::runtime_error("GmshData::read(): Cannot read file " +
+                               fileName + ".");
+    }
+    m_size = fileStat.st_size;
+    if (m_size > 0) {
+      void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("GmshData::read(): Cannot map file " +
+                                 fileName + ".");
+      }
+      madvise(data, m_size, MADV_SEQUENTIAL);
+      m_data = static_cast<const char *>(data);
+    }
+    close(fd);
+  }
+
+  ~MappedFile() {
+    if (m_data)
+      munmap(const_cast<char *>(m_data), m_size);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *begin() const { return m_data; }
+  const char *end() const { return m_data + m_size; }
+
+private:
+  const char *m_data;
+  std::size_t m_size;
+};
+
+// Cursor over the contents of an MSH file. Numbers in the ASCII parts of the
+// file are parsed by hand, which is much faster than going through streams.
+// In binary files, the data parts of the sections (nodes, elements and data
+// values) are stored in binary form, which is handled by the readData*()
+// functions.
+class GmshBuffer {
+public:
+  GmshBuffer(const char *begin, const char *end)
+      : m_pos(begin), m_end(end), m_binary(false) {}
+
+  bool finished() const { return m_pos == m_end; }
+
+  bool binary() const { return m_binary; }
+  void setBinary(bool binary) { m_binary = binary; }
+
+  // Return the rest of the current line without trailing blanks and move to
+  // the beginning of the next line.
+  std::string readLine() {
+    const char *begin = m_pos;
+    const char *end =
+        static_cast<const char *>(std::memchr(m_pos, '\n', m_end - m_pos));
+    if (end)
+      m_pos = end + 1;
+    else
+      m_pos = end = m_end;
+    while (end != begin && isBlank(end[-1]))
+      --end;
+    return std::string(begin, end);
+  }
+
+  void expectLine(const std::string &expected, const std::string &section) {
+    if (readLine() != expected)
+      throw std::runtime_error("GmshData::read(): Error reading " + section +
+                               " section.");
+  }
+
+  bool atEndOfLine() {
+    skipBlanks();
+    return m_pos == m_end || *m_pos == '\n';
+  }
+
+  // Move to the beginning of the next line. Only blanks may be left on the
+  // current line.
+  void endLine() {
+    if (!atEndOfLine())
+      throw std::runtime_error(
+          "GmshData::read(): Unexpected data at the end of a line.");
+    if (m_pos != m_end)
+      ++m_pos;
+  }
+
+  int readInt() {
+    skipBlanks();
+    bool negative = false;
+    if (m_pos != m_end && (*m_pos == '-' || *m_pos == '+'))
+      negative = *m_pos++ == '-';
+    if (m_pos == m_end || !isDigit(*m_pos))
+      throw std::runtime_error("GmshData::read(): Integer expected.");
+    int value = 0;
+    while (m_pos != m_end && isDigit(*m_pos))
+      value = 10 * value + (*m_pos++ - '0');
+    return negative ? -value : value;
+  }
+
+  double readDouble() {
+    skipBlanks();
+    const char *begin = m_pos;
+    while (m_pos != m_end && !isBlank(*m_pos) && *m_pos != '\n')
+      ++m_pos;
+    // The mapped file is not null-terminated, so strtod() is applied to a
+    // copy of the token
+    char token[64];
+    const std::size_t length = m_pos - begin;
+    if (length == 0 || length >= sizeof(token))
+      throw std::runtime_error("GmshData::read(): Number expected.");
+    std::memcpy(token, begin, length);
+    token[length] = '\0';
+    char *tokenEnd;
+    const double value = std::strtod(token, &tokenEnd);
+    if (tokenEnd != token + length)
+      throw std::runtime_error("GmshData::read(): Number expected.");
+    return value;
+  }
+
+  template <typename T> void readBinary(T *values, std::size_t count) {
+    if (static_cast<std::size_t>(m_end - m_pos) < count * sizeof(T))
+      throw std::runtime_error("GmshData::read(): Unexpected end of file.");
+    std::memcpy(values, m_pos, count * sizeof(T));
+    m_pos += count * sizeof(T);
+  }
+
+  template <typename T> T readBinary() {
+    T value;
+    readBinary(&value, 1);
+    return value;
+  }
+
+  int readDataInt() { return m_binary ? readBinary<int>() : readInt(); }
+
+  void readDataDoubles(double *values, std::size_t count) {
+    if (m_binary)
+      readBinary(values, count);
+    else
+      for (std::size_t i = 0; i < count; ++i)
+        values[i] = readDouble();
+  }
+
+  // End of a record of the data part of a section. In ASCII files, each
+  // record occupies a line; in binary files, the records follow each other
+  // and the data part is terminated by a line end (see endData()).
+  void endRecord() {
+    if (!m_binary)
+      endLine();
+  }
+
+  void endData() {
+    if (m_binary)
+      endLine();
+  }
+
+private:
+  static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+  static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+  void skipBlanks() {
+    while (m_pos != m_end && isBlank(*m_pos))
+      ++m_pos;
+  }
+
+  const char *m_pos;
+  const char *m_end;
+  bool m_binary;
+};
+
+// Read the string, real and integer tags of a NodeData, ElementData or
+// ElementNodeData section
+void readDataSetTags(GmshBuffer &buffer, std::vector<std::string> &stringTags,
+                     std::vector<double> &realTags,
+                     std::vector<int> &integerTags) {
+
+  const int numberOfStringTags = buffer.readInt();
+  buffer.endLine();
+  for (int i = 0; i < numberOfStringTags; ++i) {
+    std::string tag = buffer.readLine();
+    tag.erase(std::remove(tag.begin(), tag.end(), '\"'), tag.end());
+    stringTags.push_back(tag);
+  }
+
+  const int numberOfRealTags = buffer.readInt();
+  buffer.endLine();
+  for (int i = 0; i < numberOfRealTags; ++i) {
+    realTags.push_back(buffer.readDouble());
+    buffer.endLine();
+  }
+
+  const int numberOfIntegerTags = buffer.readInt();
+  buffer.endLine();
+  if (numberOfIntegerTags < 3)
+    throw std::runtime_error(
+        "GmshData::read(): At least 3 integer tags required.");
+  for (int i = 0; i < numberOfIntegerTags; ++i) {
+    integerTags.push_back(buffer.readInt());
+    buffer.endLine();
+  }
 }
 
 } // namespace
@@ -66,10 +311,11 @@ StringVector stringTokens(std::string input) {
 namespace Bempp {
 
 GmshData::GmshData()
-    : m_fileType(0), m_dataSize(0), m_numberOfNodes(0), m_numberOfElements(0) {}
+    : m_fileType(0), m_dataSize(0), m_elementNodeOffsets(1, 0),
+      m_elementPartitionOffsets(1, 0) {}
 
-int GmshData::numberOfNodes() const { return m_numberOfNodes; }
-int GmshData::numberOfElements() const { return m_numberOfElements; }
+int GmshData::numberOfNodes() const { return m_nodeIndices.size(); }
+int GmshData::numberOfElements() const { return m_elementIndices.size(); }
 
 int GmshData::numberOfPeriodicEntities() const {
 
@@ -98,16 +344,21 @@ int GmshData::numberOfInterpolationSchemeSets() const {
 
 void GmshData::addNode(int index, double x, double y, double z) {
 
-  if (index >= m_nodes.size())
-    m_nodes.resize(index + 1);
-  if (!m_nodes[index]) {
-    m_nodes[index] = shared_ptr<Node>(new Node());
-    ++m_numberOfNodes;
+  if (index < 0)
+    throw std::runtime_error("GmshData::addNode(): Negative index.");
+  if (index >= m_nodePositions.size())
+    m_nodePositions.resize(index + 1, -1);
+  int position = m_nodePositions[index];
+  if (position == -1) {
+    position = m_nodeIndices.size();
+    m_nodePositions[index] = position;
+    m_nodeIndices.push_back(index);
+    m_nodeCoordinates.resize(3 * (position + 1));
   }
 
-  m_nodes[index]->x = x;
-  m_nodes[index]->y = y;
-  m_nodes[index]->z = z;
+  m_nodeCoordinates[3 * position] = x;
+  m_nodeCoordinates[3 * position + 1] = y;
+  m_nodeCoordinates[3 * position + 2] = z;
 }
 
 void GmshData::addElement(int index, int elementType,
@@ -115,18 +366,31 @@ void GmshData::addElement(int index, int elementType,
                           int elementaryEntity,
                           const std::vector<int> &partitions) {
 
-  if (index >= m_elements.size())
-    m_elements.resize(index + 1);
-  if (!m_elements[index]) {
-    m_elements[index] = shared_ptr<Element>(new Element());
-    ++m_numberOfElements;
+  if (index < 0)
+    throw std::runtime_error("GmshData::addElement(): Negative index.");
+  if (index >= m_elementPositions.size())
+    m_elementPositions.resize(index + 1, -1);
+  int position = m_elementPositions[index];
+  if (position == -1) {
+    m_elementPositions[index] = m_elementIndices.size();
+    m_elementIndices.push_back(index);
+    m_elementTypes.push_back(elementType);
+    m_elementPhysicalEntities.push_back(physicalEntity);
+    m_elementElementaryEntities.push_back(elementaryEntity);
+    m_elementNodes.insert(m_elementNodes.end(), nodes.begin(), nodes.end());
+    m_elementNodeOffsets.push_back(m_elementNodes.size());
+    m_elementPartitions.insert(m_elementPartitions.end(), partitions.begin(),
+                               partitions.end());
+    m_elementPartitionOffsets.push_back(m_elementPartitions.size());
+    return;
   }
 
-  m_elements[index]->type = elementType;
-  m_elements[index]->physicalEntity = physicalEntity;
-  m_elements[index]->elementaryEntity = elementaryEntity;
-  m_elements[index]->nodes = nodes;
-  m_elements[index]->partitions = partitions;
+  m_elementTypes[position] = elementType;
+  m_elementPhysicalEntities[position] = physicalEntity;
+  m_elementElementaryEntities[position] = elementaryEntity;
+  replaceSegment(m_elementNodes, m_elementNodeOffsets, position, nodes);
+  replaceSegment(m_elementPartitions, m_elementPartitionOffsets, position,
+                 partitions);
 }
 
 void GmshData::addPeriodicEntity(int dimension, int slaveEntityTag,
@@ -252,48 +516,47 @@ void GmshData::addInterpolationMatrix(int dataSetIndex, int nrows, int ncols,
 void GmshData::getNodeIndices(std::vector<int> &indices) const {
 
   indices.clear();
-  indices.reserve(m_numberOfNodes);
-  for (int i = 0; i < m_nodes.size(); i++)
-    if (m_nodes[i])
+  indices.reserve(m_nodeIndices.size());
+  for (int i = 0; i < m_nodePositions.size(); i++)
+    if (m_nodePositions[i] != -1)
       indices.push_back(i);
 }
 
 void GmshData::getElementIndices(std::vector<int> &indices) const {
 
   indices.clear();
-  indices.reserve(m_numberOfElements);
-  for (int i = 0; i < m_elements.size(); i++)
-    if (m_elements[i])
+  indices.reserve(m_elementIndices.size());
+  for (int i = 0; i < m_elementPositions.size(); i++)
+    if (m_elementPositions[i] != -1)
       indices.push_back(i);
 }
 
 void GmshData::getNode(int index, double &x, double &y, double &z) const {
 
-  if (index >= m_nodes.size())
-    throw std::runtime_error("GmshData::getNode(): Index does not exist.");
-  if (m_nodes[index]) {
-    x = m_nodes[index]->x;
-    y = m_nodes[index]->y;
-    z = m_nodes[index]->z;
-  } else
+  const int position = nodePosition(index);
+  if (position == -1)
     throw std::runtime_error("GmshData::getNode(): Index does not exist.");
+  x = m_nodeCoordinates[3 * position];
+  y = m_nodeCoordinates[3 * position + 1];
+  z = m_nodeCoordinates[3 * position + 2];
 }
 
 void GmshData::getElement(int index, int &elementType, std::vector<int> &nodes,
                           int &physicalEntity, int &elementaryEntity,
                           std::vector<int> &partitions) const {
 
-  if (index >= m_elements.size())
+  const int position = elementPosition(index);
+  if (position == -1)
     throw std::runtime_error("GmshData::getElement(): Index does not exist.");
 
-  if (m_elements[index]) {
-    elementType = m_elements[index]->type;
-    nodes = m_elements[index]->nodes;
-    physicalEntity = m_elements[index]->physicalEntity;
-    elementaryEntity = m_elements[index]->elementaryEntity;
-    partitions = m_elements[index]->partitions;
-  } else
-    throw std::runtime_error("GmshData::getElement(): Index does not exist.");
+  elementType = m_elementTypes[position];
+  nodes.assign(m_elementNodes.begin() + m_elementNodeOffsets[position],
+               m_elementNodes.begin() + m_elementNodeOffsets[position + 1]);
+  physicalEntity = m_elementPhysicalEntities[position];
+  elementaryEntity = m_elementElementaryEntities[position];
+  partitions.assign(
+      m_elementPartitions.begin() + m_elementPartitionOffsets[position],
+      m_elementPartitions.begin() + m_elementPartitionOffsets[position + 1]);
 }
 void GmshData::getElement(int index, int &elementType, std::vector<int> &nodes,
                           int &physicalEntity, int &elementaryEntity) const {
@@ -448,53 +711,178 @@ void GmshData::getInterpolationSchemeSet(
         "Gmsh::getInterpolationSchemeSet(): Index does not exist.");
 }
 
-void GmshData::reserveNumberOfNodes(int n) { m_nodes.reserve(n + 1); }
-void GmshData::reserveNumberOfElements(int n) { m_elements.reserve(n + 1); }
+const std::vector<int> &GmshData::nodeIndices() const { return m_nodeIndices; }
+
+const std::vector<double> &GmshData::nodeCoordinates() const {
+
+  return m_nodeCoordinates;
+}
+
+const std::vector<int> &GmshData::elementIndices() const {
+
+  return m_elementIndices;
+}
+
+const std::vector<int> &GmshData::elementTypes() const {
+
+  return m_elementTypes;
+}
+
+const std::vector<int> &GmshData::elementPhysicalEntities() const {
+
+  return m_elementPhysicalEntities;
+}
 
-void GmshData::write(std::ostream &output) const {
+const std::vector<int> &GmshData::elementNodeOffsets() const {
+
+  return m_elementNodeOffsets;
+}
+
+const std::vector<int> &GmshData::elementNodes() const {
+
+  return m_elementNodes;
+}
+
+int GmshData::nodePosition(int index) const {
+
+  if (index < 0 || index >= m_nodePositions.size())
+    return -1;
+  return m_nodePositions[index];
+}
+
+int GmshData::elementPosition(int index) const {
+
+  if (index < 0 || index >= m_elementPositions.size())
+    return -1;
+  return m_elementPositions[index];
+}
+
+void GmshData::reserveNumberOfNodes(int n) {
+
+  m_nodeIndices.reserve(n);
+  m_nodeCoordinates.reserve(3 * n);
+  m_nodePositions.reserve(n + 1);
+}
+
+void GmshData::reserveNumberOfElements(int n, int nodesPerElement) {
+
+  m_elementIndices.reserve(n);
+  m_elementTypes.reserve(n);
+  m_elementPhysicalEntities.reserve(n);
+  m_elementElementaryEntities.reserve(n);
+  m_elementNodeOffsets.reserve(n + 1);
+  m_elementNodes.reserve(n * nodesPerElement);
+  m_elementPartitionOffsets.reserve(n + 1);
+  m_elementPositions.reserve(n + 1);
+}
+
+void GmshData::write(std::ostream &output, bool binary) const {
+
+  // Enough digits to reproduce the doubles exactly
+  const std::streamsize oldPrecision = output.precision(17);
 
   output << "$MeshFormat" << std::endl;
   output << "2.2"
-         << " " << 0 << " " << sizeof(double) << std::endl;
+         << " " << (binary ? 1 : 0) << " " << sizeof(double) << std::endl;
+  if (binary) {
+    writeBinary(output, 1);
+    output << std::endl;
+  }
   output << "$EndMeshFormat" << std::endl;
 
-  if (m_numberOfNodes > 0) {
+  if (numberOfNodes() > 0) {
     std::vector<int> nodeIndices;
     getNodeIndices(nodeIndices);
 
     output << "$Nodes" << std::endl;
-    output << m_numberOfNodes << std::endl;
-    for (int i = 0; i < m_numberOfNodes; i++) {
-      output << nodeIndices[i] << " "
-             << boost::lexical_cast<std::string>(m_nodes[nodeIndices[i]]->x)
-             << " "
-             << boost::lexical_cast<std::string>(m_nodes[nodeIndices[i]]->y)
-             << " "
-             << boost::lexical_cast<std::string>(m_nodes[nodeIndices[i]]->z)
-             << std::endl;
+    output << nodeIndices.size() << std::endl;
+    for (int i = 0; i < nodeIndices.size(); i++) {
+      const double *coords =
+          &m_nodeCoordinates[3 * m_nodePositions[nodeIndices[i]]];
+      if (binary) {
+        writeBinary(output, nodeIndices[i]);
+        writeBinary(output, coords, 3);
+      } else
+        output << nodeIndices[i] << " " << coords[0] << " " << coords[1]
+               << " " << coords[2] << "\n";
     }
+    if (binary)
+      output << std::endl;
     output << "$EndNodes" << std::endl;
   }
 
-  if (m_numberOfElements > 0) {
+  if (numberOfElements() > 0) {
     std::vector<int> elementIndices;
     getElementIndices(elementIndices);
+
+    // Tags of an element: physical entity, elementary entity and, if the
+    // element belongs to any partitions, the number of partitions and the
+    // partition indices
+    std::vector<int> tags;
+    auto getTags = [this, &tags](int position) {
+      tags.clear();
+      tags.push_back(m_elementPhysicalEntities[position]);
+      tags.push_back(m_elementElementaryEntities[position]);
+      const int begin = m_elementPartitionOffsets[position];
+      const int end = m_elementPartitionOffsets[position + 1];
+      if (end > begin) {
+        tags.push_back(end - begin);
+        tags.insert(tags.end(), m_elementPartitions.begin() + begin,
+                    m_elementPartitions.begin() + end);
+      }
+    };
+
     output << "$Elements" << std::endl;
-    output << m_numberOfElements << std::endl;
-    for (int i = 0; i < m_numberOfElements; i++) {
-      Element &element = *m_elements[elementIndices[i]];
-      int ntags;
-      if (element.partitions.size())
-        ntags = 3 + element.partitions.size();
-      else
-        ntags = 2;
-      output << elementIndices[i] << " " << element.type << " " << ntags << " "
-             << element.physicalEntity << " " << element.elementaryEntity;
-      for (int j = 0; j < element.partitions.size(); j++)
-        output << " " << element.partitions[j];
-      for (int j = 0; j < element.nodes.size(); j++)
-        output << " " << element.nodes[j];
+    output << elementIndices.size() << std::endl;
+    if (binary) {
+      // Consecutive elements with the same type and number of tags are
+      // written in one block
+      int blockBegin = 0;
+      while (blockBegin < elementIndices.size()) {
+        const int position = m_elementPositions[elementIndices[blockBegin]];
+        const int type = m_elementTypes[position];
+        getTags(position);
+        const int ntags = tags.size();
+        int blockEnd = blockBegin + 1;
+        while (blockEnd < elementIndices.size()) {
+          const int nextPosition = m_elementPositions[elementIndices[blockEnd]];
+          getTags(nextPosition);
+          if (m_elementTypes[nextPosition] != type || tags.size() != ntags)
+            break;
+          ++blockEnd;
+        }
+        writeBinary(output, type);
+        writeBinary(output, blockEnd - blockBegin);
+        writeBinary(output, ntags);
+        for (int i = blockBegin; i < blockEnd; ++i) {
+          const int position = m_elementPositions[elementIndices[i]];
+          const int begin = m_elementNodeOffsets[position];
+          const int end = m_elementNodeOffsets[position + 1];
+          if (end - begin != numberOfElementNodes(type))
+            throw std::runtime_error(
+                "GmshData::write(): Element type not supported in binary "
+                "files.");
+          getTags(position);
+          writeBinary(output, elementIndices[i]);
+          writeBinary(output, tags.data(), tags.size());
+          writeBinary(output, &m_elementNodes[begin], end - begin);
+        }
+        blockBegin = blockEnd;
+      }
       output << std::endl;
+    } else {
+      for (int i = 0; i < elementIndices.size(); i++) {
+        const int position = m_elementPositions[elementIndices[i]];
+        getTags(position);
+        output << elementIndices[i] << " " << m_elementTypes[position] << " "
+               << tags.size();
+        for (int j = 0; j < tags.size(); j++)
+          output << " " << tags[j];
+        for (int j = m_elementNodeOffsets[position];
+             j < m_elementNodeOffsets[position + 1]; j++)
+          output << " " << m_elementNodes[j];
+        output << "\n";
+      }
     }
     output << "$EndElements" << std::endl;
   }
@@ -525,99 +913,96 @@ void GmshData::write(std::ostream &output) const {
     output << "$EndPhysicalNames" << std::endl;
   }
 
-  if (m_nodeDataSets.size() > 0) {
-    for (int i = 0; i < m_nodeDataSets.size(); ++i) {
-
-      NodeDataSet &nodeDataSet = *m_nodeDataSets[i];
-      output << "$NodeData" << std::endl;
-      output << nodeDataSet.stringTags.size() << std::endl;
-      for (int i = 0; i < nodeDataSet.stringTags.size(); ++i) {
-        output << '\"' + nodeDataSet.stringTags[i] + '\"' << std::endl;
-      }
-      output << nodeDataSet.realTags.size() << std::endl;
-      for (int i = 0; i < nodeDataSet.realTags.size(); ++i) {
-        output << boost::lexical_cast<std::string>(nodeDataSet.realTags[i])
-               << std::endl;
-      }
-      output << 4 << std::endl; // Number of integer tags
-      output << nodeDataSet.timeStep << std::endl;
-      output << nodeDataSet.numberOfFieldComponents << std::endl;
-      output << nodeDataSet.values.size() << std::endl;
-      output << nodeDataSet.partition << std::endl;
-      for (int i = 0; i < nodeDataSet.values.size(); ++i) {
-        output << nodeDataSet.nodeIndices[i];
-        for (int j = 0; j < nodeDataSet.values[i].size(); ++j) {
-          output << " "
-                 << boost::lexical_cast<std::string>(nodeDataSet.values[i][j]);
-        }
-        output << std::endl;
-      }
-      output << "$EndNodeData" << std::endl;
+  // Header of a data set section: string, real and integer tags
+  auto writeDataSetTags = [&output](
+      const std::vector<std::string> &stringTags,
+      const std::vector<double> &realTags, int timeStep,
+      int numberOfFieldComponents, int numberOfEntities, int partition) {
+    output << stringTags.size() << std::endl;
+    for (int i = 0; i < stringTags.size(); ++i)
+      output << '\"' + stringTags[i] + '\"' << std::endl;
+    output << realTags.size() << std::endl;
+    for (int i = 0; i < realTags.size(); ++i)
+      output << realTags[i] << std::endl;
+    output << 4 << std::endl; // Number of integer tags
+    output << timeStep << std::endl;
+    output << numberOfFieldComponents << std::endl;
+    output << numberOfEntities << std::endl;
+    output << partition << std::endl;
+  };
+
+  // A record of a data set: an entity index followed by values
+  auto writeDataRecord = [&output, binary](int index,
+                                           const std::vector<double> &values) {
+    if (binary) {
+      writeBinary(output, index);
+      writeBinary(output, values.data(), values.size());
+    } else {
+      output << index;
+      for (int j = 0; j < values.size(); ++j)
+        output << " " << values[j];
+      output << "\n";
     }
+  };
+
+  for (int i = 0; i < m_nodeDataSets.size(); ++i) {
+
+    NodeDataSet &nodeDataSet = *m_nodeDataSets[i];
+    output << "$NodeData" << std::endl;
+    writeDataSetTags(nodeDataSet.stringTags, nodeDataSet.realTags,
+                     nodeDataSet.timeStep, nodeDataSet.numberOfFieldComponents,
+                     nodeDataSet.values.size(), nodeDataSet.partition);
+    for (int j = 0; j < nodeDataSet.values.size(); ++j)
+      writeDataRecord(nodeDataSet.nodeIndices[j], nodeDataSet.values[j]);
+    if (binary)
+      output << std::endl;
+    output << "$EndNodeData" << std::endl;
   }
 
-  if (m_elementDataSets.size() > 0) {
-    for (int i = 0; i < m_elementDataSets.size(); ++i) {
-
-      ElementDataSet &elementDataSet = *m_elementDataSets[i];
-      output << "$ElementData" << std::endl;
-      output << elementDataSet.stringTags.size() << std::endl;
-      for (int i = 0; i < elementDataSet.stringTags.size(); ++i) {
-        output << '\"' + elementDataSet.stringTags[i] + '\"' << std::endl;
-      }
-      output << elementDataSet.realTags.size() << std::endl;
-      for (int i = 0; i < elementDataSet.realTags.size(); ++i) {
-        output << boost::lexical_cast<std::string>(elementDataSet.realTags[i])
-               << std::endl;
-      }
-      output << 4 << std::endl; // Number of integer tags
-      output << elementDataSet.timeStep << std::endl;
-      output << elementDataSet.numberOfFieldComponents << std::endl;
-      output << elementDataSet.values.size() << std::endl;
-      output << elementDataSet.partition << std::endl;
-      for (int i = 0; i < elementDataSet.values.size(); ++i) {
-        output << elementDataSet.elementIndices[i];
-        for (int j = 0; j < elementDataSet.values[i].size(); ++j) {
-          output << " " << boost::lexical_cast<std::string>(
-                               elementDataSet.values[i][j]);
-        }
-        output << std::endl;
-      }
-      output << "$EndElementData" << std::endl;
-    }
+  for (int i = 0; i < m_elementDataSets.size(); ++i) {
+
+    ElementDataSet &elementDataSet = *m_elementDataSets[i];
+    output << "$ElementData" << std::endl;
+    writeDataSetTags(elementDataSet.stringTags, elementDataSet.realTags,
+                     elementDataSet.timeStep,
+                     elementDataSet.numberOfFieldComponents,
+                     elementDataSet.values.size(), elementDataSet.partition);
+    for (int j = 0; j < elementDataSet.values.size(); ++j)
+      writeDataRecord(elementDataSet.elementIndices[j],
+                      elementDataSet.values[j]);
+    if (binary)
+      output << std::endl;
+    output << "$EndElementData" << std::endl;
   }
 
-  if (m_elementNodeDataSets.size() > 0) {
-    for (int i = 0; i < m_elementNodeDataSets.size(); ++i) {
-
-      ElementNodeDataSet &elementNodeDataSet = *m_elementNodeDataSets[i];
-      output << "$ElementNodeData" << std::endl;
-      output << elementNodeDataSet.stringTags.size() << std::endl;
-      for (int i = 0; i < elementNodeDataSet.stringTags.size(); ++i) {
-        output << '\"' + elementNodeDataSet.stringTags[i] + '\"' << std::endl;
+  for (int i = 0; i < m_elementNodeDataSets.size(); ++i) {
+
+    ElementNodeDataSet &elementNodeDataSet = *m_elementNodeDataSets[i];
+    output << "$ElementNodeData" << std::endl;
+    writeDataSetTags(
+        elementNodeDataSet.stringTags, elementNodeDataSet.realTags,
+        elementNodeDataSet.timeStep, elementNodeDataSet.numberOfFieldComponents,
+        elementNodeDataSet.values.size(), elementNodeDataSet.partition);
+    for (int j = 0; j < elementNodeDataSet.values.size(); ++j) {
+      const std::vector<std::vector<double>> &values =
+          elementNodeDataSet.values[j];
+      if (binary) {
+        writeBinary(output, elementNodeDataSet.elementIndices[j]);
+        writeBinary(output, static_cast<int>(values.size()));
+        for (int k = 0; k < values.size(); ++k)
+          writeBinary(output, values[k].data(), values[k].size());
+      } else {
+        output << elementNodeDataSet.elementIndices[j] << " "
+               << values.size();
+        for (int k = 0; k < values.size(); ++k)
+          for (int l = 0; l < values[k].size(); ++l)
+            output << " " << values[k][l];
+        output << "\n";
       }
-      output << elementNodeDataSet.realTags.size() << std::endl;
-      for (int i = 0; i < elementNodeDataSet.realTags.size(); ++i) {
-        output << boost::lexical_cast<std::string>(
-                      elementNodeDataSet.realTags[i]) << std::endl;
-      }
-      output << 4 << std::endl; // Number of integer tags
-      output << elementNodeDataSet.timeStep << std::endl;
-      output << elementNodeDataSet.numberOfFieldComponents << std::endl;
-      output << elementNodeDataSet.values.size() << std::endl;
-      output << elementNodeDataSet.partition << std::endl;
-      for (int i = 0; i < elementNodeDataSet.values.size(); ++i) {
-        output << elementNodeDataSet.elementIndices[i] << " "
-               << elementNodeDataSet.values[i].size();
-        for (int j = 0; j < elementNodeDataSet.values[i].size(); ++j) {
-          for (int k = 0; k < elementNodeDataSet.values[i][j].size(); ++k)
-            output << " " << boost::lexical_cast<std::string>(
-                                 elementNodeDataSet.values[i][j][k]);
-        }
-        output << std::endl;
-      }
-      output << "$EndElementNodeData" << std::endl;
     }
+    if (binary)
+      output << std::endl;
+    output << "$EndElementNodeData" << std::endl;
   }
 
   for (int i = 0; i < m_interpolationSchemeSets.size(); ++i) {
@@ -642,17 +1027,25 @@ void GmshData::write(std::ostream &output) const {
     }
     output << "$EndInterpolationScheme" << std::endl;
   }
+
+  output.precision(oldPrecision);
 }
-void GmshData::write(const std::string &fileName) const {
+
+void GmshData::write(const std::string &fileName, bool binary) const {
 
   std::ofstream out;
-  out.open(fileName.c_str(), std::ios::trunc);
-  write(out);
+  out.open(fileName.c_str(), binary ? std::ios::trunc | std::ios::binary
+                                    : std::ios::trunc);
+  if (!out)
+    throw std::runtime_error("GmshData::write(): Cannot open file " +
+                             fileName + ".");
+  write(out, binary);
   out.close();
 }
 
-GmshData GmshData::read(std::istream &input, int elementType,
-                        int physicalEntity) {
+GmshData GmshData::readBuffer(const char *begin, const char *end,
+                              int elementType, int physicalEntity,
+                              bool verbose) {
 
   bool haveMeshFormat = false;
   bool haveNodes = false;
@@ -661,402 +1054,324 @@ GmshData GmshData::read(std::istream &input, int elementType,
   bool havePhysicalNames = false;
 
   GmshData gmshData;
+  GmshBuffer buffer(begin, end);
+
+  // Work arrays reused for all elements
+  std::vector<int> record;
+  std::vector<int> nodes;
+  std::vector<int> partitions;
 
-  std::string line;
-  while (std::getline(input, line)) {
+  while (!buffer.finished()) {
+    const std::string line = buffer.readLine();
 
     if (line == "$MeshFormat") {
       if (haveMeshFormat)
         throw std::runtime_error(
             "GmshData::read(): MeshFormat Section appears more than once.");
-      std::cout << "Reading MeshFormat..." << std::endl;
-      std::getline(input, line);
-      StringVector tokens = stringTokens(line);
-      if (tokens.size() != 3)
+      if (verbose)
+        std::cout << "Reading MeshFormat..." << std::endl;
+      std::istringstream format(buffer.readLine());
+      std::string version;
+      int fileType, dataSize;
+      if (!(format >> version >> fileType >> dataSize))
         throw std::runtime_error(
             "GmshData::read(): Wrong format of MeshFormat");
-      if (tokens[0] != "2" & tokens[0] != "2.2")
+      if (version != "2" && version != "2.2")
         throw std::runtime_error(
             "GmshData::read(): Version of MSH file not supported.");
-      if (boost::lexical_cast<int>(tokens[1]) != 0)
+      if (fileType != 0 && fileType != 1)
         throw std::runtime_error("GmshData::read(): File Type not supported.");
-      int dataSize = boost::lexical_cast<int>(tokens[2]);
       if (dataSize != sizeof(double))
         throw std::runtime_error(
             "MeshFormat::read(): Data size not supported.");
-      std::getline(input, line);
-      if (line != "$EndMeshFormat")
-        throw std::runtime_error(
-            "GmshData::read(): Error reading MeshFormat section.");
+      if (fileType == 1) {
+        // The integer 1 written in binary form identifies the byte order
+        if (buffer.readBinary<int>() != 1)
+          throw std::runtime_error(
+              "GmshData::read(): Byte order of binary MSH file not "
+              "supported.");
+        buffer.endLine();
+      }
+      buffer.expectLine("$EndMeshFormat", "MeshFormat");
+      buffer.setBinary(fileType == 1);
+      gmshData.m_versionNumber = version;
+      gmshData.m_fileType = fileType;
+      gmshData.m_dataSize = dataSize;
       haveMeshFormat = true;
 
     } else if (line == "$Nodes") {
       if (haveNodes)
         throw std::runtime_error(
             "GmshData::read(): Nodes section appears more than once. ");
-      std::cout << "Reading Nodes..." << std::endl;
-      std::getline(input, line);
-      int numberOfNodes = boost::lexical_cast<int>(line);
+      if (verbose)
+        std::cout << "Reading Nodes..." << std::endl;
+      const int numberOfNodes = buffer.readInt();
+      buffer.endLine();
       gmshData.reserveNumberOfNodes(numberOfNodes);
+      double coords[3];
       for (int i = 0; i < numberOfNodes; ++i) {
-        std::getline(input, line);
-        StringVector tokens = stringTokens(line);
-        if (tokens.size() != 4)
-          throw std::runtime_error(
-              "GmshData::read(): Wrong format of node definition detected.");
-        int index = boost::lexical_cast<int>(tokens[0]);
-        double x = boost::lexical_cast<double>(tokens[1]);
-        double y = boost::lexical_cast<double>(tokens[2]);
-        double z = boost::lexical_cast<double>(tokens[3]);
-        gmshData.addNode(index, x, y, z);
+        const int index = buffer.readDataInt();
+        buffer.readDataDoubles(coords, 3);
+        buffer.endRecord();
+        gmshData.addNode(index, coords[0], coords[1], coords[2]);
       }
-      std::getline(input, line);
-      if (line != "$EndNodes")
-        throw std::runtime_error(
-            "GmshData::read(): Error reading Nodes section. ");
+      buffer.endData();
+      buffer.expectLine("$EndNodes", "Nodes");
       haveNodes = true;
+
     } else if (line == "$Elements") {
       if (haveElements)
         throw std::runtime_error(
             "GmshData::read(): Elements section appears more than once.");
-      std::cout << "Reading Elements..." << std::endl;
-      std::getline(input, line);
-      int numberOfElements = boost::lexical_cast<int>(line);
-      for (int i = 0; i < numberOfElements; ++i) {
-        std::getline(input, line);
-        StringVector tokens = stringTokens(line);
-        int index = boost::lexical_cast<int>(tokens.at(0));
-        int currentElementType = boost::lexical_cast<int>(tokens.at(1));
-        int ntags = boost::lexical_cast<int>(tokens.at(2));
-        int currentPhysicalEntity = boost::lexical_cast<int>(tokens.at(3));
-        int elementaryEntity = boost::lexical_cast<int>(tokens.at(4));
-        int npartitions = 0;
-        if (ntags > 5)
-          npartitions = boost::lexical_cast<int>(tokens.at(5));
-        std::vector<int> partitions;
-        for (int i = 0; i < npartitions; ++i)
-          partitions.push_back(boost::lexical_cast<int>(tokens.at(6 + i)));
-        std::vector<int> nodes;
-        for (int i = 3 + ntags; i < tokens.size(); ++i)
-          nodes.push_back(boost::lexical_cast<int>(tokens.at(i)));
+      if (verbose)
+        std::cout << "Reading Elements..." << std::endl;
+      const int numberOfElements = buffer.readInt();
+      buffer.endLine();
+      gmshData.reserveNumberOfElements(numberOfElements);
+
+      // Store an element whose tags are tags[0], ..., tags[ntags - 1] and
+      // whose nodes are in the array nodes
+      auto storeElement = [&](int index, int currentElementType,
+                              const int *tags, int ntags) {
+        const int currentPhysicalEntity = ntags > 0 ? tags[0] : 0;
+        const int elementaryEntity = ntags > 1 ? tags[1] : 0;
+        partitions.clear();
+        if (ntags > 2)
+          for (int j = 0; j < tags[2] && 3 + j < ntags; ++j)
+            partitions.push_back(tags[3 + j]);
         if ((elementType == -1 || currentElementType == elementType) &&
-            (physicalEntity == -1 || currentPhysicalEntity == physicalEntity)) {
-          gmshData.addElement(index, currentElementType, nodes, physicalEntity,
-                              elementaryEntity, partitions);
-          gmshData.m_elementIndices.insert(index);
+            (physicalEntity == -1 || currentPhysicalEntity == physicalEntity))
+          gmshData.addElement(index, currentElementType, nodes,
+                              currentPhysicalEntity, elementaryEntity,
+                              partitions);
+      };
+
+      if (buffer.binary()) {
+        // Elements are stored in blocks of elements with the same type and
+        // number of tags, each preceded by a header of three integers
+        int i = 0;
+        while (i < numberOfElements) {
+          const int currentElementType = buffer.readBinary<int>();
+          const int blockSize = buffer.readBinary<int>();
+          const int ntags = buffer.readBinary<int>();
+          const int numberOfNodes = numberOfElementNodes(currentElementType);
+          if (numberOfNodes == 0)
+            throw std::runtime_error("GmshData::read(): Element type not "
+                                     "supported in binary files.");
+          if (blockSize <= 0 || blockSize > numberOfElements - i || ntags < 0)
+            throw std::runtime_error(
+                "GmshData::read(): Wrong format of element block.");
+          record.resize(1 + ntags + numberOfNodes);
+          for (int k = 0; k < blockSize; ++k) {
+            buffer.readBinary(record.data(), record.size());
+            nodes.assign(record.begin() + 1 + ntags, record.end());
+            storeElement(record[0], currentElementType, &record[1], ntags);
+          }
+          i += blockSize;
+        }
+        buffer.endLine();
+      } else {
+        for (int i = 0; i < numberOfElements; ++i) {
+          const int index = buffer.readInt();
+          const int currentElementType = buffer.readInt();
+          const int ntags = buffer.readInt();
+          record.clear();
+          for (int j = 0; j < ntags; ++j)
+            record.push_back(buffer.readInt());
+          nodes.clear();
+          while (!buffer.atEndOfLine())
+            nodes.push_back(buffer.readInt());
+          buffer.endLine();
+          storeElement(index, currentElementType, record.data(), ntags);
         }
       }
-      std::getline(input, line);
-      if (line != "$EndElements")
-        throw std::runtime_error(
-            "GmshData::read(): Error reading Elements section. ");
+      buffer.expectLine("$EndElements", "Elements");
       haveElements = true;
 
     } else if (line == "$Periodic") {
       if (havePeriodic)
         throw std::runtime_error(
             "GmshData::read(): Periodic section appears more than once.");
-      std::cout << "Reading Periodic..." << std::endl;
-      std::getline(input, line);
-      int numberOfPeriodicEntities = boost::lexical_cast<int>(line);
+      if (verbose)
+        std::cout << "Reading Periodic..." << std::endl;
+      const int numberOfPeriodicEntities = buffer.readInt();
+      buffer.endLine();
       for (int i = 0; i < numberOfPeriodicEntities; ++i) {
-        std::getline(input, line);
-        StringVector tokens = stringTokens(line);
-        if (tokens.size() != 3)
-          throw std::runtime_error(
-              "GmshData::read(): Wrong format for periodic entities.");
-        int dimension = boost::lexical_cast<int>(tokens[0]);
-        int slaveTag = boost::lexical_cast<int>(tokens[1]);
-        int masterTag = boost::lexical_cast<int>(tokens[2]);
+        const int dimension = buffer.readInt();
+        const int slaveTag = buffer.readInt();
+        const int masterTag = buffer.readInt();
+        buffer.endLine();
         gmshData.addPeriodicEntity(dimension, slaveTag, masterTag);
       }
 
-      std::getline(input, line);
-      int numberOfPeriodicNodes = boost::lexical_cast<int>(line);
+      const int numberOfPeriodicNodes = buffer.readInt();
+      buffer.endLine();
       for (int i = 0; i < numberOfPeriodicNodes; ++i) {
-        std::getline(input, line);
-        StringVector tokens = stringTokens(line);
-        if (tokens.size() != 2)
-          throw std::runtime_error(
-              "GmshData::read(): Wrong format for periodic nodes.");
-        int slaveNode = boost::lexical_cast<int>(tokens[0]);
-        int masterNode = boost::lexical_cast<int>(tokens[1]);
+        const int slaveNode = buffer.readInt();
+        const int masterNode = buffer.readInt();
+        buffer.endLine();
         gmshData.addPeriodicNode(slaveNode, masterNode);
       }
-      std::getline(input, line);
-      if (line != "$EndPeriodic")
-        throw std::runtime_error(
-            "GmshData::read(): Error reading Periodic section.");
+      buffer.expectLine("$EndPeriodic", "Periodic");
       havePeriodic = true;
+
     } else if (line == "$PhysicalNames") {
       if (havePhysicalNames)
         throw std::runtime_error(
             "GmshData::read(): PhysicalNames section appears more than once.");
-      std::cout << "Reading PhysicalNames..." << std::endl;
-      std::getline(input, line);
-      int numberOfPhysicalNames = boost::lexical_cast<int>(line);
+      if (verbose)
+        std::cout << "Reading PhysicalNames..." << std::endl;
+      const int numberOfPhysicalNames = buffer.readInt();
+      buffer.endLine();
       for (int i = 0; i < numberOfPhysicalNames; ++i) {
-        std::getline(input, line);
-        StringVector tokens = stringTokens(line);
-        if (tokens.size() != 3)
+        const int dimension = buffer.readInt();
+        const int number = buffer.readInt();
+        std::string name = buffer.readLine();
+        name.erase(0, name.find_first_not_of(" \t"));
+        if (name.empty())
           throw std::runtime_error(
               "PhysicalNamesSet::read(): Wrong format for physical names.");
-        int dimension = boost::lexical_cast<int>(tokens[0]);
-        int number = boost::lexical_cast<int>(tokens[1]);
-        std::string name = tokens[2];
         gmshData.addPhysicalName(dimension, number, name);
       }
-      std::getline(input, line);
-      if (line != "$EndPhysicalNames")
-        throw std::runtime_error(
-            "GmshData::read(): Error reading PhysicalNames section.");
+      buffer.expectLine("$EndPhysicalNames", "PhysicalNames");
       havePhysicalNames = true;
 
     } else if (line == "$NodeData") {
 
-      std::cout << "Reading NodeData..." << std::endl;
-      std::getline(input, line);
-      int numberOfStringTags = boost::lexical_cast<int>(line);
+      if (verbose)
+        std::cout << "Reading NodeData..." << std::endl;
       std::vector<std::string> stringTags;
-      for (int i = 0; i < numberOfStringTags; ++i) {
-        std::getline(input, line);
-        line.erase(std::remove(line.begin(), line.end(), '\"'), line.end());
-        stringTags.push_back(line);
-      }
-
-      // Real tags
-      std::getline(input, line);
-      int numberOfRealTags = boost::lexical_cast<int>(line);
       std::vector<double> realTags;
-      for (int i = 0; i < numberOfRealTags; ++i) {
-        std::getline(input, line);
-        realTags.push_back(boost::lexical_cast<double>(line));
-      }
-
-      // Integer tags
-      std::getline(input, line);
-      int numberOfIntegerTags = boost::lexical_cast<int>(line);
-      if (numberOfIntegerTags < 3)
-        throw std::runtime_error(
-            "GmshData::read(): At least 3 integer tags required.");
       std::vector<int> integerTags;
-      for (int i = 0; i < numberOfIntegerTags; ++i) {
-        std::getline(input, line);
-        integerTags.push_back(boost::lexical_cast<int>(line));
-      }
-      int timeStep = integerTags[0];
-      int numberOfFieldComponents = integerTags[1];
-      int numberOfNodes = integerTags[2];
-      int partition = 0;
-      if (integerTags.size() > 3)
-        partition = integerTags[3];
-      int dataSetIndex = gmshData.numberOfNodeDataSets();
+      readDataSetTags(buffer, stringTags, realTags, integerTags);
+      const int timeStep = integerTags[0];
+      const int numberOfFieldComponents = integerTags[1];
+      const int numberOfNodes = integerTags[2];
+      const int partition = integerTags.size() > 3 ? integerTags[3] : 0;
+      const int dataSetIndex = gmshData.numberOfNodeDataSets();
       gmshData.addNodeDataSet(stringTags, realTags, numberOfFieldComponents,
                               numberOfNodes, timeStep, partition);
 
+      std::vector<double> values(numberOfFieldComponents);
       for (int i = 0; i < numberOfNodes; ++i) {
-        std::getline(input, line);
-        StringVector tokens = stringTokens(line);
-        if (tokens.size() != 1 + numberOfFieldComponents)
-          throw std::runtime_error("GmshData::read(): Data has wrong format.");
-        int index = boost::lexical_cast<int>(tokens[0]);
-        std::vector<double> values;
-        for (int j = 1; j < tokens.size(); ++j) {
-          values.push_back(boost::lexical_cast<double>(tokens[j]));
-        }
+        const int index = buffer.readDataInt();
+        buffer.readDataDoubles(values.data(), values.size());
+        buffer.endRecord();
         gmshData.addNodeData(dataSetIndex, index, values);
       }
-
-      std::getline(input, line);
-      if (line != "$EndNodeData")
-        throw std::runtime_error(
-            "GmshData::read(): Error reading NodeData section.");
+      buffer.endData();
+      buffer.expectLine("$EndNodeData", "NodeData");
 
     } else if (line == "$ElementData") {
 
-      std::cout << "Reading ElementData..." << std::endl;
-      std::getline(input, line);
-      int numberOfStringTags = boost::lexical_cast<int>(line);
+      if (verbose)
+        std::cout << "Reading ElementData..." << std::endl;
       std::vector<std::string> stringTags;
-      for (int i = 0; i < numberOfStringTags; ++i) {
-        std::getline(input, line);
-        line.erase(std::remove(line.begin(), line.end(), '\"'), line.end());
-        stringTags.push_back(line);
-      }
-
-      // Real tags
-      std::getline(input, line);
-      int numberOfRealTags = boost::lexical_cast<int>(line);
       std::vector<double> realTags;
-      for (int i = 0; i < numberOfRealTags; ++i) {
-        std::getline(input, line);
-        realTags.push_back(boost::lexical_cast<double>(line));
-      }
-
-      // Integer tags
-      std::getline(input, line);
-      int numberOfIntegerTags = boost::lexical_cast<int>(line);
-      if (numberOfIntegerTags < 3)
-        throw std::runtime_error(
-            "GmshData::read(): At least 3 integer tags required.");
       std::vector<int> integerTags;
-      for (int i = 0; i < numberOfIntegerTags; ++i) {
-        std::getline(input, line);
-        integerTags.push_back(boost::lexical_cast<int>(line));
-      }
-      int timeStep = integerTags[0];
-      int numberOfFieldComponents = integerTags[1];
-      int numberOfElements = integerTags[2];
-      int partition = 0;
-      if (integerTags.size() > 3)
-        partition = integerTags[3];
-      int dataSetIndex = gmshData.numberOfElementDataSets();
+      readDataSetTags(buffer, stringTags, realTags, integerTags);
+      const int timeStep = integerTags[0];
+      const int numberOfFieldComponents = integerTags[1];
+      const int numberOfElements = integerTags[2];
+      const int partition = integerTags.size() > 3 ? integerTags[3] : 0;
+      const int dataSetIndex = gmshData.numberOfElementDataSets();
       gmshData.addElementDataSet(stringTags, realTags, numberOfFieldComponents,
                                  numberOfElements, timeStep, partition);
 
+      std::vector<double> values(numberOfFieldComponents);
       for (int i = 0; i < numberOfElements; ++i) {
-        std::getline(input, line);
-        StringVector tokens = stringTokens(line);
-        if (tokens.size() != 1 + numberOfFieldComponents)
-          throw std::runtime_error("GmshData::read(): Data has wrong format.");
-        int index = boost::lexical_cast<int>(tokens[0]);
-        std::vector<double> values;
-        for (int j = 1; j < tokens.size(); ++j) {
-          values.push_back(boost::lexical_cast<double>(tokens[j]));
-        }
-        if (gmshData.m_elementIndices.find(index) !=
-            gmshData.m_elementIndices.end())
+        const int index = buffer.readDataInt();
+        buffer.readDataDoubles(values.data(), values.size());
+        buffer.endRecord();
+        if (gmshData.elementPosition(index) != -1)
           gmshData.addElementData(dataSetIndex, index, values);
       }
-
-      std::getline(input, line);
-      if (line != "$EndElementData")
-        throw std::runtime_error(
-            "GmshData::read(): Error reading ElementData section.");
+      buffer.endData();
+      buffer.expectLine("$EndElementData", "ElementData");
 
     } else if (line == "$ElementNodeData") {
 
-      std::cout << "Reading ElementNodeData..." << std::endl;
-      std::getline(input, line);
-      int numberOfStringTags = boost::lexical_cast<int>(line);
+      if (verbose)
+        std::cout << "Reading ElementNodeData..." << std::endl;
       std::vector<std::string> stringTags;
-      for (int i = 0; i < numberOfStringTags; ++i) {
-        std::getline(input, line);
-        line.erase(std::remove(line.begin(), line.end(), '\"'), line.end());
-        stringTags.push_back(line);
-      }
-
-      // Real tags
-      std::getline(input, line);
-      int numberOfRealTags = boost::lexical_cast<int>(line);
       std::vector<double> realTags;
-      for (int i = 0; i < numberOfRealTags; ++i) {
-        std::getline(input, line);
-        realTags.push_back(boost::lexical_cast<double>(line));
-      }
-
-      // Integer tags
-      std::getline(input, line);
-      int numberOfIntegerTags = boost::lexical_cast<int>(line);
-      if (numberOfIntegerTags < 3)
-        throw std::runtime_error(
-            "GmshData::read(): At least 3 integer tags required.");
       std::vector<int> integerTags;
-      for (int i = 0; i < numberOfIntegerTags; ++i) {
-        std::getline(input, line);
-        integerTags.push_back(boost::lexical_cast<int>(line));
-      }
-      int timeStep = integerTags[0];
-      int numberOfFieldComponents = integerTags[1];
-      int numberOfElements = integerTags[2];
-      int partition = 0;
-      if (integerTags.size() > 3)
-        partition = integerTags[3];
-      int dataSetIndex = gmshData.numberOfElementDataSets();
+      readDataSetTags(buffer, stringTags, realTags, integerTags);
+      const int timeStep = integerTags[0];
+      const int numberOfFieldComponents = integerTags[1];
+      const int numberOfElements = integerTags[2];
+      const int partition = integerTags.size() > 3 ? integerTags[3] : 0;
+      const int dataSetIndex = gmshData.numberOfElementNodeDataSets();
       gmshData.addElementNodeDataSet(stringTags, realTags,
                                      numberOfFieldComponents, numberOfElements,
                                      timeStep, partition);
 
       for (int i = 0; i < numberOfElements; ++i) {
-        std::getline(input, line);
-        StringVector tokens = stringTokens(line);
-        if (tokens.size() < 2)
-          throw std::runtime_error("GmshData::read(): Data has wrong format.");
-        int numberOfNodes = boost::lexical_cast<int>(tokens[1]);
-        if (tokens.size() != 2 + numberOfFieldComponents * numberOfNodes)
+        const int index = buffer.readDataInt();
+        const int numberOfNodes = buffer.readDataInt();
+        if (numberOfNodes < 0)
           throw std::runtime_error("GmshData::read(): Data has wrong format.");
-        int index = boost::lexical_cast<int>(tokens[0]);
-        std::vector<std::vector<double>> values;
-        for (int j = 0; j < numberOfNodes; ++j) {
-          values.push_back(std::vector<double>());
-          for (int k = 0; k < numberOfFieldComponents; ++k)
-            values[j].push_back(boost::lexical_cast<double>(
-                tokens[2 + j * numberOfFieldComponents + k]));
-        }
-        if (gmshData.m_elementIndices.find(index) !=
-            gmshData.m_elementIndices.end())
+        std::vector<std::vector<double>> values(
+            numberOfNodes, std::vector<double>(numberOfFieldComponents));
+        for (int j = 0; j < numberOfNodes; ++j)
+          buffer.readDataDoubles(values[j].data(), values[j].size());
+        buffer.endRecord();
+        if (gmshData.elementPosition(index) != -1)
           gmshData.addElementNodeData(dataSetIndex, index, values);
       }
-
-      std::getline(input, line);
-      if (line != "$EndElementNodeData")
-        throw std::runtime_error(
-            "GmshData::read(): Error reading ElementNodeData section.");
+      buffer.endData();
+      buffer.expectLine("$EndElementNodeData", "ElementNodeData");
 
     } else if (line == "$InterpolationSchemeSet") {
 
-      std::cout << "Reading InterpolationSchemSet..." << std::endl;
-      std::getline(input, line);
-      line.erase(std::remove(line.begin(), line.end(), '\"'), line.end());
-      std::string name = line;
-      std::getline(input, line);
-      if (boost::lexical_cast<int>(line) != 1)
+      if (verbose)
+        std::cout << "Reading InterpolationSchemSet..." << std::endl;
+      std::string name = buffer.readLine();
+      name.erase(std::remove(name.begin(), name.end(), '\"'), name.end());
+      if (buffer.readInt() != 1)
         throw std::runtime_error(
             "GmshData::read(): Only one topology is currently supported.");
-      std::getline(input, line);
-      int topology = boost::lexical_cast<int>(line);
-      int dataSetIndex = gmshData.numberOfInterpolationSchemeSets();
+      buffer.endLine();
+      const int topology = buffer.readInt();
+      buffer.endLine();
+      const int dataSetIndex = gmshData.numberOfInterpolationSchemeSets();
       gmshData.addInterpolationSchemeSet(name, topology);
-      std::getline(input, line);
-      int numberOfInterpolationMatrices = boost::lexical_cast<int>(line);
+      const int numberOfInterpolationMatrices = buffer.readInt();
+      buffer.endLine();
       for (int i = 0; i < numberOfInterpolationMatrices; ++i) {
+        const int nrows = buffer.readInt();
+        const int ncols = buffer.readInt();
+        buffer.endLine();
         std::vector<double> matrix;
-        std::getline(input, line);
-        StringVector tokens = stringTokens(line);
-        if (tokens.size() != 2)
-          throw std::runtime_error(
-              "GmshData::read(): Wrong format of interpolation matrices.");
-        int nrows = boost::lexical_cast<int>(tokens[0]);
-        int ncols = boost::lexical_cast<int>(tokens[1]);
         matrix.reserve(nrows * ncols);
         for (int j = 0; j < nrows; ++j) {
-          std::getline(input, line);
-          StringVector tokens = stringTokens(line);
-          if (tokens.size() != ncols)
-            throw std::runtime_error(
-                "GmshData::read(): Wrong format of interpolation matrices.");
           for (int k = 0; k < ncols; ++k)
-            matrix.push_back(boost::lexical_cast<double>(tokens[k]));
+            matrix.push_back(buffer.readDouble());
+          buffer.endLine();
         }
         gmshData.addInterpolationMatrix(dataSetIndex, nrows, ncols, matrix);
       }
-      std::getline(input, line);
-      if (line != "$EndInterpolationSchemeSet")
-        throw std::runtime_error(
-            "GmshData::read(): Error reading InterpolationSchemeSet section.");
+      buffer.expectLine("$EndInterpolationSchemeSet", "InterpolationSchemeSet");
     }
   }
   return gmshData;
 }
 
+GmshData GmshData::read(std::istream &input, int elementType,
+                        int physicalEntity, bool verbose) {
+
+  const std::string contents((std::istreambuf_iterator<char>(input)),
+                             std::istreambuf_iterator<char>());
+  return readBuffer(contents.data(), contents.data() + contents.size(),
+                    elementType, physicalEntity, verbose);
+}
+
 GmshData GmshData::read(const std::string &fileName, int elementType,
-                        int physicalEntity) {
+                        int physicalEntity, bool verbose) {
 
-  std::ifstream(input);
-  input.open(fileName.c_str());
-  GmshData gmshData = read(input, elementType, physicalEntity);
-  input.close();
-  return gmshData;
+  MappedFile file(fileName);
+  return readBuffer(file.begin(), file.end(), elementType, physicalEntity,
+                    verbose);
 }
 
 void GmshData::resetNodeDataSets() { m_nodeDataSets.clear(); }
@@ -1148,67 +1463,63 @@ shared_ptr<const Grid> GmshIo::grid() const {
   if (m_grid)
     return m_grid;
 
+  const std::vector<int> &nodeIndices = m_gmshData.nodeIndices();
+  const std::vector<double> &nodeCoordinates = m_gmshData.nodeCoordinates();
+  const std::vector<int> &elementIndices = m_gmshData.elementIndices();
+  const std::vector<int> &elementTypes = m_gmshData.elementTypes();
+  const std::vector<int> &physicalEntities =
+      m_gmshData.elementPhysicalEntities();
+  const std::vector<int> &offsets = m_gmshData.elementNodeOffsets();
+  const std::vector<int> &elementNodes = m_gmshData.elementNodes();
+
   // Sanity check on the Gmsh Data
 
-  std::vector<int> nodeIndices;
-  m_gmshData.getNodeIndices(nodeIndices);
-  std::vector<int> elementIndices;
-  m_gmshData.getElementIndices(elementIndices);
+  if (nodeIndices.empty() || elementIndices.empty())
+    throw std::runtime_error("GmshIo::grid(): No nodes or elements found.");
 
   int maxNodeIndex =
       *(std::max_element(nodeIndices.begin(), nodeIndices.end()));
   int maxElementIndex =
       *(std::max_element(elementIndices.begin(), elementIndices.end()));
 
-  std::vector<std::vector<int>> elements;
-
   m_inverseNodePermutation.resize(maxNodeIndex + 1, -1);
   m_inverseElementPermutation.resize(maxElementIndex + 1, -1);
+  std::vector<int> corners;
+  corners.reserve(3 * elementTypes.size());
   std::vector<int> domainIndices;
 
-  for (int i = 0; i < elementIndices.size(); ++i) {
-    int physicalEntity;
-    int elementaryEntity;
-    int elementType;
-    int index = elementIndices[i];
-    std::vector<int> nodes;
-
-    m_gmshData.getElement(index, elementType, nodes, physicalEntity,
-                          elementaryEntity);
-    if (elementType == 2) {
-      int elementIndex = m_elementPermutation.size();
-      m_elementPermutation.push_back(index);
-      m_inverseElementPermutation[index] = elementIndex;
-      elements.push_back(std::vector<int>());
-      domainIndices.push_back(physicalEntity);
-      std::vector<int> &currentNodes = elements.back();
-      for (int j = 0; j < nodes.size(); ++j) {
-        int nodeIndex;
-        if (m_inverseNodePermutation[nodes[j]] == -1) { // Node not yet assigned
-          nodeIndex = m_nodePermutation.size();
-          m_inverseNodePermutation[nodes[j]] = nodeIndex;
-          m_nodePermutation.push_back(nodes[j]);
-        } else {
-          nodeIndex = m_inverseNodePermutation[nodes[j]];
-        }
-        currentNodes.push_back(nodeIndex);
+  // Second-order triangles (type 9) are imported as flat triangles: only
+  // their corner nodes, which come first, are used
+  for (int i = 0; i < elementTypes.size(); ++i) {
+    if (elementTypes[i] != 2 && elementTypes[i] != 9)
+      continue;
+    if (offsets[i + 1] - offsets[i] != numberOfElementNodes(elementTypes[i]))
+      throw std::runtime_error(
+          "GmshIo::grid(): Triangle with wrong number of nodes.");
+    const int index = elementIndices[i];
+    m_inverseElementPermutation[index] = m_elementPermutation.size();
+    m_elementPermutation.push_back(index);
+    domainIndices.push_back(physicalEntities[i]);
+    for (int j = offsets[i]; j < offsets[i] + 3; ++j) {
+      const int node = elementNodes[j];
+      if (m_gmshData.nodePosition(node) == -1)
+        throw std::runtime_error(
+            "GmshIo::grid(): Element refers to a nonexistent node.");
+      if (m_inverseNodePermutation[node] == -1) { // Node not yet assigned
+        m_inverseNodePermutation[node] = m_nodePermutation.size();
+        m_nodePermutation.push_back(node);
       }
+      corners.push_back(m_inverseNodePermutation[node]);
     }
   }
   arma::Mat<double> armaNodes(3, m_nodePermutation.size());
-  arma::Mat<int> armaElements(3, m_elementPermutation.size());
   for (int i = 0; i < m_nodePermutation.size(); ++i) {
-    double x, y, z;
-    m_gmshData.getNode(m_nodePermutation[i], x, y, z);
-    armaNodes(0, i) = x;
-    armaNodes(1, i) = y;
-    armaNodes(2, i) = z;
-  }
-  for (int i = 0; i < m_elementPermutation.size(); ++i) {
-    armaElements(0, i) = elements[i][0];
-    armaElements(1, i) = elements[i][1];
-    armaElements(2, i) = elements[i][2];
+    const int position = m_gmshData.nodePosition(m_nodePermutation[i]);
+    armaNodes(0, i) = nodeCoordinates[3 * position];
+    armaNodes(1, i) = nodeCoordinates[3 * position + 1];
+    armaNodes(2, i) = nodeCoordinates[3 * position + 2];
   }
+  arma::Mat<int> armaElements(corners.data(), 3, m_elementPermutation.size());
   GridParameters params;
   params.topology = GridParameters::TRIANGULAR;
   m_grid = GridFactory::createGridFromConnectivityArrays(
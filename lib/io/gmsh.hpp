@@ -26,7 +26,6 @@
 #include <iostream>
 #include <string>
 #include <memory>
-#include <set>
 #include "../common/shared_ptr.hpp"
 #include "../assembly/grid_function.hpp"
 #include <armadillo>
@@ -155,8 +154,27 @@ public:
                                  std::vector<int> &ncols,
                                  std::vector<std::vector<double>> &values);
 
+  // Direct access to the node and element arrays. The arrays are ordered by
+  // position, i.e. in the order in which nodes and elements were added (the
+  // order of the file for data read by read()). The coordinates of the node
+  // at position i are nodeCoordinates()[3 * i + k], k = 0, 1, 2; the nodes
+  // of the element at position i are elementNodes()[j], where j ranges from
+  // elementNodeOffsets()[i] to elementNodeOffsets()[i + 1] - 1.
+  const std::vector<int> &nodeIndices() const;
+  const std::vector<double> &nodeCoordinates() const;
+  const std::vector<int> &elementIndices() const;
+  const std::vector<int> &elementTypes() const;
+  const std::vector<int> &elementPhysicalEntities() const;
+  const std::vector<int> &elementNodeOffsets() const;
+  const std::vector<int> &elementNodes() const;
+
+  // Return the position of the node (element) with Gmsh index index, or -1
+  // if no such node (element) exists.
+  int nodePosition(int index) const;
+  int elementPosition(int index) const;
+
   void reserveNumberOfNodes(int n);
-  void reserveNumberOfElements(int n);
+  void reserveNumberOfElements(int n, int nodesPerElement = 3);
 
   void resetNodeDataSets();
   void resetElementDataSets();
@@ -164,14 +182,26 @@ public:
 
   void resetDataSets();
 
-  void write(std::ostream &output) const;
-  void write(const std::string &fileName) const;
+  // Write the data in the MSH 2.2 format. If binary is true, the binary
+  // variant of the format is used; the stream must then be opened in binary
+  // mode.
+  void write(std::ostream &output, bool binary = false) const;
+  void write(const std::string &fileName, bool binary = false) const;
+
+  // Read data in the ASCII or binary MSH 2.2 format. Only elements of type
+  // elementType (all elements if -1) belonging to the physical entity
+  // physicalEntity (all entities if -1) are kept. Files are memory-mapped and
+  // parsed in place; streams are read into memory first.
   static GmshData read(std::istream &input, int elementType = 2,
-                       int physicalEntity = -1);
+                       int physicalEntity = -1, bool verbose = true);
   static GmshData read(const std::string &fileName, int elementType = 2,
-                       int physicalEntity = -1);
+                       int physicalEntity = -1, bool verbose = true);
 
 private:
+  static GmshData readBuffer(const char *begin, const char *end,
+                             int elementType, int physicalEntity,
+                             bool verbose);
+
   struct NodeDataSet {
 
     std::vector<std::string> stringTags;
@@ -222,20 +252,6 @@ private:
     int topology;
   };
 
-  struct Node {
-    double x;
-    double y;
-    double z;
-  };
-
-  struct Element {
-    int type;
-    int physicalEntity;
-    int elementaryEntity;
-    std::vector<int> nodes;
-    std::vector<int> partitions;
-  };
-
   struct PeriodicEntity {
     int dimension;
     int slaveTag;
@@ -256,13 +272,23 @@ private:
   std::string m_versionNumber;
   int m_fileType;
   int m_dataSize;
-  int m_numberOfNodes;
-  int m_numberOfElements;
-
-  std::vector<shared_ptr<Node>> m_nodes;
-  std::vector<shared_ptr<Element>> m_elements;
 
-  std::set<int> m_elementIndices;
+  // Nodes and elements are stored in flat arrays in the order in which they
+  // were added. The positions arrays map Gmsh indices to these positions
+  // (-1 if there is no node or element with a given index).
+  std::vector<int> m_nodeIndices;
+  std::vector<double> m_nodeCoordinates;
+  std::vector<int> m_nodePositions;
+
+  std::vector<int> m_elementIndices;
+  std::vector<int> m_elementTypes;
+  std::vector<int> m_elementPhysicalEntities;
+  std::vector<int> m_elementElementaryEntities;
+  std::vector<int> m_elementNodeOffsets;
+  std::vector<int> m_elementNodes;
+  std::vector<int> m_elementPartitionOffsets;
+  std::vector<int> m_elementPartitions;
+  std::vector<int> m_elementPositions;
 
   std::vector<PeriodicEntity> m_periodicEntities;
   std::vector<PeriodicNode> m_periodicNodes;
@@ -272,6 +272,24 @@ Teuchos::RCP<Teuchos::ParameterList> inline defaultCgParameterListInternal(
   return paramList;
 }
 
+template <typename MagnitudeType>
+Teuchos::RCP<Teuchos::ParameterList> inline defaultBlockParameterListInternal(
+    const char *solverType, MagnitudeType tol, int blockSize,
+    int maxIterationCount) {
+  if (blockSize < 1)
+    throw std::invalid_argument("defaultBlockParameterList(): "
+                                "block size must be positive");
+  Teuchos::RCP<Teuchos::ParameterList> paramList(
+      new Teuchos::ParameterList("DefaultParameters"));
+  paramList->set("Solver Type", solverType);
+  Teuchos::ParameterList &solverTypesList = paramList->sublist("Solver Types");
+  Teuchos::ParameterList &blockSolverList = solverTypesList.sublist(solverType);
+  blockSolverList.set("Convergence Tolerance", tol);
+  blockSolverList.set("Maximum Iterations", maxIterationCount);
+  blockSolverList.set("Block Size", blockSize);
+  return paramList;
+}
+
 } // namespace
 
 Teuchos::RCP<Teuchos::ParameterList>
@@ -294,6 +312,32 @@ defaultCgParameterList(float tol, int maxIterationCount) {
   return defaultCgParameterListInternal(tol, maxIterationCount);
 }
 
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockGmresParameterList(double tol, int blockSize,
+                               int maxIterationCount) {
+  return defaultBlockParameterListInternal("Block GMRES", tol, blockSize,
+                                           maxIterationCount);
+}
+
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockCgParameterList(double tol, int blockSize, int maxIterationCount) {
+  return defaultBlockParameterListInternal("Block CG", tol, blockSize,
+                                           maxIterationCount);
+}
+
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockGmresParameterList(float tol, int blockSize,
+                               int maxIterationCount) {
+  return defaultBlockParameterListInternal("Block GMRES", tol, blockSize,
+                                           maxIterationCount);
+}
+
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockCgParameterList(float tol, int blockSize, int maxIterationCount) {
+  return defaultBlockParameterListInternal("Block CG", tol, blockSize,
+                                           maxIterationCount);
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(BelosSolverWrapper);
 
 } // namespace Bempp
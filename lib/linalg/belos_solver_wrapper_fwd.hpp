@@ -23,6 +23,27 @@ defaultGmresParameterList(float tol, int maxIterationCount = 1000);
 Teuchos::RCP<Teuchos::ParameterList>
 defaultCgParameterList(float tol, int maxIterationCount = 1000);
 
+/** \brief Return a parameter list selecting the Block GMRES solver.
+ *
+ *  Block Krylov methods build a common subspace for \p blockSize right-hand
+ *  sides, applying the operator to \p blockSize vectors at a time. They are
+ *  intended for DefaultIterativeSolver::solveMultiple(). */
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockGmresParameterList(double tol, int blockSize,
+                               int maxIterationCount = 1000);
+/** \brief Return a parameter list selecting the Block CG solver.
+ *
+ *  \see defaultBlockGmresParameterList(). */
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockCgParameterList(double tol, int blockSize,
+                            int maxIterationCount = 1000);
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockGmresParameterList(float tol, int blockSize,
+                               int maxIterationCount = 1000);
+Teuchos::RCP<Teuchos::ParameterList>
+defaultBlockCgParameterList(float tol, int blockSize,
+                            int maxIterationCount = 1000);
+
 } // namespace Bempp
 
 #endif // WITH_TRILINOS
@@ -40,6 +40,7 @@
 #include "../space/space.hpp"
 
 #include <Teuchos_RCPBoostSharedPtrConversions.hpp>
+#include <Thyra_DefaultSpmdMultiVector.hpp>
 #include <Thyra_DefaultSpmdVectorSpace.hpp>
 
 #include <boost/make_shared.hpp>
@@ -61,6 +62,34 @@ wrapInTrilinosVector(arma::Col<ValueType> &col) {
                          trilinosArray, 1 /* stride */));
 }
 
+template <typename ValueType>
+Teuchos::RCP<Thyra::DefaultSpmdMultiVector<ValueType>>
+wrapInTrilinosMultiVector(arma::Mat<ValueType> &mat) {
+  Teuchos::ArrayRCP<ValueType> trilinosArray =
+      Teuchos::arcp(mat.memptr(), 0 /* lowerOffset */, mat.n_elem,
+                    false /* doesn't own memory */);
+  typedef Thyra::DefaultSpmdMultiVector<ValueType> TrilinosMultiVector;
+  return Teuchos::RCP<TrilinosMultiVector>(new TrilinosMultiVector(
+      Thyra::defaultSpmdVectorSpace<ValueType>(mat.n_rows),
+      Thyra::defaultSpmdVectorSpace<ValueType>(mat.n_cols), trilinosArray,
+      mat.n_rows /* leadingDim */));
+}
+
+namespace {
+
+int solverThreadCount(const Fiber::ParallelizationOptions &parallelOptions) {
+  int maxThreadCount = 1;
+  if (!parallelOptions.isOpenClEnabled()) {
+    if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
+      maxThreadCount = tbb::task_scheduler_init::automatic;
+    else
+      maxThreadCount = parallelOptions.maxThreadCount();
+  }
+  return maxThreadCount;
+}
+
+} // namespace
+
 /** \cond HIDDEN_INTERNAL */
 
 template <typename BasisFunctionType, typename ResultType>
@@ -249,15 +278,8 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
       wrapInTrilinosVector(armaSolution);
 
   // Get number of threads
-  Fiber::ParallelizationOptions parallelOptions =
-      boundaryOp->context()->assemblyOptions().parallelizationOptions();
-  int maxThreadCount = 1;
-  if (!parallelOptions.isOpenClEnabled()) {
-    if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
-      maxThreadCount = tbb::task_scheduler_init::automatic;
-    else
-      maxThreadCount = parallelOptions.maxThreadCount();
-  }
+  const int maxThreadCount = solverThreadCount(
+      boundaryOp->context()->assemblyOptions().parallelizationOptions());
 
   // Solve
   Thyra::SolveStatus<MagnitudeType> status;
@@ -341,15 +363,8 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
   assert(context);
 
   // Get number of threads
-  Fiber::ParallelizationOptions parallelOptions =
-      context->assemblyOptions().parallelizationOptions();
-  int maxThreadCount = 1;
-  if (!parallelOptions.isOpenClEnabled()) {
-    if (parallelOptions.maxThreadCount() == ParallelizationOptions::AUTO)
-      maxThreadCount = tbb::task_scheduler_init::automatic;
-    else
-      maxThreadCount = parallelOptions.maxThreadCount();
-  }
+  const int maxThreadCount = solverThreadCount(
+      context->assemblyOptions().parallelizationOptions());
 
   // Solve
   Thyra::SolveStatus<MagnitudeType> status;
@@ -371,6 +386,76 @@ DefaultIterativeSolver<BasisFunctionType, ResultType>::solveImplBlocked(
                                                         status);
 }
 
+template <typename BasisFunctionType, typename ResultType>
+BlockedSolution<BasisFunctionType, ResultType>
+DefaultIterativeSolver<BasisFunctionType, ResultType>::solveMultiple(
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs) const {
+  typedef BoundaryOperator<BasisFunctionType, ResultType> BoundaryOp;
+  typedef typename ScalarTraits<ResultType>::RealType MagnitudeType;
+
+  const BoundaryOp *boundaryOp = boost::get<BoundaryOp>(&m_impl->op);
+  if (!boundaryOp)
+    throw std::logic_error(
+        "DefaultIterativeSolver::solveMultiple(): only solvers constructed "
+        "from a (non-blocked) BoundaryOperator are supported");
+  if (rhs.empty())
+    throw std::invalid_argument("DefaultIterativeSolver::solveMultiple(): "
+                                "at least one right-hand side is required");
+  for (size_t i = 0; i < rhs.size(); ++i)
+    Solver<BasisFunctionType, ResultType>::checkConsistency(
+        *boundaryOp, rhs[i], m_impl->mode);
+
+  // Construct the right-hand-side multivector, one column per function
+  const size_t rhsCount = rhs.size();
+  arma::Mat<ResultType> armaProjections(
+      boundaryOp->dualToRange()->globalDofCount(), rhsCount);
+  for (size_t i = 0; i < rhsCount; ++i)
+    armaProjections.col(i) = rhs[i].projections(boundaryOp->dualToRange());
+
+  arma::Mat<ResultType> armaRangeRhs;
+  arma::Mat<ResultType> *armaRhs = &armaProjections;
+  if (m_impl->mode == ConvergenceTestMode::TEST_CONVERGENCE_IN_RANGE) {
+    armaRangeRhs.set_size(boundaryOp->range()->globalDofCount(), rhsCount);
+    boost::get<BoundaryOp>(m_impl->pinvId).weakForm()->apply(
+        NO_TRANSPOSE, armaProjections, armaRangeRhs, 1., 0.);
+    armaRhs = &armaRangeRhs;
+  }
+  Teuchos::RCP<Thyra::MultiVectorBase<ResultType>> rhsVectors =
+      wrapInTrilinosMultiVector(*armaRhs);
+
+  // Construct the solution multivector
+  arma::Mat<ResultType> armaSolution(boundaryOp->domain()->globalDofCount(),
+                                     rhsCount);
+  armaSolution.fill(static_cast<ResultType>(0.));
+  Teuchos::RCP<Thyra::MultiVectorBase<ResultType>> solutionVectors =
+      wrapInTrilinosMultiVector(armaSolution);
+
+  // Get number of threads
+  const int maxThreadCount = solverThreadCount(
+      boundaryOp->context()->assemblyOptions().parallelizationOptions());
+
+  // Solve
+  Thyra::SolveStatus<MagnitudeType> status;
+  {
+    // Initialize TBB threads here (to prevent their construction and
+    // destruction on every matrix-vector multiplication)
+    tbb::task_scheduler_init scheduler(maxThreadCount);
+    status = m_impl->solverWrapper->solve(Thyra::NOTRANS, *rhsVectors,
+                                          solutionVectors.ptr());
+  }
+
+  // Convert the columns of the solution multivector into grid functions
+  std::vector<GridFunction<BasisFunctionType, ResultType>> solutionFunctions;
+  solutionFunctions.reserve(rhsCount);
+  for (size_t i = 0; i < rhsCount; ++i)
+    solutionFunctions.push_back(GridFunction<BasisFunctionType, ResultType>(
+        boundaryOp->context(), boundaryOp->domain(),
+        arma::Col<ResultType>(armaSolution.col(i))));
+
+  return BlockedSolution<BasisFunctionType, ResultType>(solutionFunctions,
+                                                        status);
+}
+
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(DefaultIterativeSolver);
 
 } // namespace Bempp
@@ -128,6 +128,30 @@ public:
   void initializeSolver(const Teuchos::RCP<Teuchos::ParameterList> &paramList,
                         const Preconditioner<ResultType> &preconditioner);
 
+  /** \brief Solve a (non-blocked) boundary integral equation for several
+    * right-hand sides at once.
+    *
+    * All right-hand sides are passed to the Belos solver as a single
+    * multivector, so the discrete operators are applied to all of them in
+    * one go (as matrix-matrix rather than matrix-vector products). Use
+    * defaultBlockGmresParameterList() or defaultBlockCgParameterList() to
+    * select a block Krylov method; the standard (pseudo-block) solvers
+    * also benefit, iterating on each right-hand side separately but
+    * applying the operator to all of them together.
+    *
+    * \param[in] rhs
+    *   <tt>vector</tt> of GridFunction objects representing the right-hand
+    *   sides. All of them must be compatible with the boundary operator.
+    *
+    * \return A BlockedSolution object whose <tt>i</tt>th grid function is
+    *   the solution corresponding to <tt>rhs[i]</tt>. The status, achieved
+    *   tolerance and iteration count refer to the worst-converged
+    *   right-hand side.
+    */
+  BlockedSolution<BasisFunctionType, ResultType> solveMultiple(
+      const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
+      const;
+
 private:
   virtual Solution<BasisFunctionType, ResultType> solveImplNonblocked(
       const GridFunction<BasisFunctionType, ResultType> &rhs) const;
@@ -0,0 +1,75 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_direct_solver.hpp"
+
+#include "../assembly/discrete_boundary_operator.hpp"
+#include "../assembly/discrete_hmat_boundary_operator.hpp"
+#include "../fiber/explicit_instantiation.hpp"
+
+namespace Bempp {
+
+template <typename BasisFunctionType, typename ResultType>
+HMatDirectSolver<BasisFunctionType, ResultType>::HMatDirectSolver(
+    const BoundaryOperator<BasisFunctionType, ResultType> &boundaryOp,
+    double eps)
+    : m_op(boundaryOp), m_eps(eps),
+      m_inverse(hMatOperatorApproximateLuInverse(boundaryOp.weakForm(), eps)) {
+}
+
+template <typename BasisFunctionType, typename ResultType>
+HMatDirectSolver<BasisFunctionType, ResultType>::~HMatDirectSolver() {}
+
+template <typename BasisFunctionType, typename ResultType>
+Solution<BasisFunctionType, ResultType>
+HMatDirectSolver<BasisFunctionType, ResultType>::solveImplNonblocked(
+    const GridFunction<BasisFunctionType, ResultType> &rhs) const {
+  Solver<BasisFunctionType, ResultType>::checkConsistency(
+      m_op, rhs, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+
+  const arma::Col<ResultType> &projections =
+      rhs.projections(m_op.dualToRange());
+  arma::Col<ResultType> armaSolution(m_inverse->rowCount());
+  m_inverse->apply(NO_TRANSPOSE, projections, armaSolution, 1., 0.);
+
+  // The factors are only accurate to the truncation accuracy, so report it
+  // instead of claiming an exact solve.
+  typedef typename SolutionBase<BasisFunctionType, ResultType>::MagnitudeType
+      MagnitudeType;
+  return Solution<BasisFunctionType, ResultType>(
+      GridFunction<BasisFunctionType, ResultType>(m_op.context(), m_op.domain(),
+                                                  armaSolution),
+      SolutionStatus::CONVERGED, static_cast<MagnitudeType>(m_eps),
+      "Approximate H-LU solve finished");
+}
+
+template <typename BasisFunctionType, typename ResultType>
+BlockedSolution<BasisFunctionType, ResultType>
+HMatDirectSolver<BasisFunctionType, ResultType>::solveImplBlocked(
+    const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs) const {
+  throw std::logic_error(
+      "HMatDirectSolver::solve(): solvers constructed from a "
+      "(non-blocked) BoundaryOperator support only the other solve() "
+      "overload");
+}
+
+FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_BASIS_AND_RESULT(HMatDirectSolver);
+
+} // namespace Bempp
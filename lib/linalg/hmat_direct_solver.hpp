@@ -0,0 +1,76 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_hmat_direct_solver_hpp
+#define bempp_hmat_direct_solver_hpp
+
+#include "solver.hpp"
+
+#include "../assembly/boundary_operator.hpp"
+#include "../common/shared_ptr.hpp"
+
+namespace Bempp {
+
+/** \cond FORWARD_DECL */
+template <typename ValueType> class DiscreteBoundaryOperator;
+/** \endcond */
+
+/** \ingroup linalg
+  * \brief Direct solver based on the H-LU decomposition of an H-matrix.
+  *
+  * The weak form of the boundary operator must have been assembled in the
+  * "hmat" mode. It is factorised once, in the constructor; each call to
+  * solve() then costs only a pair of H-matrix triangular solves.
+  *
+  * The factorisation uses truncated H-matrix arithmetic, so the solution is
+  * only as accurate as the truncation accuracy \p eps allows (amplified by
+  * the condition number of the operator). The Solution objects returned by
+  * solve() report \p eps as their achieved tolerance.
+  */
+template <typename BasisFunctionType, typename ResultType>
+class HMatDirectSolver : public Solver<BasisFunctionType, ResultType> {
+public:
+  typedef Solver<BasisFunctionType, ResultType> Base;
+
+  /** \brief Construct a solver for a non-blocked boundary operator.
+   *
+   *  \param[in] boundaryOp Operator whose weak form is stored as an H-matrix.
+   *  \param[in] eps        Truncation accuracy of the H-matrix arithmetic. */
+  HMatDirectSolver(
+      const BoundaryOperator<BasisFunctionType, ResultType> &boundaryOp,
+      double eps = 1e-8);
+  ~HMatDirectSolver();
+
+private:
+  virtual Solution<BasisFunctionType, ResultType> solveImplNonblocked(
+      const GridFunction<BasisFunctionType, ResultType> &rhs) const;
+  virtual BlockedSolution<BasisFunctionType, ResultType> solveImplBlocked(
+      const std::vector<GridFunction<BasisFunctionType, ResultType>> &rhs)
+      const;
+
+private:
+  BoundaryOperator<BasisFunctionType, ResultType> m_op;
+  double m_eps;
+  shared_ptr<const DiscreteBoundaryOperator<ResultType>> m_inverse;
+};
+
+} // namespace Bempp
+
+#endif
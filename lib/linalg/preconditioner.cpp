@@ -27,6 +27,7 @@
 
 #include "../assembly/discrete_blocked_boundary_operator.hpp"
 #include "../assembly/discrete_boundary_operator.hpp"
+#include "../assembly/discrete_hmat_boundary_operator.hpp"
 #include "../fiber/_2d_array.hpp"
 #include "../fiber/explicit_instantiation.hpp"
 #include "../fiber/scalar_traits.hpp"
@@ -89,13 +90,26 @@ Preconditioner<ValueType> discreteBlockDiagonalPreconditioner(const std::vector<
   return Preconditioner<ValueType>(precOp);
 }
 
+template <typename ValueType>
+Preconditioner<ValueType> hMatApproximateLuPreconditioner(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &
+        discreteOperator,
+    double eps) {
+  return discreteOperatorToPreconditioner(
+      hMatOperatorApproximateLuInverse(discreteOperator, eps));
+}
+
 #define INSTANTIATE_FREE_FUNCTIONS(VALUE)                                      \
   template Preconditioner<VALUE> discreteOperatorToPreconditioner(             \
       const shared_ptr<const DiscreteBoundaryOperator<VALUE>> &                \
           discreteOperator);                                                   \
   template Preconditioner<VALUE> discreteBlockDiagonalPreconditioner(          \
       const std::vector<shared_ptr<const DiscreteBoundaryOperator<VALUE>>> &   \
-          opVector);
+          opVector);                                                           \
+  template Preconditioner<VALUE> hMatApproximateLuPreconditioner(              \
+      const shared_ptr<const DiscreteBoundaryOperator<VALUE>> &                \
+          discreteOperator,                                                    \
+      double eps);
 
 FIBER_INSTANTIATE_CLASS_TEMPLATED_ON_RESULT(Preconditioner);
 FIBER_ITERATE_OVER_VALUE_TYPES(INSTANTIATE_FREE_FUNCTIONS);
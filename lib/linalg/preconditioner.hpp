@@ -72,6 +72,19 @@ template <typename ValueType>
 Preconditioner<ValueType> discreteBlockDiagonalPreconditioner(const std::vector<
     shared_ptr<const DiscreteBoundaryOperator<ValueType>>> &opVector);
 
+/** \brief Create a preconditioner from the H-LU decomposition of a discrete
+ *  operator assembled in the "hmat" mode.
+ *
+ *  \p eps is the truncation accuracy of the H-matrix arithmetic; values
+ *  between 1e-1 and 1e-2 usually give a good compromise between the cost of
+ *  the factorisation and the number of iterations. See
+ *  hMatOperatorApproximateLuInverse(). */
+template <typename ValueType>
+Preconditioner<ValueType> hMatApproximateLuPreconditioner(
+    const shared_ptr<const DiscreteBoundaryOperator<ValueType>> &
+        discreteOperator,
+    double eps);
+
 } // namespace Bempp
 
 #endif /* WITH_TRILINOS */
@@ -5,6 +5,7 @@ from data_types import dtypes, scalar_cython_type
 from bempp.utils.armadillo cimport Mat
 from bempp.utils.enum_types cimport TranspositionMode
 from bempp.utils cimport shared_ptr
+from bempp.utils cimport catch_exception
 from bempp.utils cimport complex_float,complex_double
 cimport numpy as np
 
@@ -22,6 +23,9 @@ cdef extern from "bempp/assembly/discrete_boundary_operator.hpp" namespace "Bemp
 
 cdef extern from "bempp/assembly/py_discrete_operator_support.hpp" namespace "Bempp":
     cdef object py_array_from_dense_operator[VALUE](const shared_ptr[const c_DiscreteBoundaryOperator[VALUE]]&)
+    cdef void py_apply_discrete_operator[VALUE](const c_DiscreteBoundaryOperator[VALUE]& op,
+            TranspositionMode trans, const VALUE* x, int x_rows, int x_cols,
+            VALUE* y, int y_rows, int y_cols, VALUE alpha, VALUE beta) nogil except+catch_exception
 
 cdef class DiscreteBoundaryOperatorBase:
     cdef object _dtype
@@ -38,16 +42,7 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] x_in, 
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] y_inout, 
             ${scalar_cython_type(cyvalue)} alpha,
-            ${scalar_cython_type(cyvalue)} beta)
-% endfor
-
-% for pyvalue,cyvalue in dtypes.items():
-    cdef void _apply_${pyvalue}(self,
-            TranspositionMode trans, 
-            np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] x_in, 
-            np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] y_inout, 
-            ${scalar_cython_type(cyvalue)} alpha,
-            ${scalar_cython_type(cyvalue)} beta)
+            ${scalar_cython_type(cyvalue)} beta) except *
     cdef np.ndarray _as_matrix_${pyvalue}(self)
 % endfor
 
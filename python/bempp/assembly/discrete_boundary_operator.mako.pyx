@@ -180,34 +180,76 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
 % endfor
 
 
-    def matvec(self,np.ndarray x):
+    def matvec(self,np.ndarray x,np.ndarray out=None):
+        """Return the product of the operator with x.
 
-        if self.dtype=='float64' and np.iscomplexobj(x):
-            return self*np.real(x)+1j*(self*np.imag(x))
+        x may be a vector or a matrix, whose columns are multiplied as one
+        block. Fortran-contiguous inputs of the operator's dtype are used
+        without copying. If out is given, it must be a Fortran-contiguous
+        array of the operator's dtype and of the shape of the result; the
+        result is written into it and out is returned.
+
+        Complex x applied to a real operator is handled by applying the
+        operator to the real and imaginary parts. This allocates temporary
+        arrays even if out is given, which must then be a Fortran-contiguous
+        complex128 array of the shape of the result.
+
+        """
 
         cdef np.ndarray x_in
+        cdef np.ndarray y
         cdef np.ndarray y_inout
 
         cdef int rows = self.shape[0]
         cdef int cols = self.shape[1]
+        cdef int ncols
 
-        cdef bool is_reshaped = False
+        if self.dtype=='float64' and np.iscomplexobj(x):
+            # Apply the real operator to the real and imaginary parts as
+            # one block
+            ncols = 1 if x.ndim==1 else x.shape[1]
+            if out is not None and not (out.dtype=='complex128' and
+                    out.flags['F_CONTIGUOUS'] and
+                    out.shape==((rows,) if x.ndim==1 else (rows,ncols))):
+                raise ValueError("out must be a Fortran-contiguous complex128 "
+                        "array of the shape of the result")
+            y = self.matvec(np.hstack((x.real.reshape((cols,-1),order='F'),
+                x.imag.reshape((cols,-1),order='F'))))
+            y = y[:,:ncols]+1j*y[:,ncols:]
+            if x.ndim==1:
+                y = y.ravel()
+            if out is not None:
+                out[...] = y
+                return out
+            return y
 
         if (x.ndim==1):
             x_in = x.reshape((-1,1),order='F').astype(self.dtype,
                     order='F',casting='safe',copy=False)
-            is_reshaped = True
         elif (x.ndim==2):
             x_in = x.astype(self.dtype,order='F',casting='safe',copy=False)
         else:
             raise ValueError('x must have at most two dimensions')
 
-        y = np.zeros((rows,x_in.shape[1]),dtype=self.dtype,order='F')
-
-        self._apply(x_in,y,'no_transpose',1.0,0.0)
-        if is_reshaped:
+        if out is None:
+            y = np.zeros((rows,x_in.shape[1]),dtype=self.dtype,order='F')
+        else:
+            if not (out.dtype==self.dtype and out.flags['F_CONTIGUOUS'] and
+                    out.shape==((rows,) if x.ndim==1 else (rows,x_in.shape[1]))):
+                raise ValueError("out must be a Fortran-contiguous array of "
+                        "the operator's dtype and of the shape of the result")
+            y = out
+            y.fill(0)
+        y_inout = y.reshape((rows,-1),order='F')
+
+        self._apply(x_in,y_inout,'no_transpose',1.0,0.0)
+        if out is None and x.ndim==1:
             y = y.ravel()
         return y
+
+    def matmat(self,np.ndarray x,np.ndarray out=None):
+
+        return self.matvec(x,out)
         
 % for pyvalue,cyvalue in dtypes.items():
     cdef void _apply_${pyvalue}(self,
@@ -215,7 +257,7 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] x_in, 
             np.ndarray[${scalar_cython_type(cyvalue)},ndim=2,mode='fortran'] y_inout, 
             ${scalar_cython_type(cyvalue)} alpha,
-            ${scalar_cython_type(cyvalue)} beta):
+            ${scalar_cython_type(cyvalue)} beta) except *:
 
 
         cdef int rows = self.shape[0]
@@ -225,8 +267,9 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
         cdef int yrows = y_inout.shape[0]
         cdef int ycols = y_inout.shape[1]
 
-        cdef Mat[${cyvalue}]* arma_${pyvalue}_buff_x
-        cdef Mat[${cyvalue}]* arma_${pyvalue}_buff_y
+        cdef const c_DiscreteBoundaryOperator[${cyvalue}]* op = self._impl_${pyvalue}_.get()
+        cdef ${cyvalue}* x_data = <${cyvalue}*>np.PyArray_DATA(x_in)
+        cdef ${cyvalue}* y_data = <${cyvalue}*>np.PyArray_DATA(y_inout)
 
         if (trans==enums.no_transpose or trans==enums.conjugate):
 
@@ -254,16 +297,12 @@ cdef class DiscreteBoundaryOperator(DiscreteBoundaryOperatorBase):
         cdef ${cyvalue} cpp_beta = beta
 % endif
 
-        arma_${pyvalue}_buff_x = new Mat[${cyvalue}](<${cyvalue}*>&x_in[0,0],xrows,xcols,False,True)
-        arma_${pyvalue}_buff_y = new Mat[${cyvalue}](<${cyvalue}*>&y_inout[0,0],yrows,ycols,False,True)
-
-        deref(self._impl_${pyvalue}_).apply(trans,
-                deref(arma_${pyvalue}_buff_x),
-                deref(arma_${pyvalue}_buff_y),
-                cpp_alpha,cpp_beta)
-
-        del arma_${pyvalue}_buff_y
-        del arma_${pyvalue}_buff_x
+        # The caller's buffers are wrapped in place; other Python threads
+        # may run while the operator is applied
+        with nogil:
+            py_apply_discrete_operator[${cyvalue}](deref(op),trans,
+                    x_data,xrows,xcols,y_data,yrows,ycols,
+                    cpp_alpha,cpp_beta)
 % endfor
 
 
@@ -32,7 +32,7 @@ cdef extern from "bempp/assembly/grid_function.hpp" namespace "Bempp":
                         const shared_ptr[c_Space[BASIS]]& space,
                         const shared_ptr[c_Space[BASIS]]& dualSpace,
                         const c_Function[RESULT]& function,
-                        ConstructionMode constructionMde) except+catch_exception
+                        ConstructionMode constructionMde) nogil except+catch_exception
 
  
 % for pybasis,cybasis in dtypes.items():
@@ -54,6 +54,9 @@ cdef extern from "bempp/assembly/py_functors.hpp" namespace "Bempp":
     cdef shared_ptr[c_Function[${cyvalue}]] _py_surface_normal_dependent_function_${pyvalue} "Bempp::_py_surface_normal_dependent_function<${ctypes(cyvalue)}>"(
             void (*callable)(object,object,int, object, object),object,
             int argumentDimension, int resultDimension) except+catch_exception
+    cdef shared_ptr[c_Function[${cyvalue}]] _py_batch_function_${pyvalue} "Bempp::_py_batch_function<${ctypes(cyvalue)}>"(
+            void (*callable)(object,object,object, object, object) except *,object,
+            int argumentDimension, int resultDimension) except+catch_exception
 % endfor
 
 cdef class GridFunction:
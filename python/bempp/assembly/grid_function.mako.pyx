@@ -14,7 +14,7 @@ from bempp.utils.parameter_list cimport ParameterList, c_ParameterList
 from bempp.utils.armadillo cimport Mat
 from bempp.utils cimport catch_exception
 from bempp.utils cimport complex_float,complex_double
-from bempp.utils.enum_types cimport construction_mode
+from bempp.utils.enum_types cimport construction_mode, ConstructionMode
 from bempp.common import global_parameters
 from cython.operator cimport dereference as deref
 import numpy as np
@@ -26,6 +26,10 @@ cdef void _fun_interface(object x, object normal, int domain_index, object res,
 
     call_fun(x,normal,domain_index,res) 
 
+cdef void _batch_fun_interface(object x, object normal, object domain_index, object res, object call_fun) except *:
+
+    call_fun(x,normal,domain_index,res)
+
 
 cdef class GridFunction:
     """
@@ -40,9 +44,10 @@ cdef class GridFunction:
 
        Here, x, n, and result are all numpy arrays. x contains the current evaluation
        point, n the associated outward normal direction and result is a numpy array
-       that will store the result of the Python callable. The variable domain_index
+       that will store the result of the Python callable. The integer domain_index
        stores the index of the subdomain on which x lies (default 0). This makes it
-       possible to define different functions for different subdomains.
+       possible to define different functions for different subdomains. (For
+       vectorized callables, described below, domain_index is an array instead.)
 
        The following example defines input data that is the inner product of the
        coordinate x with the normal direction n.::
@@ -52,6 +57,24 @@ cdef class GridFunction:
 
        If the input function returns complex data the keyword argument 
        'complex=True' needs to be specified in the contructor of the GridFunction.    
+
+       Calling back into Python for every quadrature point is slow. If the
+       keyword argument 'vectorized=True' is given, the callable is instead
+       called once for the quadrature points of a whole chunk of elements.
+       Then x and n are arrays of shape (3,m) whose columns are the m points
+       and normals, domain_index is an integer array of shape (m,) with the
+       subdomain index of each point and result is an array of shape (d,m),
+       where d is the codomain dimension of the space. The arrays are only
+       valid during the call. The example above becomes::
+
+            fun(x,n,domain_index,result):
+                result[0,:] = np.sum(x*n,axis=0)
+
+       Since a chunk may span several subdomains, domain_index must be used
+       elementwise, e.g. ``result[0,:] = np.where(domain_index == 1, 1., 0.)``.
+
+       Vectorized callables are evaluated by several assembly threads, which
+       take turns to acquire the GIL.
     2. By providing a vector of coefficients at the nodes. This is preferable if
        the coefficients of the data are coming from an external code.
 
@@ -70,6 +93,9 @@ cdef class GridFunction:
     fun : callable
         A Python function from which the GridFunction is constructed
         (optional).
+    vectorized : bool
+        Specify whether fun evaluates the points of many elements in one call
+        (optional, default False).
     coefficients : np.ndarray
         A 1-dimensional array with the coefficients of the GridFunction
         at the interpolatoin points of the space (optional).
@@ -114,6 +140,11 @@ cdef class GridFunction:
     >>> grid_function = GridFunction(space, dual_space=dual_space,fun=my_fun,
     ...    complex_data=True)
 
+    To create a GridFunction from a vectorized Python callable my_fun use
+
+    >>> grid_function = GridFunction(space, dual_space=dual_space,fun=my_fun,
+    ...    vectorized=True)
+
     To create a GridFunction from a vector of coefficients coeffs use
 
     >>> grid_function = GridFunction(space,coefficients=coeffs)
@@ -134,7 +165,19 @@ cdef class GridFunction:
 % for pyvalue,cyvalue in dtypes.items():
         cdef Col[${cyvalue}]* arma_data_${pyvalue}
         cdef ${scalar_cython_type(cyvalue)} [::1] data_view_${pyvalue}
+        cdef shared_ptr[c_Function[${cyvalue}]] function_${pyvalue}
 % endfor
+% for pybasis,cybasis in dtypes.items():
+        cdef shared_ptr[c_Space[${cybasis}]] space_${pybasis}
+        cdef shared_ptr[c_Space[${cybasis}]] dual_space_${pybasis}
+%     for pyresult,cyresult in dtypes.items():
+%         if pyresult in compatible_dtypes[pybasis]:
+        cdef c_GridFunction[${cybasis},${cyresult}]* impl_${pybasis}_${pyresult}
+%         endif
+%     endfor
+% endfor
+        cdef c_ParameterList* parameters
+        cdef ConstructionMode mode
 
         if 'parameter_list' in kwargs:
             self._parameter_list = kwargs['parameter_list']
@@ -163,17 +206,29 @@ cdef class GridFunction:
             if 'approximation_mode' in kwargs:
                 approx_mode = kwargs['approximation_mode'].encode("UTF-8")
 
+            vectorized = kwargs.get('vectorized', False)
+
 % for pybasis,cybasis in dtypes.items():
 %     for pyresult,cyresult in dtypes.items():
 %         if pyresult in compatible_dtypes[pybasis]:
             if (self._basis_type=="${pybasis}") and (self._result_type=="${pyresult}"):
-                self._impl_${pybasis}_${pyresult}.reset(
-                        new c_GridFunction[${cybasis},${cyresult}](deref((<ParameterList>self.parameter_list).impl_),
-                        _py_get_space_ptr[${cybasis}](self._space.impl_),
-                        _py_get_space_ptr[${cybasis}]((<Space>kwargs['dual_space']).impl_),
-                        deref(_py_surface_normal_dependent_function_${pyresult}(_fun_interface,kwargs['fun'],3,
-                            self._space.codomain_dimension)),
-                        construction_mode(approx_mode)))
+                parameters = (<ParameterList>self.parameter_list).impl_
+                space_${pybasis} = _py_get_space_ptr[${cybasis}](self._space.impl_)
+                dual_space_${pybasis} = _py_get_space_ptr[${cybasis}]((<Space>kwargs['dual_space']).impl_)
+                mode = construction_mode(approx_mode)
+                if vectorized:
+                    function_${pyresult} = _py_batch_function_${pyresult}(_batch_fun_interface,kwargs['fun'],3,
+                            self._space.codomain_dimension)
+                    # Release the GIL so that the assembly threads can call the function
+                    with nogil:
+                        impl_${pybasis}_${pyresult} = new c_GridFunction[${cybasis},${cyresult}](deref(parameters),
+                                space_${pybasis}, dual_space_${pybasis}, deref(function_${pyresult}), mode)
+                else:
+                    function_${pyresult} = _py_surface_normal_dependent_function_${pyresult}(_fun_interface,kwargs['fun'],3,
+                            self._space.codomain_dimension)
+                    impl_${pybasis}_${pyresult} = new c_GridFunction[${cybasis},${cyresult}](deref(parameters),
+                            space_${pybasis}, dual_space_${pybasis}, deref(function_${pyresult}), mode)
+                self._impl_${pybasis}_${pyresult}.reset(impl_${pybasis}_${pyresult})
 %         endif
 %     endfor
 % endfor
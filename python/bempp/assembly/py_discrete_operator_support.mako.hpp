@@ -6,6 +6,7 @@
 #include "bempp/space/py_space_variants.hpp"
 #include "bempp/assembly/discrete_sparse_boundary_operator.hpp"
 #include "bempp/assembly/discrete_dense_boundary_operator.hpp"
+#include "bempp/assembly/transposition_mode.hpp"
 #include "bempp/utils/py_types.hpp"
 #include "fiber/scalar_traits.hpp"
 #include <Python.h>
@@ -107,6 +108,20 @@ PyObject* py_get_sparse_from_discrete_operator(const shared_ptr<const DiscreteBo
         }                
 
 
+// Compute y = alpha * op(A) * x + beta * y for column-major arrays owned by
+// the caller. The arrays are wrapped without copying; the function does not
+// touch any Python objects and may be called without holding the GIL.
+template <typename ValueType>
+void py_apply_discrete_operator(const DiscreteBoundaryOperator<ValueType>& op,
+        TranspositionMode trans, const ValueType* x, int xRows, int xCols,
+        ValueType* y, int yRows, int yCols, ValueType alpha, ValueType beta)
+{
+    const arma::Mat<ValueType> xMat(const_cast<ValueType*>(x), xRows, xCols,
+                                    false, true);
+    arma::Mat<ValueType> yMat(y, yRows, yCols, false, true);
+    op.apply(trans, xMat, yMat, alpha, beta);
+}
+
 template <typename ValueType>
 PyObject* py_array_from_dense_operator(const shared_ptr<const DiscreteBoundaryOperator<ValueType>> op){
 
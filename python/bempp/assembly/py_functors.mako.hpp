@@ -3,8 +3,11 @@
 
 #include "bempp/fiber/surface_normal_and_domain_index_dependent_function.hpp"
 #include "bempp/fiber/scalar_traits.hpp"
+#include "bempp/fiber/function.hpp"
+#include "bempp/fiber/geometrical_data.hpp"
 #include "bempp/utils/py_types.hpp"
 #include <vector>
+#include <stdexcept>
 #include <armadillo>
 #include <Python.h>
 #include <numpy/arrayobject.h>
@@ -102,15 +105,189 @@ private:
 };
 
 
+// Python callables can only be called by the thread holding the GIL, and
+// PythonFunctor reuses the same argument arrays for every call, so these
+// functions must never be evaluated concurrently
+template <typename ValueType>
+class PythonSurfaceNormalAndDomainIndexDependentFunction :
+    public Fiber::SurfaceNormalAndDomainIndexDependentFunction<PythonFunctor<ValueType>>
+{
+public:
+    PythonSurfaceNormalAndDomainIndexDependentFunction(
+            const PythonFunctor<ValueType>& functor) :
+        Fiber::SurfaceNormalAndDomainIndexDependentFunction<PythonFunctor<ValueType>>(functor) {}
+
+    virtual bool isThreadSafe() const {
+        return false;
+    }
+};
+
 template <typename ValueType>
 shared_ptr<Fiber::Function<ValueType>> _py_surface_normal_dependent_function(
         typename PythonFunctor<ValueType>::pyFunc_t pyFunc,PyObject* callable, 
         int argumentDimension, int resultDimension)
 {
     return shared_ptr<Fiber::Function<ValueType>>(
-        new Fiber::SurfaceNormalAndDomainIndexDependentFunction<PythonFunctor<ValueType>>(
+        new PythonSurfaceNormalAndDomainIndexDependentFunction<ValueType>(
             PythonFunctor<ValueType>(pyFunc,callable,argumentDimension,resultDimension)));
 }
+// Function evaluated by a Python callable for many points at once. The
+// callable is invoked as callable(x, n, domainIndex, result), where x and n
+// are (argumentDimension x pointCount) Fortran-ordered arrays with the points
+// and unit normals, domainIndex is an integer array with the domain index of
+// the element containing each point and result is a
+// (resultDimension x pointCount) array to be filled. The arrays wrap the
+// assembler's buffers without copying and must not be used after the call
+// returns.
+//
+// Integrators call the function once for all the points of a chunk of
+// elements (evaluateBatch()); evaluate() handles the points of a single
+// element. The GIL is acquired once per call, so the function may be
+// evaluated by several assembly threads, provided that the thread that
+// started the assembly has released the GIL.
+template <typename ValueType_>
+class PythonBatchFunction : public Fiber::Function<ValueType_>
+{
+public:
+    typedef Fiber::Function<ValueType_> Base;
+    typedef typename Base::ValueType ValueType;
+    typedef typename Base::CoordinateType CoordinateType;
+    typedef void (*pyFunc_t)(PyObject* x, PyObject* normal,
+                             PyObject* domainIndex, PyObject* result,
+                             PyObject* callable);
+
+    PythonBatchFunction(
+        pyFunc_t pyFunc, PyObject* callable,
+        int argumentDimension, int resultDimension) :
+            m_pyFunc(pyFunc),
+            m_callable(callable),
+            m_argumentDimension(argumentDimension),
+            m_resultDimension(resultDimension)
+    {
+        Py_INCREF(m_callable);
+    }
+
+    virtual ~PythonBatchFunction()
+    {
+        PyGILState_STATE gilState = PyGILState_Ensure();
+        Py_DECREF(m_callable);
+        PyGILState_Release(gilState);
+    }
+
+    virtual int worldDimension() const {
+        return m_argumentDimension;
+    }
+
+    virtual int codomainDimension() const {
+        return m_resultDimension;
+    }
+
+    virtual void addGeometricalDependencies(size_t& geomDeps) const {
+        geomDeps |= Fiber::GLOBALS | Fiber::NORMALS | Fiber::DOMAIN_INDEX;
+    }
+
+    virtual bool isBatchEvaluationSupported() const {
+        return true;
+    }
+
+    virtual void evaluate(const Fiber::GeometricalData<CoordinateType>& geomData,
+                          arma::Mat<ValueType>& result) const
+    {
+        std::vector<int> domainIndices(geomData.globals.n_cols,
+                                       geomData.domainIndex);
+        evaluateBatch(geomData, domainIndices, result);
+    }
+
+    virtual void evaluateBatch(
+            const Fiber::GeometricalData<CoordinateType>& geomData,
+            const std::vector<int>& domainIndices,
+            arma::Mat<ValueType>& result) const
+    {
+        const arma::Mat<CoordinateType>& points = geomData.globals;
+        const arma::Mat<CoordinateType>& normals = geomData.normals;
+
+        if ((int)points.n_rows != m_argumentDimension ||
+            (int)normals.n_rows != m_argumentDimension)
+            throw std::invalid_argument(
+                "PythonBatchFunction::evaluateBatch(): "
+                "incompatible world dimension");
+        if (normals.n_cols != points.n_cols ||
+            domainIndices.size() != points.n_cols)
+            throw std::invalid_argument(
+                "PythonBatchFunction::evaluateBatch(): "
+                "numbers of points, normals and domain indices do not match");
+
+        const size_t pointCount = points.n_cols;
+        result.set_size(m_resultDimension, pointCount);
+        if (pointCount == 0)
+            return;
+
+        PyGILState_STATE gilState = PyGILState_Ensure();
+        PyObject* x = wrap(points);
+        PyObject* normal = wrap(normals);
+        PyObject* domainIndex = wrap(domainIndices);
+        PyObject* res = wrap(result);
+        if (x && normal && domainIndex && res)
+            m_pyFunc(x, normal, domainIndex, res, m_callable);
+        Py_XDECREF(x);
+        Py_XDECREF(normal);
+        Py_XDECREF(domainIndex);
+        Py_XDECREF(res);
+
+        // The exception cannot be passed on to the thread that started the
+        // assembly, so report it here and signal failure with a C++ exception
+        const bool failed = PyErr_Occurred() != 0;
+        if (failed)
+            PyErr_Print();
+        PyGILState_Release(gilState);
+        if (failed)
+            throw std::runtime_error(
+                "PythonBatchFunction::evaluateBatch(): "
+                "the Python function raised an exception");
+    }
+
+private:
+    template <typename T>
+    static PyObject* wrap(const arma::Mat<T>& matrix)
+    {
+        npy_intp dims[2] = {(npy_intp)matrix.n_rows, (npy_intp)matrix.n_cols};
+        return PyArray_New(&PyArray_Type, 2, dims, NumpyType<T>::value, 0,
+                           const_cast<T*>(matrix.memptr()), 0,
+                           NPY_ARRAY_FARRAY_RO, 0);
+    }
+
+    template <typename T>
+    static PyObject* wrap(arma::Mat<T>& matrix)
+    {
+        npy_intp dims[2] = {(npy_intp)matrix.n_rows, (npy_intp)matrix.n_cols};
+        return PyArray_New(&PyArray_Type, 2, dims, NumpyType<T>::value, 0,
+                           matrix.memptr(), 0, NPY_ARRAY_FARRAY, 0);
+    }
+
+    static PyObject* wrap(const std::vector<int>& values)
+    {
+        npy_intp dims[1] = {(npy_intp)values.size()};
+        return PyArray_New(&PyArray_Type, 1, dims, NPY_INT, 0,
+                           const_cast<int*>(values.data()), 0,
+                           NPY_ARRAY_CARRAY_RO, 0);
+    }
+
+    pyFunc_t m_pyFunc;
+    PyObject* m_callable;
+    int m_argumentDimension;
+    int m_resultDimension;
+};
+
+template <typename ValueType>
+shared_ptr<Fiber::Function<ValueType>> _py_batch_function(
+        typename PythonBatchFunction<ValueType>::pyFunc_t pyFunc,
+        PyObject* callable, int argumentDimension, int resultDimension)
+{
+    return shared_ptr<Fiber::Function<ValueType>>(
+        new PythonBatchFunction<ValueType>(
+            pyFunc, callable, argumentDimension, resultDimension));
+}
+
 } // namespace Bempp
 
 
@@ -19,8 +19,13 @@ cdef extern from "bempp/grid/grid.hpp" namespace "Bempp" nogil:
         HYBRID_2D "Bempp::GridParameters::HYBRID_2D"
         TETRAHEDRAL "Bempp::GridParameters::TETRAHEDRAL"
 
+    cdef enum Ordering "Bempp::GridParameters::Ordering":
+        INPUT_ORDER "Bempp::GridParameters::INPUT_ORDER"
+        MORTON_ORDER "Bempp::GridParameters::MORTON_ORDER"
+
     cdef cppclass GridParameters:
         Topology topology
+        Ordering ordering
 
 cdef class Grid:
     ## Holds pointer to C++ implementation
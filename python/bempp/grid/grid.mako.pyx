@@ -127,7 +127,8 @@ cdef class Grid:
             return grid_view
 
 
-def grid_from_element_data(vertices, elements, domain_indices=[]):
+def grid_from_element_data(vertices, elements, domain_indices=[],
+        morton_order=False):
     """
 
     Create a grid from a given set of vertices and elements.
@@ -141,6 +142,12 @@ def grid_from_element_data(vertices, elements, domain_indices=[]):
         A (3xN) array of vertices.
     elements : np.ndarray[int]
         A (3xN) array of elements.
+    domain_indices : list[int]
+        Domain indices of the elements (default: all 0).
+    morton_order : bool
+        If True, renumber vertices and elements along a Morton
+        (Z-order) curve, so that elements close to each other in
+        space are also close in memory (default: False).
 
     Returns
     -------
@@ -178,6 +185,8 @@ def grid_from_element_data(vertices, elements, domain_indices=[]):
     for index in domain_indices:
         indices.push_back(int(index))
     parameters.topology = TRIANGULAR
+    if morton_order:
+        parameters.ordering = MORTON_ORDER
     try:
         grid.impl_ = connect_grid(parameters, deref(c_vertices),
                 deref(c_corners), indices)
@@ -56,6 +56,35 @@ class TestDiscreteBoundaryOperator(object):
         assert res1d.ndim == 1
         assert res2d.ndim == 2
 
+    def test_matvec_writes_into_out(self,real_operator):
+
+        x = np.asfortranarray(np.random.rand(real_operator.shape[1],3))
+        out = np.empty((real_operator.shape[0],3),dtype='float64',order='F')
+        res = real_operator.matvec(x,out=out)
+
+        assert res is out
+        assert np.linalg.norm(out-real_operator.as_matrix().dot(x))<1E-10
+
+    def test_real_operator_applied_to_complex_block(self,real_operator):
+
+        x = np.random.rand(real_operator.shape[1],2)+1j*np.random.rand(real_operator.shape[1],2)
+        expected = real_operator.as_matrix().dot(x)
+        actual = real_operator*x
+
+        assert np.linalg.norm(expected-actual)<1E-10
+
+    def test_concurrent_matvec(self,real_operator):
+
+        from multiprocessing.pool import ThreadPool
+        x = [np.random.rand(real_operator.shape[1]) for i in range(8)]
+        pool = ThreadPool(4)
+        actual = pool.map(real_operator.matvec,x)
+        pool.close()
+        mat = real_operator.as_matrix()
+
+        for xi,yi in zip(x,actual):
+            assert np.linalg.norm(mat.dot(xi)-yi)<1E-10
+
     def test_shape(self):
 
         grid = grid_from_sphere(2)
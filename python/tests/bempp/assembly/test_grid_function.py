@@ -46,6 +46,30 @@ class TestGridFunction(object):
         fun = GridFunction(space,dual_space=space,fun=py_fun,complex_data=True)
         assert np.linalg.norm(coefficients-fun.coefficients)<_eps
 
+    def test_vectorized_python_function_matches_pointwise(self,space,dual_space):
+
+        def py_fun(x,n,domain_index,res):
+            res[0] = np.dot(x,n)+x[0]
+        def py_batch_fun(x,n,domain_index,res):
+            res[0,:] = np.sum(x*n,axis=0)+x[0,:]
+        expected = GridFunction(space,dual_space=dual_space,fun=py_fun)
+        actual = GridFunction(space,dual_space=dual_space,fun=py_batch_fun,
+                vectorized=True)
+        assert np.linalg.norm(expected.coefficients-actual.coefficients)<1E-10
+
+    def test_vectorized_python_function_is_called_per_chunk(self,grid,space,dual_space):
+
+        point_counts = []
+        def py_batch_fun(x,n,domain_index,res):
+            point_counts.append(x.shape[1])
+            if domain_index.shape!=(x.shape[1],):
+                raise ValueError("one domain index per point expected")
+            res[0,:] = domain_index
+        GridFunction(space,dual_space=dual_space,fun=py_batch_fun,
+                vectorized=True)
+        element_count = grid.leaf_view.entity_count(0)
+        assert len(point_counts)<element_count
+
     def test_add_grid_functions(self,space):
 
         coefficients = np.random.rand(space.global_dof_count)
@@ -20,12 +20,15 @@
 
 #include "../type_template.hpp"
 #include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
 
 #include "bempp/common/config_ahmed.hpp"
 #include "assembly/blocked_boundary_operator.hpp"
 #include "assembly/blocked_operator_structure.hpp"
 #include "assembly/context.hpp"
+#include "assembly/discrete_blocked_boundary_operator.hpp"
 #include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/discrete_dense_boundary_operator.hpp"
 #include "assembly/identity_operator.hpp"
 #include "assembly/laplace_3d_single_layer_boundary_operator.hpp"
 #include "assembly/modified_helmholtz_3d_single_layer_boundary_operator.hpp"
@@ -299,6 +302,62 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(
       10. * std::numeric_limits<RealType>::epsilon()));
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(
+    discrete_blocked_boundary_operator_apply_agrees_with_dense_product,
+    ValueType, result_types) {
+  // Blocks (1, 1) and (2, 0) are empty; rows of different heights are
+  // applied concurrently and must not interfere with each other.
+  typedef ValueType RT;
+  typedef typename ScalarTraits<ValueType>::RealType RealType;
+  typedef DiscreteBoundaryOperator<RT> Op;
+
+  std::vector<size_t> rowCounts(3), columnCounts(2);
+  rowCounts[0] = 7;
+  rowCounts[1] = 3;
+  rowCounts[2] = 5;
+  columnCounts[0] = 4;
+  columnCounts[1] = 6;
+
+  Fiber::_2dArray<shared_ptr<const Op>> blocks(3, 2);
+  arma::Mat<RT> expected(15, 10);
+  expected.fill(0.);
+  size_t rowStart = 0;
+  for (size_t row = 0; row < rowCounts.size(); ++row) {
+    size_t colStart = 0;
+    for (size_t col = 0; col < columnCounts.size(); ++col) {
+      if (!((row == 1 && col == 1) || (row == 2 && col == 0))) {
+        arma::Mat<RT> block =
+            generateRandomMatrix<RT>(rowCounts[row], columnCounts[col]);
+        blocks(row, col).reset(new DiscreteDenseBoundaryOperator<RT>(block));
+        expected.submat(rowStart, colStart, rowStart + rowCounts[row] - 1,
+                        colStart + columnCounts[col] - 1) = block;
+      }
+      colStart += columnCounts[col];
+    }
+    rowStart += rowCounts[row];
+  }
+  DiscreteBlockedBoundaryOperator<RT> op(blocks, rowCounts, columnCounts);
+
+  BOOST_CHECK(check_arrays_are_close<RT>(
+      op.asMatrix(), expected,
+      10. * std::numeric_limits<RealType>::epsilon()));
+
+  const RT alpha = 2., beta = 3.;
+  arma::Mat<RT> x = generateRandomMatrix<RT>(10, 2);
+  arma::Mat<RT> y = generateRandomMatrix<RT>(15, 2);
+  arma::Mat<RT> expectedY = alpha * expected * x + beta * y;
+  op.apply(NO_TRANSPOSE, x, y, alpha, beta);
+  BOOST_CHECK(check_arrays_are_close<RT>(
+      y, expectedY, 100. * std::numeric_limits<RealType>::epsilon()));
+
+  arma::Mat<RT> xt = generateRandomMatrix<RT>(15, 2);
+  arma::Mat<RT> yt = generateRandomMatrix<RT>(10, 2);
+  arma::Mat<RT> expectedYt = alpha * expected.st() * xt;
+  op.apply(TRANSPOSE, xt, yt, alpha, 0.);
+  BOOST_CHECK(check_arrays_are_close<RT>(
+      yt, expectedYt, 100. * std::numeric_limits<RealType>::epsilon()));
+}
+
 #ifdef WITH_AHMED
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(
@@ -38,6 +38,7 @@
 #include "space/piecewise_constant_scalar_space.hpp"
 
 #include <boost/test/floating_point_comparison.hpp>
+#include <limits>
 
 using namespace Bempp;
 
@@ -187,4 +188,53 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(L2Norm_works_for_exponential_function_and_piecewis
     BOOST_CHECK_CLOSE(norm, expectedNorm, 1 /* percent */);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(results_do_not_depend_on_thread_count, ResultType, result_types)
+{
+    typedef ResultType RT;
+    typedef typename ScalarTraits<RT>::RealType BFT;
+    typedef typename ScalarTraits<RT>::RealType CT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../meshes/sphere-h-0.2.msh", false /* verbose */);
+
+    shared_ptr<Space<BFT> > space(
+        new PiecewiseLinearContinuousScalarSpace<BFT>(grid));
+
+    AccuracyOptions accuracyOptions;
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions serialOptions;
+    serialOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    serialOptions.setMaxThreadCount(1);
+    AssemblyOptions parallelOptions(serialOptions);
+    parallelOptions.setMaxThreadCount(4);
+    shared_ptr<Context<BFT, RT> > serialContext(
+        new Context<BFT, RT>(quadStrategy, serialOptions));
+    shared_ptr<Context<BFT, RT> > parallelContext(
+        new Context<BFT, RT>(quadStrategy, parallelOptions));
+
+    Bempp::GridFunction<BFT, RT> serialFun(serialContext, space, space,
+                surfaceNormalIndependentFunction(
+                    SinusoidalFunction<RT>()));
+    Bempp::GridFunction<BFT, RT> parallelFun(parallelContext, space, space,
+                surfaceNormalIndependentFunction(
+                    SinusoidalFunction<RT>()));
+    BOOST_CHECK(check_arrays_are_close<RT>(
+                    parallelFun.coefficients(), serialFun.coefficients(),
+                    100 * std::numeric_limits<CT>::epsilon()));
+
+    arma::Mat<CT> serialPoints, parallelPoints;
+    arma::Mat<RT> serialValues, parallelValues;
+    serialFun.evaluateAtSpecialPoints(VtkWriter::VERTEX_DATA, serialPoints,
+                                      serialValues);
+    parallelFun.evaluateAtSpecialPoints(VtkWriter::VERTEX_DATA,
+                                        parallelPoints, parallelValues);
+    BOOST_CHECK(check_arrays_are_close<CT>(parallelPoints, serialPoints, 0.));
+    BOOST_CHECK(check_arrays_are_close<RT>(
+                    parallelValues, serialValues,
+                    100 * std::numeric_limits<CT>::epsilon()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,235 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
+
+#include "assembly/boundary_operator.hpp"
+#include "assembly/context.hpp"
+#include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/discrete_hmat_boundary_operator.hpp"
+#include "assembly/laplace_3d_single_layer_boundary_operator.hpp"
+#include "common/global_parameters.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "hmat/hmatrix.hpp"
+#include "hmat/hmatrix_low_rank_data.hpp"
+#include "space/piecewise_constant_scalar_space.hpp"
+
+#include <Teuchos_ParameterList.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+using namespace Bempp;
+
+namespace
+{
+
+typedef double BFT;
+typedef double RT;
+
+const char* fileName = "test_hmat_serialization.hmat";
+
+shared_ptr<const DiscreteBoundaryOperator<RT> > assembleHMatOperator(
+        int minBlockSize = 8,
+        const std::string& meshFile = "meshes/cube-12-reoriented.msh")
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+                params, meshFile, false /* verbose */);
+    shared_ptr<Space<BFT> > pwiseConstants(
+        new PiecewiseConstantScalarSpace<BFT>(grid));
+
+    ParameterList parameters = GlobalParameters::parameterList();
+    parameters.set("boundaryOperatorAssemblyType", std::string("hmat"));
+    parameters.set("verbosityLevel", -5);
+    parameters.sublist("HMat").set("minBlockSize", minBlockSize);
+    shared_ptr<Context<BFT, RT> > context(new Context<BFT, RT>(parameters));
+
+    return laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+        context, pwiseConstants, pwiseConstants, pwiseConstants).weakForm();
+}
+
+shared_ptr<const hmat::DefaultHMatrixType<RT> > hMatrix(
+        const shared_ptr<const DiscreteBoundaryOperator<RT> >& op)
+{
+    shared_ptr<const DiscreteHMatBoundaryOperator<RT> > hMatOp =
+        boost::dynamic_pointer_cast<const DiscreteHMatBoundaryOperator<RT> >(
+            op);
+    BOOST_REQUIRE(hMatOp);
+    return hMatOp->hMatrix();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(HMatSerialization)
+
+BOOST_AUTO_TEST_CASE(loaded_operator_agrees_with_saved_operator)
+{
+    shared_ptr<const DiscreteBoundaryOperator<RT> > op =
+        assembleHMatOperator();
+    saveHMatOperator(op, fileName);
+    shared_ptr<const DiscreteBoundaryOperator<RT> > loadedOp =
+        loadHMatOperator<RT>(fileName, true /* verifyData */);
+
+    BOOST_CHECK_EQUAL(loadedOp->rowCount(), op->rowCount());
+    BOOST_CHECK_EQUAL(loadedOp->columnCount(), op->columnCount());
+
+    const int rhsCount = 2;
+    arma::Mat<RT> x = generateRandomMatrix<RT>(op->columnCount(), rhsCount);
+    arma::Mat<RT> expected(op->rowCount(), rhsCount);
+    arma::Mat<RT> actual(op->rowCount(), rhsCount);
+    op->apply(NO_TRANSPOSE, x, expected, 2., 0.);
+    loadedOp->apply(NO_TRANSPOSE, x, actual, 2., 0.);
+    BOOST_CHECK(check_arrays_are_close<RT>(actual, expected, 1e-14));
+
+    arma::Mat<RT> y = generateRandomMatrix<RT>(op->rowCount(), rhsCount);
+    expected.set_size(op->columnCount(), rhsCount);
+    actual.set_size(op->columnCount(), rhsCount);
+    op->apply(TRANSPOSE, y, expected, 1., 0.);
+    loadedOp->apply(TRANSPOSE, y, actual, 1., 0.);
+    BOOST_CHECK(check_arrays_are_close<RT>(actual, expected, 1e-14));
+
+    std::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE(low_rank_blocks_are_loaded_from_mapped_file)
+{
+    // The 12-element cube has no admissible blocks; on this grid the
+    // H-matrix contains low-rank leafs, whose factors A and B are stored at
+    // separate aligned offsets of the file.
+    shared_ptr<const DiscreteBoundaryOperator<RT> > op = assembleHMatOperator(
+        16 /* minBlockSize */, "../../meshes/sphere-h-0.2.msh");
+    saveHMatOperator(op, fileName);
+    shared_ptr<const DiscreteBoundaryOperator<RT> > loadedOp =
+        loadHMatOperator<RT>(fileName, true /* verifyData */);
+
+    shared_ptr<const hmat::DefaultHMatrixType<RT> > original = hMatrix(op);
+    shared_ptr<const hmat::DefaultHMatrixType<RT> > loaded =
+        hMatrix(loadedOp);
+    BOOST_REQUIRE_EQUAL(loaded->numberOfLeafs(), original->numberOfLeafs());
+
+    typedef hmat::HMatrixLowRankData<RT> LowRankData;
+    shared_ptr<const LowRankData> originalLowRankLeaf, loadedLowRankLeaf;
+    std::size_t lowRankLeafCount = 0;
+    for (std::size_t leaf = 0; leaf < original->numberOfLeafs(); ++leaf) {
+        shared_ptr<const LowRankData> expected =
+            boost::dynamic_pointer_cast<const LowRankData>(
+                original->leafData(leaf));
+        shared_ptr<const LowRankData> actual =
+            boost::dynamic_pointer_cast<const LowRankData>(
+                loaded->leafData(leaf));
+        BOOST_REQUIRE_EQUAL(bool(actual), bool(expected));
+        if (!expected || expected->rank() == 0)
+            continue;
+        ++lowRankLeafCount;
+        originalLowRankLeaf = expected;
+        loadedLowRankLeaf = actual;
+
+        BOOST_REQUIRE_EQUAL(actual->rows(), expected->rows());
+        BOOST_REQUIRE_EQUAL(actual->cols(), expected->cols());
+        BOOST_REQUIRE_EQUAL(actual->rank(), expected->rank());
+        // Both factors are used in place from the mapped file
+        BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(
+                              actual->A().memptr()) % 64, 0u);
+        BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(
+                              actual->B().memptr()) % 64, 0u);
+        BOOST_CHECK(check_arrays_are_close<RT>(actual->A(), expected->A(),
+                                               0.));
+        BOOST_CHECK(check_arrays_are_close<RT>(actual->B(), expected->B(),
+                                               0.));
+    }
+    BOOST_CHECK_GT(lowRankLeafCount, 0u);
+
+    arma::Mat<RT> x = generateRandomMatrix<RT>(op->columnCount(), 2);
+    arma::Mat<RT> expected(op->rowCount(), 2);
+    arma::Mat<RT> actual(op->rowCount(), 2);
+    op->apply(NO_TRANSPOSE, x, expected, 1., 0.);
+    loadedOp->apply(NO_TRANSPOSE, x, actual, 1., 0.);
+    BOOST_CHECK(check_arrays_are_close<RT>(actual, expected, 1e-14));
+
+    // A leaf keeps the mapping alive after the operator and the file are gone
+    loaded.reset();
+    loadedOp.reset();
+    std::remove(fileName);
+    BOOST_REQUIRE(loadedLowRankLeaf);
+    BOOST_CHECK(check_arrays_are_close<RT>(loadedLowRankLeaf->A(),
+                                           originalLowRankLeaf->A(), 0.));
+    BOOST_CHECK(check_arrays_are_close<RT>(loadedLowRankLeaf->B(),
+                                           originalLowRankLeaf->B(), 0.));
+}
+
+BOOST_AUTO_TEST_CASE(loading_corrupted_file_throws)
+{
+    saveHMatOperator(assembleHMatOperator(), fileName);
+
+    // Flip a byte of the metadata section, which follows the 64-byte header
+    {
+        std::fstream file(fileName,
+                          std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(100);
+        char byte;
+        file.read(&byte, 1);
+        byte = ~byte;
+        file.seekp(100);
+        file.write(&byte, 1);
+    }
+
+    BOOST_CHECK_THROW(loadHMatOperator<RT>(fileName), std::runtime_error);
+
+    std::remove(fileName);
+}
+
+BOOST_AUTO_TEST_CASE(saving_over_loaded_file_leaves_loaded_operator_intact)
+{
+    shared_ptr<const DiscreteBoundaryOperator<RT> > op =
+        assembleHMatOperator();
+    saveHMatOperator(op, fileName);
+    shared_ptr<const DiscreteBoundaryOperator<RT> > loadedOp =
+        loadHMatOperator<RT>(fileName);
+
+    // An operator with a different block structure, hence a different file
+    shared_ptr<const DiscreteBoundaryOperator<RT> > otherOp =
+        assembleHMatOperator(32);
+    saveHMatOperator(otherOp, fileName);
+
+    arma::Mat<RT> x = generateRandomMatrix<RT>(op->columnCount(), 1);
+    arma::Mat<RT> expected(op->rowCount(), 1);
+    arma::Mat<RT> actual(op->rowCount(), 1);
+    op->apply(NO_TRANSPOSE, x, expected, 1., 0.);
+    loadedOp->apply(NO_TRANSPOSE, x, actual, 1., 0.);
+    BOOST_CHECK(check_arrays_are_close<RT>(actual, expected, 1e-14));
+
+    // The file now holds the other operator
+    shared_ptr<const DiscreteBoundaryOperator<RT> > reloadedOp =
+        loadHMatOperator<RT>(fileName, true /* verifyData */);
+    otherOp->apply(NO_TRANSPOSE, x, expected, 1., 0.);
+    reloadedOp->apply(NO_TRANSPOSE, x, actual, 1., 0.);
+    BOOST_CHECK(check_arrays_are_close<RT>(actual, expected, 1e-14));
+
+    std::remove(fileName);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -187,4 +187,30 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(symmetric_matches_nonsymmetric_in_aca_mode,
 #   endif
 }
 
+BOOST_AUTO_TEST_CASE(interpolation_density_follows_context_accuracy)
+{
+    typedef double BFT;
+    typedef std::complex<double> RT;
+
+    ParameterList parameters = GlobalParameters::parameterList();
+    parameters.set("kernelInterpolationAccuracy", 1e-6);
+    Context<BFT, RT> context(parameters);
+
+    BOOST_CHECK_EQUAL(context.accuracyOptions().kernelInterpolationAccuracy(),
+                      1e-6);
+    BOOST_CHECK_EQUAL(
+        helmholtz3dInterpolationDensity(
+            context, AUTOMATIC_HELMHOLTZ_INTERPOLATION_DENSITY),
+        Fiber::modifiedHelmholtz3dInterpolationDensity(1e-6));
+    // An explicit density takes precedence over the accuracy
+    BOOST_CHECK_EQUAL(helmholtz3dInterpolationDensity(context, 1000), 1000);
+
+    // By default the best accuracy attainable in double precision is used
+    Context<BFT, RT> defaultContext;
+    BOOST_CHECK_EQUAL(
+        helmholtz3dInterpolationDensity(
+            defaultContext, DEFAULT_HELMHOLTZ_INTERPOLATION_DENSITY),
+        Fiber::modifiedHelmholtz3dInterpolationDensity(0.));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,121 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "assembly/context.hpp"
+#include "assembly/evaluation_options.hpp"
+#include "assembly/grid_function.hpp"
+#include "assembly/laplace_3d_single_layer_potential_operator.hpp"
+#include "assembly/numerical_quadrature_strategy.hpp"
+
+#include "fiber/accuracy_options.hpp"
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+
+#include "space/piecewise_constant_scalar_space.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+
+using namespace Bempp;
+
+namespace
+{
+
+typedef double BFT;
+typedef double RT;
+
+// Points on a sphere of the given radius, spread over the whole sphere
+arma::Mat<double> pointsOnSphere(int pointCount, double radius)
+{
+    arma::Mat<double> points(3, pointCount);
+    const double goldenAngle = M_PI * (3. - std::sqrt(5.));
+    for (int i = 0; i < pointCount; ++i) {
+        const double z = 1. - (2. * i + 1.) / pointCount;
+        const double r = std::sqrt(1. - z * z);
+        points(0, i) = radius * r * std::cos(goldenAngle * i);
+        points(1, i) = radius * r * std::sin(goldenAngle * i);
+        points(2, i) = radius * z;
+    }
+    return points;
+}
+
+// Potential of a unit charge density on the given grid, evaluated in dense
+// mode with a quadrature rule of the given order on all elements
+arma::Mat<RT> potentialOfUnitDensity(const shared_ptr<const Grid>& grid,
+                                     int quadratureOrder,
+                                     const arma::Mat<double>& points)
+{
+    shared_ptr<Space<BFT> > space(
+        new PiecewiseConstantScalarSpace<BFT>(grid));
+
+    Fiber::AccuracyOptionsEx accuracyOptions;
+    accuracyOptions.setSingleRegular(quadratureOrder, false /* absolute */);
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    arma::Col<RT> coefficients(space->globalDofCount());
+    coefficients.fill(1.);
+    GridFunction<BFT, RT> density(context, space, coefficients);
+
+    Laplace3dSingleLayerPotentialOperator<BFT, RT> op;
+    EvaluationOptions evaluationOptions;
+    evaluationOptions.switchToDenseMode();
+    return op.evaluateAtPoints(density, points, *quadStrategy,
+                               evaluationOptions);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(PotentialNearField)
+
+BOOST_AUTO_TEST_CASE(near_surface_potential_agrees_with_refined_quadrature)
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<const Grid> grid = GridFactory::importGmshGrid(
+        params, "../../meshes/sphere-h-0.2.msh", false /* verbose */);
+
+    // About a quarter of the element size away from the surface, on both
+    // sides of it
+    arma::Mat<double> points =
+        arma::join_rows(pointsOnSphere(50, 1.05), pointsOnSphere(50, 0.95));
+
+    arma::Mat<RT> potential = potentialOfUnitDensity(grid, 6, points);
+
+    // The barycentric refinements leave the surface and the unit density
+    // unchanged; with elements about three times smaller and a much higher
+    // quadrature order the reference is far more accurate
+    shared_ptr<const Grid> refinedGrid =
+        grid->barycentricGrid()->barycentricGrid();
+    arma::Mat<RT> reference = potentialOfUnitDensity(refinedGrid, 20, points);
+
+    BOOST_REQUIRE_EQUAL(potential.n_rows, reference.n_rows);
+    BOOST_REQUIRE_EQUAL(potential.n_cols, reference.n_cols);
+    const double error = arma::abs(potential - reference).max() /
+            arma::abs(reference).max();
+    BOOST_CHECK_SMALL(error, 1e-4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
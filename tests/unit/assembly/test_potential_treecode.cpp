@@ -0,0 +1,118 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "assembly/assembly_options.hpp"
+#include "assembly/context.hpp"
+#include "assembly/evaluation_options.hpp"
+#include "assembly/grid_function.hpp"
+#include "assembly/helmholtz_3d_single_layer_potential_operator.hpp"
+#include "assembly/laplace_3d_single_layer_potential_operator.hpp"
+#include "assembly/numerical_quadrature_strategy.hpp"
+#include "assembly/treecode_options.hpp"
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+
+#include "space/piecewise_constant_scalar_space.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <complex>
+
+using namespace Bempp;
+
+namespace
+{
+
+arma::Mat<double> pointsInPlane(int pointsPerSide)
+{
+    arma::Mat<double> points(3, pointsPerSide * pointsPerSide);
+    for (int j = 0; j < pointsPerSide; ++j)
+        for (int i = 0; i < pointsPerSide; ++i) {
+            const int col = i + j * pointsPerSide;
+            points(0, col) = -3. + 6. * i / (pointsPerSide - 1);
+            points(1, col) = -3. + 6. * j / (pointsPerSide - 1);
+            points(2, col) = 0.3;
+        }
+    return points;
+}
+
+template <typename RT>
+double relativeDifferenceOfTreecodeAndDirectEvaluation(
+        const PotentialOperator<double, RT>& op)
+{
+    typedef double BFT;
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "../../meshes/sphere-h-0.1.msh", false /* verbose */);
+    shared_ptr<Space<BFT> > space(
+        new PiecewiseConstantScalarSpace<BFT>(grid));
+
+    AccuracyOptions accuracyOptions;
+    shared_ptr<NumericalQuadratureStrategy<BFT, RT> > quadStrategy(
+                new NumericalQuadratureStrategy<BFT, RT>(accuracyOptions));
+    AssemblyOptions assemblyOptions;
+    assemblyOptions.setVerbosityLevel(VerbosityLevel::LOW);
+    shared_ptr<Context<BFT, RT> > context(
+        new Context<BFT, RT>(quadStrategy, assemblyOptions));
+
+    arma::Col<RT> coefficients(space->globalDofCount());
+    coefficients.randu();
+    GridFunction<BFT, RT> density(context, space, coefficients);
+    arma::Mat<double> points = pointsInPlane(80);
+
+    EvaluationOptions evaluationOptions;
+    evaluationOptions.switchToDenseMode();
+    arma::Mat<RT> direct = op.evaluateAtPoints(
+                density, points, *quadStrategy, evaluationOptions);
+
+    // Small leaves make sure that most interactions are interpolated
+    TreecodeOptions treecodeOptions;
+    treecodeOptions.maxLeafSize = 16;
+    evaluationOptions.switchToTreecodeMode(treecodeOptions);
+    arma::Mat<RT> treecode = op.evaluateAtPoints(
+                density, points, *quadStrategy, evaluationOptions);
+
+    BOOST_REQUIRE_EQUAL(treecode.n_rows, direct.n_rows);
+    BOOST_REQUIRE_EQUAL(treecode.n_cols, direct.n_cols);
+    return arma::norm(treecode - direct, "fro") / arma::norm(direct, "fro");
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(PotentialTreecode)
+
+BOOST_AUTO_TEST_CASE(treecode_agrees_with_direct_evaluation_of_laplace_potential)
+{
+    Laplace3dSingleLayerPotentialOperator<double, double> op;
+    BOOST_CHECK_SMALL(relativeDifferenceOfTreecodeAndDirectEvaluation(op),
+                      1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(treecode_agrees_with_direct_evaluation_of_helmholtz_potential)
+{
+    Helmholtz3dSingleLayerPotentialOperator<double> op(
+                std::complex<double>(1.));
+    BOOST_CHECK_SMALL(relativeDifferenceOfTreecodeAndDirectEvaluation(op),
+                      1e-5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,151 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
+#include "../type_template.hpp"
+
+#include "assembly/sparse_csr_matrix.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+#include <complex>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+using namespace Bempp;
+
+namespace
+{
+
+// Random sparse matrix with about one in five entries nonzero
+template <typename ValueType>
+std::unique_ptr<SparseCsrMatrix<ValueType> > randomSparseMatrix(
+        int rowCount, int columnCount)
+{
+    arma::Mat<ValueType> dense = generateRandomMatrix<ValueType>(
+                rowCount, columnCount);
+    std::vector<int> rowOffsets(1, 0), columnIndices;
+    std::vector<ValueType> values;
+    for (int row = 0; row < rowCount; ++row) {
+        for (int col = 0; col < columnCount; ++col)
+            if (std::rand() % 5 == 0) {
+                columnIndices.push_back(col);
+                values.push_back(dense(row, col));
+            }
+        rowOffsets.push_back(columnIndices.size());
+    }
+    return std::unique_ptr<SparseCsrMatrix<ValueType> >(
+                new SparseCsrMatrix<ValueType>(rowCount, columnCount,
+                                               rowOffsets, columnIndices,
+                                               values));
+}
+
+template <typename ValueType>
+arma::Mat<ValueType> transformedMatrix(const arma::Mat<ValueType>& mat,
+                                       TranspositionMode trans)
+{
+    switch (trans) {
+    case TRANSPOSE: return mat.st();
+    case CONJUGATE: return arma::conj(mat);
+    case CONJUGATE_TRANSPOSE: return mat.t();
+    default: return mat;
+    }
+}
+
+template <typename MatrixValueType, typename VectorValueType>
+void checkApply(TranspositionMode trans)
+{
+    typedef typename Fiber::ScalarTraits<VectorValueType>::RealType CT;
+
+    std::unique_ptr<SparseCsrMatrix<MatrixValueType> > mat =
+            randomSparseMatrix<MatrixValueType>(700, 300);
+    const arma::Mat<VectorValueType> dense = transformedMatrix(
+                arma::conv_to<arma::Mat<VectorValueType> >::from(
+                    mat->asMatrix()),
+                trans);
+
+    const VectorValueType alpha(2.), beta(-0.5);
+    arma::Mat<VectorValueType> x =
+            generateRandomMatrix<VectorValueType>(dense.n_cols, 3);
+    arma::Mat<VectorValueType> y =
+            generateRandomMatrix<VectorValueType>(dense.n_rows, 3);
+    arma::Mat<VectorValueType> expected = alpha * dense * x + beta * y;
+
+    mat->apply(trans, x, y, alpha, beta);
+
+    BOOST_CHECK(check_arrays_are_close<VectorValueType>(
+                    y, expected, 100. * std::numeric_limits<CT>::epsilon()));
+}
+
+const TranspositionMode transpositionModes[] = {
+    NO_TRANSPOSE, CONJUGATE, TRANSPOSE, CONJUGATE_TRANSPOSE};
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(SparseCsrMatrix)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(apply_agrees_with_dense_product, ValueType,
+                              result_types)
+{
+    std::srand(1);
+    for (int i = 0; i < 4; ++i)
+        checkApply<ValueType, ValueType>(transpositionModes[i]);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(real_matrix_can_be_applied_to_complex_vectors,
+                              ResultType, complex_result_types)
+{
+    std::srand(1);
+    typedef typename Fiber::ScalarTraits<ResultType>::RealType CT;
+    for (int i = 0; i < 4; ++i)
+        checkApply<CT, ResultType>(transpositionModes[i]);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(apply_ignores_y_if_beta_is_zero, ValueType,
+                              result_types)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CT;
+    std::srand(1);
+    std::unique_ptr<Bempp::SparseCsrMatrix<ValueType> > mat =
+            randomSparseMatrix<ValueType>(50, 40);
+    arma::Mat<ValueType> x = generateRandomMatrix<ValueType>(40, 2);
+    arma::Mat<ValueType> y(50, 2);
+    y.fill(std::numeric_limits<CT>::quiet_NaN());
+
+    mat->apply(NO_TRANSPOSE, x, y, ValueType(1.), ValueType(0.));
+
+    BOOST_CHECK(y.is_finite());
+}
+
+BOOST_AUTO_TEST_CASE(constructor_rejects_inconsistent_arrays)
+{
+    std::vector<int> rowOffsets(3, 0), columnIndices(1, 5);
+    std::vector<double> values(1, 1.);
+    rowOffsets[2] = 1;
+    BOOST_CHECK_THROW(Bempp::SparseCsrMatrix<double>(
+                          2, 3, rowOffsets, columnIndices, values),
+                      std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -232,4 +232,14 @@ BOOST_AUTO_TEST_CASE(quadratureOrder_agrees_with_setDoubleRegular_for_three_rela
     BOOST_CHECK_EQUAL(orderFar, defaultOrder + order3);
 }
 
+BOOST_AUTO_TEST_CASE(congruent_singular_integral_reuse_is_disabled_by_default)
+{
+    Fiber::AccuracyOptionsEx opts;
+    BOOST_CHECK(!opts.isCongruentSingularIntegralReuseEnabled());
+    opts.enableCongruentSingularIntegralReuse();
+    BOOST_CHECK(opts.isCongruentSingularIntegralReuseEnabled());
+    opts.enableCongruentSingularIntegralReuse(false);
+    BOOST_CHECK(!opts.isCongruentSingularIntegralReuseEnabled());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fiber/geometrical_data.hpp"
+#include "fiber/laplace_3d_adjoint_double_layer_potential_kernel_functor.hpp"
+#include "fiber/laplace_3d_double_layer_potential_kernel_functor.hpp"
+#include "fiber/laplace_3d_single_layer_potential_kernel_functor.hpp"
+#include "fiber/modified_helmholtz_3d_adjoint_double_layer_potential_kernel_functor.hpp"
+#include "fiber/modified_helmholtz_3d_double_layer_potential_kernel_functor.hpp"
+#include "fiber/modified_helmholtz_3d_single_layer_potential_kernel_functor.hpp"
+#include "fiber/default_collection_of_kernels.hpp"
+
+#include "../type_template.hpp"
+#include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+#include <complex>
+
+namespace
+{
+
+// Compare the batched evaluateOnGrid() of the functor with the point-by-point
+// evaluation done by evaluateAtPointPairs(). The test point count is not a
+// multiple of Fiber::KERNEL_BATCH_SIZE, so that a partial batch is exercised.
+template <typename Functor>
+boost::test_tools::predicate_result
+batchedEvaluationAgreesWithPointwise(const Functor& functor)
+{
+    typedef typename Functor::ValueType ValueType;
+    typedef typename Functor::CoordinateType CoordinateType;
+    Fiber::DefaultCollectionOfKernels<Functor> kernels(functor);
+
+    const int worldDim = 3;
+    const int testPointCount = 2 * Fiber::KERNEL_BATCH_SIZE + 13;
+    const int trialPointCount = 7;
+    Fiber::GeometricalData<CoordinateType> testGeomData, trialGeomData;
+    testGeomData.globals =
+            generateRandomMatrix<CoordinateType>(worldDim, testPointCount);
+    testGeomData.normals =
+            generateRandomMatrix<CoordinateType>(worldDim, testPointCount);
+    trialGeomData.globals =
+            generateRandomMatrix<CoordinateType>(worldDim, trialPointCount);
+    trialGeomData.globals.row(0) += 2.; // keep the points apart
+    trialGeomData.normals =
+            generateRandomMatrix<CoordinateType>(worldDim, trialPointCount);
+
+    Fiber::CollectionOf4dArrays<ValueType> result;
+    kernels.evaluateOnGrid(testGeomData, trialGeomData, result);
+
+    Fiber::_4dArray<ValueType> expected(1, 1, testPointCount, trialPointCount);
+    Fiber::GeometricalData<CoordinateType> pairedTrialGeomData;
+    Fiber::CollectionOf3dArrays<ValueType> pairResult;
+    for (int trialPoint = 0; trialPoint < trialPointCount; ++trialPoint) {
+        pairedTrialGeomData.globals = arma::repmat(
+                trialGeomData.globals.col(trialPoint), 1, testPointCount);
+        pairedTrialGeomData.normals = arma::repmat(
+                trialGeomData.normals.col(trialPoint), 1, testPointCount);
+        kernels.evaluateAtPointPairs(testGeomData, pairedTrialGeomData,
+                                     pairResult);
+        for (int testPoint = 0; testPoint < testPointCount; ++testPoint)
+            expected(0, 0, testPoint, trialPoint) =
+                    pairResult[0](0, 0, testPoint);
+    }
+
+    CoordinateType tol = 100 * std::numeric_limits<CoordinateType>::epsilon();
+    return check_arrays_are_close<ValueType>(result[0], expected, tol);
+}
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(BatchedKernelEvaluation)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(laplace_3d_single_layer_agrees_with_pointwise,
+                              ValueType, kernel_types)
+{
+    typedef Fiber::Laplace3dSingleLayerPotentialKernelFunctor<ValueType> Functor;
+    BOOST_CHECK(batchedEvaluationAgreesWithPointwise(Functor()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(laplace_3d_double_layer_agrees_with_pointwise,
+                              ValueType, kernel_types)
+{
+    typedef Fiber::Laplace3dDoubleLayerPotentialKernelFunctor<ValueType> Functor;
+    BOOST_CHECK(batchedEvaluationAgreesWithPointwise(Functor()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(laplace_3d_adjoint_double_layer_agrees_with_pointwise,
+                              ValueType, kernel_types)
+{
+    typedef Fiber::Laplace3dAdjointDoubleLayerPotentialKernelFunctor<ValueType>
+            Functor;
+    BOOST_CHECK(batchedEvaluationAgreesWithPointwise(Functor()));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(modified_helmholtz_3d_single_layer_agrees_with_pointwise,
+                              ValueType, kernel_types)
+{
+    typedef Fiber::ModifiedHelmholtz3dSingleLayerPotentialKernelFunctor<ValueType>
+            Functor;
+    BOOST_CHECK(batchedEvaluationAgreesWithPointwise(Functor(ValueType(1.5))));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(modified_helmholtz_3d_double_layer_agrees_with_pointwise,
+                              ValueType, kernel_types)
+{
+    typedef Fiber::ModifiedHelmholtz3dDoubleLayerPotentialKernelFunctor<ValueType>
+            Functor;
+    BOOST_CHECK(batchedEvaluationAgreesWithPointwise(Functor(ValueType(1.5))));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(modified_helmholtz_3d_adjoint_double_layer_agrees_with_pointwise,
+                              ValueType, kernel_types)
+{
+    typedef Fiber::ModifiedHelmholtz3dAdjointDoubleLayerPotentialKernelFunctor<
+            ValueType> Functor;
+    BOOST_CHECK(batchedEvaluationAgreesWithPointwise(Functor(ValueType(1.5))));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(modified_helmholtz_3d_single_layer_agrees_with_pointwise_for_complex_wave_number,
+                              ValueType, complex_kernel_types)
+{
+    typedef Fiber::ModifiedHelmholtz3dSingleLayerPotentialKernelFunctor<ValueType>
+            Functor;
+    BOOST_CHECK(batchedEvaluationAgreesWithPointwise(Functor(ValueType(0.5, -3.))));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(modified_helmholtz_3d_double_layer_agrees_with_pointwise_for_complex_wave_number,
+                              ValueType, complex_kernel_types)
+{
+    typedef Fiber::ModifiedHelmholtz3dDoubleLayerPotentialKernelFunctor<ValueType>
+            Functor;
+    BOOST_CHECK(batchedEvaluationAgreesWithPointwise(Functor(ValueType(0.5, -3.))));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(modified_helmholtz_3d_adjoint_double_layer_agrees_with_pointwise_for_complex_wave_number,
+                              ValueType, complex_kernel_types)
+{
+    typedef Fiber::ModifiedHelmholtz3dAdjointDoubleLayerPotentialKernelFunctor<
+            ValueType> Functor;
+    BOOST_CHECK(batchedEvaluationAgreesWithPointwise(Functor(ValueType(0.5, -3.))));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,155 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fiber/congruent_element_pairs.hpp"
+#include "fiber/raw_grid_geometry.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Regular grid of 2 * n * n right triangles covering the unit square in the
+// plane z = 0. All interior pairs of adjacent triangles are congruent to
+// pairs from a small set of configurations.
+Fiber::RawGridGeometry<double> unitSquareGrid(int n)
+{
+    Fiber::RawGridGeometry<double> geometry(2, 3);
+    arma::Mat<double>& vertices = geometry.vertices();
+    vertices.set_size(3, (n + 1) * (n + 1));
+    for (int j = 0; j <= n; ++j)
+        for (int i = 0; i <= n; ++i) {
+            vertices(0, j * (n + 1) + i) = double(i) / n;
+            vertices(1, j * (n + 1) + i) = double(j) / n;
+            vertices(2, j * (n + 1) + i) = 0.;
+        }
+    arma::Mat<int>& corners = geometry.elementCornerIndices();
+    corners.set_size(3, 2 * n * n);
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i) {
+            const int v = j * (n + 1) + i;
+            const int e = 2 * (j * n + i);
+            corners(0, e) = v; corners(1, e) = v + 1;
+            corners(2, e) = v + n + 1;
+            corners(0, e + 1) = v + 1; corners(1, e + 1) = v + n + 2;
+            corners(2, e + 1) = v + n + 1;
+        }
+    geometry.auxData().set_size(0, 2 * n * n);
+    return geometry;
+}
+
+arma::Mat<double> rotated(const arma::Mat<double>& points)
+{
+    // Rotation by 30 degrees about the axis (1, 1, 1) / sqrt(3)
+    const double c = std::cos(M_PI / 6.), s = std::sin(M_PI / 6.);
+    const double u = 1. / std::sqrt(3.);
+    arma::Mat<double> r(3, 3);
+    r(0, 0) = c + u * u * (1 - c);
+    r(0, 1) = u * u * (1 - c) - u * s;
+    r(0, 2) = u * u * (1 - c) + u * s;
+    r(1, 0) = u * u * (1 - c) + u * s;
+    r(1, 1) = c + u * u * (1 - c);
+    r(1, 2) = u * u * (1 - c) - u * s;
+    r(2, 0) = u * u * (1 - c) - u * s;
+    r(2, 1) = u * u * (1 - c) + u * s;
+    r(2, 2) = c + u * u * (1 - c);
+    arma::Mat<double> result = r * points;
+    result.row(0) += 0.25;
+    result.row(1) -= 3.;
+    result.row(2) += 1.5;
+    return result;
+}
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(CongruentElementPairs)
+
+BOOST_AUTO_TEST_CASE(congruenceKey_is_invariant_under_rigid_motions)
+{
+    arma::Mat<double> test(3, 3), trial(3, 3);
+    test(0, 0) = 0.; test(1, 0) = 0.; test(2, 0) = 0.;
+    test(0, 1) = 1.; test(1, 1) = 0.2; test(2, 1) = 0.;
+    test(0, 2) = 0.3; test(1, 2) = 0.9; test(2, 2) = 0.1;
+    trial.col(0) = test.col(1);
+    trial.col(1) = test.col(2);
+    trial(0, 2) = 1.2; trial(1, 2) = 1.1; trial(2, 2) = -0.4;
+
+    std::vector<long long> key, movedKey;
+    BOOST_REQUIRE(Fiber::congruenceKey(test, trial, 1e-10, key));
+    BOOST_REQUIRE(Fiber::congruenceKey(rotated(test), rotated(trial), 1e-10,
+                                       movedKey));
+    BOOST_CHECK(key == movedKey);
+}
+
+BOOST_AUTO_TEST_CASE(congruenceKey_distinguishes_mirror_images)
+{
+    arma::Mat<double> test(3, 3), trial(3, 3);
+    test(0, 0) = 0.; test(1, 0) = 0.; test(2, 0) = 0.;
+    test(0, 1) = 1.; test(1, 1) = 0.; test(2, 1) = 0.;
+    test(0, 2) = 0.; test(1, 2) = 1.; test(2, 2) = 0.;
+    trial.col(0) = test.col(1);
+    trial.col(1) = test.col(2);
+    trial(0, 2) = 1.; trial(1, 2) = 1.; trial(2, 2) = 0.5;
+
+    arma::Mat<double> mirroredTrial = trial;
+    mirroredTrial(2, 2) = -0.5;
+
+    std::vector<long long> key, mirroredKey;
+    BOOST_REQUIRE(Fiber::congruenceKey(test, trial, 1e-10, key));
+    BOOST_REQUIRE(Fiber::congruenceKey(test, mirroredTrial, 1e-10,
+                                       mirroredKey));
+    BOOST_CHECK(key != mirroredKey);
+}
+
+BOOST_AUTO_TEST_CASE(findCongruentElementPairs_groups_pairs_of_structured_grid)
+{
+    const int n = 8;
+    Fiber::RawGridGeometry<double> geometry = unitSquareGrid(n);
+    std::vector<std::pair<int, int> > pairs;
+    for (int e = 0; e < 2 * n * n; ++e)
+        pairs.push_back(std::make_pair(e, e));
+    // Edge-adjacent pairs (lower and upper triangle of each square)
+    for (int e = 0; e < 2 * n * n; e += 2)
+        pairs.push_back(std::make_pair(e, e + 1));
+
+    std::vector<int> representatives, classIndices;
+    Fiber::findCongruentElementPairs(geometry, geometry, pairs,
+                                     representatives, classIndices);
+
+    // Coincident pairs: lower and upper triangles; edge-adjacent pairs: one
+    // configuration
+    BOOST_CHECK_EQUAL(representatives.size(), 3u);
+    BOOST_REQUIRE_EQUAL(classIndices.size(), pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        const std::pair<int, int>& representative =
+                pairs[representatives[classIndices[i]]];
+        BOOST_CHECK_EQUAL(representative.first % 2, pairs[i].first % 2);
+        BOOST_CHECK_EQUAL(representative.second - representative.first,
+                          pairs[i].second - pairs[i].first);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
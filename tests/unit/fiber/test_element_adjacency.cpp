@@ -0,0 +1,86 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fiber/element_adjacency.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+// Two triangles sharing the edge (1, 2), a third one touching the second
+// at vertex 3 only and a fourth one disjoint from all others
+arma::Mat<int> cornerIndicesOfFourTriangles()
+{
+    arma::Mat<int> result(3, 4);
+    result(0, 0) = 0; result(1, 0) = 1; result(2, 0) = 2;
+    result(0, 1) = 1; result(1, 1) = 3; result(2, 1) = 2;
+    result(0, 2) = 3; result(1, 2) = 4; result(2, 2) = 5;
+    result(0, 3) = 6; result(1, 3) = 7; result(2, 3) = 8;
+    return result;
+}
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(ElementAdjacency)
+
+BOOST_AUTO_TEST_CASE(neighbours_are_sorted_and_include_the_element_itself)
+{
+    Fiber::ElementAdjacency adjacency(cornerIndicesOfFourTriangles());
+
+    BOOST_REQUIRE_EQUAL(adjacency.elementCount(), 4);
+    const int expectedNeighbours[] = {1, 2};
+    BOOST_CHECK_EQUAL_COLLECTIONS(adjacency.neighboursBegin(1) + 1,
+                                  adjacency.neighboursEnd(1),
+                                  expectedNeighbours, expectedNeighbours + 2);
+    BOOST_CHECK_EQUAL(*adjacency.neighboursBegin(1), 0);
+    BOOST_CHECK_EQUAL(adjacency.neighboursEnd(3) - adjacency.neighboursBegin(3),
+                      1);
+}
+
+BOOST_AUTO_TEST_CASE(sharedVertexCount_distinguishes_vertex_and_edge_neighbours)
+{
+    Fiber::ElementAdjacency adjacency(cornerIndicesOfFourTriangles());
+
+    BOOST_CHECK_EQUAL(adjacency.sharedVertexCount(0, 0), 3);
+    BOOST_CHECK_EQUAL(adjacency.sharedVertexCount(0, 1), 2);
+    BOOST_CHECK_EQUAL(adjacency.sharedVertexCount(2, 1), 1);
+    BOOST_CHECK_EQUAL(adjacency.sharedVertexCount(0, 2), 0);
+    BOOST_CHECK_EQUAL(adjacency.sharedVertexCount(3, 0), 0);
+}
+
+BOOST_AUTO_TEST_CASE(topology_agrees_with_determineElementPairTopologyIn3D)
+{
+    const arma::Mat<int> corners = cornerIndicesOfFourTriangles();
+    Fiber::ElementAdjacency adjacency(corners);
+
+    for (int test = 0; test < 4; ++test)
+        for (int trial = 0; trial < 4; ++trial) {
+            Fiber::ElementPairTopology expected =
+                    Fiber::determineElementPairTopologyIn3D(
+                        &corners(0, test), 3, &corners(0, trial), 3);
+            BOOST_CHECK_EQUAL(adjacency.topology(test, trial), expected);
+        }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
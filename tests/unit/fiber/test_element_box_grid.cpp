@@ -0,0 +1,114 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fiber/element_box_grid.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+// Boxes of random positions and sizes, some of them much larger than others
+arma::Mat<double> randomBoxes(int count)
+{
+    std::srand(1);
+    arma::Mat<double> result(6, count);
+    for (int e = 0; e < count; ++e) {
+        const double size = (e % 10 == 0) ? 3. : 0.2;
+        for (int dim = 0; dim < 3; ++dim) {
+            const double lower = 10. * std::rand() / RAND_MAX;
+            result(2 * dim, e) = lower;
+            result(2 * dim + 1, e) = lower + size * std::rand() / RAND_MAX;
+        }
+    }
+    return result;
+}
+
+std::vector<int> boxesContainingByBruteForce(const arma::Mat<double>& boxes,
+                                             const double* point)
+{
+    std::vector<int> result;
+    for (size_t e = 0; e < boxes.n_cols; ++e) {
+        bool inside = true;
+        for (int dim = 0; dim < 3; ++dim)
+            inside = inside && boxes(2 * dim, e) <= point[dim] &&
+                    point[dim] <= boxes(2 * dim + 1, e);
+        if (inside)
+            result.push_back(e);
+    }
+    return result;
+}
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(ElementBoxGrid)
+
+BOOST_AUTO_TEST_CASE(findBoxesContaining_agrees_with_brute_force_search)
+{
+    const arma::Mat<double> boxes = randomBoxes(500);
+    Fiber::ElementBoxGrid<double> grid(boxes);
+    BOOST_REQUIRE_EQUAL(grid.boxCount(), 500);
+
+    std::vector<int> elements;
+    for (int i = 0; i < 1000; ++i) {
+        double point[3];
+        for (int dim = 0; dim < 3; ++dim)
+            point[dim] = -1. + 13. * std::rand() / RAND_MAX;
+        grid.findBoxesContaining(point, elements);
+        const std::vector<int> expected =
+                boxesContainingByBruteForce(boxes, point);
+        BOOST_CHECK_EQUAL_COLLECTIONS(elements.begin(), elements.end(),
+                                      expected.begin(), expected.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(findBoxesContaining_includes_box_boundaries)
+{
+    arma::Mat<double> boxes(6, 2);
+    boxes.col(0) = arma::Col<double>("0 1 0 1 0 1");
+    boxes.col(1) = arma::Col<double>("1 2 0 1 0 0");
+    Fiber::ElementBoxGrid<double> grid(boxes);
+
+    std::vector<int> elements;
+    const double corner[3] = {1., 1., 0.};
+    grid.findBoxesContaining(corner, elements);
+    BOOST_CHECK_EQUAL(elements.size(), 2u);
+    const double outside[3] = {2.5, 0.5, 0.};
+    grid.findBoxesContaining(outside, elements);
+    BOOST_CHECK(elements.empty());
+}
+
+BOOST_AUTO_TEST_CASE(grid_without_boxes_contains_nothing)
+{
+    Fiber::ElementBoxGrid<double> grid((arma::Mat<double>(6, 0)));
+
+    std::vector<int> elements(1, 0);
+    const double point[3] = {0., 0., 0.};
+    grid.findBoxesContaining(point, elements);
+    BOOST_CHECK(elements.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
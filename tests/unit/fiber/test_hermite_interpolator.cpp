@@ -0,0 +1,81 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fiber/hermite_interpolator.hpp"
+#include "fiber/initialize_interpolator_for_modified_helmholtz_3d_kernels.hpp"
+
+#include "../type_template.hpp"
+
+#include <algorithm>
+#include <boost/test/unit_test.hpp>
+#include <complex>
+#include <limits>
+#include <vector>
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(HermiteInterpolator)
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(batched_evaluate_agrees_with_pointwise,
+                              ValueType, kernel_types)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    const ValueType waveNumber = 2.;
+    const CoordinateType maxDist = 3.;
+    Fiber::HermiteInterpolator<ValueType> interpolator;
+    Fiber::initializeInterpolatorForModifiedHelmholtz3dKernels(
+                waveNumber, maxDist, 100, interpolator);
+
+    const int pointCount = 101;
+    std::vector<CoordinateType> x(pointCount);
+    for (int i = 0; i < pointCount; ++i)
+        x[i] = maxDist * i / CoordinateType(pointCount - 1);
+    std::vector<ValueType> values(pointCount);
+    interpolator.evaluate(&x[0], &values[0], pointCount);
+
+    for (int i = 0; i < pointCount; ++i)
+        BOOST_CHECK_EQUAL(values[i], interpolator.evaluate(x[i]));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(automatic_density_reaches_requested_accuracy,
+                              ValueType, complex_kernel_types)
+{
+    typedef typename Fiber::ScalarTraits<ValueType>::RealType CoordinateType;
+    const ValueType waveNumber(0.5, -20.);
+    const CoordinateType maxDist = 2.;
+    const CoordinateType accuracy =
+            std::max<CoordinateType>(1e-8, 1000 *
+                                     std::numeric_limits<CoordinateType>::epsilon());
+    Fiber::HermiteInterpolator<ValueType> interpolator;
+    Fiber::initializeInterpolatorForModifiedHelmholtz3dKernels(
+                waveNumber, maxDist,
+                Fiber::modifiedHelmholtz3dInterpolationDensity(accuracy),
+                interpolator);
+
+    const int pointCount = 997;
+    for (int i = 0; i < pointCount; ++i) {
+        const CoordinateType x = maxDist * i / CoordinateType(pointCount - 1);
+        const ValueType exact = std::exp(-waveNumber * x);
+        BOOST_CHECK_SMALL(std::abs(interpolator.evaluate(x) - exact) /
+                          std::abs(exact), accuracy);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
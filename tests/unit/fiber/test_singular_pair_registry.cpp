@@ -0,0 +1,96 @@
+// Copyright (C) 2011-2015 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "fiber/singular_pair_registry.hpp"
+
+#include "common/armadillo_fwd.hpp"
+#include <boost/test/unit_test.hpp>
+#include <utility>
+
+namespace
+{
+
+// Two triangles sharing the edge (1, 2) and a third one touching the second
+// at vertex 3 only
+arma::Mat<int> cornerIndicesOfThreeTriangles()
+{
+    arma::Mat<int> result(3, 3);
+    result(0, 0) = 0; result(1, 0) = 1; result(2, 0) = 2;
+    result(0, 1) = 1; result(1, 1) = 3; result(2, 1) = 2;
+    result(0, 2) = 3; result(1, 2) = 4; result(2, 2) = 5;
+    return result;
+}
+
+} // namespace
+
+// Tests
+
+BOOST_AUTO_TEST_SUITE(SingularPairRegistry)
+
+BOOST_AUTO_TEST_CASE(adjacentElementPairs_are_sorted_after_trial_element)
+{
+    Fiber::SingularPairRegistry& registry =
+            Fiber::SingularPairRegistry::instance();
+    registry.clear();
+    Fiber::shared_ptr<const Fiber::AdjacentElementPairs> pairs =
+            registry.adjacentElementPairs(cornerIndicesOfThreeTriangles());
+
+    const std::pair<int, int> expectedPairs[] = {
+        std::make_pair(0, 0), std::make_pair(1, 0),
+        std::make_pair(0, 1), std::make_pair(1, 1), std::make_pair(2, 1),
+        std::make_pair(1, 2), std::make_pair(2, 2)
+    };
+    const int expectedNeighbourIndices[] = {0, 1, 0, 1, 2, 0, 1};
+    const size_t expectedPairCount = 7;
+
+    BOOST_REQUIRE_EQUAL(pairs->pairs.size(), expectedPairCount);
+    BOOST_REQUIRE_EQUAL(pairs->neighbourIndices.size(), expectedPairCount);
+    for (size_t i = 0; i < expectedPairCount; ++i) {
+        BOOST_CHECK(pairs->pairs[i] == expectedPairs[i]);
+        BOOST_CHECK_EQUAL(pairs->neighbourIndices[i],
+                          expectedNeighbourIndices[i]);
+    }
+    BOOST_CHECK_EQUAL(pairs->maxNeighbourCount, 3);
+}
+
+BOOST_AUTO_TEST_CASE(adjacentElementPairs_are_reused_for_identical_connectivity)
+{
+    Fiber::SingularPairRegistry& registry =
+            Fiber::SingularPairRegistry::instance();
+    registry.clear();
+    const size_t lookupsBefore = registry.lookupCount();
+    const size_t hitsBefore = registry.hitCount();
+
+    Fiber::shared_ptr<const Fiber::AdjacentElementPairs> first =
+            registry.adjacentElementPairs(cornerIndicesOfThreeTriangles());
+    Fiber::shared_ptr<const Fiber::AdjacentElementPairs> second =
+            registry.adjacentElementPairs(cornerIndicesOfThreeTriangles());
+    arma::Mat<int> otherCornerIndices = cornerIndicesOfThreeTriangles();
+    otherCornerIndices(0, 2) = 6;
+    Fiber::shared_ptr<const Fiber::AdjacentElementPairs> third =
+            registry.adjacentElementPairs(otherCornerIndices);
+
+    BOOST_CHECK(first.get() == second.get());
+    BOOST_CHECK(first.get() != third.get());
+    BOOST_CHECK_EQUAL(registry.lookupCount() - lookupsBefore, 3u);
+    BOOST_CHECK_EQUAL(registry.hitCount() - hitsBefore, 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,192 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "grid/grid_view.hpp"
+#include "io/gmsh.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace Bempp;
+
+BOOST_AUTO_TEST_SUITE(GmshImport)
+
+BOOST_AUTO_TEST_CASE(binary_file_contains_the_same_data_as_ascii_file)
+{
+    GmshData ascii = GmshData::read("meshes/cube-domains.msh",
+                                    -1 /* all types */, -1, false);
+    ascii.write("cube-domains-binary.msh", true /* binary */);
+    GmshData binary = GmshData::read("cube-domains-binary.msh",
+                                     -1 /* all types */, -1, false);
+    std::remove("cube-domains-binary.msh");
+
+    BOOST_CHECK_EQUAL(binary.numberOfNodes(), ascii.numberOfNodes());
+    BOOST_CHECK_EQUAL(binary.numberOfElements(), ascii.numberOfElements());
+    BOOST_CHECK(binary.nodeIndices() == ascii.nodeIndices());
+    BOOST_CHECK(binary.nodeCoordinates() == ascii.nodeCoordinates());
+    BOOST_CHECK(binary.elementIndices() == ascii.elementIndices());
+    BOOST_CHECK(binary.elementTypes() == ascii.elementTypes());
+    BOOST_CHECK(binary.elementPhysicalEntities() ==
+                ascii.elementPhysicalEntities());
+    BOOST_CHECK(binary.elementNodeOffsets() == ascii.elementNodeOffsets());
+    BOOST_CHECK(binary.elementNodes() == ascii.elementNodes());
+}
+
+BOOST_AUTO_TEST_CASE(importGmshGrid_reads_binary_files)
+{
+    GmshData::read("meshes/cube-domains.msh", -1, -1, false)
+        .write("cube-domains-binary.msh", true /* binary */);
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> asciiGrid = GridFactory::importGmshGrid(
+        params, "meshes/cube-domains.msh", false /* verbose */);
+    shared_ptr<Grid> binaryGrid = GridFactory::importGmshGrid(
+        params, "cube-domains-binary.msh", false /* verbose */);
+    std::remove("cube-domains-binary.msh");
+
+    arma::Mat<double> asciiVertices, binaryVertices;
+    arma::Mat<int> asciiCorners, binaryCorners;
+    arma::Mat<char> auxData;
+    std::vector<int> asciiDomains, binaryDomains;
+    asciiGrid->leafView()->getRawElementData(asciiVertices, asciiCorners,
+                                             auxData, asciiDomains);
+    binaryGrid->leafView()->getRawElementData(binaryVertices, binaryCorners,
+                                              auxData, binaryDomains);
+
+    BOOST_CHECK(check_arrays_are_close<double>(binaryVertices, asciiVertices,
+                                               1e-15));
+    BOOST_CHECK(arma::all(arma::vectorise(binaryCorners == asciiCorners)));
+    BOOST_CHECK(binaryDomains == asciiDomains);
+}
+
+BOOST_AUTO_TEST_CASE(domain_indices_are_physical_entities)
+{
+    GmshData gmshData = GmshData::read("meshes/cube-domains.msh",
+                                       2 /* triangles */, -1, false);
+    std::vector<int> expected = gmshData.elementPhysicalEntities();
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    std::vector<int> boundaryId2PhysicalEntity;
+    std::vector<int> elementIndex2PhysicalEntity;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "meshes/cube-domains.msh", boundaryId2PhysicalEntity,
+        elementIndex2PhysicalEntity, false /* verbose */);
+    BOOST_CHECK(elementIndex2PhysicalEntity == expected);
+
+    arma::Mat<double> vertices;
+    arma::Mat<int> corners;
+    arma::Mat<char> auxData;
+    std::vector<int> domains;
+    grid->leafView()->getRawElementData(vertices, corners, auxData, domains);
+    std::sort(expected.begin(), expected.end());
+    std::sort(domains.begin(), domains.end());
+    BOOST_CHECK(domains == expected);
+}
+
+BOOST_AUTO_TEST_CASE(physical_entities_follow_morton_order_of_elements)
+{
+    GmshData gmshData = GmshData::read("meshes/cube-domains.msh",
+                                       2 /* triangles */, -1, false);
+    std::vector<int> expected = gmshData.elementPhysicalEntities();
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    params.ordering = GridParameters::MORTON_ORDER;
+    std::vector<int> boundaryId2PhysicalEntity;
+    std::vector<int> elementIndex2PhysicalEntity;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+        params, "meshes/cube-domains.msh", boundaryId2PhysicalEntity,
+        elementIndex2PhysicalEntity, false /* verbose */);
+
+    // The entities are indexed like the elements of the grid...
+    arma::Mat<double> vertices;
+    arma::Mat<int> corners;
+    arma::Mat<char> auxData;
+    std::vector<int> domains;
+    grid->leafView()->getRawElementData(vertices, corners, auxData, domains);
+    BOOST_CHECK(elementIndex2PhysicalEntity == domains);
+
+    // ...and are a permutation of those in the file
+    std::sort(expected.begin(), expected.end());
+    std::sort(elementIndex2PhysicalEntity.begin(),
+              elementIndex2PhysicalEntity.end());
+    BOOST_CHECK(elementIndex2PhysicalEntity == expected);
+}
+
+BOOST_AUTO_TEST_CASE(second_order_triangles_are_imported_as_flat_triangles)
+{
+    // A unit square made of two triangles, once with first-order and once
+    // with second-order elements. The mid-edge nodes 5 to 9 of the
+    // second-order elements are listed after the corners.
+    const char* nodes =
+        "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n"
+        "$Nodes\n9\n"
+        "1 0 0 0\n2 1 0 0\n3 1 1 0\n4 0 1 0\n"
+        "5 0.5 0 0\n6 1 0.5 0\n7 0.5 0.5 0\n8 0.5 1 0\n9 0 0.5 0\n"
+        "$EndNodes\n";
+    {
+        std::ofstream file("square-order-1.msh");
+        file << nodes << "$Elements\n2\n"
+             << "1 2 2 3 1 1 2 3\n"
+             << "2 2 2 4 1 1 3 4\n"
+             << "$EndElements\n";
+        std::ofstream file2("square-order-2.msh");
+        file2 << nodes << "$Elements\n2\n"
+              << "1 9 2 3 1 1 2 3 5 6 7\n"
+              << "2 9 2 4 1 1 3 4 7 8 9\n"
+              << "$EndElements\n";
+    }
+
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> firstOrderGrid = GridFactory::importGmshGrid(
+        params, "square-order-1.msh", false /* verbose */);
+    shared_ptr<Grid> secondOrderGrid = GridFactory::importGmshGrid(
+        params, "square-order-2.msh", false /* verbose */);
+    std::remove("square-order-1.msh");
+    std::remove("square-order-2.msh");
+
+    arma::Mat<double> firstVertices, secondVertices;
+    arma::Mat<int> firstCorners, secondCorners;
+    arma::Mat<char> auxData;
+    std::vector<int> firstDomains, secondDomains;
+    firstOrderGrid->leafView()->getRawElementData(firstVertices, firstCorners,
+                                                  auxData, firstDomains);
+    secondOrderGrid->leafView()->getRawElementData(
+        secondVertices, secondCorners, auxData, secondDomains);
+
+    // Only the corners become vertices
+    BOOST_CHECK_EQUAL(secondVertices.n_cols, 4u);
+    BOOST_CHECK(check_arrays_are_close<double>(secondVertices, firstVertices,
+                                               1e-15));
+    BOOST_CHECK(arma::all(arma::vectorise(secondCorners == firstCorners)));
+    BOOST_CHECK(secondDomains == firstDomains);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
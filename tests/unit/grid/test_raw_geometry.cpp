@@ -0,0 +1,145 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+
+#include "fiber/raw_grid_geometry.hpp"
+#include "grid/entity.hpp"
+#include "grid/entity_iterator.hpp"
+#include "grid/geometry.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "grid/grid_view.hpp"
+#include "grid/mapper.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace Bempp;
+
+namespace {
+
+shared_ptr<Grid> importCube(GridParameters::Ordering ordering)
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    params.ordering = ordering;
+    return GridFactory::importGmshGrid(params, "meshes/cube-domains.msh",
+                                       false /* verbose */);
+}
+
+// Sum of the coordinates of the corners of an element
+double cornerCoordinateSum(const Fiber::RawGridGeometry<double> &geometry,
+                           int element)
+{
+    double sum = 0.;
+    for (int c = 0; c < geometry.elementCornerCount(element); ++c)
+        sum += arma::accu(geometry.vertices().col(
+                              geometry.elementCornerIndices()(c, element)));
+    return sum;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(RawGeometry)
+
+BOOST_AUTO_TEST_CASE(raw_geometry_is_shared_by_all_leaf_views)
+{
+    shared_ptr<Grid> grid = importCube(GridParameters::INPUT_ORDER);
+    std::unique_ptr<GridView> view1 = grid->leafView();
+    std::unique_ptr<GridView> view2 = grid->leafView();
+    shared_ptr<const Fiber::RawGridGeometry<double> > geometry =
+        view1->rawGeometry<double>();
+    BOOST_CHECK(view2->rawGeometry<double>() == geometry);
+
+    arma::Mat<double> vertices;
+    arma::Mat<int> corners;
+    arma::Mat<char> auxData;
+    std::vector<int> domains;
+    view1->getRawElementData(vertices, corners, auxData, domains);
+    BOOST_CHECK(check_arrays_are_close<double>(geometry->vertices(), vertices,
+                                               0.));
+    BOOST_CHECK(arma::all(arma::vectorise(
+                    geometry->elementCornerIndices() == corners)));
+    BOOST_CHECK(geometry->domainIndices() == domains);
+}
+
+BOOST_AUTO_TEST_CASE(affine_element_data_agree_with_element_geometry)
+{
+    shared_ptr<Grid> grid = importCube(GridParameters::INPUT_ORDER);
+    std::unique_ptr<GridView> view = grid->leafView();
+    shared_ptr<const Fiber::RawGridGeometry<double> > geometry =
+        view->rawGeometry<double>();
+    BOOST_REQUIRE(geometry->hasAffineElementData());
+
+    arma::Mat<double> center(2, 1);
+    center.fill(1. / 3.);
+    const Mapper &mapper = view->elementMapper();
+    std::unique_ptr<EntityIterator<0> > it = view->entityIterator<0>();
+    while (!it->finished()) {
+        const Entity<0> &element = it->entity();
+        const int index = mapper.entityIndex(element);
+        arma::Row<double> integrationElements;
+        arma::Mat<double> normals;
+        element.geometry().getIntegrationElements(center,
+                                                  integrationElements);
+        element.geometry().getNormals(center, normals);
+        BOOST_CHECK_CLOSE(geometry->elementIntegrationElements()(index),
+                          integrationElements(0), 1e-10);
+        BOOST_CHECK(check_arrays_are_close<double>(
+                        arma::Mat<double>(geometry->elementNormals().col(index)),
+                        normals, 1e-12));
+        it->next();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(morton_ordering_preserves_the_grid)
+{
+    shared_ptr<const Fiber::RawGridGeometry<double> > input =
+        importCube(GridParameters::INPUT_ORDER)->leafView()
+            ->rawGeometry<double>();
+    shared_ptr<const Fiber::RawGridGeometry<double> > morton =
+        importCube(GridParameters::MORTON_ORDER)->leafView()
+            ->rawGeometry<double>();
+
+    BOOST_CHECK_EQUAL(morton->vertices().n_cols, input->vertices().n_cols);
+    BOOST_CHECK_EQUAL(morton->elementCount(), input->elementCount());
+    BOOST_CHECK_CLOSE(arma::accu(morton->elementIntegrationElements()),
+                      arma::accu(input->elementIntegrationElements()), 1e-10);
+
+    // Each element keeps its corners and domain index
+    std::vector<std::pair<int, double> > inputKeys, mortonKeys;
+    for (int e = 0; e < input->elementCount(); ++e) {
+        inputKeys.push_back(std::make_pair(input->domainIndex(e),
+                                           cornerCoordinateSum(*input, e)));
+        mortonKeys.push_back(std::make_pair(morton->domainIndex(e),
+                                            cornerCoordinateSum(*morton, e)));
+    }
+    std::sort(inputKeys.begin(), inputKeys.end());
+    std::sort(mortonKeys.begin(), mortonKeys.end());
+    for (size_t i = 0; i < inputKeys.size(); ++i) {
+        BOOST_CHECK_EQUAL(mortonKeys[i].first, inputKeys[i].first);
+        BOOST_CHECK_SMALL(mortonKeys[i].second - inputKeys[i].second, 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,168 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef bempp_hmat_test_fixtures_hpp
+#define bempp_hmat_test_fixtures_hpp
+
+#include "hmat/block_cluster_tree.hpp"
+#include "hmat/cluster_tree.hpp"
+#include "hmat/data_accessor.hpp"
+#include "hmat/geometry.hpp"
+#include "hmat/geometry_data_type.hpp"
+#include "hmat/hmatrix.hpp"
+
+#include <armadillo>
+#include <cmath>
+
+namespace HMatTest
+{
+
+// Points of a regular n x n grid in the unit square of the plane z = 0,
+// each with a small bounding box around it
+inline hmat::Geometry planarGeometry(int n)
+{
+    const double h = 1. / n;
+    hmat::Geometry geometry;
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i) {
+            std::array<double, 3> center = {{(i + .5) * h, (j + .5) * h, 0.}};
+            hmat::BoundingBox box(center[0] - h / 4, center[0] + h / 4,
+                                  center[1] - h / 4, center[1] + h / 4,
+                                  0., 0.);
+            geometry.push_back(hmat::shared_ptr<hmat::GeometryDataType>(
+                new hmat::GeometryDataType(box, center)));
+        }
+    return geometry;
+}
+
+inline hmat::shared_ptr<hmat::DefaultBlockClusterTreeType> blockClusterTree(
+        const hmat::Geometry& geometry, int minBlockSize = 16,
+        int maxBlockSize = 2048, double eta = 1.2,
+        hmat::ClusterSplittingStrategy strategy = hmat::GEOMETRIC_SPLITTING)
+{
+    hmat::shared_ptr<hmat::DefaultClusterTreeType> clusterTree(
+        new hmat::DefaultClusterTreeType(geometry, minBlockSize, strategy));
+    return hmat::shared_ptr<hmat::DefaultBlockClusterTreeType>(
+        new hmat::DefaultBlockClusterTreeType(
+            clusterTree, clusterTree, maxBlockSize,
+            hmat::StandardAdmissibility(eta)));
+}
+
+// Matrix of the smooth kernel scale / (0.1 + |x - y|) on a geometry
+class SmoothKernelAccessor : public hmat::DataAccessor<double, 2>
+{
+public:
+    SmoothKernelAccessor(const hmat::Geometry& geometry,
+                         const hmat::DefaultBlockClusterTreeType& tree,
+                         double scale = 1.) :
+        m_geometry(geometry), m_scale(scale),
+        m_rowDofs(tree.rowClusterTree()->hMatDofToOriginalDofMap()),
+        m_columnDofs(tree.columnClusterTree()->hMatDofToOriginalDofMap())
+    {
+    }
+
+    static double kernel(const std::array<double, 3>& x,
+                         const std::array<double, 3>& y)
+    {
+        double dist2 = 0.;
+        for (int k = 0; k < 3; ++k)
+            dist2 += (x[k] - y[k]) * (x[k] - y[k]);
+        return 1. / (.1 + std::sqrt(dist2));
+    }
+
+    virtual void computeMatrixBlock(
+            const hmat::IndexRangeType& rowIndexRange,
+            const hmat::IndexRangeType& columnIndexRange,
+            const hmat::BlockClusterTreeNode<2>& blockClusterTreeNode,
+            arma::Mat<double>& data) const
+    {
+        data.set_size(rowIndexRange[1] - rowIndexRange[0],
+                      columnIndexRange[1] - columnIndexRange[0]);
+        for (std::size_t j = 0; j < data.n_cols; ++j)
+            for (std::size_t i = 0; i < data.n_rows; ++i)
+                data(i, j) = m_scale * kernel(
+                    m_geometry[m_rowDofs[rowIndexRange[0] + i]]->center,
+                    m_geometry[m_columnDofs[columnIndexRange[0] + j]]->center);
+    }
+
+    // The whole matrix in the original DOF numbering
+    arma::Mat<double> denseMatrix() const
+    {
+        arma::Mat<double> result(m_geometry.size(), m_geometry.size());
+        for (std::size_t j = 0; j < result.n_cols; ++j)
+            for (std::size_t i = 0; i < result.n_rows; ++i)
+                result(i, j) = m_scale * kernel(m_geometry[i]->center,
+                                                m_geometry[j]->center);
+        return result;
+    }
+
+private:
+    const hmat::Geometry& m_geometry;
+    double m_scale;
+    const std::vector<std::size_t>& m_rowDofs;
+    const std::vector<std::size_t>& m_columnDofs;
+};
+
+typedef const hmat::DefaultBlockClusterTreeNodeType* BlockPtr;
+
+// The largest admissible block of the tree, or a null pointer if there is
+// none. The block is owned by the tree.
+inline BlockPtr largestAdmissibleBlock(
+        const hmat::DefaultBlockClusterTreeType& tree)
+{
+    BlockPtr result = 0;
+    std::size_t largestSize = 0;
+    for (const auto& node : tree.leafNodes()) {
+        if (!node->data().admissible)
+            continue;
+        const auto& rows = node->data().rowClusterTreeNode->data().indexRange;
+        const auto& cols =
+            node->data().columnClusterTreeNode->data().indexRange;
+        std::size_t size = (rows[1] - rows[0]) * (cols[1] - cols[0]);
+        if (size > largestSize) {
+            largestSize = size;
+            result = &node;
+        }
+    }
+    return result;
+}
+
+// The matrix represented by an H-matrix in the original DOF numbering
+template <typename ValueType>
+arma::Mat<ValueType> hMatrixToDense(
+        const hmat::DefaultHMatrixType<ValueType>& hMatrix)
+{
+    arma::Mat<ValueType> identity =
+        arma::eye<arma::Mat<ValueType> >(hMatrix.columns(), hMatrix.columns());
+    arma::Mat<ValueType> result(hMatrix.rows(), hMatrix.columns());
+    hMatrix.apply(identity, result, hmat::NOTRANS, 1., 0.);
+    return result;
+}
+
+inline double relativeError(const arma::Mat<double>& actual,
+                            const arma::Mat<double>& expected)
+{
+    return arma::norm(actual - expected, "fro") /
+            arma::norm(expected, "fro");
+}
+
+} // namespace HMatTest
+
+#endif
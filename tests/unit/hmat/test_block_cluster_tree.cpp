@@ -0,0 +1,165 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_fixtures.hpp"
+
+#include "hmat/block_cluster_tree.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+using namespace HMatTest;
+
+namespace
+{
+
+typedef hmat::FlatBlockClusterTreeNode FlatNode;
+typedef hmat::DefaultBlockClusterTreeNodeType Node;
+typedef hmat::shared_ptr<const hmat::DefaultClusterTreeNodeType> ClusterPtr;
+
+// Check recursively that the flat node with the given index is the block
+// of the given row and column clusters, that its children are the blocks
+// of the children of these clusters and that the same holds for its
+// descendants. Return the number of leafs below the node.
+std::size_t checkFlatNode(const hmat::DefaultBlockClusterTreeType& tree,
+                          const ClusterPtr& rowCluster,
+                          const ClusterPtr& columnCluster, std::size_t index,
+                          std::size_t parent, std::size_t& nextLeafId)
+{
+    const std::vector<FlatNode>& flatNodes = tree.flatNodes();
+    BOOST_REQUIRE_LT(index, flatNodes.size());
+    const FlatNode& flatNode = flatNodes[index];
+    const Node node = tree.node(index);
+
+    BOOST_CHECK_EQUAL(node.flatNode(), index);
+    BOOST_CHECK(node.data().rowClusterTreeNode == rowCluster);
+    BOOST_CHECK(node.data().columnClusterTreeNode == columnCluster);
+    BOOST_CHECK_EQUAL(flatNode.parent, parent);
+    BOOST_CHECK_EQUAL(flatNode.admissible, node.data().admissible);
+    BOOST_CHECK(flatNode.rowIndexRange == rowCluster->data().indexRange);
+    BOOST_CHECK(flatNode.columnIndexRange == columnCluster->data().indexRange);
+    BOOST_CHECK_EQUAL(flatNode.isLeaf(), node.isLeaf());
+
+    if (flatNode.isLeaf()) {
+        // The leafs are numbered in depth-first order
+        BOOST_CHECK_EQUAL(flatNode.leafId, nextLeafId);
+        ++nextLeafId;
+        BOOST_REQUIRE_LT(flatNode.leafId, tree.numberOfLeafs());
+        BOOST_CHECK_EQUAL(tree.leafFlatNode(flatNode.leafId), index);
+        return 1;
+    }
+    BOOST_CHECK_EQUAL(flatNode.leafId, FlatNode::NONE);
+    std::size_t leafCount = 0;
+    for (int i = 0; i < 4; ++i) {
+        BOOST_CHECK_EQUAL(node.child(i).flatNode(), flatNode.firstChild + i);
+        leafCount += checkFlatNode(tree, rowCluster->child(i / 2),
+                                   columnCluster->child(i % 2),
+                                   flatNode.firstChild + i, index, nextLeafId);
+    }
+    return leafCount;
+}
+
+void checkTree(const hmat::DefaultBlockClusterTreeType& tree)
+{
+    std::size_t nextLeafId = 0;
+    std::size_t leafCount = checkFlatNode(
+        tree, tree.rowClusterTree()->root(), tree.columnClusterTree()->root(),
+        0, FlatNode::NONE, nextLeafId);
+    BOOST_CHECK_EQUAL(leafCount, tree.numberOfLeafs());
+    BOOST_CHECK_EQUAL(tree.root().flatNode(), 0u);
+
+    // The leafs are numbered densely in the order of leafNodes()
+    const std::vector<Node>& leafNodes = tree.leafNodes();
+    BOOST_REQUIRE_EQUAL(leafNodes.size(), tree.numberOfLeafs());
+    for (std::size_t leaf = 0; leaf < leafNodes.size(); ++leaf) {
+        BOOST_CHECK_EQUAL(leafNodes[leaf].flatNode(), tree.leafFlatNode(leaf));
+        BOOST_CHECK(leafNodes[leaf].isLeaf());
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(FlatBlockClusterTree)
+
+BOOST_AUTO_TEST_CASE(flat_nodes_describe_the_block_tree)
+{
+    hmat::Geometry geometry = planarGeometry(32);
+    checkTree(*blockClusterTree(geometry));
+}
+
+BOOST_AUTO_TEST_CASE(flat_nodes_of_parallel_construction_describe_the_tree)
+{
+    // Blocks with more than 1024 rows and columns are split concurrently,
+    // and their subtrees appended afterwards
+    hmat::Geometry geometry = planarGeometry(96);
+    auto tree = blockClusterTree(geometry);
+    BOOST_REQUIRE_GT(tree->rows(), 2048u);
+    checkTree(*tree);
+}
+
+BOOST_AUTO_TEST_CASE(tree_rebuilt_from_flat_nodes_is_identical)
+{
+    hmat::Geometry geometry = planarGeometry(32);
+    auto tree = blockClusterTree(geometry);
+
+    hmat::DefaultBlockClusterTreeType rebuiltTree(
+        tree->rowClusterTree(), tree->columnClusterTree(), tree->flatNodes());
+    checkTree(rebuiltTree);
+
+    const std::vector<FlatNode>& expected = tree->flatNodes();
+    const std::vector<FlatNode>& actual = rebuiltTree.flatNodes();
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        BOOST_CHECK(actual[i].rowIndexRange == expected[i].rowIndexRange);
+        BOOST_CHECK(actual[i].columnIndexRange ==
+                    expected[i].columnIndexRange);
+        BOOST_CHECK_EQUAL(actual[i].parent, expected[i].parent);
+        BOOST_CHECK_EQUAL(actual[i].firstChild, expected[i].firstChild);
+        BOOST_CHECK_EQUAL(actual[i].leafId, expected[i].leafId);
+        BOOST_CHECK_EQUAL(actual[i].admissible, expected[i].admissible);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(oversized_blocks_of_leaf_clusters_stay_admissible)
+{
+    // With maxBlockSize below the size of the leaf clusters every block is
+    // refined down to pairs of leaf clusters, whose admissibility is kept.
+    hmat::Geometry geometry = planarGeometry(32);
+    const int minBlockSize = 16;
+    const int maxBlockSize = 8;
+    auto tree = blockClusterTree(geometry, minBlockSize, maxBlockSize);
+    const hmat::DefaultBlockClusterTreeType& constTree = *tree;
+    hmat::StandardAdmissibility admissibility(1.2);
+
+    std::size_t admissibleLeafs = 0;
+    for (const auto& node : constTree.leafNodes()) {
+        const auto& rowCluster = node.data().rowClusterTreeNode;
+        const auto& columnCluster = node.data().columnClusterTreeNode;
+        BOOST_CHECK(rowCluster->isLeaf() || columnCluster->isLeaf());
+        BOOST_CHECK_EQUAL(node.data().admissible,
+                          admissibility(rowCluster->data().boundingBox,
+                                        columnCluster->data().boundingBox));
+        if (node.data().admissible)
+            ++admissibleLeafs;
+    }
+    BOOST_CHECK_GT(admissibleLeafs, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,145 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_fixtures.hpp"
+
+#include "hmat/cluster_tree.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace HMatTest;
+
+namespace
+{
+
+typedef hmat::shared_ptr<const hmat::DefaultClusterTreeNodeType> NodePtr;
+
+std::size_t clusterSize(const NodePtr& node)
+{
+    const hmat::IndexRangeType& range = node->data().indexRange;
+    return range[1] - range[0];
+}
+
+void collectLeafs(const NodePtr& node, std::vector<NodePtr>& leafs)
+{
+    if (node->isLeaf()) {
+        leafs.push_back(node);
+        return;
+    }
+    collectLeafs(node->child(0), leafs);
+    collectLeafs(node->child(1), leafs);
+}
+
+// The maximum difference of the sizes of two sibling clusters
+std::size_t maxSiblingImbalance(const NodePtr& node)
+{
+    if (node->isLeaf())
+        return 0;
+    std::size_t size0 = clusterSize(node->child(0));
+    std::size_t size1 = clusterSize(node->child(1));
+    return std::max(std::max(size0, size1) - std::min(size0, size1),
+                    std::max(maxSiblingImbalance(node->child(0)),
+                             maxSiblingImbalance(node->child(1))));
+}
+
+void checkTreeIsValid(const hmat::DefaultClusterTreeType& tree,
+                      const hmat::Geometry& geometry,
+                      std::size_t maxLeafSize)
+{
+    BOOST_REQUIRE_EQUAL(tree.numberOfDofs(), geometry.size());
+
+    // The DOF permutation is a bijection
+    std::vector<std::size_t> dofs = tree.hMatDofToOriginalDofMap();
+    std::sort(dofs.begin(), dofs.end());
+    for (std::size_t i = 0; i < dofs.size(); ++i)
+        BOOST_REQUIRE_EQUAL(dofs[i], i);
+
+    // The leafs are small and cover consecutive index ranges, and their
+    // bounding boxes contain the centers of their elements
+    std::vector<NodePtr> leafs;
+    collectLeafs(tree.root(), leafs);
+    std::size_t nextIndex = 0;
+    for (const NodePtr& leaf : leafs) {
+        const hmat::IndexRangeType& range = leaf->data().indexRange;
+        BOOST_CHECK_EQUAL(range[0], nextIndex);
+        BOOST_CHECK_GE(clusterSize(leaf), 1u);
+        BOOST_CHECK_LE(clusterSize(leaf), maxLeafSize);
+        nextIndex = range[1];
+
+        hmat::BoundingBox box = leaf->data().boundingBox;
+        const std::array<double, 6>& bounds = box.bounds();
+        for (std::size_t hMatDof = range[0]; hMatDof < range[1]; ++hMatDof) {
+            const std::array<double, 3>& center =
+                geometry[tree.mapHMatDofToOriginalDof(hMatDof)]->center;
+            for (int dim = 0; dim < 3; ++dim) {
+                BOOST_CHECK_LE(bounds[2 * dim], center[dim]);
+                BOOST_CHECK_GE(bounds[2 * dim + 1], center[dim]);
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(nextIndex, geometry.size());
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ClusterTree)
+
+BOOST_AUTO_TEST_CASE(geometric_splitting_gives_valid_tree)
+{
+    hmat::Geometry geometry = planarGeometry(40);
+    hmat::DefaultClusterTreeType tree(geometry, 16, hmat::GEOMETRIC_SPLITTING);
+    checkTreeIsValid(tree, geometry, 16);
+}
+
+BOOST_AUTO_TEST_CASE(cardinality_splitting_gives_balanced_tree)
+{
+    // Points concentrated near one corner, where bisection of the bounding
+    // boxes gives unbalanced clusters
+    hmat::Geometry geometry;
+    for (const auto& data : planarGeometry(40)) {
+        std::array<double, 3> center = data->center;
+        center[0] *= center[0] * center[0];
+        center[1] *= center[1];
+        hmat::BoundingBox box(center[0], center[0], center[1], center[1],
+                              0., 0.);
+        geometry.push_back(hmat::shared_ptr<hmat::GeometryDataType>(
+            new hmat::GeometryDataType(box, center)));
+    }
+
+    hmat::DefaultClusterTreeType tree(geometry, 16,
+                                      hmat::CARDINALITY_SPLITTING);
+    checkTreeIsValid(tree, geometry, 16);
+    BOOST_CHECK_LE(maxSiblingImbalance(tree.root()), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(zero_min_block_size_gives_single_index_leafs)
+{
+    hmat::Geometry geometry = planarGeometry(8);
+    hmat::DefaultClusterTreeType geometricTree(geometry, 0,
+                                               hmat::GEOMETRIC_SPLITTING);
+    checkTreeIsValid(geometricTree, geometry, 1);
+    hmat::DefaultClusterTreeType cardinalityTree(geometry, 0,
+                                                 hmat::CARDINALITY_SPLITTING);
+    checkTreeIsValid(cardinalityTree, geometry, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,161 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_fixtures.hpp"
+
+#include "hmat/hmatrix_aca_compressor.hpp"
+#include "hmat/hmatrix_low_rank_data.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <utility>
+
+using namespace HMatTest;
+
+namespace
+{
+
+void checkAcaReachesTolerance(hmat::AcaVariant variant)
+{
+    hmat::Geometry geometry = planarGeometry(32);
+    auto tree = blockClusterTree(geometry);
+    SmoothKernelAccessor accessor(geometry, *tree);
+    auto node = largestAdmissibleBlock(*tree);
+    BOOST_REQUIRE(node);
+
+    const auto& rows = node->data().rowClusterTreeNode->data().indexRange;
+    const auto& cols = node->data().columnClusterTreeNode->data().indexRange;
+    arma::Mat<double> block;
+    accessor.computeMatrixBlock(rows, cols, *node, block);
+
+    const double epsValues[] = {1e-3, 1e-6, 1e-9};
+    int previousRank = 0;
+    for (double eps : epsValues) {
+        hmat::HMatrixAcaCompressor<double, 2> compressor(
+            accessor, eps, 1000, variant, 42 /* seed */);
+        hmat::shared_ptr<hmat::HMatrixData<double> > data;
+        compressor.compressBlock(*node, data);
+        const auto& lowRankData =
+            dynamic_cast<const hmat::HMatrixLowRankData<double>&>(*data);
+
+        // The stopping criterion of ACA is a heuristic, so allow a small
+        // safety factor.
+        BOOST_CHECK_SMALL(
+            relativeError(lowRankData.A() * lowRankData.B(), block),
+            10 * eps);
+        BOOST_CHECK_LT(lowRankData.rank(),
+                       static_cast<int>(std::min(block.n_rows, block.n_cols)));
+        BOOST_CHECK_GE(lowRankData.rank(), previousRank);
+        previousRank = lowRankData.rank();
+    }
+}
+
+// Compress the largest admissible block of the smooth kernel multiplied by
+// scale and return the rank and the relative error of the approximation
+std::pair<int, double> compressScaledBlock(hmat::AcaVariant variant,
+                                           double scale, double eps)
+{
+    hmat::Geometry geometry = planarGeometry(32);
+    auto tree = blockClusterTree(geometry);
+    SmoothKernelAccessor accessor(geometry, *tree, scale);
+    auto node = largestAdmissibleBlock(*tree);
+    BOOST_REQUIRE(node);
+
+    const auto& rows = node->data().rowClusterTreeNode->data().indexRange;
+    const auto& cols = node->data().columnClusterTreeNode->data().indexRange;
+    arma::Mat<double> block;
+    accessor.computeMatrixBlock(rows, cols, *node, block);
+
+    hmat::HMatrixAcaCompressor<double, 2> compressor(
+        accessor, eps, 1000, variant, 42 /* seed */);
+    hmat::shared_ptr<hmat::HMatrixData<double> > data;
+    compressor.compressBlock(*node, data);
+    const auto& lowRankData =
+        dynamic_cast<const hmat::HMatrixLowRankData<double>&>(*data);
+    return std::make_pair(
+        lowRankData.rank(),
+        relativeError(lowRankData.A() * lowRankData.B(), block));
+}
+
+void checkAcaIsScaleInvariant(hmat::AcaVariant variant)
+{
+    // Entries of the order of 1e-15 and 1e+15 are all far from any absolute
+    // threshold for zero pivots. Powers of two scale the entries exactly,
+    // so the same pivots must be chosen.
+    const double eps = 1e-6;
+    auto reference = compressScaledBlock(variant, 1., eps);
+    BOOST_REQUIRE_GT(reference.first, 0);
+    const double scales[] = {std::ldexp(1., -50), std::ldexp(1., 50)};
+    for (double scale : scales) {
+        auto scaled = compressScaledBlock(variant, scale, eps);
+        BOOST_CHECK_EQUAL(scaled.first, reference.first);
+        BOOST_CHECK_SMALL(scaled.second, 10 * eps);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(HMatrixAcaCompressor)
+
+BOOST_AUTO_TEST_CASE(partially_pivoted_aca_reaches_requested_tolerance)
+{
+    checkAcaReachesTolerance(hmat::ACA_PARTIAL_PIVOTING);
+}
+
+BOOST_AUTO_TEST_CASE(aca_plus_reaches_requested_tolerance)
+{
+    checkAcaReachesTolerance(hmat::ACA_PLUS);
+}
+
+BOOST_AUTO_TEST_CASE(partially_pivoted_aca_does_not_depend_on_kernel_scale)
+{
+    checkAcaIsScaleInvariant(hmat::ACA_PARTIAL_PIVOTING);
+}
+
+BOOST_AUTO_TEST_CASE(aca_plus_does_not_depend_on_kernel_scale)
+{
+    checkAcaIsScaleInvariant(hmat::ACA_PLUS);
+}
+
+BOOST_AUTO_TEST_CASE(compression_is_deterministic_under_a_seed)
+{
+    hmat::Geometry geometry = planarGeometry(32);
+    auto tree = blockClusterTree(geometry);
+    SmoothKernelAccessor accessor(geometry, *tree);
+    auto node = largestAdmissibleBlock(*tree);
+    BOOST_REQUIRE(node);
+
+    hmat::HMatrixAcaCompressor<double, 2> compressor(
+        accessor, 1e-6, 1000, hmat::ACA_PLUS, 7 /* seed */);
+    hmat::shared_ptr<hmat::HMatrixData<double> > first, second;
+    compressor.compressBlock(*node, first);
+    compressor.compressBlock(*node, second);
+
+    const auto& firstData =
+        dynamic_cast<const hmat::HMatrixLowRankData<double>&>(*first);
+    const auto& secondData =
+        dynamic_cast<const hmat::HMatrixLowRankData<double>&>(*second);
+    BOOST_REQUIRE_EQUAL(firstData.rank(), secondData.rank());
+    BOOST_CHECK_EQUAL(arma::norm(firstData.A() - secondData.A(), "fro"), 0.);
+    BOOST_CHECK_EQUAL(arma::norm(firstData.B() - secondData.B(), "fro"), 0.);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
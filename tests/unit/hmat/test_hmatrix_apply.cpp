@@ -0,0 +1,110 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_fixtures.hpp"
+
+#include "hmat/hmatrix.hpp"
+#include "hmat/hmatrix_aca_compressor.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <vector>
+
+using namespace HMatTest;
+
+namespace
+{
+
+struct HMatrixFixture
+{
+    HMatrixFixture() :
+        geometry(planarGeometry(24)),
+        tree(blockClusterTree(geometry)),
+        accessor(geometry, *tree),
+        compressor(accessor, 1e-12, 200),
+        hMatrix(tree, compressor),
+        denseMatrix(accessor.denseMatrix())
+    {
+    }
+
+    hmat::Geometry geometry;
+    hmat::shared_ptr<hmat::DefaultBlockClusterTreeType> tree;
+    SmoothKernelAccessor accessor;
+    hmat::HMatrixAcaCompressor<double, 2> compressor;
+    hmat::DefaultHMatrixType<double> hMatrix;
+    arma::Mat<double> denseMatrix;
+};
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(HMatrixApply, HMatrixFixture)
+
+BOOST_AUTO_TEST_CASE(apply_agrees_with_dense_product_for_single_column)
+{
+    arma::Mat<double> x = arma::randu<arma::Mat<double> >(hMatrix.columns(), 1);
+    arma::Mat<double> y(hMatrix.rows(), 1);
+    hMatrix.apply(x, y, hmat::NOTRANS, 1., 0.);
+    BOOST_CHECK_SMALL(relativeError(y, denseMatrix * x), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(apply_agrees_with_dense_product_for_multiple_columns)
+{
+    arma::Mat<double> x = arma::randu<arma::Mat<double> >(hMatrix.columns(), 5);
+    arma::Mat<double> y = arma::randu<arma::Mat<double> >(hMatrix.rows(), 5);
+    arma::Mat<double> expected = 2. * denseMatrix * x + 3. * y;
+    hMatrix.apply(x, y, hmat::NOTRANS, 2., 3.);
+    BOOST_CHECK_SMALL(relativeError(y, expected), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(transposed_apply_agrees_with_dense_product)
+{
+    arma::Mat<double> x = arma::randu<arma::Mat<double> >(hMatrix.rows(), 3);
+    arma::Mat<double> y(hMatrix.columns(), 3);
+    hMatrix.apply(x, y, hmat::TRANS, 1., 0.);
+    BOOST_CHECK_SMALL(relativeError(y, denseMatrix.t() * x), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE(nested_applies_of_the_same_hmatrix_do_not_interfere)
+{
+    // Threads waiting inside apply() may steal tasks applying the same
+    // H-matrix, so every apply needs its own work arrays.
+    const int applyCount = 64;
+    std::vector<arma::Mat<double> > xs(applyCount);
+    std::vector<arma::Mat<double> > ys(applyCount);
+    for (int i = 0; i < applyCount; ++i) {
+        xs[i] = arma::randu<arma::Mat<double> >(hMatrix.columns(), 1 + i % 3);
+        ys[i].set_size(hMatrix.rows(), xs[i].n_cols);
+    }
+
+    tbb::parallel_for(tbb::blocked_range<int>(0, applyCount, 1),
+                      [&](const tbb::blocked_range<int>& r) {
+        for (int i = r.begin(); i != r.end(); ++i)
+            tbb::parallel_for(tbb::blocked_range<int>(i, i + 1),
+                              [&](const tbb::blocked_range<int>& s) {
+                hMatrix.apply(xs[i], ys[i], hmat::NOTRANS, 1., 0.);
+            });
+    });
+
+    for (int i = 0; i < applyCount; ++i)
+        BOOST_CHECK_SMALL(relativeError(ys[i], denseMatrix * xs[i]), 1e-8);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_fixtures.hpp"
+
+#include "hmat/hmatrix.hpp"
+#include "hmat/hmatrix_aca_compressor.hpp"
+#include "hmat/hmatrix_data.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <tbb/task_scheduler_init.h>
+
+using namespace HMatTest;
+
+BOOST_AUTO_TEST_SUITE(HMatrixCompression)
+
+BOOST_AUTO_TEST_CASE(parallel_compression_agrees_with_serial_compression)
+{
+    hmat::Geometry geometry = planarGeometry(24);
+    auto tree = blockClusterTree(geometry);
+    SmoothKernelAccessor accessor(geometry, *tree);
+    hmat::HMatrixAcaCompressor<double, 2> compressor(accessor, 1e-6, 30);
+
+    hmat::DefaultHMatrixType<double> serialHMatrix(tree);
+    {
+        tbb::task_scheduler_init scheduler(1);
+        serialHMatrix.initialize(compressor);
+    }
+    hmat::DefaultHMatrixType<double> parallelHMatrix(tree);
+    {
+        tbb::task_scheduler_init scheduler(4);
+        parallelHMatrix.initialize(compressor);
+    }
+
+    BOOST_REQUIRE_EQUAL(parallelHMatrix.numberOfLeafs(),
+                        serialHMatrix.numberOfLeafs());
+    for (std::size_t leaf = 0; leaf < serialHMatrix.numberOfLeafs(); ++leaf) {
+        BOOST_CHECK_EQUAL(parallelHMatrix.leafFlatNode(leaf),
+                          serialHMatrix.leafFlatNode(leaf));
+        BOOST_CHECK_EQUAL(parallelHMatrix.leafData(leaf)->rank(),
+                          serialHMatrix.leafData(leaf)->rank());
+    }
+
+    // The pivots of ACA depend only on the seed and the block, so the
+    // compressed blocks are identical.
+    arma::Mat<double> serialMatrix = hMatrixToDense(serialHMatrix);
+    arma::Mat<double> parallelMatrix = hMatrixToDense(parallelHMatrix);
+    BOOST_CHECK_SMALL(relativeError(parallelMatrix, serialMatrix), 1e-15);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
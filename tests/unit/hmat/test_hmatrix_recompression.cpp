@@ -0,0 +1,100 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "hmat_test_fixtures.hpp"
+
+#include "hmat/hmatrix.hpp"
+#include "hmat/hmatrix_aca_compressor.hpp"
+#include "hmat/hmatrix_low_rank_data.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+
+using namespace HMatTest;
+
+BOOST_AUTO_TEST_SUITE(HMatrixRecompression)
+
+BOOST_AUTO_TEST_CASE(low_rank_block_is_truncated_within_eps)
+{
+    // A rank-20 matrix whose singular values decay geometrically, stored
+    // with factors of rank 40
+    const int rows = 60, cols = 50, rank = 20;
+    arma::Mat<double> U, V;
+    arma::Col<double> s;
+    arma::svd_econ(U, s, V, arma::randu<arma::Mat<double> >(rows, cols));
+    arma::Mat<double> exact = arma::zeros<arma::Mat<double> >(rows, cols);
+    for (int i = 0; i < rank; ++i)
+        exact += std::pow(.5, i) * U.col(i) * V.col(i).t();
+
+    hmat::HMatrixLowRankData<double> data;
+    arma::Mat<double> scaledU = U.cols(0, rank - 1);
+    for (int i = 0; i < rank; ++i)
+        scaledU.col(i) *= std::pow(.5, i);
+    data.A() = arma::join_rows(scaledU, U.cols(rank, 2 * rank - 1));
+    data.B() = arma::join_cols(arma::Mat<double>(V.cols(0, rank - 1).t()),
+                               arma::zeros<arma::Mat<double> >(rank, cols));
+    BOOST_REQUIRE_EQUAL(data.rank(), 2 * rank);
+
+    const double eps = 1e-3;
+    data.recompress(eps);
+    BOOST_CHECK_LT(data.rank(), rank);
+    BOOST_CHECK_SMALL(relativeError(data.A() * data.B(), exact), eps);
+}
+
+BOOST_AUTO_TEST_CASE(recompression_stays_within_eps_and_saves_memory)
+{
+    hmat::Geometry geometry = planarGeometry(32);
+    auto tree = blockClusterTree(geometry);
+    SmoothKernelAccessor accessor(geometry, *tree);
+    hmat::HMatrixAcaCompressor<double, 2> compressor(accessor, 1e-10, 200);
+    hmat::DefaultHMatrixType<double> hMatrix(tree, compressor);
+
+    arma::Mat<double> original = hMatrixToDense(hMatrix);
+    double originalMemSizeKb = hMatrix.memSizeKb();
+
+    const double eps = 1e-5;
+    hMatrix.recompress(eps);
+    BOOST_CHECK_LT(hMatrix.memSizeKb(), originalMemSizeKb);
+    BOOST_CHECK_SMALL(relativeError(hMatrixToDense(hMatrix), original), eps);
+}
+
+BOOST_AUTO_TEST_CASE(coarsening_stays_within_eps_and_saves_memory)
+{
+    hmat::Geometry geometry = planarGeometry(32);
+    auto tree = blockClusterTree(geometry, 8 /* minBlockSize */);
+    SmoothKernelAccessor accessor(geometry, *tree);
+    hmat::HMatrixAcaCompressor<double, 2> compressor(accessor, 1e-10, 200);
+    hmat::DefaultHMatrixType<double> hMatrix(tree, compressor);
+
+    arma::Mat<double> original = hMatrixToDense(hMatrix);
+    const double eps = 1e-5;
+    hMatrix.recompress(eps);
+    double recompressedMemSizeKb = hMatrix.memSizeKb();
+    std::size_t recompressedLeafCount = hMatrix.numberOfLeafs();
+
+    hMatrix.recompress(eps, true /* coarsen */);
+    BOOST_CHECK_LE(hMatrix.memSizeKb(), recompressedMemSizeKb);
+    BOOST_CHECK_LT(hMatrix.numberOfLeafs(), recompressedLeafCount);
+    // Each of the two truncations may contribute an error of eps
+    BOOST_CHECK_SMALL(relativeError(hMatrixToDense(hMatrix), original),
+                      2 * eps);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -29,6 +29,8 @@
 
 #include "assembly/blocked_boundary_operator.hpp"
 #include "assembly/blocked_operator_structure.hpp"
+#include "assembly/grid_function.hpp"
+#include "assembly/surface_normal_independent_function.hpp"
 #include "linalg/default_iterative_solver.hpp"
 #include "linalg/solver.hpp"
 
@@ -38,6 +40,26 @@
 
 using namespace Bempp;
 
+namespace
+{
+
+template <typename ValueType_>
+struct LinearFunctor
+{
+    typedef ValueType_ ValueType;
+    typedef typename ScalarTraits<ValueType>::RealType CoordinateType;
+
+    int argumentDimension() const { return 3; }
+    int resultDimension() const { return 1; }
+
+    void evaluate(const arma::Col<CoordinateType>& point,
+                  arma::Col<ValueType>& result) const {
+        result(0) = point(0) + 2. * point(1) - point(2);
+    }
+};
+
+} // namespace
+
 // Tests
 
 BOOST_AUTO_TEST_SUITE(DefaultIterativeSolver)
@@ -355,6 +377,55 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(boundary_operator_agrees_with_2x2_blocked_boundary
     }
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(solve_multiple_agrees_with_separate_solves,
+                              ValueType, result_types)
+{
+    typedef ValueType RT;
+    typedef typename ScalarTraits<ValueType>::RealType RealType;
+    typedef RealType BFT;
+
+    typedef Bempp::DefaultIterativeSolver<BFT, RT> IterSolver;
+    const RealType solverTol = 1e-5;
+
+    Laplace3dDirichletFixture<BFT, RT> fixture;
+
+    // Linearly independent right-hand sides, so that the block Krylov space
+    // has full rank and mixed-up solutions are detected
+    std::vector<GridFunction<BFT, RT> > rhs(2);
+    rhs[0] = fixture.rhs;
+    rhs[1] = GridFunction<BFT, RT>(
+        fixture.lhsOp.context(), fixture.lhsOp.range(),
+        fixture.lhsOp.dualToRange(),
+        surfaceNormalIndependentFunction(LinearFunctor<RT>()));
+
+    // Solve for each right-hand side separately
+    std::vector<arma::Col<RT> > solutionVectorsSingle(rhs.size());
+    for (size_t i = 0; i < rhs.size(); ++i) {
+        IterSolver solver(
+            fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+        solver.initializeSolver(defaultGmresParameterList(solverTol));
+        Solution<BFT, RT> solution = solver.solve(rhs[i]);
+        solutionVectorsSingle[i] = solution.gridFunction().coefficients();
+    }
+    BOOST_REQUIRE(!check_arrays_are_close<ValueType>(
+                      solutionVectorsSingle[0], solutionVectorsSingle[1],
+                      solverTol * 10));
+
+    // Solve for both right-hand sides at once with Block GMRES
+    IterSolver solver(
+        fixture.lhsOp, ConvergenceTestMode::TEST_CONVERGENCE_IN_DUAL_TO_RANGE);
+    solver.initializeSolver(
+        defaultBlockGmresParameterList(solverTol, 2 /* blockSize */));
+    BlockedSolution<BFT, RT> solution = solver.solveMultiple(rhs);
+    BOOST_REQUIRE_EQUAL(solution.gridFunctionCount(), rhs.size());
+    for (size_t i = 0; i < rhs.size(); ++i) {
+        arma::Col<RT> solutionVector = solution.gridFunction(i).coefficients();
+        BOOST_CHECK(check_arrays_are_close<ValueType>(
+                        solutionVectorsSingle[i], solutionVector,
+                        solverTol * 10));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 #endif
@@ -0,0 +1,175 @@
+// Copyright (C) 2011 by the BEM++ Authors
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "../check_arrays_are_close.hpp"
+#include "../random_arrays.hpp"
+
+#include "assembly/boundary_operator.hpp"
+#include "assembly/context.hpp"
+#include "assembly/discrete_boundary_operator.hpp"
+#include "assembly/discrete_hmat_boundary_operator.hpp"
+#include "assembly/grid_function.hpp"
+#include "assembly/laplace_3d_single_layer_boundary_operator.hpp"
+#include "assembly/surface_normal_independent_function.hpp"
+#include "common/global_parameters.hpp"
+#include "grid/grid.hpp"
+#include "grid/grid_factory.hpp"
+#include "hmat/hmatrix_lu.hpp"
+#include "linalg/default_direct_solver.hpp"
+#include "linalg/hmat_direct_solver.hpp"
+#include "space/piecewise_constant_scalar_space.hpp"
+
+#include <Teuchos_ParameterList.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include <limits>
+#include <string>
+
+using namespace Bempp;
+
+namespace
+{
+
+typedef double BFT;
+typedef double RT;
+
+struct UnitFunctor
+{
+    typedef RT ValueType;
+    typedef BFT CoordinateType;
+
+    int argumentDimension() const { return 3; }
+    int resultDimension() const { return 1; }
+
+    void evaluate(const arma::Col<CoordinateType>& point,
+                  arma::Col<ValueType>& result) const {
+        result(0) = 1.;
+    }
+};
+
+shared_ptr<Space<BFT> > piecewiseConstantSpace(
+        const std::string& meshFile = "meshes/cube-12-reoriented.msh")
+{
+    GridParameters params;
+    params.topology = GridParameters::TRIANGULAR;
+    shared_ptr<Grid> grid = GridFactory::importGmshGrid(
+                params, meshFile, false /* verbose */);
+    return shared_ptr<Space<BFT> >(new PiecewiseConstantScalarSpace<BFT>(grid));
+}
+
+BoundaryOperator<BFT, RT> singleLayerOperator(
+        const shared_ptr<Space<BFT> >& space, const std::string& assemblyType,
+        int minBlockSize = 8)
+{
+    ParameterList parameters = GlobalParameters::parameterList();
+    parameters.set("boundaryOperatorAssemblyType", assemblyType);
+    parameters.set("verbosityLevel", -5);
+    parameters.sublist("HMat").set("eps", 1e-8);
+    parameters.sublist("HMat").set("maxRank", 1000);
+    parameters.sublist("HMat").set("minBlockSize", minBlockSize);
+    shared_ptr<Context<BFT, RT> > context(new Context<BFT, RT>(parameters));
+
+    return laplace3dSingleLayerBoundaryOperator<BFT, RT>(
+        context, space, space, space);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(HMatDirectSolver)
+
+BOOST_AUTO_TEST_CASE(approximate_lu_inverse_inverts_hmat_operator)
+{
+    BoundaryOperator<BFT, RT> op =
+        singleLayerOperator(piecewiseConstantSpace(), "hmat");
+    shared_ptr<const DiscreteBoundaryOperator<RT> > weakForm = op.weakForm();
+    shared_ptr<const DiscreteBoundaryOperator<RT> > inverse =
+        hMatOperatorApproximateLuInverse(weakForm, 1e-10);
+
+    const int rhsCount = 3;
+    arma::Mat<RT> x = generateRandomMatrix<RT>(weakForm->columnCount(),
+                                               rhsCount);
+    arma::Mat<RT> y(weakForm->rowCount(), rhsCount);
+    weakForm->apply(NO_TRANSPOSE, x, y, 1., 0.);
+
+    arma::Mat<RT> result(inverse->rowCount(), rhsCount);
+    result.fill(std::numeric_limits<RT>::quiet_NaN());
+    inverse->apply(NO_TRANSPOSE, y, result, 1., 0.);
+
+    BOOST_CHECK(check_arrays_are_close<RT>(result, x, 1e-5));
+}
+
+BOOST_AUTO_TEST_CASE(solution_agrees_with_default_direct_solver)
+{
+    shared_ptr<Space<BFT> > space = piecewiseConstantSpace();
+    BoundaryOperator<BFT, RT> denseOp = singleLayerOperator(space, "dense");
+    BoundaryOperator<BFT, RT> hMatOp = singleLayerOperator(space, "hmat");
+
+    GridFunction<BFT, RT> rhs(
+        denseOp.context(), denseOp.range(), denseOp.dualToRange(),
+        surfaceNormalIndependentFunction(UnitFunctor()));
+
+    DefaultDirectSolver<BFT, RT> denseSolver(denseOp);
+    arma::Col<RT> expected =
+        denseSolver.solve(rhs).gridFunction().coefficients();
+
+    Bempp::HMatDirectSolver<BFT, RT> hMatSolver(hMatOp, 1e-10);
+    Solution<BFT, RT> solution = hMatSolver.solve(rhs);
+    BOOST_CHECK_EQUAL(solution.status(), SolutionStatus::CONVERGED);
+    // The solution is only as accurate as the truncated factorisation
+    BOOST_CHECK_EQUAL(solution.achievedTolerance(), 1e-10);
+    arma::Col<RT> actual = solution.gridFunction().coefficients();
+
+    BOOST_CHECK(check_arrays_are_close<RT>(actual, expected, 1e-5));
+}
+
+BOOST_AUTO_TEST_CASE(factorisation_with_low_rank_blocks_agrees_with_default_direct_solver)
+{
+    // The 12-element cube has no admissible blocks, so its factorisation is
+    // dense. On this grid the factors contain low-rank blocks, which
+    // exercises the truncated low-rank products and updates.
+    shared_ptr<Space<BFT> > space =
+        piecewiseConstantSpace("../../meshes/sphere-h-0.2.msh");
+    BoundaryOperator<BFT, RT> denseOp = singleLayerOperator(space, "dense");
+    BoundaryOperator<BFT, RT> hMatOp =
+        singleLayerOperator(space, "hmat", 16 /* minBlockSize */);
+    const double eps = 1e-10;
+
+    shared_ptr<const DiscreteHMatBoundaryOperator<RT> > hMatWeakForm =
+        boost::dynamic_pointer_cast<const DiscreteHMatBoundaryOperator<RT> >(
+            hMatOp.weakForm());
+    BOOST_REQUIRE(hMatWeakForm);
+    hmat::DefaultHMatrixLuType<RT> lu(*hMatWeakForm->hMatrix(), eps);
+    BOOST_CHECK_GT(lu.numberOfLowRankBlocks(), 0u);
+
+    GridFunction<BFT, RT> rhs(
+        denseOp.context(), denseOp.range(), denseOp.dualToRange(),
+        surfaceNormalIndependentFunction(UnitFunctor()));
+
+    DefaultDirectSolver<BFT, RT> denseSolver(denseOp);
+    arma::Col<RT> expected =
+        denseSolver.solve(rhs).gridFunction().coefficients();
+
+    Bempp::HMatDirectSolver<BFT, RT> hMatSolver(hMatOp, eps);
+    arma::Col<RT> actual = hMatSolver.solve(rhs).gridFunction().coefficients();
+
+    BOOST_CHECK(check_arrays_are_close<RT>(actual, expected, 1e-5));
+}
+
+BOOST_AUTO_TEST_SUITE_END()